@@ -62,7 +62,8 @@ typedef enum {
 	HashTable,
 	Catalogue,
 	Report,
-	Network
+	Network,
+	LockFreeQueue
 } ContainerType;
 
 /**
@@ -73,6 +74,67 @@ typedef struct {
 	ContainerType type;		// 容器类型
 } Container_t, *Container;
 
+/**
+ * 内存分配函数的类型定义，最后一个参数为设置分配器时提供的上下文ctx，语义分别与标准库的malloc(), realloc(), free()相同
+ */
+typedef void *(*MallocFunc)(size_t, void *);
+typedef void *(*ReallocFunc)(void *, size_t, void *);
+typedef void (*FreeFunc)(void *, void *);
+
+/**
+ * 内存分配器
+ */
+typedef struct {
+	MallocFunc malloc_fn;	// 分配函数
+	ReallocFunc realloc_fn;	// 重新分配函数
+	FreeFunc free_fn;	// 释放函数
+	void *ctx;		// 传递给以上三个函数的上下文
+} Allocator_t, *Allocator;
+
+/**
+ * 容器的加锁策略
+ * Lock_Mutex:	互斥锁，默认策略，所有操作互相排斥
+ * Lock_None:	不加锁，只能用于不在线程间共享的容器，省去所有加锁开销
+ * Lock_RWLock:	读写锁，只读操作（查找、获取、迭代等）之间可以并行，修改操作独占
+ * Lock_Spin:	自旋锁，适用于临界区很短且竞争不激烈的容器，等待时不让出CPU
+ * 列表的阻塞等待操作依赖互斥锁上的条件变量，只在Lock_Mutex策略下可用，其他策略下需要等待的调用直接返回失败
+ */
+typedef enum {
+	Lock_Mutex,
+	Lock_None,
+	Lock_RWLock,
+	Lock_Spin
+} LockPolicy;
+
+/**
+ * 容器的创建属性，在各容器的*_create_ex()函数中使用，传入NULL表示全部采用默认值
+ * 建议以指定成员的方式初始化，未指定的成员为0即默认值，例如: ContainerAttr_t attr = { .slab = 1 };
+ */
+typedef struct {
+	int slab;		// 非0表示启用slab模式，容器的节点和元素从容器私有的内存块中成批分配，释放的节点和元素在容器内循环复用，清空和销毁容器时按块整体释放
+	Allocator allocator;	// 容器专用的内存分配器，创建时复制一份保存在容器中，NULL表示使用创建时的全局分配器
+	LockPolicy lock;	// 加锁策略，默认为Lock_Mutex，指定了无效的策略时创建失败
+} ContainerAttr_t, *ContainerAttr;
+
+/**
+ * 设置全库使用的全局内存分配器，三个函数均为NULL时恢复为标准库的malloc(), realloc(), free()
+ * 容器在创建时确定并保存所用的分配器，此后修改全局分配器不影响已经创建的容器，容器的迭代器也由容器的分配器分配，查找时使用的临时元素在栈上构造，较长的元素值同样由容器的分配器分配
+ * it_create()等直接创建的迭代器和mr_malloc(), mr_free()总是使用当前的全局分配器，因此应在创建任何容器之前设置
+ * 释放函数应与free()一样接受NULL
+ * 容器返回给调用者的元素值（副本或交出所有权的元素值）由该容器的分配器分配，交给容器接管所有权的元素值也必须由该容器的分配器分配
+ *
+ * return
+ *	设置成功返回0，三个函数只提供了一部分时返回-1，全局分配器不变
+ */
+extern int mr_set_allocator(MallocFunc malloc_fn, ReallocFunc realloc_fn, FreeFunc free_fn, void *ctx);
+
+/**
+ * 用全局分配器分配、重新分配和释放内存，未设置全局分配器时与标准库的malloc(), realloc(), free()相同
+ */
+extern void *mr_malloc(size_t size);
+extern void *mr_realloc(void *ptr, size_t size);
+extern void mr_free(void *ptr);
+
 typedef long long Integer;		// 整数类型
 typedef long double Real;		// 实数类型
 typedef char *String;			// 字符串类型
@@ -108,6 +170,18 @@ typedef void *Element;
  */
 typedef int (*CmpFunc)(const Element, const Element, size_t, size_t);
 
+/**
+ * 元素哈希函数的类型定义，两个参数依次为元素的值, 元素的长度，与比较函数配套使用，比较函数认为相等的两个元素必须得到相同的哈希值
+ */
+typedef size_t (*HashFunc)(const Element, size_t);
+
+/**
+ * 元素访问函数的类型定义，三个参数依次为容器中元素的值, 元素的长度, 调用者提供的上下文
+ * 访问函数直接读取容器内部保存的元素值，不产生副本，调用期间容器处于加锁状态，因此访问函数中不能修改该元素，也不能再访问同一个容器
+ * 返回非0值表示终止后续的访问，仅在连续访问多个元素时有意义，例如各容器的*_foreach()函数
+ */
+typedef int (*VisitFunc)(const Element, size_t, void *);
+
 /**
  * 迭代器
  */
@@ -129,7 +203,53 @@ extern const int Desc;
  * 迭代器函数
  */
 extern Iterator it_create(void *iterator, Element (*next)(void *), size_t (*remove)(void *), void (*reset)(void *), void (*destroy)(void *));
+
+/**
+ * @brief 创建同时提供访问迭代和批量迭代实现的迭代器，前两个参数和后三个参数与it_create()相同
+ * it_create()创建的迭代器以及这里next_with或next_batch为NULL时，it_next_with()和it_next_batch()通过next函数逐个复制元素完成
+ *
+ * @param next_with
+ *	用访问函数直接访问下一个元素的函数，迭代完成时返回-1，可以为NULL
+ * @param next_batch
+ *	一次迭代多个元素的函数，返回写入的元素数量，可以为NULL
+ *
+ * @return
+ *	新创建的迭代器，内存不足时返回NULL
+ */
+extern Iterator it_create_ex(void *iterator, Element (*next)(void *), int (*next_with)(void *, VisitFunc, void *), size_t (*next_batch)(void *, Element *, size_t), size_t (*remove)(void *), void (*reset)(void *), void (*destroy)(void *));
 extern Element it_next(Iterator it);
+
+/**
+ * @brief 用访问函数直接访问下一个元素，不产生副本，访问期间容器处于加锁状态，访问函数的返回值被忽略
+ * 未提供next_with实现的迭代器通过next函数取得副本后访问并释放，此时访问函数得到的元素长度为0
+ *
+ * @param it
+ *	迭代器
+ * @param visit
+ *	访问函数
+ * @param ctx
+ *	传递给访问函数的上下文
+ *
+ * @return
+ *	访问成功返回0，已经迭代完成时返回-1，直到迭代器被重置
+ */
+extern int it_next_with(Iterator it, VisitFunc visit, void *ctx);
+
+/**
+ * @brief 一次迭代最多n个元素，把它们的副本依次写入out数组，整批只对容器加锁一次，副本由调用者负责释放
+ * 未提供next_batch实现的迭代器通过next函数逐个复制
+ *
+ * @param it
+ *	迭代器
+ * @param out
+ *	保存元素副本的数组，至少有n个位置
+ * @param n
+ *	最多迭代的元素数量
+ *
+ * @return
+ *	写入的元素数量，小于n表示迭代已经结束或复制元素时内存不足，迭代结束后再调用返回0直到迭代器被重置
+ */
+extern size_t it_next_batch(Iterator it, Element *out, size_t n);
 extern size_t it_remove(Iterator it);
 extern void it_reset(Iterator it);
 extern void it_destroy(Iterator it);
@@ -20,6 +20,17 @@
  */
 extern Container hash_create(void);
 
+/**
+ * @brief 按指定的创建属性创建一个哈希表
+ *
+ * @param attr
+ * 	创建属性，NULL表示全部采用默认值，等同于hash_create()
+ *
+ * @return 
+ * 	哈希表容器，创建失败返回NULL
+ */
+extern Container hash_create_ex(ContainerAttr attr);
+
 /**
  * @brief 销毁一个哈希表容器，销毁其中所有保存的元素
  *
@@ -70,6 +81,42 @@ extern size_t hash_size(Container hash);
  */
 extern int hash_register(Container hash, Element ele, ElementType type, size_t len);
 
+/**
+ * @brief 向哈希表中注册一个新元素并接管元素值的所有权，元素值不进行复制
+ *
+ * @param hash
+ * 	哈希表容器
+ * @param ele
+ * 	元素值，必须是由容器的分配器分配的内存，字符串必须至少有len + 1个字节
+ * @param type
+ * 	元素数据类型
+ * @param len
+ * 	元素长度
+ *
+ * @return 
+ * 	注册成功返回0，此后ele归哈希表所有，调用者不能再访问或释放；注册失败或相同的元素已经存在返回-1，ele仍归调用者所有
+ */
+extern int hash_register_adopt(Container hash, Element ele, ElementType type, size_t len);
+
+/**
+ * @brief 向哈希表中批量注册一组元素，整个过程只加锁一次，事先把哈希表一次扩充到足够的容量，已经存在的元素将被跳过
+ *
+ * @param hash
+ * 	哈希表容器
+ * @param values
+ * 	元素值数组，integer, real和object类型为连续存放的元素值，每个元素值占len个字节；string类型为字符串指针数组，即String *
+ * @param count
+ * 	元素数量
+ * @param type
+ * 	元素数据类型
+ * @param len
+ * 	integer, real和object类型为每个元素值的字节长度，string类型不使用，每个字符串的长度为strlen()
+ *
+ * @return 
+ * 	实际注册的元素数量
+ */
+extern size_t hash_register_many(Container hash, const void *values, size_t count, ElementType type, size_t len);
+
 /**
  * @brief 判断一个元素是否在哈希表中已经注册存在
  *
@@ -126,4 +173,19 @@ extern int hash_removeall(Container hash);
  */
 extern Iterator hash_iterator(Container hash);
 
+/**
+ * @brief 用访问函数访问哈希表中的全部元素，不复制元素，整个过程只加锁一次，访问函数返回非0时立即终止，访问顺序与迭代器相同
+ *
+ * @param hash
+ * 	哈希表容器
+ * @param visit
+ * 	访问函数，在哈希表加锁期间执行，不能修改元素，也不能再访问同一个哈希表
+ * @param ctx
+ * 	传递给访问函数的上下文
+ *
+ * @return 
+ * 	已访问的元素数量，包括使访问终止的元素，哈希表无效或visit为NULL时返回0
+ */
+extern size_t hash_foreach(Container hash, VisitFunc visit, void *ctx);
+
 #endif
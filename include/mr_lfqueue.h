@@ -0,0 +1,124 @@
+/**
+ * "mr_lfqueue.h"，无锁队列
+ * 无锁队列是容量固定的环形先进先出队列，入队和出队不使用互斥锁，多个线程同时访问时互不阻塞，适合在线程之间高频率地传递消息
+ * 多生产者多消费者队列的每个槽位带有一个序号，生产者和消费者各自用一次原子比较交换抢占位置，再通过槽位序号交接元素
+ * 单生产者单消费者队列只能由一个线程入队、一个线程出队，不需要原子比较交换，速度更快，多个线程同时入队或同时出队的结果是未定义的
+ * 无锁队列与列表的队列接口一样，入队时复制元素，出队时把元素值交给调用者；队列满时入队立即失败，队列空时出队立即返回NULL，不进行等待
+ * 无锁队列是强类型容器，在创建时必须指定一种元素类型，不支持迭代器和随机访问
+ */
+#ifndef MR_LFQUEUE_H
+#define MR_LFQUEUE_H
+
+#include "mr_common.h"
+
+typedef enum {
+	MPMC_Queue,
+	SPSC_Queue
+} LFQueueType;
+
+/**
+ * @brief 创建一个无锁队列
+ *
+ * @param qtype
+ * 	队列类型，MPMC_Queue为多生产者多消费者队列，SPSC_Queue为单生产者单消费者队列
+ * @param etype
+ * 	元素的数据类型
+ * @param capacity
+ * 	队列容量，向上取整为2的幂，最小为2
+ *
+ * @return 
+ * 	新建的无锁队列，取整后的容量超出可分配的大小或创建失败返回NULL
+ */
+extern Container lfq_create(LFQueueType qtype, ElementType etype, size_t capacity);
+
+/**
+ * @brief 按指定的创建属性创建一个无锁队列，队列只使用创建属性中的分配器，不支持slab模式，分配器必须是线程安全的
+ *
+ * @param qtype
+ * 	队列类型
+ * @param etype
+ * 	元素的数据类型
+ * @param capacity
+ * 	队列容量，向上取整为2的幂，最小为2
+ * @param attr
+ * 	创建属性，NULL表示全部采用默认值，等同于lfq_create()
+ *
+ * @return 
+ * 	新建的无锁队列，取整后的容量超出可分配的大小或创建失败返回NULL
+ */
+extern Container lfq_create_ex(LFQueueType qtype, ElementType etype, size_t capacity, ContainerAttr attr);
+
+/**
+ * @brief 销毁无锁队列及其中剩余的元素，销毁时不能有其他线程正在访问队列
+ *
+ * @param q
+ * 	无锁队列容器
+ *
+ * @return 
+ * 	销毁成功返回0，容器无效返回-1
+ */
+extern int lfq_destroy(Container q);
+
+/**
+ * @brief 获取队列中的元素数量，其他线程同时入队或出队时只是一个近似值
+ *
+ * @param q
+ * 	无锁队列容器
+ *
+ * @return 
+ * 	元素数量，容器无效返回0
+ */
+extern size_t lfq_size(Container q);
+
+/**
+ * @brief 判断队列是否为空，其他线程同时入队或出队时只是一个近似判断
+ *
+ * @param q
+ * 	无锁队列容器
+ *
+ * @return 
+ * 	队列为空返回1，不空返回0，容器无效返回1
+ */
+extern int lfq_isempty(Container q);
+
+/**
+ * @brief 获取队列的容量
+ *
+ * @param q
+ * 	无锁队列容器
+ *
+ * @return 
+ * 	队列容量，容器无效返回0
+ */
+extern size_t lfq_capacity(Container q);
+
+/**
+ * @brief 新元素入队，元素值被复制，元素值为NULL或长度为0时入队失败，因为出队返回的NULL表示队列为空
+ *
+ * @param q
+ * 	无锁队列容器
+ * @param element
+ * 	待入队元素的值
+ * @param type
+ * 	待入队元素的类型
+ * @param len
+ * 	待入队元素的字节长度
+ *
+ * @return 
+ * 	入队成功返回0，队列已满、元素值为空或入队失败返回-1
+ */
+extern int lfq_enqueue(Container q, Element element, ElementType type, size_t len);
+
+/**
+ * @brief 队首元素出队
+ *
+ * @param q
+ * 	无锁队列容器
+ *
+ * @return 
+ * 	队首元素的值，由调用者用容器的分配器释放，队列为空时返回NULL
+ * 	出队时元素值连同元素所在的内存直接交给调用者，不需要再分配内存，因此不会因内存不足丢失已出队的元素
+ */
+extern Element lfq_dequeue(Container q);
+
+#endif
@@ -1,10 +1,13 @@
 /**
- * "mr_list.h"，多用途的列表容器，可基于数组或链表两种实现方式
+ * "mr_list.h"，多用途的列表容器，可基于数组、环形数组、链表、展开链表或索引树五种实现方式
  * 列表容器可以实现按索引随机存取，但基于链表结构的列表在随机存取时效率较低
  * 列表容器也可以使用迭代器顺序访问，且列表容器在迭代时可以删除当前迭代位置的元素，对基于数组和链表两种结构的列表迭代器的效率都很好
  * 列表容器可以进行排序和反向排列操作，对已经排序的列表可以进行二分搜索，但基于链表结构的列表二分搜索的效率较低
  * 列表容器提供堆栈和队列的访问接口，可以把容器直接作为堆栈或队列来使用
  * 基于数组的列表在中间插入或删除元素时效率明显低于基于链表的列表
+ * 基于环形数组的列表在两端插入和删除元素的时间为O(1)，在中间插入或删除时只移动较短一侧的元素，适合作为队列和双端队列使用
+ * 基于展开链表的列表每个节点存放一小段连续的元素，兼顾链表在中间插入删除的效率和数组在顺序访问、搜索时的缓存友好性
+ * 基于索引树的列表用记录子树大小的平衡二叉树按位置组织元素，按位置读取、插入、删除和二分搜索的时间均为O(log n)，适合在很长的有序序列中频繁按位置编辑
  * 列表的迭代器同样使用Fast-Fail模式，如果在迭代过程中目标列表被其他线程或其他迭代器修改，则迭代立即终止，再次迭代需要重置迭代器
  * 列表容器可以存入重复元素（元素值相等）和空元素（元素值为NULL或元素长度为0），元素默认比较时，元素值为NULL的空元素会认为比元素值不为NULL但元素长度为0的元素更小
  * 列表容器是强类型容器，在创建时必须指定一种元素类型，表内只能存取相同类型的元素，也可以使用object类型以实现多类型容器
@@ -22,7 +25,10 @@
  */
 typedef enum {
 	ArrayList,
-	LinkedList
+	LinkedList,
+	RingList,
+	UnrolledList,
+	IndexedList
 } ListType;
 
 /**
@@ -31,7 +37,7 @@ typedef enum {
  * @param etype
  *	列表的元素类型
  * @param ltype
- *	列表的构造类型，LinkedList或ArrayList
+ *	列表的构造类型，LinkedList、ArrayList、RingList、UnrolledList或IndexedList
  * @param cmpfunc
  *	列表元素的比较函数，NULL表示使用元素类型对应的默认比较函数
  *
@@ -40,6 +46,24 @@ typedef enum {
  */
 extern Container list_create(ElementType etype, ListType ltype, CmpFunc cmpfunc);
 
+/**
+ * @brief 按指定的创建属性创建一个列表容器
+ *
+ * @param etype
+ *	列表的元素类型
+ * @param ltype
+ *	列表的构造类型，LinkedList、ArrayList、RingList、UnrolledList或IndexedList
+ * @param cmpfunc
+ *	列表元素的比较函数，NULL表示使用元素类型对应的默认比较函数
+ * @param attr
+ *	创建属性，NULL表示全部采用默认值，等同于list_create()
+ *	加锁策略为Lock_RWLock时，展开链表(UnrolledList)的只读操作会移动内部的定位缓存，仍然互相排斥
+ *
+ * @return
+ *	创建成功返回列表容器，失败返回NULL
+ */
+extern Container list_create_ex(ElementType etype, ListType ltype, CmpFunc cmpfunc, ContainerAttr attr);
+
 /**
  * @brief 销毁一个列表容器，同时销毁其中所有元素
  *
@@ -61,6 +85,40 @@ extern int list_destroy(Container list);
  */
 extern void list_set_cmpfunc(Container list, CmpFunc cmpfunc);
 
+/**
+ * @brief 设置列表容器的哈希函数，与自定义的比较函数配套，用于list_minus()和list_retain()中对另一个列表建立哈希索引
+ * 使用默认比较函数时无需设置，自动使用默认的哈希函数；使用自定义比较函数而未设置哈希函数时改用按比较函数排序后二分查找
+ * 调用list_set_cmpfunc()重新设置比较函数时哈希函数被清除
+ *
+ * @param list
+ * 	列表容器
+ * @param hashfunc
+ * 	哈希函数，比较函数认为相等的元素必须有相同的哈希值，NULL表示不使用哈希函数
+ */
+extern void list_set_hashfunc(Container list, HashFunc hashfunc);
+
+/**
+ * @brief 设置链表节点缓存的容量，链表删除元素时把空闲节点留在缓存中供之后添加元素时复用，不再每次都向分配器申请和释放，默认缓存256个节点
+ * 只对非slab模式的链表(LinkedList)有效，slab模式下节点已经在slab中循环复用，其他类型的列表不使用缓存
+ *
+ * @param list
+ * 	列表容器
+ * @param max
+ * 	最多缓存的空闲节点数量，0表示不缓存，缓存中已有的超出部分立即释放
+ */
+extern void list_set_cache(Container list, size_t max);
+
+/**
+ * @brief 释放链表节点缓存中的全部空闲节点，缓存容量不变，例如在一次突发的大量进出之后归还内存
+ *
+ * @param list
+ * 	列表容器
+ *
+ * @return 
+ * 	释放的节点数量，列表无效或没有缓存时返回0
+ */
+extern size_t list_trim(Container list);
+
 /**
  * @brief 判断一个列表容器是否为空
  *
@@ -84,7 +142,21 @@ extern int list_isempty(Container list);
 extern size_t list_size(Container list);
 
 /**
- * @brief 在列表最后添加一个新元素，本函数调用list_insert()函数实现添加
+ * @brief 为列表预留容纳指定数量元素的空间，此后元素数量不超过预留容量时添加元素不再需要扩容
+ * 只对线性表和环形线性表有效，环形线性表的容量向上取整为2的幂；其他列表按需分配节点，直接返回0
+ *
+ * @param list
+ * 	列表容器
+ * @param capacity
+ * 	预留的元素数量，不大于现有容量时不做任何操作
+ *
+ * @return 
+ * 	预留成功返回0，列表无效或分配失败返回-1
+ */
+extern int list_reserve(Container list, size_t capacity);
+
+/**
+ * @brief 在列表最后添加一个新元素，本函数调用list_insert()函数实现添加，有序模式下添加到有序位置
  *
  * @param list
  * 	列表容器
@@ -101,7 +173,7 @@ extern size_t list_size(Container list);
 extern int list_append(Container list, Element element, ElementType type, size_t len);
 
 /**
- * @brief 在列表指定位置插入一个元素
+ * @brief 在列表指定位置插入一个元素，有序模式下忽略index，插入到排在所有相等元素之后的有序位置，见list_sort_lock()
  *
  * @param list
  * 	列表容器
@@ -119,6 +191,84 @@ extern int list_append(Container list, Element element, ElementType type, size_t
  */
 extern int list_insert(Container list, size_t index, Element element, ElementType type, size_t len);
 
+/**
+ * @brief 在列表最后添加一个新元素并接管元素值的所有权，元素值不进行复制，本函数调用list_insert_adopt()函数实现添加
+ *
+ * @param list
+ * 	列表容器
+ * @param element
+ * 	待添加元素的值，必须是由容器的分配器分配的内存，字符串必须至少有len + 1个字节
+ * @param type
+ * 	待添加元素的类型
+ * @param len
+ * 	待添加元素的字节长度
+ *
+ * @return 
+ * 	添加成功返回0，此后element归列表所有，调用者不能再访问或释放；失败返回-1，element仍归调用者所有
+ */
+extern int list_append_adopt(Container list, Element element, ElementType type, size_t len);
+
+/**
+ * @brief 在列表指定位置插入一个元素并接管元素值的所有权，元素值不进行复制
+ *
+ * @param list
+ * 	列表容器
+ * @param index
+ * 	插入的位置，超过现有列表尾部的在尾部插入
+ * @param element
+ * 	待插入元素的值，必须是由容器的分配器分配的内存，字符串必须至少有len + 1个字节
+ * @param type
+ * 	待插入元素的类型
+ * @param len
+ * 	待插入元素的字节长度
+ *
+ * @return 
+ * 	插入成功返回0，此后element归列表所有，调用者不能再访问或释放；失败返回-1，element仍归调用者所有
+ */
+extern int list_insert_adopt(Container list, size_t index, Element element, ElementType type, size_t len);
+
+/**
+ * @brief 在列表最后批量添加一组元素，本函数调用list_insert_range()函数实现添加
+ *
+ * @param list
+ * 	列表容器
+ * @param values
+ * 	元素值数组，integer, real和object类型为连续存放的元素值，每个元素值占len个字节；string类型为字符串指针数组，即String *，指针不能为NULL
+ * @param count
+ * 	元素数量
+ * @param type
+ * 	元素的类型
+ * @param len
+ * 	integer, real和object类型为每个元素值的字节长度，同时也是数组中相邻元素值的间隔；string类型不使用，每个字符串的长度为strlen()
+ *
+ * @return 
+ * 	添加成功返回0，失败返回-1
+ */
+extern int list_append_array(Container list, const void *values, size_t count, ElementType type, size_t len);
+
+/**
+ * @brief 在列表指定位置批量插入一组元素，整个过程只加锁一次，插入的元素保持在数组中的顺序
+ * 线性表和环形线性表一次预留足够的空间并只移动一次后续元素，链表只查找一次插入位置
+ * 有序模式下忽略index，全部添加后与原有元素一起做一次稳定排序
+ *
+ * @param list
+ * 	列表容器
+ * @param index
+ * 	插入的位置，超过现有列表尾部的在尾部插入
+ * @param values
+ * 	元素值数组，约定同list_append_array()
+ * @param count
+ * 	元素数量
+ * @param type
+ * 	元素的类型
+ * @param len
+ * 	元素的长度，约定同list_append_array()
+ *
+ * @return 
+ * 	插入成功返回0，失败返回-1，失败时一个元素也不插入
+ */
+extern int list_insert_range(Container list, size_t index, const void *values, size_t count, ElementType type, size_t len);
+
 /**
  * @brief 获取列表容器中第index个位置的元素，index从0开始计数
  *
@@ -132,6 +282,40 @@ extern int list_insert(Container list, size_t index, Element element, ElementTyp
  */
 extern Element list_get(Container list, size_t index);
 
+/**
+ * @brief 用访问函数直接访问列表容器中第index个位置的元素，不复制元素，访问函数在列表加锁期间执行
+ *
+ * @param list
+ * 	列表容器
+ * @param index
+ * 	元素所在位置，从0开始计数
+ * @param visit
+ * 	访问函数
+ * @param ctx
+ * 	传递给访问函数的上下文
+ *
+ * @return 
+ * 	访问成功返回0，index超过范围或列表无效时返回-1
+ */
+extern int list_get_with(Container list, size_t index, VisitFunc visit, void *ctx);
+
+/**
+ * @brief 把列表容器中第index个位置的元素复制到调用者提供的缓冲区中，不分配内存
+ *
+ * @param list
+ * 	列表容器
+ * @param index
+ * 	元素所在位置，从0开始计数
+ * @param buf
+ * 	缓冲区
+ * @param cap
+ * 	缓冲区的字节容量
+ *
+ * @return 
+ * 	元素的长度（字符串包含结尾符），返回值大于cap时表示缓冲区不足，不进行复制，index超过范围或列表无效时返回-1
+ */
+extern long list_get_into(Container list, size_t index, void *buf, size_t cap);
+
 /**
  * @brief 删除列表容器中第index个位置的元素，index从0开始计数
  *
@@ -145,6 +329,22 @@ extern Element list_get(Container list, size_t index);
  */
 extern size_t list_remove_at(Container list, size_t index);
 
+/**
+ * @brief 删除列表中位置在[from, to)之间的所有元素，整个过程只加锁一次
+ * 线性表只移动一次后续元素完成压缩，环形线性表移动删除范围前后两侧中较短的一侧
+ *
+ * @param list
+ * 	列表容器
+ * @param from
+ * 	范围的起点
+ * @param to
+ * 	范围的终点（不含），超过列表尾部的部分被忽略
+ *
+ * @return 
+ * 	实际删除的元素数量
+ */
+extern size_t list_remove_range(Container list, size_t from, size_t to);
+
 /**
  * @brief 删除列表容器中所有与ele相等的元素
  *
@@ -194,6 +394,7 @@ extern int list_search(Container list, int from, int dir, Element element, Eleme
 /**
  * @brief 对列表进行二分搜索，注意：二分搜索是一种快速但不确定的搜索算法，当列表中有重复元素时，对重复元素的搜索不能确保返回的结果是确定的
  * 另外，如果列表处于无序状态，或排序和二分搜索用了不同的比较函数，可能导致无法进行正确的搜索
+ * 有序模式下按设定的顺序搜索，否则根据首尾两个元素判断列表的排列顺序
  *
  * @param list
  * 	列表容器
@@ -209,8 +410,67 @@ extern int list_search(Container list, int from, int dir, Element element, Eleme
  */
 extern int list_bi_search(Container list, Element element, ElementType type, size_t len);
 
+/**
+ * @brief 在有序列表中查找第一个不排在指定元素之前的位置，即保持有序时该元素可插入的最前位置，与list_bi_search()一样判断排列顺序
+ * 链表为顺序查找，其他列表为二分查找
+ *
+ * @param list
+ * 	列表容器
+ * @param element
+ * 	查找的元素值
+ * @param type
+ * 	查找的元素类型
+ * @param len
+ * 	查找的元素长度
+ *
+ * @return 
+ * 	找到的位置，所有元素都排在指定元素之前时返回列表元素数量，列表无效或元素类型不符时返回-1
+ */
+extern int list_lower_bound(Container list, Element element, ElementType type, size_t len);
+
+/**
+ * @brief 在有序列表中查找第一个排在指定元素之后的位置，即保持有序时该元素可插入的最后位置，与list_bi_search()一样判断排列顺序
+ * 链表为顺序查找，其他列表为二分查找
+ *
+ * @param list
+ * 	列表容器
+ * @param element
+ * 	查找的元素值
+ * @param type
+ * 	查找的元素类型
+ * @param len
+ * 	查找的元素长度
+ *
+ * @return 
+ * 	找到的位置，没有元素排在指定元素之后时返回列表元素数量，列表无效或元素类型不符时返回-1
+ */
+extern int list_upper_bound(Container list, Element element, ElementType type, size_t len);
+
+/**
+ * @brief 在有序列表中查找与指定元素相等的所有元素的位置范围[from, to)，结果等同于list_lower_bound()和list_upper_bound()，可与list_range_iterator()配合使用
+ *
+ * @param list
+ * 	列表容器
+ * @param element
+ * 	查找的元素值
+ * @param type
+ * 	查找的元素类型
+ * @param len
+ * 	查找的元素长度
+ * @param from
+ * 	返回范围的起点，NULL表示不需要
+ * @param to
+ * 	返回范围的终点（不含），NULL表示不需要
+ *
+ * @return 
+ * 	相等元素的数量，列表无效或元素类型不符时返回0且不修改from和to
+ */
+extern size_t list_equal_range(Container list, Element element, ElementType type, size_t len, size_t *from, size_t *to);
+
 /**
  * @brief 对列表进行快速排序，注意：快速排序是一种速度快但不稳定的排序算法
+ * 基于数组的列表采用内省排序，对已经有序的列表也能保证O(n log n)的时间；基于链表的列表采用重新链接节点的归并排序，实际上是稳定的
+ * 元素较多且使用默认比较函数的整数、实数和字符串列表改用基数排序，见list_radix_sort()
  *
  * @param list
  * 	列表容器
@@ -220,7 +480,7 @@ extern int list_bi_search(Container list, Element element, ElementType type, siz
 extern void list_qsort(Container list, int order);
 
 /**
- * @brief 对列表进行插入排序，注意：插入排序是稳定的排序算法但元素数量很大时速度较慢
+ * @brief 对列表进行稳定排序，元素不超过16个时使用插入排序，元素较多时自动改用list_stable_sort()的归并排序，时间为O(n log n)
  *
  * @param list
  * 	列表容器
@@ -229,6 +489,75 @@ extern void list_qsort(Container list, int order);
  */
 extern void list_isort(Container list, int order);
 
+/**
+ * @brief 对列表进行稳定排序，相等的元素保持原有的相对顺序，时间为O(n log n)，对已经有序或基本有序的列表接近O(n)
+ * 基于链表的列表采用重新链接节点的归并排序，其他列表采用Timsort，需要分配不超过元素数量一半的临时空间，分配失败时退化为插入排序
+ *
+ * @param list
+ * 	列表容器
+ * @param order
+ * 	排序顺序，使用预定义常量Asc或Desc表示升序和降序
+ */
+extern void list_stable_sort(Container list, int order);
+
+/**
+ * @brief 对列表进行基数排序，是稳定的排序算法，只适用于使用默认比较函数的整数、实数和字符串列表，其他列表等同于list_stable_sort()
+ * 整数和实数按保持顺序的排序键做LSD基数排序，字符串做MSD基数排序，不调用比较函数，需要分配与元素数量相当的临时空间
+ * 元素较多且使用默认比较函数时，list_qsort()和list_stable_sort()也会自动使用基数排序
+ *
+ * @param list
+ * 	列表容器
+ * @param order
+ * 	排序顺序，使用预定义常量Asc或Desc表示升序和降序
+ */
+extern void list_radix_sort(Container list, int order);
+
+/**
+ * @brief 对列表进行多线程并行的稳定排序，适用于元素数量很大的基于数组的列表，排序结果与list_stable_sort()相同
+ * 线性表和环形线性表先分段由各线程排序再并行合并，需要分配与元素数量相同的临时空间；其他列表等同于list_stable_sort()
+ * 比较函数会在多个线程中同时调用，必须是可重入的；元素太少时实际使用的线程数会相应减少
+ *
+ * @param list
+ * 	列表容器
+ * @param order
+ * 	排序顺序，使用预定义常量Asc或Desc表示升序和降序
+ * @param nthreads
+ * 	线程数量，不大于0时使用在线的处理器数量
+ */
+extern void list_psort(Container list, int order, int nthreads);
+
+/**
+ * @brief 对列表进行稳定排序并进入有序模式，此后列表始终保持指定的顺序
+ * 有序模式下list_append()、list_insert()、list_push()、list_enqueue()等添加操作都把元素插入到排在所有相等元素之后的有序位置，忽略指定的位置
+ * 再次排序会改变保持的顺序，list_reverse()会把保持的顺序反转，修改比较函数时按新的比较函数重新排序
+ * 基于数组的列表插入时二分查找插入位置再移动元素，链表需要顺序查找插入位置
+ *
+ * @param list
+ * 	列表容器
+ * @param order
+ * 	保持的顺序，使用预定义常量Asc或Desc表示升序和降序
+ */
+extern void list_sort_lock(Container list, int order);
+
+/**
+ * @brief 退出有序模式，列表中的元素保持现有顺序，此后的添加操作恢复为按指定位置添加
+ *
+ * @param list
+ * 	列表容器
+ */
+extern void list_sort_unlock(Container list);
+
+/**
+ * @brief 获取列表的有序模式
+ *
+ * @param list
+ * 	列表容器
+ *
+ * @return 
+ * 	处于有序模式时返回保持的顺序Asc或Desc，否则返回0，列表无效时也返回0
+ */
+extern int list_sorted(Container list);
+
 /**
  * @brief 对列表容器中的元素进行顺序反转
  *
@@ -265,6 +594,17 @@ extern int list_push(Container list, Element element, ElementType type, size_t l
  */
 extern Element list_pop(Container list);
 
+/**
+ * @brief 用列表实现堆栈弹栈操作，直接交出栈顶元素值的所有权，较长的元素值不再复制
+ *
+ * @param list
+ * 	列表容器
+ *
+ * @return 
+ * 	栈顶元素，使用完毕后必须用容器的分配器销毁，空栈时返回NULL
+ */
+extern Element list_pop_take(Container list);
+
 /**
  * @brief 用列表实现堆栈查看栈顶元素的操作
  *
@@ -304,6 +644,17 @@ extern int list_enqueue(Container list, Element element, ElementType type, size_
  */
 extern Element list_dequeue(Container list);
 
+/**
+ * @brief 用列表实现队列出队操作，直接交出队首元素值的所有权，较长的元素值不再复制
+ *
+ * @param list
+ * 	列表容器
+ *
+ * @return 
+ * 	队首元素，使用完毕后必须用容器的分配器销毁，空队时返回NULL
+ */
+extern Element list_dequeue_take(Container list);
+
 /**
  * @brief 用列表实现队列查看队首元素的操作
  *
@@ -315,6 +666,121 @@ extern Element list_dequeue(Container list);
  */
 extern Element list_queuehead(Container list);
 
+/**
+ * @brief 设置阻塞队列的容量上限，元素数量达到上限时list_enqueue_wait()等阻塞入队函数等待其他线程出队
+ * 容量上限同样约束list_insert()、list_append()、list_push()、list_enqueue()及其adopt和array版本，超出上限时这些函数直接返回-1
+ * list_plus()、list_splice()等整表合并的函数不受限制
+ * 阻塞等待依赖互斥锁，只有采用默认加锁策略Lock_Mutex的列表才能使用等待时间不为0的阻塞函数，其他策略下这些函数直接返回失败
+ *
+ * @param list
+ * 	列表容器
+ * @param bound
+ * 	容量上限，0表示不限容量
+ *
+ * @return 
+ * 	设置成功返回0，列表无效返回-1
+ */
+extern int list_set_bound(Container list, size_t bound);
+
+/**
+ * @brief 阻塞入队，元素数量达到容量上限时一直等待到有空位或列表被关闭，有序模式下添加到有序位置
+ *
+ * @param list
+ * 	列表容器
+ * @param element
+ * 	待入队元素的值
+ * @param type
+ * 	待入队元素的类型
+ * @param len
+ * 	待入队元素的字节长度
+ *
+ * @return 
+ * 	入队成功返回0，列表已关闭、加锁策略不是Lock_Mutex或入队失败返回-1
+ */
+extern int list_enqueue_wait(Container list, Element element, ElementType type, size_t len);
+
+/**
+ * @brief 限时阻塞入队，元素数量达到容量上限时最多等待msec毫秒
+ *
+ * @param list
+ * 	列表容器
+ * @param element
+ * 	待入队元素的值
+ * @param type
+ * 	待入队元素的类型
+ * @param len
+ * 	待入队元素的字节长度
+ * @param msec
+ * 	最长等待的毫秒数，0表示不等待，小于0表示一直等待
+ *
+ * @return 
+ * 	入队成功返回0，超时、列表已关闭、msec不为0而加锁策略不是Lock_Mutex或入队失败返回-1
+ */
+extern int list_enqueue_timedwait(Container list, Element element, ElementType type, size_t len, long msec);
+
+/**
+ * @brief 阻塞出队，列表为空时一直等待到有元素入队或列表被关闭，列表关闭后仍可取出剩余的元素
+ * 等待期间不占用处理器，元素入队后立即唤醒等待的线程，因此不需要轮询
+ *
+ * @param list
+ * 	列表容器
+ *
+ * @return 
+ * 	表头元素的值，直接交出所有权，调用者负责释放；列表已关闭且为空或加锁策略不是Lock_Mutex时返回NULL
+ */
+extern Element list_dequeue_wait(Container list);
+
+/**
+ * @brief 限时阻塞出队，列表为空时最多等待msec毫秒
+ *
+ * @param list
+ * 	列表容器
+ * @param msec
+ * 	最长等待的毫秒数，0表示不等待，小于0表示一直等待
+ *
+ * @return 
+ * 	表头元素的值，直接交出所有权，调用者负责释放；超时、列表已关闭且为空或msec不为0而加锁策略不是Lock_Mutex时返回NULL
+ */
+extern Element list_dequeue_timedwait(Container list, long msec);
+
+/**
+ * @brief 批量出队，列表为空时最多等待msec毫秒，有元素后一次取出最多max个元素，整个过程只加锁一次
+ *
+ * @param list
+ * 	列表容器
+ * @param buf
+ * 	接收元素值的数组，元素值直接交出所有权，调用者负责逐个释放
+ * @param max
+ * 	最多取出的元素数量，buf至少要能容纳max个元素
+ * @param msec
+ * 	列表为空时最长等待的毫秒数，0表示不等待，小于0表示一直等待
+ *
+ * @return 
+ * 	实际取出的元素数量，超时、列表已关闭且为空或msec不为0而加锁策略不是Lock_Mutex时返回0；
+ * 	内联存储的元素值复制失败时只返回此前取出的元素，其余元素留在列表中
+ */
+extern size_t list_drain(Container list, Element *buf, size_t max, long msec);
+
+/**
+ * @brief 关闭阻塞队列，唤醒所有等待中的线程，此后阻塞入队函数立即返回-1，阻塞出队函数取完剩余元素后立即返回
+ * 用于通知流水线上的消费者线程结束工作；销毁列表前应先关闭并等待所有使用它的线程结束
+ *
+ * @param list
+ * 	列表容器
+ */
+extern void list_close(Container list);
+
+/**
+ * @brief 判断阻塞队列是否已经关闭
+ *
+ * @param list
+ * 	列表容器
+ *
+ * @return 
+ * 	已关闭返回1，未关闭返回0，列表无效返回1
+ */
+extern int list_isclosed(Container list);
+
 /**
  * @brief 获取列表容器的迭代器
  *
@@ -328,8 +794,45 @@ extern Element list_queuehead(Container list);
  */
 extern Iterator list_iterator(Container list, int dir);
 
+/**
+ * @brief 获取只迭代列表中位置在[from, to)之间的元素的迭代器，超出列表尾部的部分被忽略，反向迭代时从to - 1迭代到from
+ * 通过迭代器删除元素后，范围的终点随之前移
+ *
+ * @param list
+ * 	列表容器
+ * @param from
+ * 	范围的起点
+ * @param to
+ * 	范围的终点（不含）
+ * @param dir
+ * 	迭代方向，Forward或Reverse
+ *
+ * @return 
+ * 	列表的迭代器，列表无效或from大于to时返回NULL，创建失败返回NULL
+ */
+extern Iterator list_range_iterator(Container list, size_t from, size_t to, int dir);
+
+/**
+ * @brief 按顺序用访问函数访问列表中的全部元素，不复制元素，整个过程只加锁一次，访问函数返回非0时立即终止
+ * 链表、展开链表和索引树沿节点顺序遍历，比迭代器逐个定位元素更快，遍历大量元素时应优先使用
+ *
+ * @param list
+ * 	列表容器
+ * @param dir
+ * 	访问方向，Forward或Reverse
+ * @param visit
+ * 	访问函数，在列表加锁期间执行，不能修改元素，也不能再访问同一个列表
+ * @param ctx
+ * 	传递给访问函数的上下文
+ *
+ * @return 
+ * 	已访问的元素数量，包括使访问终止的元素，列表无效或visit为NULL时返回0
+ */
+extern size_t list_foreach(Container list, int dir, VisitFunc visit, void *ctx);
+
 /**
  * @brief 把list2中的所有元素添加到list1的最后，保持在list2中的顺序，两个列表元素类型不同时不做任何添加
+ * list1和list2为同一个列表时把原有的元素再添加一遍
  *
  * @param list1
  * 	列表1
@@ -339,7 +842,46 @@ extern Iterator list_iterator(Container list, int dir);
 extern void list_plus(Container list1, Container list2);
 
 /**
- * @brief 从list1中删除所有在list2中存在的元素，两个列表的元素数据类型不同时不做任何删除
+ * @brief 把src中的所有元素按原顺序移到dst的第index个位置，src被清空，两个列表元素类型不同或为同一个列表时失败
+ * 只有两个列表都没有启用slab模式且使用相同的分配器时元素才直接转移而不复制：两个链表之间直接把src的节点整串接入，只需找到插入位置，
+ * 线性表和环形线性表一次预留空间后整块移动元素指针，dst为空且类型相同时直接交换存储
+ * 其他情况下元素不能在列表间转移，退化为逐个复制到dst后清空src，时间和内存开销与list_plus()相同，并且可能因内存不足失败
+ * 两个列表按地址顺序加锁，两个线程以相反的顺序同时操作同一对列表时不会死锁
+ * dst处于有序模式时忽略index，src与dst按相同顺序和比较函数有序时线性合并，否则添加后重新稳定排序
+ *
+ * @param dst
+ * 	目标列表
+ * @param index
+ * 	插入位置，超过表尾的添加在尾部
+ * @param src
+ * 	源列表
+ *
+ * @return 
+ * 	成功返回0，列表无效、元素类型不同或为同一个列表或内存不足时返回-1，失败时两个列表都不变
+ */
+extern int list_splice(Container dst, size_t index, Container src);
+
+/**
+ * @brief 把src中的所有元素合并到dst中，src被清空，两个列表须已按order和dst的比较函数排好序，合并后dst按order有序，相等的元素中原dst的在前
+ * 时间为O(n + m)：链表重新链接节点，线性表和环形线性表只使用较短一段长度的缓冲区
+ * 元素转移的条件与list_splice()相同，只有两个列表都没有启用slab模式且分配器相同时才不复制元素，否则先把src的元素逐个复制到dst再合并
+ * dst处于有序模式时忽略order，按有序模式的顺序合并
+ *
+ * @param dst
+ * 	目标列表
+ * @param src
+ * 	源列表
+ * @param order
+ * 	两个列表的排列顺序，Asc或Desc
+ *
+ * @return 
+ * 	成功返回0，列表无效、元素类型不同或为同一个列表或内存不足时返回-1，失败时两个列表都不变
+ */
+extern int list_merge(Container dst, Container src, int order);
+
+/**
+ * @brief 从list1中删除所有在list2中存在的元素，两个列表的元素数据类型不同时不做任何删除，list1和list2为同一个列表时list1被清空
+ * 用list2的比较函数判断元素是否相等，先对list2建立哈希索引（或排序后的查找表），再对list1做一遍压缩，时间接近O(n + m)
  *
  * @param list1
  * 	列表1
@@ -349,7 +891,8 @@ extern void list_plus(Container list1, Container list2);
 extern void list_minus(Container list1, Container list2);
 
 /**
- * @brief 从list1中删除所有在list2中不存在的元素，两个列表的元素数据类型不同或list2为空集合时list1将被清空
+ * @brief 从list1中删除所有在list2中不存在的元素，两个列表的元素数据类型不同或list2为空集合时list1将被清空，list1和list2为同一个列表时list1不变
+ * 与list_minus()一样先对list2建立索引，再对list1做一遍压缩
  *
  * @param list1
  * 	列表1
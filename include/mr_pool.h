@@ -27,6 +27,19 @@ typedef int PoolNodeHandler;
  */
 extern Container pool_create(size_t capacity);
 
+/**
+ * @brief 按指定的创建属性创建一个池，池只使用创建属性中的分配器，不支持slab模式
+ *
+ * @param capacity
+ *	池容量，小于10时取下限10
+ * @param attr
+ *	创建属性，NULL表示全部采用默认值，等同于pool_create()
+ *
+ * @return 
+ *	创建成功返回一个封装了池的容器，创建失败返回NULL
+ */
+extern Container pool_create_ex(size_t capacity, ContainerAttr attr);
+
 /**
  * @brief 销毁池，但不销毁其中的元素
  *
@@ -91,6 +104,23 @@ extern double pool_ratio(Container pool);
  */
 extern PoolNodeHandler pool_retrieve(Container pool, Element element, ElementType type, size_t len);
 
+/**
+ * @brief 托管一个元素到池中并接管元素值的所有权，元素值不进行复制
+ *
+ * @param pool
+ *	池容器
+ * @param element
+ *	要托管到池中的元素，必须是由容器的分配器分配的内存，字符串必须至少有len + 1个字节
+ * @param type
+ *	元素的类型
+ * @param len
+ *	元素的长度
+ *
+ * @return
+ *	托管成功返回一个非负整数的句柄，此后element归池所有，调用者不能再访问或释放；托管失败返回-1，element仍归调用者所有
+ */
+extern PoolNodeHandler pool_retrieve_adopt(Container pool, Element element, ElementType type, size_t len);
+
 /**
  * @brief 从池中释放一个元素并销毁池中保存的元素
  *
@@ -104,6 +134,19 @@ extern PoolNodeHandler pool_retrieve(Container pool, Element element, ElementTyp
  */
 extern size_t pool_release(Container pool, PoolNodeHandler handler);
 
+/**
+ * @brief 从池中释放一个元素并交出元素值的所有权，较长的元素值不再复制
+ *
+ * @param pool
+ *	池容器
+ * @param handler
+ *	要释放的元素的句柄
+ *
+ * @return
+ *	被释放的元素，使用完毕后必须用容器的分配器销毁，释放失败或句柄无效返回NULL
+ */
+extern Element pool_release_take(Container pool, PoolNodeHandler handler);
+
 /**
  * @brief 从池中获取一个元素
  *
@@ -117,6 +160,40 @@ extern size_t pool_release(Container pool, PoolNodeHandler handler);
  */
 extern Element pool_get(Container pool, PoolNodeHandler handler);
 
+/**
+ * @brief 用访问函数直接访问池中的一个元素，不复制元素，访问函数在池加锁期间执行
+ *
+ * @param pool
+ *	池容器
+ * @param handler
+ *	要访问的元素的句柄
+ * @param visit
+ *	访问函数
+ * @param ctx
+ *	传递给访问函数的上下文
+ *
+ * @return
+ *	访问成功返回0，句柄无效或访问失败返回-1
+ */
+extern int pool_get_with(Container pool, PoolNodeHandler handler, VisitFunc visit, void *ctx);
+
+/**
+ * @brief 把池中的一个元素复制到调用者提供的缓冲区中，不分配内存
+ *
+ * @param pool
+ *	池容器
+ * @param handler
+ *	要获取的元素的句柄
+ * @param buf
+ *	缓冲区
+ * @param cap
+ *	缓冲区的字节容量
+ *
+ * @return
+ *	元素的长度（字符串包含结尾符），返回值大于cap时表示缓冲区不足，不进行复制，句柄无效或获取失败返回-1
+ */
+extern long pool_get_into(Container pool, PoolNodeHandler handler, void *buf, size_t cap);
+
 /**
  * @brief 扩展池的容量，扩展的容量为池创建时的初始容量
  *
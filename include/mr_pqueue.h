@@ -34,6 +34,23 @@ typedef enum {
  */
 extern Container pq_create(PriorityType ptype, ElementType etype, CmpFunc cmpfunc);
 
+/**
+ * @brief 按指定的创建属性创建一个优先级队列
+ *
+ * @param ptype
+ * 	队列优先级顺序类型
+ * @param etype
+ * 	元素的数据类型
+ * @param cmpfunc
+ * 	元素比较函数，NULL则根据etype取默认的元素比较函数
+ * @param attr
+ * 	创建属性，NULL表示全部采用默认值，等同于pq_create()
+ *
+ * @return 
+ * 	新建的优先级队列，创建失败返回NULL
+ */
+extern Container pq_create_ex(PriorityType ptype, ElementType etype, CmpFunc cmpfunc, ContainerAttr attr);
+
 /**
  * @brief 销毁一个优先级队列，销毁其中的所有元素
  *
@@ -86,6 +103,47 @@ extern size_t pq_size(Container pq);
  */
 extern int pq_enqueue(Container pq, Element ele, ElementType type, size_t len, int priority);
 
+/**
+ * @brief 新元素入队并接管元素值的所有权，元素值不进行复制
+ *
+ * @param pq
+ * 	优先级队列容器
+ * @param ele
+ * 	元素值，必须是由容器的分配器分配的内存，字符串必须至少有len + 1个字节
+ * @param type
+ * 	元素数据类型
+ * @param len
+ * 	元素长度
+ * @param priority
+ * 	元素优先级
+ *
+ * @return 
+ * 	入队成功返回顺序索引，此后ele归队列所有，调用者不能再访问或释放；入队失败返回-1，ele仍归调用者所有
+ */
+extern int pq_enqueue_adopt(Container pq, Element ele, ElementType type, size_t len, int priority);
+
+/**
+ * @brief 一组新元素批量入队，整个过程只加锁一次，事先一次扩展到足够的容量，新元素较多时整体重新建堆
+ * 优先级相同的元素按入队顺序出队，同一批元素的入队顺序即在数组中的顺序
+ *
+ * @param pq
+ * 	优先级队列容器
+ * @param values
+ * 	元素值数组，integer, real和object类型为连续存放的元素值，每个元素值占len个字节；string类型为字符串指针数组，即String *，指针不能为NULL
+ * @param count
+ * 	元素数量
+ * @param type
+ * 	元素数据类型
+ * @param len
+ * 	integer, real和object类型为每个元素值的字节长度，string类型不使用，每个字符串的长度为strlen()
+ * @param priorities
+ * 	各元素的优先级，与values一一对应
+ *
+ * @return 
+ * 	入队成功返回0，失败返回-1，失败时一个元素也不入队
+ */
+extern int pq_enqueue_many(Container pq, const void *values, size_t count, ElementType type, size_t len, const int *priorities);
+
 /**
  * @brief 按优先级顺序和同级元素FIFO原则出队
  *
@@ -99,6 +157,19 @@ extern int pq_enqueue(Container pq, Element ele, ElementType type, size_t len, i
  */
 extern Element pq_dequeue(Container pq, int *priority);
 
+/**
+ * @brief 按优先级顺序和同级元素FIFO原则出队，直接交出队首元素值的所有权，较长的元素值不再复制
+ *
+ * @param pq
+ * 	优先级队列
+ * @param priority
+ * 	出队成功时写入元素的优先级，失败时置为-1，不需要获取优先级时可以传入NULL
+ *
+ * @return 
+ * 	队首元素，使用完毕后必须用容器的分配器销毁，空队列或执行失败时返回NULL
+ */
+extern Element pq_dequeue_take(Container pq, int *priority);
+
 /**
  * @brief 查看队首元素
  *
@@ -112,6 +183,40 @@ extern Element pq_dequeue(Container pq, int *priority);
  */
 extern Element pq_queuehead(Container pq, int *priority);
 
+/**
+ * @brief 用访问函数直接访问队首元素，不复制元素，访问函数在队列加锁期间执行
+ *
+ * @param pq
+ * 	优先级队列
+ * @param visit
+ * 	访问函数
+ * @param ctx
+ * 	传递给访问函数的上下文
+ * @param priority
+ * 	访问成功时写入元素的优先级，失败时置为-1，不需要获取优先级时可以传入NULL
+ *
+ * @return 
+ * 	访问成功返回0，空队列或执行失败时返回-1
+ */
+extern int pq_queuehead_with(Container pq, VisitFunc visit, void *ctx, int *priority);
+
+/**
+ * @brief 把队首元素复制到调用者提供的缓冲区中，不分配内存
+ *
+ * @param pq
+ * 	优先级队列
+ * @param buf
+ * 	缓冲区
+ * @param cap
+ * 	缓冲区的字节容量
+ * @param priority
+ * 	获取元素成功时写入元素的优先级，失败时置为-1，不需要获取优先级时可以传入NULL
+ *
+ * @return 
+ * 	元素的长度（字符串包含结尾符），返回值大于cap时表示缓冲区不足，不进行复制，空队列或执行失败时返回-1
+ */
+extern long pq_queuehead_into(Container pq, void *buf, size_t cap, int *priority);
+
 /**
  * @brief 按索引获取队列元素
  *
@@ -127,6 +232,60 @@ extern Element pq_queuehead(Container pq, int *priority);
  */
 extern Element pq_get(Container pq, int index, int *priority);
 
+/**
+ * @brief 用访问函数直接访问指定索引位置的元素，不复制元素，访问函数在队列加锁期间执行
+ *
+ * @param pq
+ * 	优先级队列
+ * @param index
+ * 	位置索引值
+ * @param visit
+ * 	访问函数
+ * @param ctx
+ * 	传递给访问函数的上下文
+ * @param priority
+ * 	访问成功时写入元素的优先级，失败时置为-1，不需要获取优先级时可以传入NULL
+ *
+ * @return 
+ * 	访问成功返回0，index无效或队列无效时返回-1
+ */
+extern int pq_get_with(Container pq, int index, VisitFunc visit, void *ctx, int *priority);
+
+/**
+ * @brief 把指定索引位置的元素复制到调用者提供的缓冲区中，不分配内存
+ *
+ * @param pq
+ * 	优先级队列
+ * @param index
+ * 	位置索引值
+ * @param buf
+ * 	缓冲区
+ * @param cap
+ * 	缓冲区的字节容量
+ * @param priority
+ * 	获取元素成功时写入元素的优先级，失败时置为-1，不需要获取优先级时可以传入NULL
+ *
+ * @return 
+ * 	元素的长度（字符串包含结尾符），返回值大于cap时表示缓冲区不足，不进行复制，index无效或队列无效时返回-1
+ */
+extern long pq_get_into(Container pq, int index, void *buf, size_t cap, int *priority);
+
+/**
+ * @brief 用访问函数访问队列中的全部元素，不复制元素，整个过程只加锁一次，访问函数返回非0时立即终止
+ * 访问顺序为元素在堆中的存放顺序，即索引值从0开始递增的顺序，第一个访问的是队首元素，其余元素并不按优先级排列
+ *
+ * @param pq
+ * 	优先级队列
+ * @param visit
+ * 	访问函数，在队列加锁期间执行，不能修改元素，也不能再访问同一个队列
+ * @param ctx
+ * 	传递给访问函数的上下文
+ *
+ * @return 
+ * 	已访问的元素数量，包括使访问终止的元素，队列无效或visit为NULL时返回0
+ */
+extern size_t pq_foreach(Container pq, VisitFunc visit, void *ctx);
+
 /**
  * @brief 判断一个元素是否在队列中存在
  *
@@ -1,7 +1,8 @@
 /**
  * "mr_set.h"，集合数据结构
  *
- * mr_set库提供一种基于红黑树构造的有序集合
+ * mr_set库提供基于红黑树或B+树构造的有序集合，默认为红黑树，用set_create_typed()在创建时选择B+树
+ * B+树把元素集中存放在叶节点中并用链表串联叶节点，查找和顺序遍历时访问的内存更连续，适合元素多、查找和遍历频繁的集合
  * 向集合中添加新元素时根据cmpfunc比较的结果构造二叉查找树，如果创建集合时cmpfunc参数为NULL，则根据type参数选用默认的比较函数
  * 集合容器不提供按索引位置随机访问的功能，而是提供基于cmpfunc的有序迭代访问，也由于集合容器本身具备有序迭代的能力，因此不提供排序功能
  * 集合容器中不能存放重复的元素，元素是否重复根据cmpfunc确定，默认情况下数值和字符串根据内容判断，Object进行逐字节比较
@@ -15,6 +16,16 @@
 
 #include "mr_common.h"
 
+/**
+ * 集合构造类型的枚举
+ * RBTreeSet:	红黑树，默认类型，每个节点存放一个元素
+ * BPlusTreeSet:	B+树，每个叶节点存放多个元素并按顺序链接，使用默认比较函数的整数集合直接在节点中比较整数键而不调用比较函数
+ */
+typedef enum {
+	RBTreeSet,
+	BPlusTreeSet
+} SetType;
+
 /**
  * @brief 创建一个集合
  *
@@ -28,6 +39,38 @@
  */
 extern Container set_create(ElementType type, CmpFunc cmpfunc);
 
+/**
+ * @brief 按指定的创建属性创建一个集合，集合运算得到的结果集合沿用第一个运算集合的创建属性
+ *
+ * @param type
+ *	元素的类型
+ * @param cmpfunc
+ *	元素比较函数，传入NULL表示采用与type对应的默认比较函数
+ * @param attr
+ *	创建属性，NULL表示全部采用默认值，等同于set_create()
+ *
+ * @return
+ *	新创建的集合，创建失败返回NULL
+ */
+extern Container set_create_ex(ElementType type, CmpFunc cmpfunc, ContainerAttr attr);
+
+/**
+ * @brief 按指定的构造类型和创建属性创建一个集合，两种构造类型的集合提供完全相同的操作，可以互相进行集合运算，运算结果沿用第一个运算集合的构造类型
+ *
+ * @param type
+ *	元素的类型
+ * @param stype
+ *	集合的构造类型
+ * @param cmpfunc
+ *	元素比较函数，传入NULL表示采用与type对应的默认比较函数
+ * @param attr
+ *	创建属性，NULL表示全部采用默认值
+ *
+ * @return
+ *	新创建的集合，构造类型无效或创建失败返回NULL
+ */
+extern Container set_create_typed(ElementType type, SetType stype, CmpFunc cmpfunc, ContainerAttr attr);
+
 /**
  * @brief 销毁一个集合及其中的所有元素
  *
@@ -101,6 +144,42 @@ extern int set_contains(Container set, Element element, ElementType type, size_t
  */
 extern int set_add(Container set, Element element, ElementType type, size_t len);
 
+/**
+ * @brief 添加一个元素并接管元素值的所有权，元素值不进行复制，重复元素将不予添加
+ *
+ * @param set
+ *	集合容器
+ * @param element
+ *	待添加的元素，必须是由容器的分配器分配的内存，字符串必须至少有len + 1个字节
+ * @param type
+ *	元素的类型
+ * @param len
+ *	元素的长度
+ *
+ * @return
+ *	添加成功返回0，此后element归集合所有，调用者不能再访问或释放；添加失败或元素重复返回-1，element仍归调用者所有
+ */
+extern int set_add_adopt(Container set, Element element, ElementType type, size_t len);
+
+/**
+ * @brief 批量添加一组元素，整个过程只加锁一次，重复元素将不予添加
+ *
+ * @param set
+ *	集合容器
+ * @param values
+ *	元素值数组，integer, real和object类型为连续存放的元素值，每个元素值占len个字节；string类型为字符串指针数组，即String *
+ * @param count
+ *	元素数量
+ * @param type
+ *	元素的类型
+ * @param len
+ *	integer, real和object类型为每个元素值的长度，同时也是数组中相邻元素值的间隔；string类型不使用，每个字符串的长度为strlen()
+ *
+ * @return
+ *	实际添加的元素数量
+ */
+extern size_t set_add_many(Container set, const void *values, size_t count, ElementType type, size_t len);
+
 /**
  * @brief 删除一个元素，根据参数ele查找集合中与之相同的元素，删除并返回该元素
  *
@@ -142,8 +221,144 @@ extern void set_removeall(Container set);
  */
 extern Iterator set_iterator(Container set, int dir);
 
+/**
+ * @brief 获取只迭代集合中处于[lo, hi)之间的元素的迭代器，创建时从根节点向下直接定位到范围的起点，时间复杂度为O(log n)，之后每次迭代与set_iterator()相同
+ * 正向迭代从第一个不小于lo的元素迭代到最后一个小于hi的元素，反向迭代顺序相反
+ *
+ * @param set
+ *	集合容器
+ * @param lo
+ *	范围的起点，NULL表示从最小的元素开始
+ * @param hi
+ *	范围的终点（不含），NULL表示到最大的元素为止
+ * @param type
+ *	元素类型
+ * @param lolen
+ *	起点元素的长度，lo为NULL时忽略
+ * @param hilen
+ *	终点元素的长度，hi为NULL时忽略
+ * @param dir
+ *	迭代方向，Forward(1)或Reverse(0)
+ *
+ * @return
+ *	集合迭代器，hi不大于lo时迭代器不迭代任何元素，集合无效、元素类型不符或创建失败返回NULL
+ */
+extern Iterator set_range_iterator(Container set, Element lo, Element hi, ElementType type, size_t lolen, size_t hilen, int dir);
+
+/**
+ * @brief 按顺序用访问函数访问集合中的全部元素，不复制元素，整个过程只加锁一次，访问函数返回非0时立即终止
+ *
+ * @param set
+ *	集合容器
+ * @param dir
+ *	访问方向，Forward(1)为递增顺序，Reverse(0)为递减顺序
+ * @param visit
+ *	访问函数，在集合加锁期间执行，不能修改元素，也不能再访问同一个集合
+ * @param ctx
+ *	传递给访问函数的上下文
+ *
+ * @return
+ *	已访问的元素数量，包括使访问终止的元素，集合无效或visit为NULL时返回0
+ */
+extern size_t set_foreach(Container set, int dir, VisitFunc visit, void *ctx);
+
+/**
+ * @brief 计算集合中小于指定元素的元素数量，即指定元素按递增顺序在集合中的序号，指定元素不必在集合中，时间复杂度为O(log n)
+ *
+ * @param set
+ *	集合容器
+ * @param element
+ *	元素值
+ * @param type
+ *	元素类型
+ * @param len
+ *	元素长度
+ *
+ * @return
+ *	小于指定元素的元素数量，集合无效或元素类型不符时返回0
+ */
+extern size_t set_rank(Container set, Element element, ElementType type, size_t len);
+
+/**
+ * @brief 获取集合中按递增顺序的第k个元素，时间复杂度为O(log n)，与set_rank()互逆
+ *
+ * @param set
+ *	集合容器
+ * @param k
+ *	元素序号，从0开始计数
+ *
+ * @return
+ *	元素值的副本，由调用者负责释放，k超过范围或集合无效时返回NULL
+ */
+extern Element set_select(Container set, size_t k);
+
+/**
+ * @brief 计算集合中处于[lo, hi)之间的元素数量，时间复杂度为O(log n)，等于set_rank(hi) - set_rank(lo)
+ *
+ * @param set
+ *	集合容器
+ * @param lo
+ *	范围的起点
+ * @param hi
+ *	范围的终点（不含）
+ * @param type
+ *	元素类型
+ * @param lolen
+ *	起点元素的长度
+ * @param hilen
+ *	终点元素的长度
+ *
+ * @return
+ *	范围内的元素数量，hi不大于lo、集合无效或元素类型不符时返回0
+ */
+extern size_t set_count_range(Container set, Element lo, Element hi, ElementType type, size_t lolen, size_t hilen);
+
+/**
+ * @brief 获取集合中最小的元素
+ *
+ * @param set
+ *	集合容器
+ *
+ * @return
+ *	元素值的副本，由调用者负责释放，集合为空或无效时返回NULL
+ */
+extern Element set_first(Container set);
+
+/**
+ * @brief 获取集合中最大的元素
+ *
+ * @param set
+ *	集合容器
+ *
+ * @return
+ *	元素值的副本，由调用者负责释放，集合为空或无效时返回NULL
+ */
+extern Element set_last(Container set);
+
+/**
+ * @brief 获取集合中不大于指定元素的最大元素，指定元素不必在集合中，时间复杂度为O(log n)
+ * set_ceiling()获取不小于指定元素的最小元素，set_lower()获取小于指定元素的最大元素，set_higher()获取大于指定元素的最小元素
+ *
+ * @param set
+ *	集合容器
+ * @param element
+ *	元素值
+ * @param type
+ *	元素类型
+ * @param len
+ *	元素长度
+ *
+ * @return
+ *	找到的元素值的副本，由调用者负责释放，不存在这样的元素、集合无效或元素类型不符时返回NULL
+ */
+extern Element set_floor(Container set, Element element, ElementType type, size_t len);
+extern Element set_ceiling(Container set, Element element, ElementType type, size_t len);
+extern Element set_lower(Container set, Element element, ElementType type, size_t len);
+extern Element set_higher(Container set, Element element, ElementType type, size_t len);
+
 /**
  * @brief 求两个集合的交集，如果两个集合的元素数据类型不一致则返回空集合
+ * 三种集合运算都按递增顺序同时迭代两个集合，结果元素本身有序，最后一次性构造结果集合的树，时间复杂度为O(n + m)
  * 如果两个集合的元素比较函数不同则使用s1的cmpfunc进行元素比较，并且结果集合也采用s1的cmpfunc为其元素比较函数
  *
  * @param s1, s2
@@ -178,4 +393,72 @@ extern Container set_union(Container s1, Container s2);
  */
 extern Container set_minus(Container s1, Container s2);
 
+/**
+ * @brief 用一组已按比较函数递增排列的元素一次性构造一个集合，时间复杂度为O(n)，比逐个添加的O(n log n)更快，适合批量装载
+ * 相邻的重复元素只保留一个，元素不是递增排列时退化为逐个添加，结果仍然正确
+ *
+ * @param type
+ *	元素的类型
+ * @param stype
+ *	集合的构造类型
+ * @param cmpfunc
+ *	元素比较函数，传入NULL表示采用与type对应的默认比较函数
+ * @param values
+ *	元素值数组，存放方式与set_add_many()相同
+ * @param count
+ *	元素数量
+ * @param len
+ *	元素值的长度，含义与set_add_many()相同
+ * @param attr
+ *	创建属性，NULL表示全部采用默认值
+ *
+ * @return
+ *	新创建的集合，构造类型无效或内存不足时返回NULL
+ */
+extern Container set_build_sorted(ElementType type, SetType stype, CmpFunc cmpfunc, const void *values, size_t count, size_t len, ContainerAttr attr);
+
+/**
+ * @brief 原地求两个集合的并集，把s2中有而s1中没有的元素复制添加到s1中，s2不变，适合在循环中累积结果，避免每次新建集合并复制全部元素
+ * s1中已有的元素不复制，s2的元素较少时逐个查找添加，否则按顺序合并后一次性重建s1的树，时间复杂度为O(min(m log n, n + m))
+ * 元素比较采用s1的cmpfunc，s1和s2为同一个集合时s1不变
+ *
+ * @param s1
+ *	被修改的集合
+ * @param s2
+ *	参与运算的集合
+ *
+ * @return
+ *	成功返回0，有无效集合、元素类型不一致或内存不足返回-1，元素较少时逐个添加中途内存不足s1中可能已经添加了部分元素，否则s1不变
+ */
+extern int set_union_into(Container s1, Container s2);
+
+/**
+ * @brief 原地求两个集合的交集，从s1中删除s2中没有的元素，s2不变，保留的元素不复制，按顺序合并后一次性重建s1的树，时间复杂度为O(n + m)
+ * 元素比较采用s1的cmpfunc，s1和s2为同一个集合时s1不变
+ *
+ * @param s1
+ *	被修改的集合
+ * @param s2
+ *	参与运算的集合
+ *
+ * @return
+ *	成功返回0，有无效集合、元素类型不一致或内存不足返回-1，此时s1不变
+ */
+extern int set_intersect_into(Container s1, Container s2);
+
+/**
+ * @brief 原地求两个集合的减集，从s1中删除所有存在于s2中的元素，s2不变
+ * s2的元素较少时逐个删除，否则按顺序合并后一次性重建s1的树，时间复杂度为O(min(m log n, n + m))
+ * 元素比较采用s1的cmpfunc，s1和s2为同一个集合时s1被清空
+ *
+ * @param s1
+ *	被修改的集合
+ * @param s2
+ *	参与运算的集合
+ *
+ * @return
+ *	成功返回0，有无效集合、元素类型不一致或内存不足返回-1，此时s1不变
+ */
+extern int set_subtract_into(Container s1, Container s2);
+
 #endif
@@ -0,0 +1,43 @@
+/**
+ * private_alloc.h 用于内存分配的内部函数
+ */
+
+#ifndef PRIVATE_ALLOC_H
+#define PRIVATE_ALLOC_H
+
+#include <stdlib.h>
+
+#include "mr_common.h"
+
+/**
+ * 确定容器所用的分配器，创建属性中指定了分配器时使用指定的分配器，否则使用当前的全局分配器
+ *
+ * dest
+ *	保存分配器的位置
+ * attr
+ *	容器的创建属性，可以为NULL
+ *
+ * return
+ *	成功返回0，指定的分配器不完整时返回-1
+ */
+extern int __mr_allocator(Allocator dest, ContainerAttr attr);
+
+/**
+ * 用指定的分配器分配、重新分配和释放内存
+ *
+ * alloc
+ *	分配器，为NULL时使用当前的全局分配器
+ */
+extern void *__mr_malloc(Allocator alloc, size_t size);
+extern void *__mr_realloc(Allocator alloc, void *ptr, size_t size);
+extern void __mr_free(Allocator alloc, void *ptr);
+
+/**
+ * 用指定的分配器创建迭代器，it_destroy()时用同一个分配器释放，其余参数与it_create_ex()相同，容器的迭代器都用这个函数创建
+ *
+ * alloc
+ *	容器的分配器，为NULL时使用当前的全局分配器
+ */
+extern Iterator __it_create(Allocator alloc, void *iterator, Element (*next)(void *), int (*next_with)(void *, VisitFunc, void *), size_t (*next_batch)(void *, Element *, size_t), size_t (*remove)(void *), void (*reset)(void *), void (*destroy)(void *));
+
+#endif
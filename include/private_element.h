@@ -9,19 +9,71 @@
 #include <string.h>
 
 #include "mr_common.h"
+#include "private_slab.h"
+
+/**
+ * 元素值内联存储的最大字节数，不超过此长度的元素值与元素结构一次性分配在同一块内存中，超过此长度的元素值单独分配内存
+ */
+#define ELE_INLINE_MAX 48
+
+/**
+ * 元素存储标志
+ */
+#define ELE_INLINE 0x01		// 元素值内联存储在元素结构尾部的data中，不需要单独释放
 
 /**
  * 元素的内部结构
  */
 typedef struct {
-	void *value;
-	ElementType type;
-	size_t len;
+	void *value;		// 元素值的地址，内联存储时指向data
+	ElementType type;	// 元素类型
+	unsigned int flags;	// 存储标志
+	size_t len;		// 元素值长度，字符串包含结尾符
+	Real data[];		// 内联存储区，以Real类型声明以保证对所有基本类型的对齐
 } element_t, *element_p;
 
 /**
- * 创建一个元素，元素值将被复制而非引用
+ * 查找、比较时使用的临时元素的存储区，在栈上或其他结构中分配，元素值长度不超过ELE_INLINE_MAX时内联存储，不需要分配内存
+ */
+typedef struct {
+	Real buf[(sizeof(element_t) + ELE_INLINE_MAX + sizeof(Real) - 1) / sizeof(Real)];
+} element_tmp_t, *element_tmp_p;
+
+/**
+ * 在调用者提供的存储区中构造一个临时元素，元素值的复制方式与__element_create()相同，较长的元素值由容器的分配器单独分配
  *
+ * tmp
+ *	临时元素的存储区
+ * alloc
+ *	容器的分配器，为NULL时使用全局分配器
+ * value
+ *	元素值
+ * type
+ *	元素类型
+ * len
+ *	元素长度
+ *
+ * return
+ *	临时元素，即tmp的地址，较长的元素值分配失败返回NULL，用完后须调用__element_temp_release()
+ */
+extern element_p __element_temp(element_tmp_p tmp, Allocator alloc, Element value, ElementType type, size_t len);
+
+/**
+ * 释放临时元素中单独分配的元素值，存储区本身由调用者负责
+ *
+ * alloc
+ *	构造临时元素时所用的分配器
+ * element
+ *	__element_temp()返回的临时元素，可以为NULL
+ */
+extern void __element_temp_release(Allocator alloc, element_p element);
+
+/**
+ * 创建一个元素，元素值将被复制而非引用，元素值长度不超过ELE_INLINE_MAX时内联存储，只需分配一次内存
+ * 从启用的slab中分配时，元素值能放进slab的对象中则内联存储，否则元素值单独分配并计入slab的outer计数
+ *
+ * slab
+ *	分配元素结构所用的slab，为NULL时使用全局分配器
  * value
  *	元素值
  * type
@@ -32,7 +84,59 @@ typedef struct {
  * return
  *	新创建的元素，创建失败返回NULL
  */
-extern element_p __element_create(Element value, ElementType type, size_t len);
+extern element_p __element_create(slab_p slab, Element value, ElementType type, size_t len);
+
+/**
+ * 在slab中创建一个与element值相同的新元素，容器之间或容器内部复制元素时使用
+ * 字符串元素的len包含结尾符，这里去掉结尾符再交给__element_create()，复制出的元素长度与原元素相同
+ *
+ * slab
+ *	分配新元素所用的slab，为NULL时使用全局分配器
+ * element
+ *	被复制的元素
+ *
+ * return
+ *	新创建的元素，创建失败返回NULL
+ */
+extern element_p __element_clone(slab_p slab, element_p element);
+
+/**
+ * 创建一个元素并接管元素值的所有权，元素值不进行复制，而是直接引用，销毁元素时一并释放
+ *
+ * slab
+ *	分配元素结构所用的slab，为NULL时使用全局分配器
+ * value
+ *	元素值，必须是由slab的分配器分配的内存，字符串类型的元素值必须至少有len + 1个字节，第len个字节将被置为结尾符
+ * type
+ *	元素类型
+ * len
+ *	元素长度
+ *
+ * return
+ *	新创建的元素，value为NULL、len为0或创建失败返回NULL，此时value的所有权仍属于调用者
+ */
+extern element_p __element_adopt(slab_p slab, Element value, ElementType type, size_t len);
+
+/**
+ * 销毁元素结构但不释放其中的元素值，用于接管所有权失败时把元素值交还给调用者，以及在__element_prepare_take()之后完成取出
+ *
+ * slab
+ *	创建元素时所用的slab
+ * element
+ *	用__element_adopt()创建的元素
+ */
+extern void __element_detach(slab_p slab, element_p element);
+
+/**
+ * 计算为某种类型的元素创建slab时所用的对象大小，数值类型恰好容纳一个完整的数值，字符串和对象可以内联ELE_INLINE_MAX个字节
+ *
+ * type
+ *	元素类型
+ *
+ * return
+ *	slab的对象大小
+ */
+extern size_t __element_size(ElementType type);
 
 /**
  * 判断一个元素是否为NULL元素，value == NULL或len == 0为NULL元素
@@ -48,21 +152,115 @@ extern int __element_isnull(element_p element);
 /**
  * 销毁一个元素
  *
+ * slab
+ *	创建元素时所用的slab
  * element
  *	待销毁的元素，销毁元素时同时销毁其中的元素值
  */
-extern void __element_destroy(element_p element);
+extern void __element_destroy(slab_p slab, element_p element);
 
 /**
  * 通过复制的方式获取一个元素中的值
  *
+ * slab
+ *	创建元素时所用的slab，副本由slab的分配器分配
  * element
  *	元素
  *
  * return
  *	元素的值的副本
  */
-extern Element __element_clone_value(element_p element);
+extern Element __element_clone_value(slab_p slab, element_p element);
+
+/**
+ * 取出元素中的值并销毁元素，单独分配的元素值直接交出所有权而不复制
+ * 未启用slab时元素结构是单独分配的，内联存储的元素值移到结构开头后连同这块内存一起交出，同样不复制也不会失败
+ * 启用slab时内联存储的元素值复制一份后交出，复制失败时元素不被销毁
+ *
+ * slab
+ *	创建元素时所用的slab
+ * element
+ *	元素
+ *
+ * return
+ *	元素的值，由调用者用slab的分配器释放，元素为NULL元素时返回NULL，复制失败时返回NULL且元素不被销毁
+ */
+extern Element __element_take_value(slab_p slab, element_p element);
+
+/**
+ * 取出元素值的第一步，单独分配的元素值直接返回，内联存储的元素值复制一份后返回，元素保持不变
+ * 容器应先取值，成功后再移除元素并用__element_detach()销毁元素结构，复制失败时元素仍留在容器中，元素值不会丢失
+ *
+ * slab
+ *	创建元素时所用的slab
+ * element
+ *	元素
+ *
+ * return
+ *	元素的值，NULL元素或复制失败时返回NULL
+ */
+extern Element __element_prepare_take(slab_p slab, element_p element);
+
+/**
+ * 放弃__element_prepare_take()开始的取出，释放复制出的副本，元素保持不变
+ *
+ * slab
+ *	创建元素时所用的slab
+ * element
+ *	元素
+ * value
+ *	__element_prepare_take()返回的元素值
+ */
+extern void __element_cancel_take(slab_p slab, element_p element, Element value);
+
+/**
+ * 用访问函数直接访问元素中的值，不产生副本
+ *
+ * element
+ *	元素
+ * visit
+ *	访问函数
+ * ctx
+ *	传递给访问函数的上下文
+ *
+ * return
+ *	访问函数的返回值
+ */
+extern int __element_visit(element_p element, VisitFunc visit, void *ctx);
+
+/**
+ * 把元素中的值复制到调用者提供的缓冲区中，不分配内存
+ *
+ * element
+ *	元素
+ * buf
+ *	缓冲区
+ * cap
+ *	缓冲区的字节容量，小于元素长度时不进行复制
+ *
+ * return
+ *	元素的长度，字符串包含结尾符，返回值大于cap表示缓冲区不足，未进行复制
+ */
+extern long __element_copy_into(element_p element, void *buf, size_t cap);
+
+/**
+ * 获取批量操作的元素值数组中的第index个元素值，批量添加元素的函数都按此约定解释元素值数组
+ *
+ * values
+ *	元素值数组，integer, real和object类型为连续存放的元素值，每个元素值占len个字节；string类型为字符串指针数组，即String *
+ * index
+ *	元素值的位置
+ * type
+ *	元素类型
+ * len
+ *	integer, real和object类型为每个元素值的长度，string类型不使用，每个字符串的长度为strlen()
+ * elen
+ *	返回元素值的长度，可直接作为__element_create()的len参数
+ *
+ * return
+ *	第index个元素值
+ */
+extern Element __element_array_at(const void *values, size_t index, ElementType type, size_t len, size_t *elen);
 
 /**
  * 获取元素默认的比较函数
@@ -75,4 +273,15 @@ extern Element __element_clone_value(element_p element);
  */
 extern CmpFunc __default_cmpfunc(ElementType type);
 
+/**
+ * 获取与默认比较函数配套的哈希函数
+ *
+ * type
+ *	元素的类型
+ *
+ * return
+ *	根据元素类型选择的默认哈希函数
+ */
+extern HashFunc __default_hashfunc(ElementType type);
+
 #endif
@@ -0,0 +1,156 @@
+/**
+ * private_lock.h 容器内部使用的锁，按创建时指定的加锁策略选用互斥锁、读写锁、自旋锁或不加锁
+ *
+ * 只读操作用__lock_rdlock()加共享锁，修改操作用__lock_wrlock()加独占锁，两者都用__lock_unlock()解锁
+ * 只有读写锁区分共享和独占，互斥锁和自旋锁的共享锁也是独占的，不加锁策略下三个函数都不做任何操作
+ * 加锁和解锁处在每个操作的热路径上，因此定义为内联函数
+ * 同时操作两个容器的函数用__lock_pair()按地址顺序加锁，避免两个线程以相反的顺序对同一对容器加锁而死锁
+ */
+
+#ifndef PRIVATE_LOCK_H
+#define PRIVATE_LOCK_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "mr_common.h"
+
+/**
+ * 锁结构
+ */
+typedef struct {
+	LockPolicy policy;			// 加锁策略
+	union {
+		pthread_mutex_t mutex;		// Lock_Mutex策略的互斥锁
+		pthread_rwlock_t rwlock;	// Lock_RWLock策略的读写锁
+		pthread_spinlock_t spin;	// Lock_Spin策略的自旋锁
+	} u;
+} lock_t, *lock_p;
+
+/**
+ * 获取创建属性中指定的加锁策略，attr为NULL时为默认的Lock_Mutex
+ */
+#define LOCK_POLICY(A) ((A) ? (A)->lock : Lock_Mutex)
+
+/**
+ * 按加锁策略初始化一个锁
+ *
+ * lock
+ *	锁
+ * policy
+ *	加锁策略
+ *
+ * return
+ *	成功返回0，策略无效或初始化失败返回-1
+ */
+extern int __lock_init(lock_p lock, LockPolicy policy);
+
+/**
+ * 销毁一个锁，调用前须确保锁未被持有
+ *
+ * lock
+ *	锁
+ */
+extern void __lock_destroy(lock_p lock);
+
+/**
+ * 获取锁中的互斥锁，供条件变量使用
+ *
+ * lock
+ *	锁
+ *
+ * return
+ *	Lock_Mutex策略下返回互斥锁，其他策略下返回NULL
+ */
+extern pthread_mutex_t *__lock_mutex(lock_p lock);
+
+/**
+ * 加共享锁，用于只读操作
+ */
+static inline void __lock_rdlock(lock_p lock)
+{
+	switch (lock->policy) {
+	case Lock_Mutex:
+		pthread_mutex_lock(&lock->u.mutex);
+		break;
+	case Lock_RWLock:
+		pthread_rwlock_rdlock(&lock->u.rwlock);
+		break;
+	case Lock_Spin:
+		pthread_spin_lock(&lock->u.spin);
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * 加独占锁，用于修改操作
+ */
+static inline void __lock_wrlock(lock_p lock)
+{
+	switch (lock->policy) {
+	case Lock_Mutex:
+		pthread_mutex_lock(&lock->u.mutex);
+		break;
+	case Lock_RWLock:
+		pthread_rwlock_wrlock(&lock->u.rwlock);
+		break;
+	case Lock_Spin:
+		pthread_spin_lock(&lock->u.spin);
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * 解锁，共享锁和独占锁都用这个函数解锁
+ */
+static inline void __lock_unlock(lock_p lock)
+{
+	switch (lock->policy) {
+	case Lock_Mutex:
+		pthread_mutex_unlock(&lock->u.mutex);
+		break;
+	case Lock_RWLock:
+		pthread_rwlock_unlock(&lock->u.rwlock);
+		break;
+	case Lock_Spin:
+		pthread_spin_unlock(&lock->u.spin);
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * 对两个不同的锁按地址从低到高的顺序加锁，解锁时分别调用__lock_unlock()，顺序无关
+ * 调用者须自行处理两个锁相同的情况，对同一个锁加两次会死锁
+ *
+ * a, b
+ *	两个锁
+ * wa, wb
+ *	非0时对相应的锁加独占锁，0时加共享锁
+ */
+static inline void __lock_pair(lock_p a, int wa, lock_p b, int wb)
+{
+	if ((uintptr_t)a > (uintptr_t)b) {
+		lock_p t = a;
+		int w = wa;
+		a = b;
+		wa = wb;
+		b = t;
+		wb = w;
+	}
+	if (wa)
+		__lock_wrlock(a);
+	else
+		__lock_rdlock(a);
+	if (wb)
+		__lock_wrlock(b);
+	else
+		__lock_rdlock(b);
+}
+
+#endif
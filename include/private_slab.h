@@ -0,0 +1,101 @@
+/**
+ * private_slab.h 容器内部使用的定长对象分配器
+ *
+ * slab以块为单位向系统申请内存，每个块切分为若干个等长的对象，释放的对象进入空闲链表等待复用
+ * 清空容器时无需逐个释放对象，按块整体释放即可，时间开销为O(块数)
+ * slab同时保存容器所用的分配器，未启用时slab不切分块，只是把分配和释放直接转交给分配器
+ * 所有函数的slab参数为NULL时均退化为使用全局分配器
+ */
+
+#ifndef PRIVATE_SLAB_H
+#define PRIVATE_SLAB_H
+
+#include <stdlib.h>
+
+#include "mr_common.h"
+
+/**
+ * slab结构
+ */
+typedef struct {
+	size_t size;		// 对象大小，已按对齐要求向上取整
+	size_t count;		// 下一个新块中的对象数量，每分配一个新块增长一倍直到上限
+	void *blocks;		// 已分配的块链表
+	void *idle;		// 空闲对象链表
+	char *cursor;		// 当前块中尚未切分的区域起点
+	char *end;		// 当前块的结束位置
+	size_t outer;		// 持有额外堆内存的对象数量，由使用者维护，为0时可以整体释放而无需逐个销毁对象
+	int active;		// 是否启用，未启用时每个对象直接由分配器分配和释放
+	Allocator_t alloc;	// 分配块和对象所用的分配器
+} slab_t, *slab_p;
+
+/**
+ * 判断slab是否启用
+ */
+#define SLAB_ACTIVE(S) ((S) && (S)->active)
+
+/**
+ * 获取slab所用的分配器，slab为NULL时为NULL，即使用全局分配器
+ */
+#define SLAB_ALLOCATOR(S) ((S) ? &(S)->alloc : NULL)
+
+/**
+ * 判断slab中的对象能否按块整体释放而无需逐个销毁
+ */
+#define SLAB_RELEASABLE(S) (SLAB_ACTIVE(S) && (S)->outer == 0)
+
+/**
+ * 创建一个slab
+ *
+ * size
+ *	对象大小
+ * active
+ *	非0表示启用，为0时只转交分配器
+ * alloc
+ *	所用的分配器，复制一份保存在slab中，slab结构本身也由它分配
+ *
+ * return
+ *	新创建的slab，失败返回NULL
+ */
+extern slab_p __slab_create(size_t size, int active, Allocator alloc);
+
+/**
+ * 销毁一个slab，同时释放其中所有的块
+ *
+ * slab
+ *	slab
+ */
+extern void __slab_destroy(slab_p slab);
+
+/**
+ * 从slab中分配一个对象
+ *
+ * slab
+ *	slab，为NULL时使用全局分配器
+ * size
+ *	对象大小，slab启用时不能超过slab的对象大小
+ *
+ * return
+ *	分配到的对象，失败返回NULL
+ */
+extern void *__slab_alloc(slab_p slab, size_t size);
+
+/**
+ * 把一个对象归还到slab的空闲链表中
+ *
+ * slab
+ *	slab，为NULL时使用全局分配器
+ * ptr
+ *	对象，可以为NULL
+ */
+extern void __slab_free(slab_p slab, void *ptr);
+
+/**
+ * 释放slab中所有的块，所有已分配的对象同时失效，slab回到初始状态
+ *
+ * slab
+ *	slab，为NULL或未启用时不做任何操作
+ */
+extern void __slab_reset(slab_p slab);
+
+#endif
@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <mr_set.h>
+
+// 对比在循环中用set_union()/set_minus()新建结果集合和用set_union_into()/set_subtract_into()原地修改累积集合的耗时
+// 命令行第一个参数为每批的元素数量，默认为一万个，第二个参数为批数，默认为一百批
+// 新建结果集合每次都要复制累积集合中的全部元素，原地修改只复制新加入的元素，批量较小时逐个查找添加或删除，不再重建整棵树
+
+#define ELAPSED(S) ((double)(clock() - (S)) / CLOCKS_PER_SEC)
+
+static Container batch(SetType stype, long k, long n)
+{
+	Integer *v = (Integer *)malloc(n * sizeof(Integer));
+	for (long i = 0; i < n; i++)
+		v[i] = k * n / 2 + i;		// 相邻的两批有一半元素重复
+	Container s = set_build_sorted(integer, stype, NULL, v, n, sizeof(Integer), NULL);
+	free(v);
+	return s;
+}
+
+static void bench(const char *name, SetType stype, long n, int k)
+{
+	Container *batches = (Container *)malloc(k * sizeof(Container));
+	for (int i = 0; i < k; i++)
+		batches[i] = batch(stype, i, n);
+
+	clock_t start = clock();
+	Container acc1 = set_create_typed(integer, stype, NULL, NULL);
+	for (int i = 0; i < k; i++) {
+		Container u = set_union(acc1, batches[i]);
+		set_destroy(acc1);
+		acc1 = u;
+	}
+	for (int i = 0; i < k; i += 10) {		// 每十批删除一批
+		Container m = set_minus(acc1, batches[i]);
+		set_destroy(acc1);
+		acc1 = m;
+	}
+	double t1 = ELAPSED(start);
+
+	start = clock();
+	Container acc2 = set_create_typed(integer, stype, NULL, NULL);
+	for (int i = 0; i < k; i++)
+		set_union_into(acc2, batches[i]);
+	for (int i = 0; i < k; i += 10)
+		set_subtract_into(acc2, batches[i]);
+	double t2 = ELAPSED(start);
+
+	int ok = set_size(acc1) == set_size(acc2);
+	Iterator it1 = set_iterator(acc1, Forward), it2 = set_iterator(acc2, Forward);
+	Element e1, e2;
+	while (ok && (e1 = it_next(it1))) {
+		e2 = it_next(it2);
+		ok = e2 && *(Integer *)e1 == *(Integer *)e2;
+		free(e1);
+		free(e2);
+	}
+	it_destroy(it1);
+	it_destroy(it2);
+	printf("%s\t新建结果集合 %.3f秒\t原地修改 %.3f秒\t累积元素 %zu\t%s\n", name, t1, t2, set_size(acc2), ok ? "Ok!" : "结果错误");
+	set_destroy(acc1);
+	set_destroy(acc2);
+	for (int i = 0; i < k; i++)
+		set_destroy(batches[i]);
+	free(batches);
+}
+
+int main(int argc, char **argv)
+{
+	long n = argc > 1 ? atol(argv[1]) : 10000;
+	int k = argc > 2 ? atoi(argv[2]) : 100;
+	printf("每批元素数量 %ld，批数 %d\n", n, k);
+	bench("RBTreeSet", RBTreeSet, n, k);
+	bench("BPlusTreeSet", BPlusTreeSet, n, k);
+	return 0;
+}
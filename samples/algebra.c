@@ -0,0 +1,59 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <mr_set.h>
+
+// 对比逐个添加和用set_build_sorted()批量装载有序元素的耗时，以及两个大集合求并集、交集和差集的耗时，命令行第一个参数为每个集合的元素数量，默认为一百万个
+// 集合运算的结果元素按递增顺序产生，直接自底向上构造结果集合的树，不再逐个插入和重新平衡，时间复杂度为O(n + m)
+
+#define ELAPSED(S) ((double)(clock() - (S)) / CLOCKS_PER_SEC)
+
+static void bench(const char *name, SetType stype, long n)
+{
+	Integer *a = (Integer *)malloc(n * sizeof(Integer));
+	Integer *b = (Integer *)malloc(n * sizeof(Integer));
+	for (long i = 0; i < n; i++) {
+		a[i] = i * 2;		// 偶数
+		b[i] = i * 3;		// 3的倍数
+	}
+	clock_t start = clock();
+	Container s1 = set_create_typed(integer, stype, NULL, NULL);
+	for (long i = 0; i < n; i++)
+		set_add(s1, &a[i], integer, sizeof(Integer));
+	double t1 = ELAPSED(start);
+
+	start = clock();
+	Container s2 = set_build_sorted(integer, stype, NULL, b, n, sizeof(Integer), NULL);
+	double t2 = ELAPSED(start);
+
+	start = clock();
+	Container u = set_union(s1, s2);
+	double t3 = ELAPSED(start);
+	start = clock();
+	Container x = set_intersection(s1, s2);
+	double t4 = ELAPSED(start);
+	start = clock();
+	Container m = set_minus(s1, s2);
+	double t5 = ELAPSED(start);
+
+	long expect_x = (n * 2 - 1) / 6 + 1;		// 小于2n的6的倍数
+	int ok = set_size(s2) == (size_t)n && set_size(x) == (size_t)expect_x && set_size(u) == (size_t)(2 * n - expect_x) && set_size(m) == (size_t)(n - expect_x);
+	printf("%s\t逐个添加 %.3f秒\t批量装载 %.3f秒\t并集 %.3f秒\t交集 %.3f秒\t差集 %.3f秒\t%s\n", name, t1, t2, t3, t4, t5, ok ? "Ok!" : "结果错误");
+	set_destroy(s1);
+	set_destroy(s2);
+	set_destroy(u);
+	set_destroy(x);
+	set_destroy(m);
+	free(a);
+	free(b);
+}
+
+int main(int argc, char **argv)
+{
+	long n = argc > 1 ? atol(argv[1]) : 1000000;
+	printf("每个集合的元素数量 %ld\n", n);
+	bench("RBTreeSet", RBTreeSet, n);
+	bench("BPlusTreeSet", BPlusTreeSet, n);
+	return 0;
+}
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+#include <mr_list.h>
+
+// 对比多个生产者线程逐个添加和批量添加同样数量的整数到同一个线性表的耗时，命令行第一个参数为每个线程添加的元素数量，默认为一百万个，第二个参数为线程数，默认为4
+// 批量添加时每个线程每次添加BATCH个元素，整批只加锁一次，列表的扩容也只进行一次
+
+#define BATCH 256
+
+typedef struct {
+	Container list;
+	long n;
+	int batch;
+} producer_t;
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void *produce(void *arg)
+{
+	producer_t *p = (producer_t *)arg;
+	Integer buf[BATCH];
+	long i = 0;
+	while (i < p->n) {
+		if (p->batch) {
+			int k;
+			for (k = 0; k < BATCH && i < p->n; k++, i++)
+				buf[k] = i;
+			list_append_array(p->list, buf, k, integer, sizeof(Integer));
+		} else {
+			Integer v = i++;
+			list_append(p->list, &v, integer, sizeof(Integer));
+		}
+	}
+	return NULL;
+}
+
+static double run(long n, int nthreads, int batch)
+{
+	Container list = list_create(integer, ArrayList, NULL);
+	pthread_t tids[nthreads];
+	producer_t p = { list, n, batch };
+	double start = now();
+	for (int t = 0; t < nthreads; t++)
+		pthread_create(&tids[t], NULL, produce, &p);
+	for (int t = 0; t < nthreads; t++)
+		pthread_join(tids[t], NULL);
+	double elapsed = now() - start;
+	if (list_size(list) != n * nthreads)
+		printf("元素数量错误: %lu\n", (unsigned long)list_size(list));
+	list_remove_range(list, 0, list_size(list) / 2);
+	if (list_size(list) != n * nthreads - n * nthreads / 2)
+		printf("区间删除后元素数量错误: %lu\n", (unsigned long)list_size(list));
+	list_destroy(list);
+	return elapsed;
+}
+
+int main(int argc, char **argv)
+{
+	long n = argc > 1 ? atol(argv[1]) : 1000000;
+	int nthreads = argc > 2 ? atoi(argv[2]) : 4;
+	printf("每个线程添加 %ld 个元素，线程数 %d\n", n, nthreads);
+	double single = run(n, nthreads, 0);
+	double batch = run(n, nthreads, 1);
+	printf("list_append\t\t%.3f秒\nlist_append_array\t%.3f秒\t加速比 %.2f\n", single, batch, single / batch);
+	return 0;
+}
@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <mr_set.h>
+
+// 对比红黑树和B+树两种构造的整数集合在随机添加、随机查找、顺序遍历和随机删除时的耗时，命令行第一个参数为元素数量，默认为一百万个
+// B+树的叶节点连续存放多个元素，使用默认比较函数的整数集合在节点中直接比较整数，查找和遍历时访问的内存更少更连续
+
+#define ELAPSED(S) ((double)(clock() - (S)) / CLOCKS_PER_SEC)
+
+static int sum(const Element e, size_t len, void *ctx)
+{
+	*(Integer *)ctx += *(Integer *)e;
+	return 0;
+}
+
+static void bench(const char *name, SetType stype, Integer *keys, long n)
+{
+	Container set = set_create_typed(integer, stype, NULL, NULL);
+	clock_t start = clock();
+	for (long i = 0; i < n; i++)
+		set_add(set, &keys[i], integer, sizeof(Integer));
+	double t1 = ELAPSED(start);
+
+	long found = 0;
+	start = clock();
+	for (int r = 0; r < 4; r++) {
+		for (long i = 0; i < n; i++) {
+			Integer v = keys[(i * 7 + r) % n];
+			found += set_contains(set, &v, integer, sizeof(Integer));
+		}
+	}
+	double t2 = ELAPSED(start);
+
+	Integer total = 0;
+	start = clock();
+	for (int r = 0; r < 10; r++)
+		set_foreach(set, Forward, sum, &total);
+	double t3 = ELAPSED(start);
+
+	start = clock();
+	for (long i = 0; i < n; i++)
+		set_remove(set, &keys[i], integer, sizeof(Integer));
+	double t4 = ELAPSED(start);
+
+	printf("%s\t添加 %.3f秒\t查找 %.3f秒\t遍历 %.3f秒\t删除 %.3f秒\t%s\n", name, t1, t2, t3, t4, found == 4 * n && set_isempty(set) ? "Ok!" : "结果错误");
+	set_destroy(set);
+}
+
+int main(int argc, char **argv)
+{
+	long n = argc > 1 ? atol(argv[1]) : 1000000;
+	Integer *keys = (Integer *)malloc(n * sizeof(Integer));
+	for (long i = 0; i < n; i++)
+		keys[i] = i;
+	srand((unsigned)time(NULL));
+	for (long i = n - 1; i > 0; i--) {
+		long j = rand() % (i + 1);
+		Integer t = keys[i];
+		keys[i] = keys[j];
+		keys[j] = t;
+	}
+	printf("元素数量 %ld，查找%ld次，遍历10次\n", n, 4 * n);
+	bench("RBTreeSet", RBTreeSet, keys, n);
+	bench("BPlusTreeSet", BPlusTreeSet, keys, n);
+	free(keys);
+	return 0;
+}
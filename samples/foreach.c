@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <mr_list.h>
+#include <mr_set.h>
+
+// 对比逐个迭代、访问函数迭代、批量迭代和内部迭代四种方式遍历同一个列表和集合并求和的耗时，命令行第一个参数为元素数量，默认为一千万个
+// it_next()每个元素加锁一次并复制一次，it_next_with()每个元素加锁一次但不复制，it_next_batch()每批加锁一次，*_foreach()整个遍历只加锁一次且不复制
+
+#define ELAPSED(S) ((double)(clock() - (S)) / CLOCKS_PER_SEC)
+#define BATCH 256
+
+static int sum(const Element e, size_t len, void *ctx)
+{
+	*(Integer *)ctx += *(Integer *)e;
+	return 0;
+}
+
+static void bench(const char *name, Container cont, Iterator it, size_t (*foreach)(Container, int, VisitFunc, void *))
+{
+	Element e, batch[BATCH];
+	Integer total, expect = 0;
+	size_t got;
+
+	clock_t start = clock();
+	while ((e = it_next(it))) {
+		expect += *(Integer *)e;
+		free(e);
+	}
+	double t1 = ELAPSED(start);
+
+	it_reset(it);
+	total = 0;
+	start = clock();
+	while (it_next_with(it, sum, &total) == 0)
+		;
+	double t2 = ELAPSED(start);
+	if (total != expect)
+		printf("it_next_with()结果错误\n");
+
+	it_reset(it);
+	total = 0;
+	start = clock();
+	while ((got = it_next_batch(it, batch, BATCH)) > 0) {
+		for (size_t i = 0; i < got; i++) {
+			total += *(Integer *)batch[i];
+			free(batch[i]);
+		}
+	}
+	double t3 = ELAPSED(start);
+	if (total != expect)
+		printf("it_next_batch()结果错误\n");
+
+	total = 0;
+	start = clock();
+	foreach(cont, Forward, sum, &total);
+	double t4 = ELAPSED(start);
+	if (total != expect)
+		printf("foreach结果错误\n");
+
+	printf("%s\tit_next %.3f秒\tit_next_with %.3f秒\tit_next_batch %.3f秒\tforeach %.3f秒\n", name, t1, t2, t3, t4);
+}
+
+int main(int argc, char **argv)
+{
+	long n = argc > 1 ? atol(argv[1]) : 10000000;
+	printf("元素数量 %ld\n", n);
+	ListType types[] = { ArrayList, LinkedList, UnrolledList, IndexedList };
+	const char *names[] = { "ArrayList", "LinkedList", "UnrolledList", "IndexedList" };
+	for (int k = 0; k < 4; k++) {
+		Container list = list_create(integer, types[k], NULL);
+		for (Integer i = 0; i < n; i++)
+			list_append(list, &i, integer, sizeof(Integer));
+		Iterator it = list_iterator(list, Forward);
+		bench(names[k], list, it, list_foreach);
+		it_destroy(it);
+		list_destroy(list);
+	}
+	Container set = set_create(integer, NULL);
+	for (Integer i = 0; i < n; i++)
+		set_add(set, &i, integer, sizeof(Integer));
+	Iterator it = set_iterator(set, Forward);
+	bench("Set", set, it, set_foreach);
+	it_destroy(it);
+	set_destroy(set);
+	return 0;
+}
@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include <mr_list.h>
+#include <mr_lfqueue.h>
+
+// 对比互斥锁保护的列表队列和无锁队列的吞吐量，分别用1, 2, 4, 8, 16对生产者和消费者线程传递同样数量的整数消息
+// 命令行第一个参数为消息总数，默认为两百万条；单生产者单消费者队列只在1对线程时参与对比
+// 队列满或空时线程让出处理器后重试，所有消息传递完毕后检查消费者收到的消息之和
+
+#define QUEUE_CAPA 65536
+
+typedef struct {
+	Container q;
+	int lfq;
+	long n;
+	long long sum;
+} worker_t;
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void *produce(void *arg)
+{
+	worker_t *w = (worker_t *)arg;
+	for (Integer i = 0; i < w->n; i++)
+		while ((w->lfq ? lfq_enqueue(w->q, &i, integer, sizeof(Integer)) : list_enqueue(w->q, &i, integer, sizeof(Integer))) != 0)
+			sched_yield();
+	return NULL;
+}
+
+static void *consume(void *arg)
+{
+	worker_t *w = (worker_t *)arg;
+	Element e;
+	for (long i = 0; i < w->n; i++) {
+		while (!(e = w->lfq ? lfq_dequeue(w->q) : list_dequeue_take(w->q)))
+			sched_yield();
+		w->sum += *(Integer *)e;
+		mr_free(e);
+	}
+	return NULL;
+}
+
+static double run(Container q, int lfq, int pairs, long total)
+{
+	pthread_t tids[pairs * 2];
+	worker_t workers[pairs * 2];
+	long n = total / pairs;
+	double start = now();
+	for (int i = 0; i < pairs * 2; i++) {
+		workers[i] = (worker_t){ q, lfq, n, 0 };
+		pthread_create(&tids[i], NULL, i < pairs ? produce : consume, &workers[i]);
+	}
+	long long sum = 0;
+	for (int i = 0; i < pairs * 2; i++) {
+		pthread_join(tids[i], NULL);
+		sum += workers[i].sum;
+	}
+	double elapsed = now() - start;
+	if (sum != (long long)pairs * n * (n - 1) / 2)
+		printf("消息之和错误\n");
+	return n * pairs / elapsed / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+	long total = argc > 1 ? atol(argv[1]) : 2000000;
+	printf("消息总数 %ld，吞吐量单位为百万条每秒\n", total);
+	printf("线程对数\t列表队列\tMPMC无锁队列\tSPSC无锁队列\n");
+	for (int pairs = 1; pairs <= 16; pairs *= 2) {
+		Container list = list_create(integer, RingList, NULL);
+		double lt = run(list, 0, pairs, total);
+		list_destroy(list);
+		Container mpmc = lfq_create(MPMC_Queue, integer, QUEUE_CAPA);
+		double mt = run(mpmc, 1, pairs, total);
+		lfq_destroy(mpmc);
+		printf("%d\t\t%.2f\t\t%.2f", pairs, lt, mt);
+		if (pairs == 1) {
+			Container spsc = lfq_create(SPSC_Queue, integer, QUEUE_CAPA);
+			printf("\t\t%.2f", run(spsc, 1, pairs, total));
+			lfq_destroy(spsc);
+		}
+		printf("\n");
+	}
+	return 0;
+}
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+#include <mr_list.h>
+#include <mr_set.h>
+
+// 对比四种加锁策略下集合和列表只读操作的性能，命令行第一个参数为每个线程的查找次数，默认为两百万次，第二个参数为最大线程数，默认为8
+// 第一部分在单线程中交替调用set_contains()和list_get_into()，反映加锁本身的开销
+// 第二部分用1, 2, 4, 8个线程同时调用set_contains()，反映只读操作的并行度，不加锁的策略不能在线程间共享容器，不参与这一部分
+// 多线程下CPU时间不能反映实际耗时，这里使用单调时钟计时
+
+#define ELEMENTS 1024
+
+typedef struct {
+	Container set;
+	long n;
+	long found;
+} reader_t;
+
+static const char *names[] = { "Lock_Mutex", "Lock_None", "Lock_RWLock", "Lock_Spin" };
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void fill(Container set, Container list)
+{
+	for (Integer i = 0; i < ELEMENTS; i++) {
+		set_add(set, &i, integer, sizeof(Integer));
+		list_append(list, &i, integer, sizeof(Integer));
+	}
+}
+
+static void *lookup(void *arg)
+{
+	reader_t *r = (reader_t *)arg;
+	for (long i = 0; i < r->n; i++) {
+		Integer v = i % ELEMENTS;
+		r->found += set_contains(r->set, &v, integer, sizeof(Integer));
+	}
+	return NULL;
+}
+
+static void single(LockPolicy policy, long n)
+{
+	ContainerAttr_t attr = { .lock = policy };
+	Container set = set_create_ex(integer, NULL, &attr);
+	Container list = list_create_ex(integer, ArrayList, NULL, &attr);
+	fill(set, list);
+	long found = 0;
+	double start = now();
+	for (long i = 0; i < n; i++) {
+		Integer v = i % ELEMENTS;
+		found += set_contains(set, &v, integer, sizeof(Integer));
+		Integer x;
+		found += list_get_into(list, v, &x, sizeof(Integer)) == sizeof(Integer) && x == v;
+	}
+	double elapsed = now() - start;
+	printf("%-12s\t单线程\t%.3f秒\t%.1f纳秒/次\t%s\n", names[policy], elapsed, elapsed * 1e9 / n, found == 2 * n ? "Ok!" : "结果错误");
+	set_destroy(set);
+	list_destroy(list);
+}
+
+static void scaling(LockPolicy policy, long n, int maxthreads)
+{
+	ContainerAttr_t attr = { .lock = policy };
+	Container set = set_create_ex(integer, NULL, &attr);
+	Container list = list_create_ex(integer, ArrayList, NULL, &attr);
+	fill(set, list);
+	pthread_t *tids = (pthread_t *)malloc(maxthreads * sizeof(pthread_t));
+	reader_t *readers = (reader_t *)malloc(maxthreads * sizeof(reader_t));
+	double base = 0.0;
+	for (int t = 1; t <= maxthreads; t *= 2) {
+		long found = 0;
+		double start = now();
+		for (int i = 0; i < t; i++) {
+			readers[i].set = set;
+			readers[i].n = n;
+			readers[i].found = 0;
+			pthread_create(&tids[i], NULL, lookup, &readers[i]);
+		}
+		for (int i = 0; i < t; i++) {
+			pthread_join(tids[i], NULL);
+			found += readers[i].found;
+		}
+		double rate = t * n / (now() - start);
+		if (t == 1)
+			base = rate;
+		printf("%-12s\t%2d线程\t%.2f百万次/秒\t扩展比 %.2f\t%s\n", names[policy], t, rate / 1e6, rate / base, found == t * n ? "Ok!" : "结果错误");
+	}
+	free(tids);
+	free(readers);
+	set_destroy(set);
+	list_destroy(list);
+}
+
+int main(int argc, char **argv)
+{
+	long n = argc > 1 ? atol(argv[1]) : 2000000;
+	int maxthreads = argc > 2 ? atoi(argv[2]) : 8;
+	LockPolicy policies[] = { Lock_None, Lock_Mutex, Lock_Spin, Lock_RWLock };
+	printf("每个线程查找次数 %ld，最大线程数 %d\n", n, maxthreads);
+	for (int i = 0; i < 4; i++)
+		single(policies[i], n);
+	for (int i = 1; i < 4; i++)
+		scaling(policies[i], n, maxthreads);
+	return 0;
+}
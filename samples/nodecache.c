@@ -0,0 +1,46 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <mr_list.h>
+
+// 对比链表在不缓存节点、缓存节点（默认）和slab模式三种情况下作为队列使用时的耗时，命令行第一个参数为进出队列的次数，默认为一千万次
+// 队列中保持WINDOW个元素，每入队一个元素就出队一个，稳定状态下每次出队释放的节点都能在下一次入队时复用
+
+#define WINDOW 64
+
+#define ELAPSED(S) ((double)(clock() - (S)) / CLOCKS_PER_SEC)
+
+static void bench(const char *name, long n, int slab, size_t cache)
+{
+	ContainerAttr_t attr = { .slab = slab };
+	Container list = list_create_ex(integer, LinkedList, NULL, &attr);
+	if (!slab)
+		list_set_cache(list, cache);
+	clock_t start = clock();
+	Integer sum = 0, expect = 0;
+	for (Integer i = 0; i < n; i++) {
+		list_enqueue(list, &i, integer, sizeof(Integer));
+		if (i >= WINDOW) {
+			Element e = list_dequeue_take(list);
+			sum += *(Integer *)e;
+			mr_free(e);
+			expect += i - WINDOW;
+		}
+	}
+	double elapsed = ELAPSED(start);
+	list_removeall(list);
+	size_t trimmed = list_trim(list);
+	printf("%-8s\t%.3f秒\t%.1f纳秒/次\t清空后释放缓存节点 %zu\t%s\n", name, elapsed, elapsed * 1e9 / n, trimmed, sum == expect ? "Ok!" : "结果错误");
+	list_destroy(list);
+}
+
+int main(int argc, char **argv)
+{
+	long n = argc > 1 ? atol(argv[1]) : 10000000;
+	printf("进出次数 %ld\n", n);
+	bench("不缓存", n, 0, 0);
+	bench("缓存", n, 0, 256);
+	bench("slab", n, 1, 0);
+	return 0;
+}
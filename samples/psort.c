@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <mr_list.h>
+
+// 对比单线程稳定排序和不同线程数的并行排序对同一组随机整数排序的耗时，命令行第一个参数为元素数量，默认为一千万个，第二个参数为最大线程数，默认为处理器数量
+// 多线程下CPU时间不能反映实际耗时，这里使用单调时钟计时
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static Container fill(long n)
+{
+	Container list = list_create(integer, ArrayList, NULL);
+	srand(20200101);
+	for (long i = 0; i < n; i++) {
+		Integer v = ((Integer)rand() << 16) ^ rand();
+		list_append(list, &v, integer, sizeof(Integer));
+	}
+	return list;
+}
+
+static int check(Container list)
+{
+	Iterator it = list_iterator(list, Forward);
+	Element e;
+	Integer prev = 0;
+	int first = 1, ok = 1;
+	while ((e = it_next(it))) {
+		if (!first && *(Integer *)e < prev)
+			ok = 0;
+		prev = *(Integer *)e;
+		first = 0;
+		free(e);
+	}
+	it_destroy(it);
+	return ok;
+}
+
+int main(int argc, char **argv)
+{
+	long n = argc > 1 ? atol(argv[1]) : 10000000;
+	int maxthreads = argc > 2 ? atoi(argv[2]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+	printf("元素数量 %ld，最大线程数 %d\n", n, maxthreads);
+
+	Container list = fill(n);
+	double start = now();
+	list_stable_sort(list, Asc);
+	double base = now() - start;
+	printf("list_stable_sort\t\t%.3f秒\t%s\n", base, check(list) ? "Ok!" : "排序错误");
+	list_destroy(list);
+
+	for (int t = 1; t <= maxthreads; t *= 2) {
+		list = fill(n);
+		start = now();
+		list_psort(list, Asc, t);
+		double elapsed = now() - start;
+		printf("list_psort %2d线程\t\t%.3f秒\t加速比 %.2f\t%s\n", t, elapsed, base / elapsed, check(list) ? "Ok!" : "排序错误");
+		list_destroy(list);
+	}
+	return 0;
+}
@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <mr_list.h>
+
+// 对比基数排序和比较排序对同一组随机整数和随机字符串排序的耗时，命令行第一个参数为元素数量，默认为一千万个
+// 自定义比较函数的列表不能使用基数排序，list_stable_sort()对它们只能进行比较排序
+
+#define ELAPSED(S) ((double)(clock() - (S)) / CLOCKS_PER_SEC)
+
+static int my_int_cmp(const Element e1, const Element e2, size_t len1, size_t len2)
+{
+	Integer a = *(Integer *)e1, b = *(Integer *)e2;
+	return a == b ? 0 : a > b ? 1 : -1;
+}
+
+static int my_str_cmp(const Element e1, const Element e2, size_t len1, size_t len2)
+{
+	return strcmp((const char *)e1, (const char *)e2);
+}
+
+static Container fill(ElementType type, CmpFunc cmpfunc, long n)
+{
+	Container list = list_create(type, ArrayList, cmpfunc);
+	char s[16];
+	srand(20200101);
+	for (long i = 0; i < n; i++) {
+		if (type == integer) {
+			Integer v = ((Integer)rand() << 32) ^ rand();
+			list_append(list, &v, integer, sizeof(Integer));
+		} else {
+			int len = 4 + rand() % 10;
+			for (int k = 0; k < len; k++)
+				s[k] = 'a' + rand() % 26;
+			s[len] = '\0';
+			list_append(list, s, string, len);
+		}
+	}
+	return list;
+}
+
+static void bench(const char *name, ElementType type, CmpFunc cmpfunc, long n)
+{
+	Container list = fill(type, NULL, n);
+	clock_t start = clock();
+	list_radix_sort(list, Asc);
+	double radix = ELAPSED(start);
+	list_destroy(list);
+	list = fill(type, cmpfunc, n);
+	start = clock();
+	list_stable_sort(list, Asc);
+	double cmp = ELAPSED(start);
+	list_destroy(list);
+	printf("%s\t基数排序 %.3f秒\t比较排序 %.3f秒\t加速比 %.2f\n", name, radix, cmp, cmp / radix);
+}
+
+int main(int argc, char **argv)
+{
+	long n = argc > 1 ? atol(argv[1]) : 10000000;
+	printf("元素数量 %ld\n", n);
+	bench("Integer", integer, my_int_cmp, n);
+	bench("String", string, my_str_cmp, n);
+	return 0;
+}
@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <mr_set.h>
+
+// 对比用完整迭代筛选和用set_range_iterator()取出集合中一个小范围内元素的耗时，以及用完整迭代和用set_floor()查找最接近的元素的耗时
+// 命令行第一个参数为元素数量，默认为十万个，第二个参数为查询次数，默认为一千次，每次查询的范围包含100个元素
+// 完整迭代的时间复杂度为O(n)，范围迭代器从根节点向下直接定位到范围起点，时间复杂度为O(log n + k)
+
+#define ELAPSED(S) ((double)(clock() - (S)) / CLOCKS_PER_SEC)
+#define WIDTH 100
+
+static void bench(const char *name, SetType stype, long n, long q)
+{
+	Container set = set_create_typed(integer, stype, NULL, NULL);
+	for (Integer i = 0; i < n; i++) {
+		Integer v = i * 10;
+		set_add(set, &v, integer, sizeof(Integer));
+	}
+	long ok = 0;
+	Element e;
+	clock_t start = clock();
+	for (long j = 0; j < q; j++) {
+		Integer lo = (j * 7919 % (n - WIDTH)) * 10, hi = lo + WIDTH * 10, floor = -1;
+		Iterator it = set_iterator(set, Forward);
+		long count = 0;
+		while ((e = it_next(it))) {
+			Integer v = *(Integer *)e;
+			count += v >= lo && v < hi;
+			if (v <= lo + 5)
+				floor = v;
+			free(e);
+		}
+		it_destroy(it);
+		ok += count == WIDTH && floor == lo;
+	}
+	double t1 = ELAPSED(start);
+
+	start = clock();
+	for (long j = 0; j < q; j++) {
+		Integer lo = (j * 7919 % (n - WIDTH)) * 10, hi = lo + WIDTH * 10, x = lo + 5;
+		Iterator it = set_range_iterator(set, &lo, &hi, integer, sizeof(Integer), sizeof(Integer), Forward);
+		long count = 0;
+		while ((e = it_next(it))) {
+			count++;
+			free(e);
+		}
+		it_destroy(it);
+		e = set_floor(set, &x, integer, sizeof(Integer));
+		ok += count == WIDTH && e && *(Integer *)e == lo;
+		free(e);
+	}
+	double t2 = ELAPSED(start);
+	printf("%s\t完整迭代 %.3f秒\t范围迭代+set_floor() %.3f秒\t%s\n", name, t1, t2, ok == 2 * q ? "Ok!" : "结果错误");
+	set_destroy(set);
+}
+
+int main(int argc, char **argv)
+{
+	long n = argc > 1 ? atol(argv[1]) : 100000;
+	long q = argc > 2 ? atol(argv[2]) : 1000;
+	printf("元素数量 %ld，查询次数 %ld\n", n, q);
+	bench("RBTreeSet", RBTreeSet, n, q);
+	bench("BPlusTreeSet", BPlusTreeSet, n, q);
+	return 0;
+}
@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <mr_set.h>
+
+// 对比用迭代器逐个计数和用set_select()、set_rank()求集合中第k个元素及元素排名的耗时，命令行第一个参数为元素数量，默认为十万个，第二个参数为查询次数，默认为一千次
+// 迭代器需要从头数到第k个元素并复制途经的每个元素，时间复杂度为O(n)；节点中保存了子树的元素数量后按序号查找和计算排名都只需从根节点向下走一遍，时间复杂度为O(log n)
+
+#define ELAPSED(S) ((double)(clock() - (S)) / CLOCKS_PER_SEC)
+
+static void bench(const char *name, SetType stype, long n, long q)
+{
+	Container set = set_create_typed(integer, stype, NULL, NULL);
+	for (Integer i = 0; i < n; i++) {
+		Integer v = i * 2;
+		set_add(set, &v, integer, sizeof(Integer));
+	}
+	long ok = 0;
+	clock_t start = clock();
+	for (long j = 0; j < q; j++) {
+		size_t k = (size_t)(j * 7919 % n);
+		Iterator it = set_iterator(set, Forward);
+		Element e = NULL;
+		for (size_t i = 0; i <= k; i++) {
+			free(e);
+			e = it_next(it);
+		}
+		ok += e && *(Integer *)e == (Integer)k * 2;
+		free(e);
+		it_destroy(it);
+	}
+	double t1 = ELAPSED(start);
+
+	start = clock();
+	for (long j = 0; j < q; j++) {
+		size_t k = (size_t)(j * 7919 % n);
+		Element e = set_select(set, k);
+		Integer v = (Integer)k * 2 + 1;
+		ok += e && *(Integer *)e == (Integer)k * 2 && set_rank(set, &v, integer, sizeof(Integer)) == k + 1;
+		free(e);
+	}
+	double t2 = ELAPSED(start);
+	printf("%s\t迭代计数 %.3f秒\tset_select()+set_rank() %.3f秒\t%s\n", name, t1, t2, ok == 2 * q ? "Ok!" : "结果错误");
+	set_destroy(set);
+}
+
+int main(int argc, char **argv)
+{
+	long n = argc > 1 ? atol(argv[1]) : 100000;
+	long q = argc > 2 ? atol(argv[2]) : 1000;
+	printf("元素数量 %ld，查询次数 %ld\n", n, q);
+	bench("RBTreeSet", RBTreeSet, n, q);
+	bench("BPlusTreeSet", BPlusTreeSet, n, q);
+	return 0;
+}
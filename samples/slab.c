@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <mr_list.h>
+#include <mr_set.h>
+#include <mr_hashtable.h>
+#include <mr_pqueue.h>
+
+// 对比普通模式和slab模式下各容器在大量元素进出时的耗时，命令行第一个参数为操作次数，默认为一千万次
+// 每个容器的测试分为两部分：保持1024个元素的进出循环，以及分10轮每轮添加十分之一的元素后整体清空
+
+#define WINDOW 1024
+#define ROUNDS 10
+
+#define ELAPSED(S) ((double)(clock() - (S)) / CLOCKS_PER_SEC)
+
+static Container create_list(int slab)
+{
+	ContainerAttr_t attr = { .slab = slab };
+	return list_create_ex(integer, LinkedList, NULL, &attr);
+}
+
+static Container create_set(int slab)
+{
+	ContainerAttr_t attr = { .slab = slab };
+	return set_create_ex(integer, NULL, &attr);
+}
+
+static Container create_hash(int slab)
+{
+	ContainerAttr_t attr = { .slab = slab };
+	return hash_create_ex(&attr);
+}
+
+static Container create_pq(int slab)
+{
+	ContainerAttr_t attr = { .slab = slab };
+	return pq_create_ex(Max_Priority, integer, NULL, &attr);
+}
+
+static void bench_list(long n, int slab)
+{
+	Container list = create_list(slab);
+	clock_t start = clock();
+	for (Integer i = 0; i < n; i++) {
+		list_enqueue(list, &i, integer, sizeof(Integer));
+		if (i >= WINDOW)
+			list_remove_at(list, 0);
+	}
+	double churn = ELAPSED(start);
+	list_removeall(list);
+	start = clock();
+	for (int r = 0; r < ROUNDS; r++) {
+		for (Integer i = 0; i < n / ROUNDS; i++)
+			list_append(list, &i, integer, sizeof(Integer));
+		list_removeall(list);
+	}
+	double fill = ELAPSED(start);
+	list_destroy(list);
+	printf("LinkedList\t%s\t进出循环 %.3f秒\t填充清空 %.3f秒\n", slab ? "slab" : "普通", churn, fill);
+}
+
+static void bench_set(long n, int slab)
+{
+	Container set = create_set(slab);
+	clock_t start = clock();
+	for (Integer i = 0; i < n; i++) {
+		set_add(set, &i, integer, sizeof(Integer));
+		if (i >= WINDOW) {
+			Integer old = i - WINDOW;
+			set_remove(set, &old, integer, sizeof(Integer));
+		}
+	}
+	double churn = ELAPSED(start);
+	set_removeall(set);
+	start = clock();
+	for (int r = 0; r < ROUNDS; r++) {
+		for (Integer i = 0; i < n / ROUNDS; i++)
+			set_add(set, &i, integer, sizeof(Integer));
+		set_removeall(set);
+	}
+	double fill = ELAPSED(start);
+	set_destroy(set);
+	printf("Set\t\t%s\t进出循环 %.3f秒\t填充清空 %.3f秒\n", slab ? "slab" : "普通", churn, fill);
+}
+
+static void bench_hash(long n, int slab)
+{
+	// 哈希表采用线性探测，进出循环的耗时主要在探测上，因此只测试填充清空
+	Container hash = create_hash(slab);
+	clock_t start = clock();
+	for (int r = 0; r < ROUNDS; r++) {
+		for (Integer i = 0; i < n / ROUNDS; i++)
+			hash_register(hash, &i, integer, sizeof(Integer));
+		hash_removeall(hash);
+	}
+	double fill = ELAPSED(start);
+	hash_destroy(hash);
+	printf("HashTable\t%s\t\t\t填充清空 %.3f秒\n", slab ? "slab" : "普通", fill);
+}
+
+static void bench_pq(long n, int slab)
+{
+	Container pq = create_pq(slab);
+	clock_t start = clock();
+	for (Integer i = 0; i < n; i++) {
+		pq_enqueue(pq, &i, integer, sizeof(Integer), (int)(i % 100));
+		if (i >= WINDOW)
+			mr_free(pq_dequeue_take(pq, NULL));	// 交出的元素值由容器的分配器分配
+	}
+	double churn = ELAPSED(start);
+	pq_removeall(pq);
+	start = clock();
+	for (int r = 0; r < ROUNDS; r++) {
+		for (Integer i = 0; i < n / ROUNDS; i++)
+			pq_enqueue(pq, &i, integer, sizeof(Integer), (int)(i % 100));
+		pq_removeall(pq);
+	}
+	double fill = ELAPSED(start);
+	pq_destroy(pq);
+	printf("PriorityQueue\t%s\t进出循环 %.3f秒\t填充清空 %.3f秒\n", slab ? "slab" : "普通", churn, fill);
+}
+
+int main(int argc, char *argv[])
+{
+	long n = argc > 1 ? atol(argv[1]) : 10000000;
+	printf("操作次数：%ld\n", n);
+	for (int slab = 0; slab < 2; slab++) {
+		bench_list(n, slab);
+		bench_set(n, slab);
+		bench_hash(n, slab);
+		bench_pq(n, slab);
+	}
+	return 0;
+}
@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <mr_list.h>
+
+// 对比把一个列表的全部元素并入另一个列表的两种方式的耗时，命令行第一个参数为每个列表的元素数量，默认为一百万个
+// 第一部分把list2整体接到list1的最后，list_plus()逐个复制元素，list_splice()直接转移元素，链表只需重新链接首尾两个节点
+// 第二部分合并两个各自有序的列表，list_plus()之后重新稳定排序，list_merge()一遍线性合并且不复制元素
+// 最后检查两个参数为同一个列表的情况，list_plus()添加原有元素的副本，list_minus()清空列表，list_retain()不变，list_splice()和list_merge()失败
+
+#define ELAPSED(S) ((double)(clock() - (S)) / CLOCKS_PER_SEC)
+
+static Container fill(ListType type, long n, Integer from, Integer step)
+{
+	Container list = list_create(integer, type, NULL);
+	for (long i = 0; i < n; i++) {
+		Integer v = from + i * step;
+		list_append(list, &v, integer, sizeof(Integer));
+	}
+	return list;
+}
+
+static int ordered(Container list)
+{
+	Integer prev = 0;
+	Iterator it = list_iterator(list, Forward);
+	Element e;
+	int ok = 1;
+	while ((e = it_next(it))) {
+		ok = ok && *(Integer *)e >= prev;
+		prev = *(Integer *)e;
+		free(e);
+	}
+	it_destroy(it);
+	return ok;
+}
+
+int main(int argc, char **argv)
+{
+	long n = argc > 1 ? atol(argv[1]) : 1000000;
+	printf("每个列表的元素数量 %ld\n", n);
+	ListType types[] = { ArrayList, RingList, LinkedList, UnrolledList, IndexedList };
+	const char *names[] = { "ArrayList", "RingList", "LinkedList", "UnrolledList", "IndexedList" };
+	for (int k = 0; k < 5; k++) {
+		Container l1 = fill(types[k], n, 0, 1), l2 = fill(types[k], n, n, 1);
+		clock_t start = clock();
+		list_plus(l1, l2);
+		list_removeall(l2);
+		double t1 = ELAPSED(start);
+		list_destroy(l1);
+		list_destroy(l2);
+
+		l1 = fill(types[k], n, 0, 1);
+		l2 = fill(types[k], n, n, 1);
+		start = clock();
+		list_splice(l1, list_size(l1), l2);
+		double t2 = ELAPSED(start);
+		printf("%-12s\t追加\tlist_plus %.3f秒\tlist_splice %.3f秒\t%s\n", names[k], t1, t2,
+				list_size(l1) == 2 * n && list_size(l2) == 0 && ordered(l1) ? "Ok!" : "结果错误");
+		list_destroy(l1);
+		list_destroy(l2);
+
+		l1 = fill(types[k], n, 0, 2);
+		l2 = fill(types[k], n, 1, 2);
+		start = clock();
+		list_plus(l1, l2);
+		list_stable_sort(l1, Asc);
+		t1 = ELAPSED(start);
+		list_destroy(l1);
+		list_destroy(l2);
+
+		l1 = fill(types[k], n, 0, 2);
+		l2 = fill(types[k], n, 1, 2);
+		start = clock();
+		list_merge(l1, l2, Asc);
+		t2 = ELAPSED(start);
+		printf("%-12s\t合并\tlist_plus+排序 %.3f秒\tlist_merge %.3f秒\t%s\n", names[k], t1, t2,
+				list_size(l1) == 2 * n && ordered(l1) ? "Ok!" : "结果错误");
+		list_destroy(l1);
+		list_destroy(l2);
+	}
+	for (int k = 0; k < 5; k++) {
+		Container l = fill(types[k], 100, 0, 1);
+		list_plus(l, l);
+		Integer *top = (Integer *)list_stacktop(l);
+		int ok = list_size(l) == 200 && top && *top == 99;
+		free(top);
+		list_retain(l, l);
+		ok = ok && list_size(l) == 200;
+		ok = ok && list_splice(l, 0, l) == -1 && list_merge(l, l, Asc) == -1 && list_size(l) == 200;
+		list_minus(l, l);
+		ok = ok && list_size(l) == 0;
+		printf("%-12s\t自身\tlist_plus/list_minus/list_retain/list_splice/list_merge\t%s\n", names[k], ok ? "Ok!" : "结果错误");
+		list_destroy(l);
+	}
+	return 0;
+}
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <mr_list.h>
+
+// 对比LinkedList、ArrayList、UnrolledList和IndexedList四种列表在插入密集和扫描密集两类操作组合下的耗时，命令行第一个参数为元素数量，默认为五万个
+// 插入密集：每次在随机位置插入一个元素，每插入四次删除一个随机位置的元素
+// 扫描密集：先顺序添加全部元素，然后按位置顺序逐个读取、正向迭代和搜索若干个元素
+
+#define SEARCHES 100
+
+#define ELAPSED(S) ((double)(clock() - (S)) / CLOCKS_PER_SEC)
+
+static const char *names[] = { "ArrayList", "LinkedList", "RingList", "UnrolledList", "IndexedList" };
+
+static int visit(const Element value, size_t len, void *ctx)
+{
+	*(Integer *)ctx += VALUEOF(value, Integer);
+	return 0;
+}
+
+static void bench_insert(ListType type, long n)
+{
+	Container list = list_create(integer, type, NULL);
+	srand(1);
+	clock_t start = clock();
+	for (Integer i = 0; i < n; i++) {
+		list_insert(list, rand() % (list_size(list) + 1), &i, integer, sizeof(Integer));
+		if (i % 4 == 3)
+			list_remove_at(list, rand() % list_size(list));
+	}
+	double elapsed = ELAPSED(start);
+	list_destroy(list);
+	printf("%-12s\t插入密集 %.3f秒\n", names[type], elapsed);
+}
+
+static void bench_scan(ListType type, long n)
+{
+	Container list = list_create(integer, type, NULL);
+	for (Integer i = 0; i < n; i++)
+		list_append(list, &i, integer, sizeof(Integer));
+	Integer sum = 0;
+	clock_t start = clock();
+	for (size_t i = 0; i < n; i++)
+		list_get_with(list, i, visit, &sum);
+	double get = ELAPSED(start);
+	start = clock();
+	Iterator it = list_iterator(list, Forward);
+	while (it_next_with(it, visit, &sum) == 0)
+		;
+	it_destroy(it);
+	double iter = ELAPSED(start);
+	start = clock();
+	for (int i = 0; i < SEARCHES; i++) {
+		Integer v = n - 1 - i;
+		list_search(list, -1, Forward, &v, integer, sizeof(Integer));
+	}
+	double search = ELAPSED(start);
+	list_destroy(list);
+	printf("%-12s\t按位置读取 %.3f秒\t迭代 %.3f秒\t搜索 %.3f秒\n", names[type], get, iter, search);
+}
+
+int main(int argc, char *argv[])
+{
+	long n = argc > 1 ? atol(argv[1]) : 50000;
+	ListType types[] = { LinkedList, ArrayList, UnrolledList, IndexedList };
+	printf("元素数量：%ld\n", n);
+	for (int i = 0; i < ARRAY_LEN(types); i++)
+		bench_insert(types[i], n);
+	for (int i = 0; i < ARRAY_LEN(types); i++)
+		bench_scan(types[i], n);
+	return 0;
+}
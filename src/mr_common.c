@@ -1,6 +1,7 @@
 #include <stdlib.h>
 
 #include "mr_common.h"
+#include "private_alloc.h"
 
 const int Forward = 1;
 const int Reverse = 0;
@@ -11,11 +12,23 @@ const int Desc = -1;
 struct Iterator_t {
 	void *iterator;
 	Element (*next)(void *);
+	int (*next_with)(void *, VisitFunc, void *);
+	size_t (*next_batch)(void *, Element *, size_t);
 	size_t (*remove)(void *);
 	void (*reset)(void *);
 	void (*destroy)(void *);
+	Allocator_t alloc;		// 分配迭代器结构所用的分配器，销毁时用同一个分配器释放
 };
 
+static void *__std_malloc(size_t size, void *ctx);			// 标准库malloc()的包装
+static void *__std_realloc(void *ptr, size_t size, void *ctx);		// 标准库realloc()的包装
+static void __std_free(void *ptr, void *ctx);				// 标准库free()的包装
+
+static int __it_next_with(Iterator it, VisitFunc visit, void *ctx);		// 未提供next_with函数时的通用实现
+static size_t __it_next_batch(Iterator it, Element *out, size_t n);		// 未提供next_batch函数时的通用实现
+
+static Allocator_t allocator = { __std_malloc, __std_realloc, __std_free, NULL };	// 全局分配器
+
 unsigned int lg2(unsigned int n)
 {
 	unsigned int ret = 0;
@@ -27,10 +40,23 @@ unsigned int lg2(unsigned int n)
 
 Iterator it_create(void *iterator, Element (*next)(void *), size_t (*remove)(void *), void (*reset)(void *), void (*destroy)(void *))
 {
-	Iterator it = (Iterator)malloc(sizeof(struct Iterator_t));
+	return it_create_ex(iterator, next, NULL, NULL, remove, reset, destroy);
+}
+
+Iterator it_create_ex(void *iterator, Element (*next)(void *), int (*next_with)(void *, VisitFunc, void *), size_t (*next_batch)(void *, Element *, size_t), size_t (*remove)(void *), void (*reset)(void *), void (*destroy)(void *))
+{
+	return __it_create(NULL, iterator, next, next_with, next_batch, remove, reset, destroy);
+}
+
+Iterator __it_create(Allocator alloc, void *iterator, Element (*next)(void *), int (*next_with)(void *, VisitFunc, void *), size_t (*next_batch)(void *, Element *, size_t), size_t (*remove)(void *), void (*reset)(void *), void (*destroy)(void *))
+{
+	Iterator it = (Iterator)__mr_malloc(alloc, sizeof(struct Iterator_t));
 	if (it) {
+		it->alloc = alloc ? *alloc : allocator;
 		it->iterator = iterator;
 		it->next = next;
+		it->next_with = next_with;
+		it->next_batch = next_batch;
 		it->remove = remove;
 		it->reset = reset;
 		it->destroy = destroy;
@@ -43,6 +69,16 @@ Element it_next(Iterator it)
 	return it->next(it->iterator);
 }
 
+int it_next_with(Iterator it, VisitFunc visit, void *ctx)
+{
+	return it->next_with ? it->next_with(it->iterator, visit, ctx) : __it_next_with(it, visit, ctx);
+}
+
+size_t it_next_batch(Iterator it, Element *out, size_t n)
+{
+	return it->next_batch ? it->next_batch(it->iterator, out, n) : __it_next_batch(it, out, n);
+}
+
 size_t it_remove(Iterator it)
 {
 	return it->remove(it->iterator);
@@ -55,6 +91,118 @@ void it_reset(Iterator it)
 
 void it_destroy(Iterator it)
 {
+	Allocator_t alloc = it->alloc;
 	it->destroy(it->iterator);
-	free(it);
+	__mr_free(&alloc, it);
+}
+
+int mr_set_allocator(MallocFunc malloc_fn, ReallocFunc realloc_fn, FreeFunc free_fn, void *ctx)
+{
+	int ret = -1;
+	if (malloc_fn && realloc_fn && free_fn) {
+		allocator.malloc_fn = malloc_fn;
+		allocator.realloc_fn = realloc_fn;
+		allocator.free_fn = free_fn;
+		allocator.ctx = ctx;
+		ret = 0;
+	} else if (!malloc_fn && !realloc_fn && !free_fn) {
+		allocator.malloc_fn = __std_malloc;
+		allocator.realloc_fn = __std_realloc;
+		allocator.free_fn = __std_free;
+		allocator.ctx = NULL;
+		ret = 0;
+	}
+	return ret;
+}
+
+void *mr_malloc(size_t size)
+{
+	return allocator.malloc_fn(size, allocator.ctx);
+}
+
+void *mr_realloc(void *ptr, size_t size)
+{
+	return allocator.realloc_fn(ptr, size, allocator.ctx);
+}
+
+void mr_free(void *ptr)
+{
+	allocator.free_fn(ptr, allocator.ctx);
+}
+
+int __mr_allocator(Allocator dest, ContainerAttr attr)
+{
+	int ret = 0;
+	if (attr && attr->allocator) {
+		if (attr->allocator->malloc_fn && attr->allocator->realloc_fn && attr->allocator->free_fn)
+			*dest = *attr->allocator;
+		else
+			ret = -1;
+	} else {
+		*dest = allocator;
+	}
+	return ret;
+}
+
+void *__mr_malloc(Allocator alloc, size_t size)
+{
+	return alloc ? alloc->malloc_fn(size, alloc->ctx) : mr_malloc(size);
+}
+
+void *__mr_realloc(Allocator alloc, void *ptr, size_t size)
+{
+	return alloc ? alloc->realloc_fn(ptr, size, alloc->ctx) : mr_realloc(ptr, size);
+}
+
+void __mr_free(Allocator alloc, void *ptr)
+{
+	if (alloc)
+		alloc->free_fn(ptr, alloc->ctx);
+	else
+		mr_free(ptr);
+}
+
+/**
+ * 通过next函数取得下一个元素的副本，用访问函数访问后释放副本，next函数不提供元素长度，因此访问函数得到的长度为0
+ *
+ * return
+ *	访问成功返回0，已经迭代完成时返回-1
+ */
+static int __it_next_with(Iterator it, VisitFunc visit, void *ctx)
+{
+	Element e = it->next(it->iterator);
+	if (!e)
+		return -1;
+	visit(e, 0, ctx);
+	mr_free(e);
+	return 0;
+}
+
+/**
+ * 通过next函数逐个取得最多n个元素的副本
+ *
+ * return
+ *	写入out的元素数量
+ */
+static size_t __it_next_batch(Iterator it, Element *out, size_t n)
+{
+	size_t ret = 0;
+	while (ret < n && (out[ret] = it->next(it->iterator)))
+		ret++;
+	return ret;
+}
+
+static void *__std_malloc(size_t size, void *ctx)
+{
+	return malloc(size);
+}
+
+static void *__std_realloc(void *ptr, size_t size, void *ctx)
+{
+	return realloc(ptr, size);
+}
+
+static void __std_free(void *ptr, void *ctx)
+{
+	free(ptr);
 }
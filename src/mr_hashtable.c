@@ -3,6 +3,8 @@
 
 #include "mr_hashtable.h"
 #include "private_element.h"
+#include "private_alloc.h"
+#include "private_lock.h"
 
 #define IS_VALID_HT(X) (X && X->container && X->type == HashTable)
 
@@ -30,53 +32,79 @@ typedef struct {
 	int capa_idx;
 	long size;
 	long changes;
-	pthread_mutex_t mut;
+	lock_t lock;
+	Allocator_t alloc;
+	slab_p nslab;
+	slab_p eslab;
 } ht_t, *ht_p;
 
 typedef struct {
 	ht_p ht;
 	long changes;
 	long it_pos;
+	Allocator_t alloc;
 } ht_it_t, *ht_it_p;
 
 static void __ht_prepare_crypt_table(void);							// 准备哈希函数所需的数据
 static void __ht_hashcodes(element_p element, unsigned long *hashcodes);			// Hash函数
 
-static int __ht_expand(ht_p ht);								// 哈希表容量扩展
+static int __ht_expand(ht_p ht, long size);							// 哈希表容量扩展
+static int __ht_register(ht_p ht, element_p e);							// 注册一个元素，直接引用元素，调用前须加锁
 
-static void __ht_node_destroy(ht_node_p node);							// 销毁节点以及其中的元素
+static void __ht_node_destroy(slab_p nslab, slab_p eslab, ht_node_p node);			// 销毁节点以及其中的元素
 static void __ht_removeall(ht_p ht);								// 销毁哈希表中所有节点及其中的元素
-static ht_node_p __ht_node_create(element_p ele);						// 创建一个哈希表节点
+static ht_node_p __ht_node_create(slab_p nslab, element_p ele);					// 创建一个哈希表节点
 static long __ht_index(ht_node_p node, long capacity, ht_node_p *table);			// 计算表中存放位置
 
 static ht_it_p __ht_iterator(ht_p ht);								// 创建一个迭代器
+static ht_node_p __ht_it_next_node(ht_it_p it);							// 迭代到下一个节点
 static Element __ht_it_next(void *it);								// 迭代获取下一个元素
+static int __ht_it_next_with(void *it, VisitFunc visit, void *ctx);				// 用访问函数迭代访问下一个元素
+static size_t __ht_it_next_batch(void *it, Element *out, size_t n);				// 一次迭代获取多个元素
 static size_t __ht_it_remove(void *it);								// 删除上一次迭代的元素
 static void __ht_it_reset(void *it);								// 重置迭代器
 static void __ht_it_destroy(void *it);								// 销毁迭代器
 
 Container hash_create(void)
 {
-	Container cont = (Container)malloc(sizeof(Container_t));
+	return hash_create_ex(NULL);
+}
+
+Container hash_create_ex(ContainerAttr attr)
+{
+	Allocator_t alloc;
+	if (__mr_allocator(&alloc, attr) != 0)
+		return NULL;
+	Container cont = (Container)__mr_malloc(&alloc, sizeof(Container_t));
 	if (!cont)
 		return NULL;
-	ht_p ht = (ht_p)malloc(sizeof(ht_t));
+	ht_p ht = (ht_p)__mr_malloc(&alloc, sizeof(ht_t));
 	if (!ht) {
-		free(cont);
+		__mr_free(&alloc, cont);
 		return NULL;
 	}
-	ht_node_p *table = (ht_node_p *)malloc(CAPACITIES[0] * sizeof(ht_node_p));
-	memset(table, 0, CAPACITIES[0] * sizeof(ht_node_p));
+	ht_node_p *table = (ht_node_p *)__mr_malloc(&alloc, CAPACITIES[0] * sizeof(ht_node_p));
 	if (!table) {
-		free(ht);
-		free(cont);
+		__mr_free(&alloc, ht);
+		__mr_free(&alloc, cont);
+		return NULL;
+	}
+	memset(table, 0, CAPACITIES[0] * sizeof(ht_node_p));
+	ht->alloc = alloc;
+	ht->nslab = __slab_create(sizeof(ht_node_t), attr && attr->slab, &alloc);
+	ht->eslab = __slab_create(__element_size(object), attr && attr->slab, &alloc);
+	if (!ht->nslab || !ht->eslab || __lock_init(&ht->lock, LOCK_POLICY(attr)) != 0) {
+		__slab_destroy(ht->nslab);
+		__slab_destroy(ht->eslab);
+		__mr_free(&alloc, table);
+		__mr_free(&alloc, ht);
+		__mr_free(&alloc, cont);
 		return NULL;
 	}
 	ht->table = table;
 	ht->capa_idx = 0;
 	ht->size = 0;
 	ht->changes = 0;
-	pthread_mutex_init(&ht->mut, NULL);
 	cont->container = ht;
 	cont->type = HashTable;
 	if (!ct_ready) {
@@ -90,13 +118,16 @@ int hash_destroy(Container hash)
 {
 	if (IS_VALID_HT(hash)) {
 		ht_p ht = (ht_p)hash->container;
-		pthread_mutex_lock(&ht->mut);
+		Allocator_t alloc = ht->alloc;
+		__lock_wrlock(&ht->lock);
 		__ht_removeall(ht);
-		free(ht->table);
-		pthread_mutex_unlock(&ht->mut);
-		pthread_mutex_destroy(&ht->mut);
-		free(ht);
-		free(hash);
+		__mr_free(&alloc, ht->table);
+		__slab_destroy(ht->nslab);
+		__slab_destroy(ht->eslab);
+		__lock_unlock(&ht->lock);
+		__lock_destroy(&ht->lock);
+		__mr_free(&alloc, ht);
+		__mr_free(&alloc, hash);
 		return 0;
 	}
 	return -1;
@@ -122,26 +153,50 @@ int hash_register(Container hash, Element ele, ElementType type, size_t len)
 {
 	int ret = -1;
 	element_p e;
-	if (IS_VALID_HT(hash) && ele && len > 0 && (e = __element_create(ele, type, len))) {
+	if (IS_VALID_HT(hash) && ele && len > 0) {
 		ht_p ht = (ht_p)hash->container;
-		pthread_mutex_lock(&ht->mut);
-		if (ht->size < CAPACITIES[ht->capa_idx] || __ht_expand(ht) == 0) {
-			ht_node_p node = __ht_node_create(e);
-			if (!node) {
-				__element_destroy(e);
-				return -1;
-			}
-			long pos = __ht_index(node, CAPACITIES[ht->capa_idx], ht->table);	// 因为事先扩容，所以不会返回返回-1
-			if (ht->table[pos]) {							// 检查是不是已经有相同元素存在
-				__ht_node_destroy(node);
-				return -1;
-			}
-			ht->table[pos] = node;
-			ht->size++;
-			ht->changes++;
-			ret = 0;
+		__lock_wrlock(&ht->lock);
+		if ((e = __element_create(ht->eslab, ele, type, len)) && (ret = __ht_register(ht, e)) != 0)
+			__element_destroy(ht->eslab, e);
+		__lock_unlock(&ht->lock);
+	}
+	return ret;
+}
+
+int hash_register_adopt(Container hash, Element ele, ElementType type, size_t len)
+{
+	int ret = -1;
+	element_p e;
+	if (IS_VALID_HT(hash)) {
+		ht_p ht = (ht_p)hash->container;
+		__lock_wrlock(&ht->lock);
+		if ((e = __element_adopt(ht->eslab, ele, type, len)) && (ret = __ht_register(ht, e)) != 0)
+			__element_detach(ht->eslab, e);
+		__lock_unlock(&ht->lock);
+	}
+	return ret;
+}
+
+size_t hash_register_many(Container hash, const void *values, size_t count, ElementType type, size_t len)
+{
+	size_t ret = 0;
+	element_p e;
+	if (IS_VALID_HT(hash) && values) {
+		ht_p ht = (ht_p)hash->container;
+		__lock_wrlock(&ht->lock);
+		if (ht->size + (long)count > CAPACITIES[ht->capa_idx])
+			__ht_expand(ht, ht->size + count);	// 事先一次扩充到位，失败时由逐个注册的过程按需扩充
+		for (size_t i = 0; i < count; i++) {
+			size_t elen;
+			Element v = __element_array_at(values, i, type, len, &elen);
+			if (!v || !elen || !(e = __element_create(ht->eslab, v, type, elen)))
+				continue;
+			if (__ht_register(ht, e) == 0)
+				ret++;
+			else
+				__element_destroy(ht->eslab, e);
 		}
-		pthread_mutex_unlock(&ht->mut);
+		__lock_unlock(&ht->lock);
 	}
 	return ret;
 }
@@ -149,20 +204,19 @@ int hash_register(Container hash, Element ele, ElementType type, size_t len)
 int hash_contains(Container hash, Element ele, ElementType type, size_t len)
 {
 	int ret = 0;
+	element_tmp_t tmp;
+	ht_node_t node;			// 查找用的临时节点和元素都在栈上，不分配内存
 	element_p e;
-	if (IS_VALID_HT(hash) && ele && len > 0 && (e = __element_create(ele, type, len))) {
+	if (IS_VALID_HT(hash) && ele && len > 0 && (e = __element_temp(&tmp, &((ht_p)hash->container)->alloc, ele, type, len))) {
 		ht_p ht = (ht_p)hash->container;
-		pthread_mutex_lock(&ht->mut);
-		ht_node_p node = __ht_node_create(e);
-		if (!node) {
-			__element_destroy(e);
-			return 0;
-		}
-		long pos = __ht_index(node, CAPACITIES[ht->capa_idx], ht->table);
+		node.element = e;
+		__ht_hashcodes(e, node.hash);
+		__lock_rdlock(&ht->lock);
+		long pos = __ht_index(&node, CAPACITIES[ht->capa_idx], ht->table);
 		if (pos != -1 && ht->table[pos])
 			ret = 1;
-		__ht_node_destroy(node);
-		pthread_mutex_unlock(&ht->mut);
+		__lock_unlock(&ht->lock);
+		__element_temp_release(&ht->alloc, e);
 	}
 	return ret;
 }
@@ -170,25 +224,24 @@ int hash_contains(Container hash, Element ele, ElementType type, size_t len)
 int hash_remove(Container hash, Element ele, ElementType type, size_t len)
 {
 	int ret = 0;
+	element_tmp_t tmp;
+	ht_node_t node;
 	element_p e;
-	if (IS_VALID_HT(hash) && ele && len > 0 && (e = __element_create(ele, type, len))) {
+	if (IS_VALID_HT(hash) && ele && len > 0 && (e = __element_temp(&tmp, &((ht_p)hash->container)->alloc, ele, type, len))) {
 		ht_p ht = (ht_p)hash->container;
-		pthread_mutex_lock(&ht->mut);
-		ht_node_p node = __ht_node_create(e);
-		if (!node) {
-			__element_destroy(e);
-			return 0;
-		}
-		long pos = __ht_index(node, CAPACITIES[ht->capa_idx], ht->table);
+		node.element = e;
+		__ht_hashcodes(e, node.hash);
+		__lock_wrlock(&ht->lock);
+		long pos = __ht_index(&node, CAPACITIES[ht->capa_idx], ht->table);
 		if (pos != -1 && ht->table[pos]) {
-			__ht_node_destroy(ht->table[pos]);
+			__ht_node_destroy(ht->nslab, ht->eslab, ht->table[pos]);
 			ht->table[pos] = NULL;
 			ht->size--;
 			ht->changes++;
 			ret = 1;
 		}
-		__ht_node_destroy(node);
-		pthread_mutex_unlock(&ht->mut);
+		__lock_unlock(&ht->lock);
+		__element_temp_release(&ht->alloc, e);
 	}
 	return ret;
 }
@@ -197,9 +250,9 @@ int hash_removeall(Container hash)
 {
 	if (IS_VALID_HT(hash)) {
 		ht_p ht = (ht_p)hash->container;
-		pthread_mutex_lock(&ht->mut);
+		__lock_wrlock(&ht->lock);
 		__ht_removeall(ht);					// 在这个函数里已经修改了size和changes了
-		pthread_mutex_unlock(&ht->mut);
+		__lock_unlock(&ht->lock);
 		return 0;
 	}
 	return -1;
@@ -210,11 +263,33 @@ Iterator hash_iterator(Container hash)
 	ht_it_p it = NULL;
 	if (IS_VALID_HT(hash)) {
 		ht_p ht = (ht_p)hash->container;
-		pthread_mutex_lock(&ht->mut);
+		__lock_rdlock(&ht->lock);
 		it = __ht_iterator(ht);
-		pthread_mutex_unlock(&ht->mut);
+		__lock_unlock(&ht->lock);
 	}
-	return it ? it_create(it, __ht_it_next, __ht_it_remove, __ht_it_reset, __ht_it_destroy) : NULL;
+	Iterator ret = it ? __it_create(&it->alloc, it, __ht_it_next, __ht_it_next_with, __ht_it_next_batch, __ht_it_remove, __ht_it_reset, __ht_it_destroy) : NULL;
+	if (it && !ret)
+		__ht_it_destroy(it);
+	return ret;
+}
+
+size_t hash_foreach(Container hash, VisitFunc visit, void *ctx)
+{
+	size_t count = 0;
+	if (IS_VALID_HT(hash) && visit) {
+		ht_p ht = (ht_p)hash->container;
+		__lock_rdlock(&ht->lock);
+		long capa = CAPACITIES[ht->capa_idx];
+		for (long i = 0; i < capa; i++) {
+			if (ht->table[i]) {
+				count++;
+				if (__element_visit(ht->table[i]->element, visit, ctx))
+					break;
+			}
+		}
+		__lock_unlock(&ht->lock);
+	}
+	return count;
 }
 
 /**
@@ -269,21 +344,26 @@ static void __ht_hashcodes(element_p element, unsigned long *hashcodes)
 }
 
 /**
- * @brief 扩充哈希表容量
+ * @brief 扩充哈希表容量，直接扩充到能容纳size个元素的最小容量，所有元素只重新散列一次
  *
  * @param ht
  * 	哈希表
+ * @param size
+ * 	需要容纳的元素数量，不大于现有容量时扩充一级
  *
  * @return 
  * 	扩充成功返回0，失败或已经无法扩展返回-1
  */
-static int __ht_expand(ht_p ht)
+static int __ht_expand(ht_p ht, long size)
 {
 	long oc = CAPACITIES[ht->capa_idx];
-	if (oc == CAPA_COUNT - 1)
+	if (ht->capa_idx == CAPA_COUNT - 1)
 		return -1;
-	long nc = CAPACITIES[ht->capa_idx + 1];
-	ht_node_p *ntable = (ht_node_p *)malloc(nc * sizeof(ht_node_p));
+	int idx = ht->capa_idx + 1;
+	while (idx < CAPA_COUNT - 1 && CAPACITIES[idx] < size)
+		idx++;
+	long nc = CAPACITIES[idx];
+	ht_node_p *ntable = (ht_node_p *)__mr_malloc(&ht->alloc, nc * sizeof(ht_node_p));
 	if (!ntable)
 		return -1;
 	memset(ntable, 0, nc * sizeof(ht_node_p));
@@ -297,24 +377,57 @@ static int __ht_expand(ht_p ht)
 			ntable[np] = node;
 		}
 	}
-	free(ht->table);
+	__mr_free(&ht->alloc, ht->table);
 	ht->table = ntable;
-	ht->capa_idx++;
+	ht->capa_idx = idx;
 	return 0;
 }
 
+/**
+ * @brief 向哈希表中注册一个元素，直接引用元素而不复制，调用前须对哈希表加锁
+ *
+ * @param ht
+ * 	哈希表
+ * @param e
+ * 	元素
+ *
+ * @return 
+ * 	注册成功返回0，注册失败或相同的元素已经存在返回-1，此时元素由调用者负责处理
+ */
+static int __ht_register(ht_p ht, element_p e)
+{
+	int ret = -1;
+	if (ht->size < CAPACITIES[ht->capa_idx] || __ht_expand(ht, ht->size + 1) == 0) {
+		ht_node_p node = __ht_node_create(ht->nslab, e);
+		if (node) {
+			long pos = __ht_index(node, CAPACITIES[ht->capa_idx], ht->table);	// 因为事先扩容，所以不会返回返回-1
+			if (ht->table[pos]) {							// 检查是不是已经有相同元素存在
+				__slab_free(ht->nslab, node);
+			} else {
+				ht->table[pos] = node;
+				ht->size++;
+				ht->changes++;
+				ret = 0;
+			}
+		}
+	}
+	return ret;
+}
+
 /**
  * @brief 生成一个哈希表节点
  *
+ * @param nslab
+ * 	分配节点所用的slab，NULL表示使用全局分配器，查找用的临时节点总是使用全局分配器
  * @param ele
  * 	节点中的元素
  *
  * @return 
  * 	生成的节点，失败时返回NULL
  */
-static ht_node_p __ht_node_create(element_p ele)
+static ht_node_p __ht_node_create(slab_p nslab, element_p ele)
 {
-	ht_node_p node = (ht_node_p)malloc(sizeof(ht_node_t));
+	ht_node_p node = (ht_node_p)__slab_alloc(nslab, sizeof(ht_node_t));
 	if (node) {
 		node->element = ele;
 		__ht_hashcodes(ele, node->hash);
@@ -355,19 +468,23 @@ static long __ht_index(ht_node_p node, long capacity, ht_node_p *table)
 /**
  * @brief 销毁节点及其中的元素
  *
+ * @param nslab
+ * 	创建节点时所用的slab
+ * @param eslab
+ * 	创建元素时所用的slab
  * @param node
  * 	待销毁的节点
  */
-static void __ht_node_destroy(ht_node_p node)
+static void __ht_node_destroy(slab_p nslab, slab_p eslab, ht_node_p node)
 {
 	if (!node)
 		return;
-	__element_destroy(node->element);
-	free(node);
+	__element_destroy(eslab, node->element);
+	__slab_free(nslab, node);
 }
 
 /**
- * @brief 清空所有节点，销毁其中元素
+ * @brief 清空所有节点，销毁其中元素，slab模式下如果所有元素值都内联存储，则不逐个销毁节点，直接整块释放
  *
  * @param ht
  * 	哈希表
@@ -375,8 +492,11 @@ static void __ht_node_destroy(ht_node_p node)
 static void __ht_removeall(ht_p ht)
 {
 	long i = CAPACITIES[ht->capa_idx];
-	while (--i >= 0)
-		__ht_node_destroy(ht->table[i]);
+	if (!SLAB_RELEASABLE(ht->eslab))
+		while (--i >= 0)
+			__ht_node_destroy(ht->nslab, ht->eslab, ht->table[i]);
+	__slab_reset(ht->nslab);
+	__slab_reset(ht->eslab);
 	memset(ht->table, 0, CAPACITIES[ht->capa_idx] * sizeof(ht_node_p));
 	ht->size = 0;
 	ht->changes++;
@@ -384,50 +504,91 @@ static void __ht_removeall(ht_p ht)
 
 static ht_it_p __ht_iterator(ht_p ht)
 {
-	ht_it_p it = (ht_it_p)malloc(sizeof(ht_it_t));
+	ht_it_p it = (ht_it_p)__mr_malloc(&ht->alloc, sizeof(ht_it_t));	// 迭代器由哈希表的分配器分配
 	if (!it)
 		return NULL;
+	it->alloc = ht->alloc;
 	it->ht = ht;
 	it->changes = ht->changes;
 	it->it_pos = -1;
 	return it;
 }
 
+static ht_node_p __ht_it_next_node(ht_it_p it)
+{
+	ht_p ht = it->ht;
+	long capa = CAPACITIES[ht->capa_idx];
+	if (ht->changes != it->changes)
+		it->it_pos = capa;
+	while (++it->it_pos < capa)
+		if (ht->table[it->it_pos])
+			return ht->table[it->it_pos];
+	return NULL;
+}
+
 static Element __ht_it_next(void *it)
 {
 	Element ret = NULL;
 	if (it && ((ht_it_p)it)->ht) {
-		ht_it_p iterator = (ht_it_p)it;
-		ht_p ht = iterator->ht;
-		long capa = CAPACITIES[ht->capa_idx];
-		if (ht->changes != iterator->changes)
-			iterator->it_pos = capa;
-		while (++iterator->it_pos < capa)
-			if (ht->table[iterator->it_pos]) {
-				ret = __element_clone_value(ht->table[iterator->it_pos]->element);
-				break;
-			}
+		ht_p ht = ((ht_it_p)it)->ht;
+		__lock_rdlock(&ht->lock);
+		ht_node_p node = __ht_it_next_node((ht_it_p)it);
+		if (node)
+			ret = __element_clone_value(ht->eslab, node->element);
+		__lock_unlock(&ht->lock);
 	}
 	return ret;
 }
 
+static int __ht_it_next_with(void *it, VisitFunc visit, void *ctx)
+{
+	int ret = -1;
+	if (it && ((ht_it_p)it)->ht) {
+		ht_p ht = ((ht_it_p)it)->ht;
+		__lock_rdlock(&ht->lock);
+		ht_node_p node = __ht_it_next_node((ht_it_p)it);
+		if (node) {
+			__element_visit(node->element, visit, ctx);
+			ret = 0;
+		}
+		__lock_unlock(&ht->lock);
+	}
+	return ret;
+}
+
+static size_t __ht_it_next_batch(void *it, Element *out, size_t n)
+{
+	size_t count = 0;
+	if (it && ((ht_it_p)it)->ht && out) {
+		ht_p ht = ((ht_it_p)it)->ht;
+		ht_node_p node;
+		__lock_rdlock(&ht->lock);
+		while (count < n && (node = __ht_it_next_node((ht_it_p)it)) && (out[count] = __element_clone_value(ht->eslab, node->element)))
+			count++;
+		__lock_unlock(&ht->lock);
+	}
+	return count;
+}
+
 static size_t __ht_it_remove(void *it)
 {
 	size_t ret = 0;
 	if (it && ((ht_it_p)it)->ht) {
 		ht_it_p iterator = (ht_it_p)it;
 		ht_p ht = iterator->ht;
+		__lock_wrlock(&ht->lock);
 		long capa = CAPACITIES[ht->capa_idx];
 		if (ht->changes != iterator->changes)
 			iterator->it_pos = capa;
 		if (iterator->it_pos >= 0 && iterator->it_pos < capa) {
-			__ht_node_destroy(ht->table[iterator->it_pos]);
+			__ht_node_destroy(ht->nslab, ht->eslab, ht->table[iterator->it_pos]);
 			ht->table[iterator->it_pos] = NULL;
 			ht->size--;
 			ht->changes++;
 			iterator->changes++;
 			ret = 1;
 		}
+		__lock_unlock(&ht->lock);
 	}
 	return ret;
 }
@@ -443,6 +604,9 @@ static void __ht_it_reset(void *it)
 
 static void __ht_it_destroy(void *it)
 {
-	free(it);
+	if (it) {
+		Allocator_t alloc = ((ht_it_p)it)->alloc;
+		__mr_free(&alloc, it);
+	}
 }
 
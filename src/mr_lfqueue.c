@@ -0,0 +1,265 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "mr_lfqueue.h"
+#include "private_element.h"
+#include "private_alloc.h"
+
+#define IS_VALID_LFQ(X) (X && X->container && X->type == LockFreeQueue)
+
+#define LFQ_MIN_CAPA 2
+#define LFQ_CACHE_LINE 64
+
+/**
+ * @brief 多生产者多消费者队列的槽位，seq等于位置pos时可以写入，等于pos + 1时可以读出
+ */
+typedef struct {
+	atomic_size_t seq;
+	element_p element;
+} lfq_cell_t, *lfq_cell_p;
+
+/**
+ * @brief 无锁队列结构，生产者和消费者各自修改的位置计数分别放在不同的缓存行中，避免伪共享
+ * 单生产者单消费者队列不使用槽位序号，各自缓存对方的位置计数，只在看起来满或空时才重新读取
+ */
+typedef struct {
+	LFQueueType qtype;
+	ElementType etype;
+	size_t mask;
+	lfq_cell_p cells;
+	Allocator_t alloc;
+	slab_p eslab;
+	char pad0[LFQ_CACHE_LINE];
+	atomic_size_t tail;
+	size_t head_cache;
+	char pad1[LFQ_CACHE_LINE];
+	atomic_size_t head;
+	size_t tail_cache;
+	char pad2[LFQ_CACHE_LINE];
+} lfq_t, *lfq_p;
+
+static int __mpmc_enqueue(lfq_p q, element_p e);		// 多生产者多消费者队列入队
+static element_p __mpmc_dequeue(lfq_p q);			// 多生产者多消费者队列出队
+static int __spsc_enqueue(lfq_p q, element_p e);		// 单生产者单消费者队列入队
+static element_p __spsc_dequeue(lfq_p q);			// 单生产者单消费者队列出队
+
+Container lfq_create(LFQueueType qtype, ElementType etype, size_t capacity)
+{
+	return lfq_create_ex(qtype, etype, capacity, NULL);
+}
+
+Container lfq_create_ex(LFQueueType qtype, ElementType etype, size_t capacity, ContainerAttr attr)
+{
+	Allocator_t alloc;
+	if (__mr_allocator(&alloc, attr) != 0)
+		return NULL;
+	size_t capa = LFQ_MIN_CAPA;
+	while (capa < capacity && capa <= SIZE_MAX / 2 / sizeof(lfq_cell_t))
+		capa *= 2;
+	if (capa < capacity)
+		return NULL;		// 向上取整后的容量超出槽位数组可以分配的大小
+	Container cont = (Container)__mr_malloc(&alloc, sizeof(Container_t));
+	if (!cont)
+		return NULL;
+	lfq_p q = (lfq_p)__mr_malloc(&alloc, sizeof(lfq_t));
+	lfq_cell_p cells = (lfq_cell_p)__mr_malloc(&alloc, capa * sizeof(lfq_cell_t));
+	slab_p eslab = __slab_create(__element_size(etype), 0, &alloc);	// 元素由多个线程同时创建和销毁，不能使用slab模式
+	if (!q || !cells || !eslab) {
+		__slab_destroy(eslab);
+		__mr_free(&alloc, cells);
+		__mr_free(&alloc, q);
+		__mr_free(&alloc, cont);
+		return NULL;
+	}
+	for (size_t i = 0; i < capa; i++) {
+		atomic_init(&cells[i].seq, i);
+		cells[i].element = NULL;
+	}
+	q->qtype = qtype;
+	q->etype = etype;
+	q->mask = capa - 1;
+	q->cells = cells;
+	q->alloc = alloc;
+	q->eslab = eslab;
+	atomic_init(&q->tail, 0);
+	atomic_init(&q->head, 0);
+	q->head_cache = 0;
+	q->tail_cache = 0;
+	cont->container = q;
+	cont->type = LockFreeQueue;
+	return cont;
+}
+
+int lfq_destroy(Container q)
+{
+	if (IS_VALID_LFQ(q)) {
+		lfq_p lq = (lfq_p)q->container;
+		Allocator_t alloc = lq->alloc;
+		element_p e;
+		while ((e = lq->qtype == SPSC_Queue ? __spsc_dequeue(lq) : __mpmc_dequeue(lq)))
+			__element_destroy(lq->eslab, e);
+		__slab_destroy(lq->eslab);
+		__mr_free(&alloc, lq->cells);
+		__mr_free(&alloc, lq);
+		__mr_free(&alloc, q);
+		return 0;
+	}
+	return -1;
+}
+
+size_t lfq_size(Container q)
+{
+	if (IS_VALID_LFQ(q)) {
+		lfq_p lq = (lfq_p)q->container;
+		size_t head = atomic_load_explicit(&lq->head, memory_order_acquire);
+		size_t tail = atomic_load_explicit(&lq->tail, memory_order_acquire);
+		return tail > head ? tail - head : 0;	// 先读head再读tail，两次读取之间有出队时tail可能落后，此时按空队列计
+	}
+	return 0;
+}
+
+int lfq_isempty(Container q)
+{
+	return lfq_size(q) == 0;
+}
+
+size_t lfq_capacity(Container q)
+{
+	return IS_VALID_LFQ(q) ? ((lfq_p)q->container)->mask + 1 : 0;
+}
+
+int lfq_enqueue(Container q, Element element, ElementType type, size_t len)
+{
+	int ret = -1;
+	element_p e;
+	if (IS_VALID_LFQ(q) && ((lfq_p)q->container)->etype == type && element && len > 0) {	// 空值出队时无法与空队列区分，不允许入队
+		lfq_p lq = (lfq_p)q->container;
+		if ((e = __element_create(lq->eslab, element, type, len)) &&
+				(ret = lq->qtype == SPSC_Queue ? __spsc_enqueue(lq, e) : __mpmc_enqueue(lq, e)) != 0)
+			__element_destroy(lq->eslab, e);
+	}
+	return ret;
+}
+
+Element lfq_dequeue(Container q)
+{
+	Element ret = NULL;
+	if (IS_VALID_LFQ(q)) {
+		lfq_p lq = (lfq_p)q->container;
+		element_p e = lq->qtype == SPSC_Queue ? __spsc_dequeue(lq) : __mpmc_dequeue(lq);
+		if (e)
+			ret = __element_take_value(lq->eslab, e);	// 元素不来自slab，取值不会失败，已出队的元素不会丢失
+	}
+	return ret;
+}
+
+/**
+ * @brief 多生产者多消费者队列入队，用比较交换抢占tail位置，抢到后写入槽位并把序号推进到pos + 1，通知消费者可以读出
+ *
+ * @param q
+ * 	无锁队列
+ * @param e
+ * 	元素
+ *
+ * @return 
+ * 	入队成功返回0，队列已满返回-1
+ */
+static int __mpmc_enqueue(lfq_p q, element_p e)
+{
+	lfq_cell_p cell;
+	size_t pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+	for (;;) {
+		cell = &q->cells[pos & q->mask];
+		size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+		intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+		if (dif == 0) {
+			if (atomic_compare_exchange_weak_explicit(&q->tail, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+				break;			// 抢占失败时pos已被更新为最新的tail
+		} else if (dif < 0) {
+			return -1;			// 槽位中还是一圈之前的元素，尚未被读出，队列已满
+		} else {
+			pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+		}
+	}
+	cell->element = e;
+	atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+	return 0;
+}
+
+/**
+ * @brief 多生产者多消费者队列出队，用比较交换抢占head位置，抢到后取出元素并把序号推进到下一圈的写入位置pos + capacity
+ *
+ * @param q
+ * 	无锁队列
+ *
+ * @return 
+ * 	出队的元素，队列为空返回NULL
+ */
+static element_p __mpmc_dequeue(lfq_p q)
+{
+	lfq_cell_p cell;
+	size_t pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+	for (;;) {
+		cell = &q->cells[pos & q->mask];
+		size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+		intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+		if (dif == 0) {
+			if (atomic_compare_exchange_weak_explicit(&q->head, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+				break;
+		} else if (dif < 0) {
+			return NULL;			// 槽位尚未写入，队列为空
+		} else {
+			pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+		}
+	}
+	element_p e = cell->element;
+	atomic_store_explicit(&cell->seq, pos + q->mask + 1, memory_order_release);
+	return e;
+}
+
+/**
+ * @brief 单生产者单消费者队列入队，只有生产者修改tail，缓存的head显示队列已满时才重新读取消费者的位置
+ *
+ * @param q
+ * 	无锁队列
+ * @param e
+ * 	元素
+ *
+ * @return 
+ * 	入队成功返回0，队列已满返回-1
+ */
+static int __spsc_enqueue(lfq_p q, element_p e)
+{
+	size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+	if (tail - q->head_cache > q->mask) {
+		q->head_cache = atomic_load_explicit(&q->head, memory_order_acquire);
+		if (tail - q->head_cache > q->mask)
+			return -1;
+	}
+	q->cells[tail & q->mask].element = e;
+	atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+	return 0;
+}
+
+/**
+ * @brief 单生产者单消费者队列出队，只有消费者修改head，缓存的tail显示队列为空时才重新读取生产者的位置
+ *
+ * @param q
+ * 	无锁队列
+ *
+ * @return 
+ * 	出队的元素，队列为空返回NULL
+ */
+static element_p __spsc_dequeue(lfq_p q)
+{
+	size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+	if (head == q->tail_cache) {
+		q->tail_cache = atomic_load_explicit(&q->tail, memory_order_acquire);
+		if (head == q->tail_cache)
+			return NULL;
+	}
+	element_p e = q->cells[head & q->mask].element;
+	atomic_store_explicit(&q->head, head + 1, memory_order_release);
+	return e;
+}
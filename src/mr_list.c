@@ -1,14 +1,59 @@
 #include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <limits.h>
 #include <pthread.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "mr_list.h"
 #include "private_element.h"
+#include "private_alloc.h"
+#include "private_lock.h"
 
 #define IS_VALID_LIST(X) (X && X->container && X->type == List)
 
 #define AL_INIT_CAPA 10
 #define AL_NEXT_CAPA(CC) ((CC) * 3 / 2 + 1)
 
+#define RL_INIT_CAPA 16
+#define RL_AT(RL, I) ((RL)->elements[((RL)->head + (I)) & ((RL)->capacity - 1)])
+
+#define LL_CACHE_CAPA 256
+
+#define UL_NODE_CAPA 64
+
+#define IL_SIZE(N) ((N) ? (N)->size : 0)
+#define IL_HEIGHT(N) ((N) ? (N)->height : 0)
+
+#define SORT_QUICK 0
+#define SORT_INSERT 1
+#define SORT_STABLE 2
+#define SORT_RADIX 3
+#define SORT_SMALL 16
+#define SORT_MAX_RUNS 85
+#define SORT_PAR_MIN 8192
+#define SORT_PAR_MAX 64
+#define SORT_RADIX_MIN 256
+#define SORT_RADIX_SMALL 32
+#define SORT_RADIX_LEVELS 32
+
+#define IDX_MIN_CAPA 16
+
+#define LIST_ROOM(L, N) (!(L)->bound || ((L)->size <= (L)->bound && (N) <= (L)->bound - (L)->size))	// 再添加N个元素是否不超过容量上限
+#define LIST_CAN_WAIT(L, MSEC) ((MSEC) == 0 || (L)->lock.policy == Lock_Mutex)				// 条件变量只能配合互斥锁使用
+
+#if LDBL_MANT_DIG == 64 && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define RADIX_REAL_EXT 2		// x87扩展精度，低8字节为尾数，随后2字节为符号和阶码
+#elif LDBL_MANT_DIG == 53
+#define RADIX_REAL_EXT 0		// 与double相同的双精度
+#else
+#define RADIX_REAL_EXT -1		// 其他格式的实数不使用基数排序
+#endif
+
+#define ORDER_CMP(A, B) (order * cmpfunc((A)->value, (B)->value, (A)->len, (B)->len))
+
 /**
  * @brief 链表节点结构
  */
@@ -34,6 +79,53 @@ typedef struct {
 	element_p *elements;
 } arraylist_t, *arraylist_p;
 
+/**
+ * @brief 环形线性表结构，容量总是2的幂，第i个元素存放在(head + i) & (capacity - 1)处
+ */
+typedef struct {
+	size_t capacity;
+	size_t head;
+	element_p *elements;
+} ringlist_t, *ringlist_p;
+
+/**
+ * @brief 展开链表节点结构，每个节点存放最多UL_NODE_CAPA个连续的元素
+ */
+typedef struct UnrolledListNode {
+	struct UnrolledListNode *next;
+	struct UnrolledListNode *prev;
+	size_t count;
+	element_p elements[UL_NODE_CAPA];
+} ul_node_t, *ul_node_p;
+
+/**
+ * @brief 展开链表结构，finger记录最近一次定位到的节点，按位置顺序访问时从finger开始查找
+ */
+typedef struct {
+	ul_node_p head;
+	ul_node_p tail;
+	ul_node_p finger;
+	size_t fbase;
+} unrolledlist_t, *unrolledlist_p;
+
+/**
+ * @brief 索引树节点结构，以子树的元素数量作为位置索引，按AVL树的规则保持平衡
+ */
+typedef struct IndexedListNode {
+	struct IndexedListNode *left;
+	struct IndexedListNode *right;
+	size_t size;
+	int height;
+	element_p element;
+} il_node_t, *il_node_p;
+
+/**
+ * @brief 索引树结构，中序遍历的顺序即为元素在列表中的顺序
+ */
+typedef struct {
+	il_node_p root;
+} indexedlist_t, *indexedlist_p;
+
 /**
  * @brief 列表容器结构
  */
@@ -42,11 +134,71 @@ typedef struct {
 	ListType ltype;
 	ElementType etype;
 	CmpFunc cmpfunc;
+	HashFunc hashfunc;
+	int sorted;
 	size_t size;
-	pthread_mutex_t mut;
+	lock_t lock;
+	pthread_cond_t notempty;
+	pthread_cond_t notfull;
+	size_t bound;
+	int closed;
+	int rwait;
+	int wwait;
 	unsigned int changes;
+	Allocator_t alloc;
+	slab_p nslab;
+	slab_p eslab;
+	ll_node_p cache;
+	size_t cached;
+	size_t cachemax;
 } list_t, *list_p;
 
+/**
+ * @brief 并行排序的任务，排序任务以dst[lo, hi)为缓冲区对src[lo, hi)进行稳定排序，合并任务把src[lo, hi)与src[lo2, hi2)合并到dst[out]开始的位置
+ */
+typedef struct {
+	element_p *src;
+	element_p *dst;
+	size_t lo;
+	size_t hi;
+	size_t lo2;
+	size_t hi2;
+	size_t out;
+	int order;
+	CmpFunc cmpfunc;
+	pthread_t tid;
+	int running;
+} psort_task_t, *psort_task_p;
+
+/**
+ * @brief 基数排序的排序项，把元素的值转换为按无符号整数比较即可保持顺序的排序键，排序时不再访问元素
+ */
+typedef struct {
+	unsigned long long key;
+	unsigned int ext;
+	element_p element;
+} radix_item_t, *radix_item_p;
+
+/**
+ * @brief 列表索引的哈希槽，element为NULL表示空槽
+ */
+typedef struct {
+	size_t hash;
+	element_p element;
+} idx_slot_t, *idx_slot_p;
+
+/**
+ * @brief 列表索引，用于快速判断一个元素是否在列表中存在，有哈希函数时为去重的开放定址哈希表，否则为按比较函数排序的元素数组
+ * 两者都无法分配时退化为在列表中顺序搜索
+ */
+typedef struct {
+	list_p list;
+	HashFunc hashfunc;
+	idx_slot_p slots;
+	size_t mask;
+	element_p *sorted;
+} list_idx_t, *list_idx_p;
+
 /**
  * @brief 列表迭代器当前位置联合
  */
@@ -56,7 +208,7 @@ typedef union {
 } list_pos_t, *list_pos_p;
 
 /**
- * @brief 列表迭代器
+ * @brief 列表迭代器，只迭代位置在[from, to)之间的元素，to小于0表示直到表尾，at为链表迭代器当前节点的位置
  */
 typedef struct {
 	list_p list;
@@ -64,77 +216,195 @@ typedef struct {
 	int dir;
 	unsigned int changes;
 	int removable;
+	int from;
+	int to;
+	int at;
+	Allocator_t alloc;
 } list_it_t, *list_it_p;
 
-static void __linkedlist_node_destroy(ll_node_p node);						// 销毁链表节点
+static void __linkedlist_node_destroy(list_p list, ll_node_p node);				// 销毁链表节点
 static void __linkedlist_node_plugout(linkedlist_p ll, ll_node_p node);				// 从链表中抽离出一个节点
-static void __linkedlist_removeall(linkedlist_p list);						// 清空链表
-static void __arraylist_removeall(arraylist_p list, size_t size);				// 清空线性表
-static size_t __linkedlist_remove_at(linkedlist_p ll, size_t size, size_t index);		// 删除链表节点
-static size_t __arraylist_remove_at(arraylist_p al, size_t size, size_t index);			// 删除线性表元素
-static size_t __linkedlist_remove(linkedlist_p ll, element_p ele, CmpFunc cmpfunc);		// 删除所有与ele相等的元素的链表节点
-static size_t __arraylist_remove(arraylist_p al, size_t size, element_p ele, CmpFunc cmpfunc);	// 删除所有与ele相等的线性表元素
-
-static int __arraylist_expand(arraylist_p list);						// 线性表扩容
-static ll_node_p __linkedlist_node_create(element_p ele);					// 创建一个链表节点
+static void __linkedlist_removeall(list_p list);						// 清空链表
+static void __arraylist_removeall(list_p list);							// 清空线性表
+static void __ringlist_removeall(list_p list);							// 清空环形线性表
+static void __unrolledlist_removeall(list_p list);						// 清空展开链表
+static void __indexedlist_node_destroy(list_p list, il_node_p node);				// 销毁一棵索引树子树，包括其中的元素
+static size_t __linkedlist_remove_at(list_p list, size_t index);				// 删除链表节点
+static size_t __arraylist_remove_at(list_p list, size_t index);					// 删除线性表元素
+static size_t __ringlist_remove_at(list_p list, size_t index);					// 删除环形线性表元素
+static element_p __unrolledlist_detach(list_p list, size_t index);				// 从展开链表中取出一个元素但不销毁
+static il_node_p __indexedlist_node_del(list_p list, il_node_p node, size_t index, element_p *ele);	// 从索引树子树中取出第index个元素
+static size_t __indexedlist_remove(list_p list, element_p ele);					// 删除所有与ele相等的索引树元素
+static size_t __linkedlist_remove(list_p list, element_p ele);					// 删除所有与ele相等的元素的链表节点
+static size_t __arraylist_remove(list_p list, element_p ele);					// 删除所有与ele相等的线性表元素
+static size_t __ringlist_remove(list_p list, element_p ele);					// 删除所有与ele相等的环形线性表元素
+static size_t __unrolledlist_remove(list_p list, element_p ele);				// 删除所有与ele相等的展开链表元素
+
+static int __arraylist_expand(arraylist_p list, Allocator alloc);				// 线性表扩容
+static int __ringlist_expand(ringlist_p rl, Allocator alloc);					// 环形线性表扩容
+static ll_node_p __linkedlist_node_create(list_p list, element_p ele);				// 创建一个链表节点
 static ll_node_p __linkedlist_goto(linkedlist_p ll, size_t size, size_t pos);			// 找到链表的第pos个节点
-static int __linkedlist_ins(linkedlist_p ll, size_t size, size_t index, element_p ele);		// 在index位置插入一个新元素
-static int __arraylist_ins(arraylist_p al, size_t size, size_t index, element_p ele);		// 在index位置插入一个新元素
+static int __linkedlist_ins(list_p list, size_t index, element_p ele);				// 在index位置插入一个新元素
+static int __arraylist_ins(arraylist_p al, size_t size, size_t index, element_p ele, Allocator alloc);	// 在index位置插入一个新元素
+static int __ringlist_ins(list_p list, size_t index, element_p ele);				// 在index位置插入一个新元素
+static ul_node_p __unrolledlist_node_create(list_p list);					// 创建一个展开链表节点
+static void __unrolledlist_node_plugout(list_p list, ul_node_p node);				// 从展开链表中抽离并销毁一个空节点
+static ul_node_p __unrolledlist_locate(unrolledlist_p ul, size_t size, size_t index, size_t *base);	// 找到第index个元素所在的节点
+static int __unrolledlist_ins(list_p list, size_t index, element_p ele);			// 在index位置插入一个新元素
+static void __indexedlist_node_update(il_node_p node);						// 重新计算节点的子树大小和高度
+static il_node_p __indexedlist_rotate_left(il_node_p node);					// 索引树左旋
+static il_node_p __indexedlist_rotate_right(il_node_p node);					// 索引树右旋
+static il_node_p __indexedlist_balance(il_node_p node);						// 索引树节点重新平衡
+static il_node_p __indexedlist_goto(il_node_p root, size_t index);				// 找到索引树中第index个节点
+static il_node_p __indexedlist_node_ins(il_node_p node, size_t index, il_node_p n);		// 把节点插入到索引树子树的第index个位置
+static int __indexedlist_ins(list_p list, size_t index, element_p ele);				// 在index位置插入一个新元素
 
 static int __linkedlist_search(linkedlist_p ll, size_t from, int dir, size_t size, element_p ele, CmpFunc cmpfunc);		// 搜索链表
 static int __arraylist_search(arraylist_p al, size_t from, int dir, size_t size, element_p ele, CmpFunc cmpfunc);		// 搜索线性表
+static int __ringlist_search(ringlist_p rl, size_t from, int dir, size_t size, element_p ele, CmpFunc cmpfunc);		// 搜索环形线性表
+static int __unrolledlist_search(unrolledlist_p ul, size_t from, int dir, size_t size, element_p ele, CmpFunc cmpfunc);	// 搜索展开链表
+static int __indexedlist_search(il_node_p node, size_t base, size_t from, int dir, element_p ele, CmpFunc cmpfunc);	// 搜索索引树
+static size_t __arraylist_bound(element_p *a, size_t lo, size_t hi, element_p e, int upper, int order, CmpFunc cmpfunc);	// 在有序序列中查找e的插入位置
 static int __linkedlist_bisearch(element_p e, size_t size, int order, ll_node_p left, ll_node_p right, CmpFunc cmpfunc);	// 链表二分搜索
 static int __arraylist_bisearch(element_p e, element_p *a, int order, int left, int right, CmpFunc cmpfunc);			// 线性表二分搜索
-static void __linkedlist_quicksort(ll_node_p left, ll_node_p right, int order, CmpFunc cmpfunc);				// 链表快速排序
+static int __ringlist_bisearch(element_p e, ringlist_p rl, int order, int left, int right, CmpFunc cmpfunc);			// 环形线性表二分搜索
+static int __unrolledlist_bisearch(element_p e, unrolledlist_p ul, int order, CmpFunc cmpfunc);				// 展开链表二分搜索
+static void __unrolledlist_sort(list_p list, int order, int method);							// 展开链表排序
+static int __indexedlist_bisearch(element_p e, il_node_p root, int order, CmpFunc cmpfunc);				// 索引树二分搜索
+static size_t __indexedlist_collect(il_node_p node, element_p *a, int fill);						// 按中序收集或写回索引树中的元素
+static void __indexedlist_sort(list_p list, int order, int method);							// 索引树排序
+static void __linkedlist_mergesort(linkedlist_p ll, int order, CmpFunc cmpfunc);						// 链表自底向上归并排序
 static void __arraylist_quicksort(element_p *a, int left, int right, int order, CmpFunc cmpfunc);				// 线性表快速排序
+static void __arraylist_introsort(element_p *a, int left, int right, int depth, int order, CmpFunc cmpfunc);		// 线性表内省排序
+static void __arraylist_heapsort(element_p *a, int left, int right, int order, CmpFunc cmpfunc);				// 线性表堆排序
+static void __arraylist_stablesort(element_p *a, size_t size, element_p *buf, int order, CmpFunc cmpfunc, Allocator alloc);	// 线性表稳定排序
+static void __arraylist_merge(element_p *a, size_t lo, size_t mid, size_t hi, element_p *buf, int order, CmpFunc cmpfunc);	// 合并两段相邻的有序序列
+static void __arraylist_sort(list_p list, element_p *a, int order, int method);						// 按指定的排序方法对元素数组排序
+static void __radix_key(element_p e, ElementType type, int order, radix_item_p item);					// 计算元素的基数排序键
+static void __radix_lsd(radix_item_p items, radix_item_p tmp, size_t n, int digits);					// 对排序项进行LSD基数排序
+static void __radix_msd(element_p *a, element_p *tmp, size_t n, size_t depth, int level, int order, CmpFunc cmpfunc);	// 对字符串进行MSD基数排序
+static int __arraylist_radixsort(list_p list, element_p *a, size_t size, int order);					// 使用默认比较函数的列表的基数排序
+static int __linkedlist_radixsort(list_p list, int order);								// 链表基数排序
+static void *__psort_sort_task(void *task);											// 并行排序中对一段元素排序的线程
+static void *__psort_merge_task(void *task);										// 并行排序中合并两段有序序列的一部分的线程
+static void __psort_run(psort_task_p tasks, int ntasks, void *(*func)(void *));						// 并行执行一组任务并等待全部完成
+static void __arraylist_psort(list_p list, element_p *a, int order, int nthreads);					// 线性表多线程并行稳定排序
 static void __linkedlist_insertsort(ll_node_p left, ll_node_p right, int order, CmpFunc cmpfunc);				// 链表插入排序
 static void __arraylist_insertsort(element_p *a, int left, int right, int order, CmpFunc cmpfunc);				// 线性表插入排序
 
 static void __linkedlist_reverse(ll_node_p head, ll_node_p tail);				// 链表元素反转排列
 static void __arraylist_reverse(element_p *a, size_t size);					// 线性表元素反转排列
+static element_p *__ringlist_linearize(ringlist_p rl);						// 把环形线性表旋转为从数组头部开始连续存放
+static void __unrolledlist_reverse(unrolledlist_p ul, size_t size);				// 展开链表元素反转排列
+static void __indexedlist_mirror(il_node_p node);						// 索引树左右镜像，即元素反转排列
+static int __indexedlist_foreach(il_node_p node, int dir, VisitFunc visit, void *ctx, size_t *count);	// 按中序顺序访问索引树中的元素
 
-static list_it_p __list_iterator(list_p list, int dir);						// 创建一个列表迭代器
+static list_it_p __list_iterator(list_p list, int dir, int from, int to);			// 创建一个列表迭代器
+static Iterator __list_it_wrap(list_it_p it);							// 用列表的分配器把列表迭代器封装成Iterator
+static void __list_it_start(list_it_p it);							// 把迭代器置于起始位置
+static element_p __list_it_next_element(list_it_p it);						// 迭代到下一个元素，调用前须加锁
 static Element __list_it_next(void *it);							// 迭代访问下一个元素
+static int __list_it_next_with(void *it, VisitFunc visit, void *ctx);				// 用访问函数迭代访问下一个元素
+static size_t __list_it_next_batch(void *it, Element *out, size_t n);				// 一次迭代访问多个元素
 static size_t __list_it_remove(void *it);							// 删除上一次迭代访问的元素
 static void __list_it_reset(void *it);								// 重置迭代器
 static void __list_it_destroy(void *it);							// 销毁迭代器
 
+static void __list_clear(list_p list);								// 清空列表
+static size_t __list_trim(list_p list, size_t keep);						// 释放缓存中超出keep个的空闲链表节点
+static size_t __list_foreach(list_p list, int dir, VisitFunc visit, void *ctx);			// 按顺序用访问函数访问全部元素，调用前须加锁
 static element_p __list_get_at(list_p list, list_pos_t pos);					// 获取当前位置的元素
-static void __list_del_at(list_p list, list_pos_p pos);						// 删除当前位置的元素
+static element_p __list_element_at(list_p list, size_t index);					// 获取第index个元素
+static size_t __list_remove_at(list_p list, size_t index);					// 删除第index个元素
 static void __list_append(list_p list, element_p ele);						// 在最后添加元素
+static int __list_insert(list_p list, size_t index, element_p ele);				// 在index位置插入元素，调用前须加锁
+static int __list_reserve(list_p list, size_t capacity);					// 预留容纳capacity个元素的空间
+static element_p *__list_elements_create(list_p list, const void *values, size_t count, ElementType type, size_t len);	// 按元素值数组批量创建元素
+static int __list_insert_array(list_p list, size_t index, element_p *a, size_t n);		// 在index位置批量插入元素，调用前须加锁
+static int __list_movable(list_p dst, list_p src);						// 判断src的元素和节点能否直接转移给dst
+static void __indexedlist_forget(il_node_p node);						// 断开索引树子树中节点对元素的引用
+static void __list_forget(list_p list);								// 清空列表但不销毁元素，元素已经转移给其他列表
+static int __list_transfer(list_p dst, size_t index, list_p src);				// 把src的全部元素移到dst的index位置，调用前须对两个列表加锁
+static void __linkedlist_merge(linkedlist_p ll, ll_node_p mid, int order, CmpFunc cmpfunc);	// 重新链接节点合并链表中相邻的两段有序序列
+static void __list_merge_at(list_p list, size_t mid, int order);				// 合并列表中各自有序的[0, mid)和[mid, size)两段
+static size_t __list_remove_range(list_p list, size_t from, size_t to);				// 删除[from, to)之间的元素，调用前须加锁
+static Element __list_pop(list_p list, int take);						// 弹出表尾元素
+static Element __list_dequeue(list_p list, int take);						// 弹出表头元素，调用前须加锁
+static void __list_rdlock(list_p list);								// 为只读操作加锁
+static void __list_wrlock(list_p list);								// 为修改操作加锁
+static void __list_unlock(list_p list);								// 唤醒可以继续执行的等待线程并解锁
+static void __list_lock_pair(list_p a, int wa, list_p b, int wb);				// 按地址顺序对两个列表加锁
+static int __list_wait(list_p list, pthread_cond_t *cond, int *waiters, const struct timespec *deadline);	// 在条件变量上等待
+static struct timespec *__list_deadline(struct timespec *ts, long msec);			// 计算等待的截止时间
+static void __list_sort(list_p list, int order, int method);					// 按指定的排序方法对列表排序
+static int __list_order(list_p list);								// 获取有序列表的排列顺序
+static size_t __list_bound(list_p list, element_p ele, int upper, int order);			// 在有序列表中查找元素的插入位置
+static void __list_collect(list_p list, element_p *a);						// 按顺序收集列表中的全部元素
+static size_t __list_hash(list_idx_p idx, element_p ele);					// 计算元素在索引中使用的哈希值
+static void __list_idx_build(list_p list, list_idx_p idx);					// 为列表建立索引
+static int __list_idx_contains(list_idx_p idx, element_p ele);					// 判断元素是否在索引的列表中存在
+static void __list_idx_destroy(list_idx_p idx);							// 销毁索引
+static void __list_filter(list_p list, list_idx_p idx, int found);				// 删除在索引中存在或不存在的全部元素
 
 Container list_create(ElementType etype, ListType ltype, CmpFunc cmpfunc)
+{
+	return list_create_ex(etype, ltype, cmpfunc, NULL);
+}
+
+Container list_create_ex(ElementType etype, ListType ltype, CmpFunc cmpfunc, ContainerAttr attr)
 {
 	Container cont = NULL;
 	list_p list = NULL;
 	void *l = NULL;
 	element_p *elements = NULL;
-	cont = (Container)malloc(sizeof(Container_t));
+	Allocator_t alloc;
+	if (__mr_allocator(&alloc, attr) != 0)
+		return NULL;
+	cont = (Container)__mr_malloc(&alloc, sizeof(Container_t));
 	if (!cont)
 		return NULL;
-	list = (list_p)malloc(sizeof(list_t));
+	list = (list_p)__mr_malloc(&alloc, sizeof(list_t));
 	if (!list) {
-		free(cont);
+		__mr_free(&alloc, cont);
 		return NULL;
 	} else {
 		cont->container = list;
 		cont->type = List;
 	}
-	l = ltype == LinkedList ? malloc(sizeof(linkedlist_t)) : malloc(sizeof(arraylist_t));
+	l = __mr_malloc(&alloc, ltype == LinkedList ? sizeof(linkedlist_t) : ltype == RingList ? sizeof(ringlist_t) : ltype == UnrolledList ? sizeof(unrolledlist_t) : ltype == IndexedList ? sizeof(indexedlist_t) : sizeof(arraylist_t));
 	if (!l) {
-		free(list);
-		free(cont);
+		__mr_free(&alloc, list);
+		__mr_free(&alloc, cont);
 		return NULL;
 	} else {
 		if (ltype == LinkedList) {
 			((linkedlist_p)l)->head = NULL;
 			((linkedlist_p)l)->tail = NULL;
+		} else if (ltype == UnrolledList) {
+			((unrolledlist_p)l)->head = NULL;
+			((unrolledlist_p)l)->tail = NULL;
+			((unrolledlist_p)l)->finger = NULL;
+			((unrolledlist_p)l)->fbase = 0;
+		} else if (ltype == IndexedList) {
+			((indexedlist_p)l)->root = NULL;
+		} else if (ltype == RingList) {
+			elements = (element_p *)__mr_malloc(&alloc, RL_INIT_CAPA * sizeof(element_p));
+			if (!elements) {
+				__mr_free(&alloc, l);
+				__mr_free(&alloc, list);
+				__mr_free(&alloc, cont);
+				return NULL;
+			} else {
+				((ringlist_p)l)->capacity = RL_INIT_CAPA;
+				((ringlist_p)l)->head = 0;
+				((ringlist_p)l)->elements = elements;
+			}
 		} else {
-			elements = (element_p *)malloc(AL_INIT_CAPA * sizeof(element_p));
+			elements = (element_p *)__mr_malloc(&alloc, AL_INIT_CAPA * sizeof(element_p));
 			if (!elements) {
-				free(l);
-				free(list);
-				free(cont);
+				__mr_free(&alloc, l);
+				__mr_free(&alloc, list);
+				__mr_free(&alloc, cont);
 				return NULL;
 			} else {
 				((arraylist_p)l)->capacity = AL_INIT_CAPA;
@@ -145,9 +415,43 @@ Container list_create(ElementType etype, ListType ltype, CmpFunc cmpfunc)
 		list->ltype = ltype;
 		list->etype = etype;
 		list->cmpfunc = cmpfunc ? cmpfunc : __default_cmpfunc(etype);
+		list->hashfunc = NULL;
+		list->sorted = 0;
 		list->size = 0;
 		list->changes = 0;
-		pthread_mutex_init(&list->mut, NULL);
+		list->alloc = alloc;
+		list->nslab = NULL;
+		list->eslab = __slab_create(__element_size(etype), attr && attr->slab, &alloc);
+		if (ltype == LinkedList)
+			list->nslab = __slab_create(sizeof(ll_node_t), attr && attr->slab, &alloc);
+		else if (ltype == UnrolledList)
+			list->nslab = __slab_create(sizeof(ul_node_t), attr && attr->slab, &alloc);
+		else if (ltype == IndexedList)
+			list->nslab = __slab_create(sizeof(il_node_t), attr && attr->slab, &alloc);
+		list->cache = NULL;
+		list->cached = 0;
+		list->cachemax = ltype == LinkedList && !SLAB_ACTIVE(list->nslab) ? LL_CACHE_CAPA : 0;	// slab模式下节点已经在slab中循环复用
+		if (!list->eslab || ((ltype == LinkedList || ltype == UnrolledList || ltype == IndexedList) && !list->nslab) ||
+				__lock_init(&list->lock, LOCK_POLICY(attr)) != 0) {
+			__slab_destroy(list->eslab);
+			__slab_destroy(list->nslab);
+			if (elements)
+				__mr_free(&alloc, elements);
+			__mr_free(&alloc, l);
+			__mr_free(&alloc, list);
+			__mr_free(&alloc, cont);
+			return NULL;
+		}
+		list->bound = 0;
+		list->closed = 0;
+		list->rwait = 0;
+		list->wwait = 0;
+		pthread_condattr_t cattr;
+		pthread_condattr_init(&cattr);
+		pthread_condattr_setclock(&cattr, CLOCK_MONOTONIC);	// 限时等待使用单调时钟，不受系统时间调整的影响
+		pthread_cond_init(&list->notempty, &cattr);
+		pthread_cond_init(&list->notfull, &cattr);
+		pthread_condattr_destroy(&cattr);
 	}
 	return cont;
 }
@@ -157,20 +461,24 @@ int list_destroy(Container list)
 	int ret = -1;
 	if (IS_VALID_LIST(list)) {
 		list_p l = (list_p)list->container;
-		pthread_mutex_lock(&l->mut);
-		if (l->ltype == LinkedList) {
-			__linkedlist_removeall((linkedlist_p)l->list);
-		} else {
-			__arraylist_removeall((arraylist_p)l->list, l->size);
-			free(((arraylist_p)l->list)->elements);
-		}
-		free(l->list);
-		l->size = 0;
+		Allocator_t alloc = l->alloc;
+		__list_wrlock(l);
+		__list_clear(l);
+		if (l->ltype == RingList)
+			__mr_free(&alloc, ((ringlist_p)l->list)->elements);
+		else if (l->ltype == ArrayList)
+			__mr_free(&alloc, ((arraylist_p)l->list)->elements);
+		__mr_free(&alloc, l->list);
+		__list_trim(l, 0);
+		__slab_destroy(l->nslab);
+		__slab_destroy(l->eslab);
 		l->changes++;
-		pthread_mutex_unlock(&l->mut);
-		pthread_mutex_destroy(&l->mut);
-		free(l);
-		free(list);
+		__lock_unlock(&l->lock);
+		__lock_destroy(&l->lock);
+		pthread_cond_destroy(&l->notempty);
+		pthread_cond_destroy(&l->notfull);
+		__mr_free(&alloc, l);
+		__mr_free(&alloc, list);
 		ret = 0;
 	}
 	return ret;
@@ -180,12 +488,50 @@ void list_set_cmpfunc(Container list, CmpFunc cmpfunc)
 {
 	if (IS_VALID_LIST(list)) {
 		list_p l = (list_p)list->container;
-		pthread_mutex_lock(&l->mut);
+		__list_wrlock(l);
 		l->cmpfunc = cmpfunc ? cmpfunc : __default_cmpfunc(l->etype);
-		pthread_mutex_unlock(&l->mut);
+		l->hashfunc = NULL;
+		if (l->sorted)
+			__list_sort(l, l->sorted, SORT_STABLE);
+		__list_unlock(l);
 	}
 }
 
+void list_set_hashfunc(Container list, HashFunc hashfunc)
+{
+	if (IS_VALID_LIST(list)) {
+		list_p l = (list_p)list->container;
+		__list_wrlock(l);
+		l->hashfunc = hashfunc;
+		__list_unlock(l);
+	}
+}
+
+void list_set_cache(Container list, size_t max)
+{
+	if (IS_VALID_LIST(list)) {
+		list_p l = (list_p)list->container;
+		__list_wrlock(l);
+		if (l->ltype == LinkedList && !SLAB_ACTIVE(l->nslab)) {
+			l->cachemax = max;
+			__list_trim(l, max);
+		}
+		__list_unlock(l);
+	}
+}
+
+size_t list_trim(Container list)
+{
+	size_t ret = 0;
+	if (IS_VALID_LIST(list)) {
+		list_p l = (list_p)list->container;
+		__list_wrlock(l);
+		ret = __list_trim(l, 0);
+		__list_unlock(l);
+	}
+	return ret;
+}
+
 int list_isempty(Container list)
 {
 	return IS_VALID_LIST(list) ? ((list_p)list->container)->size == 0 : 1;
@@ -196,6 +542,18 @@ size_t list_size(Container list)
 	return IS_VALID_LIST(list) ? ((list_p)list->container)->size : 0;
 }
 
+int list_reserve(Container list, size_t capacity)
+{
+	int ret = -1;
+	if (IS_VALID_LIST(list)) {
+		list_p l = (list_p)list->container;
+		__list_wrlock(l);
+		ret = __list_reserve(l, capacity);
+		__list_unlock(l);
+	}
+	return ret;
+}
+
 int list_append(Container list, Element element, ElementType type, size_t len)
 {
 	return IS_VALID_LIST(list) ? list_insert(list, ((list_p)list->container)->size, element, type, len) : -1;
@@ -206,19 +564,58 @@ int list_insert(Container list, size_t index, Element element, ElementType type,
 	int ret = -1;
 	element_p ele = NULL;
 	list_p l = NULL;
-	if (IS_VALID_LIST(list) && (l = (list_p)list->container)->etype == type && (ele = __element_create(element, type, len))) {
-		pthread_mutex_lock(&l->mut);
-		if (l->ltype == LinkedList)
-			ret = __linkedlist_ins((linkedlist_p)l->list, l->size, index, ele);
-		else
-			ret = __arraylist_ins((arraylist_p)l->list, l->size, index, ele);
-		if (ret == 0) {
-			l->size++;
-			l->changes++;
-		} else {
-			__element_destroy(ele);
+	if (IS_VALID_LIST(list) && (l = (list_p)list->container)->etype == type) {
+		__list_wrlock(l);
+		if (LIST_ROOM(l, 1) && (ele = __element_create(l->eslab, element, type, len)) && (ret = __list_insert(l, l->sorted ? __list_bound(l, ele, 1, l->sorted) : index, ele)) != 0)
+			__element_destroy(l->eslab, ele);
+		__list_unlock(l);
+	}
+	return ret;
+}
+
+int list_append_adopt(Container list, Element element, ElementType type, size_t len)
+{
+	return IS_VALID_LIST(list) ? list_insert_adopt(list, ((list_p)list->container)->size, element, type, len) : -1;
+}
+
+int list_insert_adopt(Container list, size_t index, Element element, ElementType type, size_t len)
+{
+	int ret = -1;
+	element_p ele = NULL;
+	list_p l = NULL;
+	if (IS_VALID_LIST(list) && (l = (list_p)list->container)->etype == type) {
+		__list_wrlock(l);
+		if (LIST_ROOM(l, 1) && (ele = __element_adopt(l->eslab, element, type, len)) && (ret = __list_insert(l, l->sorted ? __list_bound(l, ele, 1, l->sorted) : index, ele)) != 0)
+			__element_detach(l->eslab, ele);
+		__list_unlock(l);
+	}
+	return ret;
+}
+
+int list_append_array(Container list, const void *values, size_t count, ElementType type, size_t len)
+{
+	return IS_VALID_LIST(list) ? list_insert_range(list, ((list_p)list->container)->size, values, count, type, len) : -1;
+}
+
+int list_insert_range(Container list, size_t index, const void *values, size_t count, ElementType type, size_t len)
+{
+	int ret = -1;
+	element_p *a = NULL;
+	if (IS_VALID_LIST(list) && ((list_p)list->container)->etype == type && (values || count == 0)) {
+		list_p l = (list_p)list->container;
+		if (count == 0)
+			return 0;
+		__list_wrlock(l);
+		if (LIST_ROOM(l, count) && (a = __list_elements_create(l, values, count, type, len))) {
+			if ((ret = __list_insert_array(l, l->sorted ? l->size : index, a, count)) != 0) {
+				for (size_t i = 0; i < count; i++)
+					__element_destroy(l->eslab, a[i]);
+			} else if (l->sorted) {
+				__list_sort(l, l->sorted, SORT_STABLE);		// 有序模式下先添加在尾部再合并，只需一次稳定排序
+			}
+			__mr_free(&l->alloc, a);
 		}
-		pthread_mutex_unlock(&l->mut);
+		__list_unlock(l);
 	}
 	return ret;
 }
@@ -226,14 +623,40 @@ int list_insert(Container list, size_t index, Element element, ElementType type,
 Element list_get(Container list, size_t index)
 {
 	Element ret = NULL;
-	if (IS_VALID_LIST(list) && index < ((list_p)list->container)->size) {
+	if (IS_VALID_LIST(list)) {
 		list_p l = (list_p)list->container;
-		pthread_mutex_lock(&l->mut);
-		if (l->ltype == LinkedList)
-			ret = __element_clone_value((__linkedlist_goto((linkedlist_p)l->list, l->size, index))->element);
-		else
-			ret = __element_clone_value(((arraylist_p)l->list)->elements[index]);
-		pthread_mutex_unlock(&l->mut);
+		__list_rdlock(l);
+		if (index < l->size)			// 须在加锁后检查位置，其他线程可能同时删除了元素
+			ret = __element_clone_value(l->eslab, __list_element_at(l, index));
+		__list_unlock(l);
+	}
+	return ret;
+}
+
+int list_get_with(Container list, size_t index, VisitFunc visit, void *ctx)
+{
+	int ret = -1;
+	if (IS_VALID_LIST(list) && visit) {
+		list_p l = (list_p)list->container;
+		__list_rdlock(l);
+		if (index < l->size) {
+			__element_visit(__list_element_at(l, index), visit, ctx);
+			ret = 0;
+		}
+		__list_unlock(l);
+	}
+	return ret;
+}
+
+long list_get_into(Container list, size_t index, void *buf, size_t cap)
+{
+	long ret = -1;
+	if (IS_VALID_LIST(list)) {
+		list_p l = (list_p)list->container;
+		__list_rdlock(l);
+		if (index < l->size)
+			ret = __element_copy_into(__list_element_at(l, index), buf, cap);
+		__list_unlock(l);
 	}
 	return ret;
 }
@@ -241,18 +664,33 @@ Element list_get(Container list, size_t index)
 size_t list_remove_at(Container list, size_t index)
 {
 	size_t count = 0;
-	if (IS_VALID_LIST(list) && index < ((list_p)list->container)->size) {
+	if (IS_VALID_LIST(list)) {
 		list_p l = (list_p)list->container;
-		pthread_mutex_lock(&l->mut);
-		if (l->ltype == LinkedList)
-			count = __linkedlist_remove_at((linkedlist_p)l->list, l->size, index);
-		else
-			count = __arraylist_remove_at((arraylist_p)l->list, l->size, index);
+		__list_wrlock(l);
+		count = index < l->size ? __list_remove_at(l, index) : 0;
 		if (count) {
 			l->size -= count;
 			l->changes++;
 		}
-		pthread_mutex_unlock(&l->mut);
+		__list_unlock(l);
+	}
+	return count;
+}
+
+size_t list_remove_range(Container list, size_t from, size_t to)
+{
+	size_t count = 0;
+	if (IS_VALID_LIST(list)) {
+		list_p l = (list_p)list->container;
+		__list_wrlock(l);
+		if (to > l->size)
+			to = l->size;
+		if (from < to) {
+			count = __list_remove_range(l, from, to);
+			l->size -= count;
+			l->changes++;
+		}
+		__list_unlock(l);
 	}
 	return count;
 }
@@ -260,20 +698,27 @@ size_t list_remove_at(Container list, size_t index)
 size_t list_remove(Container list, Element element, ElementType type, size_t len)
 {
 	size_t count = 0;
+	element_tmp_t tmp;
 	element_p ele = NULL;
-	if (IS_VALID_LIST(list) && ((list_p)list->container)->etype == type && ((list_p)list->container)->size > 0 && (ele = __element_create(element, type, len))) {
+	if (IS_VALID_LIST(list) && ((list_p)list->container)->etype == type && ((list_p)list->container)->size > 0 && (ele = __element_temp(&tmp, &((list_p)list->container)->alloc, element, type, len))) {
 		list_p l = (list_p)list->container;
-		pthread_mutex_lock(&l->mut);
+		__list_wrlock(l);
 		if (l->ltype == LinkedList)
-			count = __linkedlist_remove((linkedlist_p)l->list, ele, l->cmpfunc);
+			count = __linkedlist_remove(l, ele);
+		else if (l->ltype == RingList)
+			count = __ringlist_remove(l, ele);
+		else if (l->ltype == UnrolledList)
+			count = __unrolledlist_remove(l, ele);
+		else if (l->ltype == IndexedList)
+			count = __indexedlist_remove(l, ele);
 		else
-			count = __arraylist_remove((arraylist_p)l->list, l->size, ele, l->cmpfunc);
+			count = __arraylist_remove(l, ele);
 		if (count) {
 			l->size -= count;
 			l->changes++;
 		}
-		__element_destroy(ele);
-		pthread_mutex_unlock(&l->mut);
+		__element_temp_release(&l->alloc, ele);
+		__list_unlock(l);
 	}
 	return count;
 }
@@ -282,25 +727,27 @@ void list_removeall(Container list)
 {
 	if (IS_VALID_LIST(list)) {
 		list_p l = (list_p)list->container;
-		pthread_mutex_lock(&l->mut);
-		if (l->ltype == LinkedList)
-			__linkedlist_removeall((linkedlist_p)l->list);
-		else
-			__arraylist_removeall((arraylist_p)l->list, l->size);
-		l->size = 0;
+		__list_wrlock(l);
+		__list_clear(l);
 		l->changes++;
-		pthread_mutex_unlock(&l->mut);
+		__list_unlock(l);
 	}
 }
 
 int list_search(Container list, int from, int dir, Element element, ElementType type, size_t len)
 {
 	int ret = -1;
+	element_tmp_t tmp;
 	element_p ele = NULL;
-	if (IS_VALID_LIST(list) && ((list_p)list->container)->etype == type && ((list_p)list->container)->size > 0 && (ele = __element_create(element, type, len))) {
+	if (IS_VALID_LIST(list) && ((list_p)list->container)->etype == type && (ele = __element_temp(&tmp, &((list_p)list->container)->alloc, element, type, len))) {
 		list_p l = (list_p)list->container;
-		pthread_mutex_lock(&l->mut);
+		__list_rdlock(l);
 		size_t start;
+		if (l->size == 0) {
+			__element_temp_release(&l->alloc, ele);
+			__list_unlock(l);
+			return -1;
+		}
 		if (from < 0)
 			start = dir == Reverse ? l->size - 1 : 0;
 		else if (from >= l->size)
@@ -309,10 +756,16 @@ int list_search(Container list, int from, int dir, Element element, ElementType
 			start = from;
 		if (l->ltype == LinkedList)
 			ret = __linkedlist_search((linkedlist_p)l->list, start, dir, l->size, ele, l->cmpfunc);
+		else if (l->ltype == RingList)
+			ret = __ringlist_search((ringlist_p)l->list, start, dir, l->size, ele, l->cmpfunc);
+		else if (l->ltype == UnrolledList)
+			ret = __unrolledlist_search((unrolledlist_p)l->list, start, dir, l->size, ele, l->cmpfunc);
+		else if (l->ltype == IndexedList)
+			ret = __indexedlist_search(((indexedlist_p)l->list)->root, 0, start, dir, ele, l->cmpfunc);
 		else
 			ret = __arraylist_search((arraylist_p)l->list, start, dir, l->size, ele, l->cmpfunc);
-		__element_destroy(ele);
-		pthread_mutex_unlock(&l->mut);
+		__element_temp_release(&l->alloc, ele);
+		__list_unlock(l);
 	}
 	return ret;
 }
@@ -320,51 +773,169 @@ int list_search(Container list, int from, int dir, Element element, ElementType
 int list_bi_search(Container list, Element element, ElementType type, size_t len)
 {
 	int ret = -1;
+	element_tmp_t tmp;
 	element_p e = NULL;
-	if (IS_VALID_LIST(list) && ((list_p)list->container)->etype == type && ((list_p)list->container)->size > 0 && (e = __element_create(element, type, len))) {
+	if (IS_VALID_LIST(list) && ((list_p)list->container)->etype == type && (e = __element_temp(&tmp, &((list_p)list->container)->alloc, element, type, len))) {
 		list_p l = (list_p)list->container;
-		pthread_mutex_lock(&l->mut);
-		int order;
-		if (l->ltype == LinkedList) {
+		__list_rdlock(l);
+		int order = __list_order(l);
+		if (l->size == 0) {
+			ret = -1;
+		} else if (l->ltype == LinkedList) {
 			linkedlist_p ll = (linkedlist_p)l->list;
-			order = l->cmpfunc(ll->head->element->value, ll->tail->element->value, ll->head->element->len, ll->tail->element->len) > 0 ? Desc : Asc;
 			ret = __linkedlist_bisearch(e, l->size, order, ll->head, ll->tail, l->cmpfunc);
+		} else if (l->ltype == RingList) {
+			ret = __ringlist_bisearch(e, (ringlist_p)l->list, order, 0, l->size - 1, l->cmpfunc);
+		} else if (l->ltype == UnrolledList) {
+			ret = __unrolledlist_bisearch(e, (unrolledlist_p)l->list, order, l->cmpfunc);
+		} else if (l->ltype == IndexedList) {
+			ret = __indexedlist_bisearch(e, ((indexedlist_p)l->list)->root, order, l->cmpfunc);
 		} else {
-			arraylist_p al = (arraylist_p)l->list;
-			order = l->cmpfunc(al->elements[0]->value, al->elements[l->size - 1]->value, al->elements[0]->len, al->elements[l->size -1]->len) > 0 ? Desc : Asc;
-			ret = __arraylist_bisearch(e, al->elements, order, 0, l->size - 1, l->cmpfunc);
+			ret = __arraylist_bisearch(e, ((arraylist_p)l->list)->elements, order, 0, l->size - 1, l->cmpfunc);
 		}
-		__element_destroy(e);
-		pthread_mutex_unlock(&l->mut);
+		__element_temp_release(&l->alloc, e);
+		__list_unlock(l);
 	}
 	return ret;
 }
 
 void list_qsort(Container list, int order)
 {
-	if (IS_VALID_LIST(list) && ((list_p)list->container)->size > 1) {
+	if (IS_VALID_LIST(list)) {
 		list_p l = (list_p)list->container;
-		pthread_mutex_lock(&l->mut);
-		if (l->ltype == LinkedList)
-			__linkedlist_quicksort(((linkedlist_p)l->list)->head, ((linkedlist_p)l->list)->tail, order, l->cmpfunc);
-		else
-			__arraylist_quicksort(((arraylist_p)l->list)->elements, 0, l->size - 1, order, l->cmpfunc);
-		l->changes++;
-		pthread_mutex_unlock(&l->mut);
+		__list_wrlock(l);
+		__list_sort(l, order, SORT_QUICK);
+		__list_unlock(l);
 	}
 }
 
 void list_isort(Container list, int order)
+{
+	if (IS_VALID_LIST(list)) {
+		list_p l = (list_p)list->container;
+		__list_wrlock(l);
+		__list_sort(l, order, l->size <= SORT_SMALL ? SORT_INSERT : SORT_STABLE);		// 元素较多时改用稳定的归并排序，避免O(n²)
+		__list_unlock(l);
+	}
+}
+
+void list_stable_sort(Container list, int order)
+{
+	if (IS_VALID_LIST(list)) {
+		list_p l = (list_p)list->container;
+		__list_wrlock(l);
+		__list_sort(l, order, SORT_STABLE);
+		__list_unlock(l);
+	}
+}
+
+void list_radix_sort(Container list, int order)
+{
+	if (IS_VALID_LIST(list)) {
+		list_p l = (list_p)list->container;
+		__list_wrlock(l);
+		__list_sort(l, order, SORT_RADIX);
+		__list_unlock(l);
+	}
+}
+
+int list_lower_bound(Container list, Element element, ElementType type, size_t len)
+{
+	int ret = -1;
+	element_tmp_t tmp;
+	element_p e = NULL;
+	if (IS_VALID_LIST(list) && ((list_p)list->container)->etype == type && (e = __element_temp(&tmp, &((list_p)list->container)->alloc, element, type, len))) {
+		list_p l = (list_p)list->container;
+		__list_rdlock(l);
+		ret = __list_bound(l, e, 0, __list_order(l));
+		__element_temp_release(&l->alloc, e);
+		__list_unlock(l);
+	}
+	return ret;
+}
+
+int list_upper_bound(Container list, Element element, ElementType type, size_t len)
+{
+	int ret = -1;
+	element_tmp_t tmp;
+	element_p e = NULL;
+	if (IS_VALID_LIST(list) && ((list_p)list->container)->etype == type && (e = __element_temp(&tmp, &((list_p)list->container)->alloc, element, type, len))) {
+		list_p l = (list_p)list->container;
+		__list_rdlock(l);
+		ret = __list_bound(l, e, 1, __list_order(l));
+		__element_temp_release(&l->alloc, e);
+		__list_unlock(l);
+	}
+	return ret;
+}
+
+size_t list_equal_range(Container list, Element element, ElementType type, size_t len, size_t *from, size_t *to)
+{
+	size_t count = 0;
+	element_tmp_t tmp;
+	element_p e = NULL;
+	if (IS_VALID_LIST(list) && ((list_p)list->container)->etype == type && (e = __element_temp(&tmp, &((list_p)list->container)->alloc, element, type, len))) {
+		list_p l = (list_p)list->container;
+		__list_rdlock(l);
+		int order = __list_order(l);
+		size_t lo = __list_bound(l, e, 0, order);
+		size_t hi = __list_bound(l, e, 1, order);
+		if (from)
+			*from = lo;
+		if (to)
+			*to = hi;
+		count = hi - lo;
+		__element_temp_release(&l->alloc, e);
+		__list_unlock(l);
+	}
+	return count;
+}
+
+void list_sort_lock(Container list, int order)
+{
+	if (IS_VALID_LIST(list)) {
+		list_p l = (list_p)list->container;
+		__list_wrlock(l);
+		__list_sort(l, order, SORT_STABLE);
+		l->sorted = order;
+		__list_unlock(l);
+	}
+}
+
+void list_sort_unlock(Container list)
+{
+	if (IS_VALID_LIST(list)) {
+		list_p l = (list_p)list->container;
+		__list_wrlock(l);
+		l->sorted = 0;
+		__list_unlock(l);
+	}
+}
+
+int list_sorted(Container list)
+{
+	return IS_VALID_LIST(list) ? ((list_p)list->container)->sorted : 0;
+}
+
+void list_psort(Container list, int order, int nthreads)
 {
 	if (IS_VALID_LIST(list) && ((list_p)list->container)->size > 1) {
 		list_p l = (list_p)list->container;
-		pthread_mutex_lock(&l->mut);
+		__list_wrlock(l);
 		if (l->ltype == LinkedList)
-			__linkedlist_insertsort(((linkedlist_p)l->list)->head, ((linkedlist_p)l->list)->tail, order, l->cmpfunc);
+			__linkedlist_mergesort((linkedlist_p)l->list, order, l->cmpfunc);
+		else if (l->ltype == RingList)
+			__arraylist_psort(l, __ringlist_linearize((ringlist_p)l->list), order, nthreads);
+		else if (l->ltype == UnrolledList)
+			__unrolledlist_sort(l, order, SORT_STABLE);
+		else if (l->ltype == IndexedList)
+			__indexedlist_sort(l, order, SORT_STABLE);
 		else
-			__arraylist_insertsort(((arraylist_p)l->list)->elements, 0, l->size - 1, order, l->cmpfunc);
+			__arraylist_psort(l, ((arraylist_p)l->list)->elements, order, nthreads);
+		if (l->sorted)
+			l->sorted = order;
 		l->changes++;
-		pthread_mutex_unlock(&l->mut);
+		__list_unlock(l);
 	}
 }
 
@@ -372,13 +943,20 @@ void list_reverse(Container list)
 {
 	if (IS_VALID_LIST(list) && ((list_p)list->container)->size > 1) {
 		list_p l = (list_p)list->container;
-		pthread_mutex_lock(&l->mut);
+		__list_wrlock(l);
 		if (l->ltype == LinkedList)
 			__linkedlist_reverse(((linkedlist_p)l->list)->head, ((linkedlist_p)l->list)->tail);
+		else if (l->ltype == RingList)
+			__arraylist_reverse(__ringlist_linearize((ringlist_p)l->list), l->size);
+		else if (l->ltype == UnrolledList)
+			__unrolledlist_reverse((unrolledlist_p)l->list, l->size);
+		else if (l->ltype == IndexedList)
+			__indexedlist_mirror(((indexedlist_p)l->list)->root);
 		else
 			__arraylist_reverse(((arraylist_p)l->list)->elements, l->size);
+		l->sorted = -l->sorted;
 		l->changes++;
-		pthread_mutex_unlock(&l->mut);
+		__list_unlock(l);
 	}
 }
 
@@ -389,39 +967,23 @@ int list_push(Container list, Element element, ElementType type, size_t len)
 
 Element list_pop(Container list)
 {
-	Element ret = NULL;
-	if (IS_VALID_LIST(list) && ((list_p)list->container)->size > 0) {
-		list_p l = (list_p)list->container;
-		pthread_mutex_lock(&l->mut);
-		if (l->ltype == LinkedList) {
-			linkedlist_p ll = (linkedlist_p)l->list;
-			ll_node_p top = ll->tail;
-			ret = __element_clone_value(top->element);
-			__linkedlist_node_plugout(ll, top);
-			__linkedlist_node_destroy(top);
-		} else {
-			arraylist_p al = (arraylist_p)l->list;
-			ret = __element_clone_value(al->elements[l->size - 1]);
-			__element_destroy(al->elements[l->size - 1]);
-		}
-		l->size--;
-		l->changes++;
-		pthread_mutex_unlock(&l->mut);
-	}
-	return ret;
+	return IS_VALID_LIST(list) ? __list_pop((list_p)list->container, 0) : NULL;
+}
+
+Element list_pop_take(Container list)
+{
+	return IS_VALID_LIST(list) ? __list_pop((list_p)list->container, 1) : NULL;
 }
 
 Element list_stacktop(Container list)
 {
 	Element ret = NULL;
-	if (IS_VALID_LIST(list) && ((list_p)list->container)->size > 0) {
+	if (IS_VALID_LIST(list)) {
 		list_p l = (list_p)list->container;
-		pthread_mutex_lock(&l->mut);
-		if (l->ltype == LinkedList)
-			ret = __element_clone_value(((linkedlist_p)l->list)->tail->element);
-		else
-			ret = __element_clone_value(((arraylist_p)l->list)->elements[l->size - 1]);
-		pthread_mutex_unlock(&l->mut);
+		__list_rdlock(l);
+		if (l->size > 0)
+			ret = __element_clone_value(l->eslab, __list_element_at(l, l->size - 1));
+		__list_unlock(l);
 	}
 	return ret;
 }
@@ -434,147 +996,301 @@ int list_enqueue(Container list, Element element, ElementType type, size_t len)
 Element list_dequeue(Container list)
 {
 	Element ret = NULL;
-	if (IS_VALID_LIST(list) && ((list_p)list->container)->size > 0) {
+	if (IS_VALID_LIST(list)) {
 		list_p l = (list_p)list->container;
-		pthread_mutex_lock(&l->mut);
-		if (l->ltype == LinkedList) {
-			linkedlist_p ll = (linkedlist_p)l->list;
-			ll_node_p head = ll->head;
-			ret = __element_clone_value(head->element);
-			__linkedlist_node_plugout(ll, head);
-			__linkedlist_node_destroy(head);
-		} else {
-			arraylist_p al = (arraylist_p)l->list;
-			ret = __element_clone_value(al->elements[0]);
-			__element_destroy(al->elements[0]);
-			for (size_t i = 1; i < l->size; i++)
-				al->elements[i - 1] = al->elements[i];
-		}
-		l->size--;
-		l->changes++;
-		pthread_mutex_unlock(&l->mut);
+		__list_wrlock(l);
+		ret = __list_dequeue(l, 0);
+		__list_unlock(l);
 	}
 	return ret;
 }
 
-Element list_queuehead(Container list)
+Element list_dequeue_take(Container list)
 {
 	Element ret = NULL;
-	if (IS_VALID_LIST(list) && ((list_p)list->container)->size > 0) {
+	if (IS_VALID_LIST(list)) {
 		list_p l = (list_p)list->container;
-		pthread_mutex_lock(&l->mut);
-		if (l->ltype == LinkedList)
-			ret = __element_clone_value(((linkedlist_p)l->list)->head->element);
-		else
-			ret = __element_clone_value(((arraylist_p)l->list)->elements[0]);
-		pthread_mutex_unlock(&l->mut);
+		__list_wrlock(l);
+		ret = __list_dequeue(l, 1);
+		__list_unlock(l);
 	}
 	return ret;
 }
 
-Iterator list_iterator(Container list, int dir)
+int list_set_bound(Container list, size_t bound)
 {
-	list_it_p it = NULL;
 	if (IS_VALID_LIST(list)) {
 		list_p l = (list_p)list->container;
-		pthread_mutex_lock(&l->mut);
-		it = __list_iterator(l, dir);
-		pthread_mutex_unlock(&l->mut);
+		__list_wrlock(l);
+		l->bound = bound;
+		__list_unlock(l);		// 容量放宽后可能有等待入队的线程可以继续
+		return 0;
 	}
-	return it ? it_create(it, __list_it_next, __list_it_remove, __list_it_reset, __list_it_destroy) : NULL;
+	return -1;
 }
 
-void list_plus(Container list1, Container list2)
+int list_enqueue_wait(Container list, Element element, ElementType type, size_t len)
 {
-	list_p l1, l2;
-	if (IS_VALID_LIST(list1) && IS_VALID_LIST(list2) &&
-			(l1 = (list_p)list1->container)->etype == (l2 = (list_p)list2->container)->etype &&
-			l2->size > 0) {
-		pthread_mutex_lock(&l1->mut);
-		pthread_mutex_lock(&l2->mut);
-		list_pos_t pos;
-		if (l2->ltype == LinkedList)
-			pos.node = ((linkedlist_p)l2->list)->head;
-		else
-			pos.index = 0;
-		element_p ele;
-		while ((ele = __list_get_at(l2, pos))) {
-			__list_append(l1, ele);
-			if (l2->ltype == LinkedList)
-				pos.node = pos.node->next;
-			else
-				pos.index++;
+	return list_enqueue_timedwait(list, element, type, len, -1);
+}
+
+int list_enqueue_timedwait(Container list, Element element, ElementType type, size_t len, long msec)
+{
+	int ret = -1;
+	element_p ele = NULL;
+	if (IS_VALID_LIST(list) && ((list_p)list->container)->etype == type && LIST_CAN_WAIT((list_p)list->container, msec)) {
+		list_p l = (list_p)list->container;
+		struct timespec ts;
+		struct timespec *deadline = __list_deadline(&ts, msec);
+		__list_wrlock(l);
+		while (!l->closed && !LIST_ROOM(l, 1) && msec != 0)
+			if (__list_wait(l, &l->notfull, &l->wwait, deadline) == ETIMEDOUT)
+				break;
+		if (!l->closed && LIST_ROOM(l, 1) &&
+				(ele = __element_create(l->eslab, element, type, len)) && (ret = __list_insert(l, l->sorted ? __list_bound(l, ele, 1, l->sorted) : l->size, ele)) != 0)
+			__element_destroy(l->eslab, ele);
+		__list_unlock(l);
+	}
+	return ret;
+}
+
+Element list_dequeue_wait(Container list)
+{
+	return list_dequeue_timedwait(list, -1);
+}
+
+Element list_dequeue_timedwait(Container list, long msec)
+{
+	Element ret = NULL;
+	if (IS_VALID_LIST(list) && LIST_CAN_WAIT((list_p)list->container, msec)) {
+		list_p l = (list_p)list->container;
+		struct timespec ts;
+		struct timespec *deadline = __list_deadline(&ts, msec);
+		__list_wrlock(l);
+		while (l->size == 0 && !l->closed && msec != 0)
+			if (__list_wait(l, &l->notempty, &l->rwait, deadline) == ETIMEDOUT)
+				break;
+		ret = __list_dequeue(l, 1);
+		__list_unlock(l);
+	}
+	return ret;
+}
+
+size_t list_drain(Container list, Element *buf, size_t max, long msec)
+{
+	size_t n = 0;
+	if (IS_VALID_LIST(list) && buf && max > 0 && LIST_CAN_WAIT((list_p)list->container, msec)) {
+		list_p l = (list_p)list->container;
+		struct timespec ts;
+		struct timespec *deadline = __list_deadline(&ts, msec);
+		__list_wrlock(l);
+		while (l->size == 0 && !l->closed && msec != 0)
+			if (__list_wait(l, &l->notempty, &l->rwait, deadline) == ETIMEDOUT)
+				break;
+		if (l->ltype == ArrayList && l->size > 0) {
+			// 线性表从头部逐个出队每次都要移动全部元素，这里一次取出后只移动一次
+			element_p *a = ((arraylist_p)l->list)->elements;
+			size_t m = max < l->size ? max : l->size;
+			for (; n < m; n++)			// 先逐个取值，复制失败时停在该元素，它和后面的元素都留在列表中
+				if (!(buf[n] = __element_prepare_take(l->eslab, a[n])) && a[n]->value)
+					break;
+			for (size_t i = 0; i < n; i++)
+				__element_detach(l->eslab, a[i]);
+			if (n > 0) {
+				memmove(a, a + n, (l->size - n) * sizeof(element_p));
+				l->size -= n;
+				l->changes++;
+			}
+		} else {
+			size_t size;
+			while (n < max && (size = l->size) > 0) {
+				buf[n] = __list_dequeue(l, 1);
+				if (l->size == size)		// 复制失败时元素没有出队，不再继续
+					break;
+				n++;
+			}
 		}
-		pthread_mutex_unlock(&l1->mut);
-		pthread_mutex_unlock(&l2->mut);
+		__list_unlock(l);
 	}
+	return n;
 }
 
-void list_minus(Container list1, Container list2)
+void list_close(Container list)
+{
+	if (IS_VALID_LIST(list)) {
+		list_p l = (list_p)list->container;
+		__list_wrlock(l);
+		l->closed = 1;
+		pthread_cond_broadcast(&l->notempty);
+		pthread_cond_broadcast(&l->notfull);
+		__lock_unlock(&l->lock);
+	}
+}
+
+int list_isclosed(Container list)
+{
+	return IS_VALID_LIST(list) ? ((list_p)list->container)->closed : 1;
+}
+
+Element list_queuehead(Container list)
+{
+	Element ret = NULL;
+	if (IS_VALID_LIST(list)) {
+		list_p l = (list_p)list->container;
+		__list_rdlock(l);
+		if (l->size > 0)
+			ret = __element_clone_value(l->eslab, __list_element_at(l, 0));
+		__list_unlock(l);
+	}
+	return ret;
+}
+
+Iterator list_iterator(Container list, int dir)
+{
+	list_it_p it = NULL;
+	if (IS_VALID_LIST(list)) {
+		list_p l = (list_p)list->container;
+		__list_rdlock(l);
+		it = __list_iterator(l, dir, 0, -1);
+		__list_unlock(l);
+	}
+	return __list_it_wrap(it);
+}
+
+Iterator list_range_iterator(Container list, size_t from, size_t to, int dir)
+{
+	list_it_p it = NULL;
+	if (IS_VALID_LIST(list) && from <= to && to <= INT_MAX) {
+		list_p l = (list_p)list->container;
+		__list_rdlock(l);
+		it = __list_iterator(l, dir, from, to);
+		__list_unlock(l);
+	}
+	return __list_it_wrap(it);
+}
+
+size_t list_foreach(Container list, int dir, VisitFunc visit, void *ctx)
+{
+	size_t count = 0;
+	if (IS_VALID_LIST(list) && visit) {
+		list_p l = (list_p)list->container;
+		__lock_rdlock(&l->lock);		// 直接沿节点遍历，不移动展开链表的finger，因此总是加共享锁
+		count = __list_foreach(l, dir, visit, ctx);
+		__list_unlock(l);
+	}
+	return count;
+}
+
+void list_plus(Container list1, Container list2)
 {
 	list_p l1, l2;
 	if (IS_VALID_LIST(list1) && IS_VALID_LIST(list2) &&
 			(l1 = (list_p)list1->container)->etype == (l2 = (list_p)list2->container)->etype &&
 			l2->size > 0) {
-		pthread_mutex_lock(&l1->mut);
-		pthread_mutex_lock(&l2->mut);
+		if (l1 == l2)
+			__list_wrlock(l1);
+		else
+			__list_lock_pair(l1, 1, l2, 0);
+		size_t mid = l1->size, n = l2->size;
 		list_pos_t pos;
-		if (l1->ltype == LinkedList)
-			pos.node = ((linkedlist_p)l1->list)->head;
+		if (l2->ltype == LinkedList)
+			pos.node = ((linkedlist_p)l2->list)->head;
 		else
 			pos.index = 0;
 		element_p ele;
-		int ex;
-		while ((ele = __list_get_at(l1, pos))) {
+		for (size_t i = 0; i < n && (ele = __list_get_at(l2, pos)); i++) {	// 与自身相加时只复制原有的n个元素
+			__list_append(l1, ele);
 			if (l2->ltype == LinkedList)
-				ex = __linkedlist_search((linkedlist_p)l2->list, 0, Forward, l2->size, ele, l2->cmpfunc);
+				pos.node = pos.node->next;
 			else
-				ex = __arraylist_search((arraylist_p)l2->list, 0, Forward, l2->size, ele, l2->cmpfunc);
-			if (ex != -1) {
-				__list_del_at(l1, &pos);
-			} else {
-				if (l1->ltype == LinkedList)
-					pos.node = pos.node->next;
-				else
-					pos.index++;
-			}
+				pos.index++;
+		}
+		if (l1->sorted) {
+			if (l2->sorted == l1->sorted && l2->cmpfunc == l1->cmpfunc)
+				__list_merge_at(l1, mid, l1->sorted);		// 两部分按相同的顺序有序，直接合并
+			else
+				__list_sort(l1, l1->sorted, SORT_STABLE);
+		}
+		__list_unlock(l1);
+		if (l1 != l2)
+			__list_unlock(l2);
+	}
+}
+
+int list_splice(Container dst, size_t index, Container src)
+{
+	int ret = -1;
+	list_p d, s;
+	if (IS_VALID_LIST(dst) && IS_VALID_LIST(src) && dst != src &&
+			(d = (list_p)dst->container)->etype == (s = (list_p)src->container)->etype) {
+		__list_lock_pair(d, 1, s, 1);
+		size_t mid = d->size;
+		int merge = d->sorted && s->sorted == d->sorted && s->cmpfunc == d->cmpfunc;
+		ret = __list_transfer(d, d->sorted ? mid : index, s);
+		if (ret == 0 && d->sorted && d->size > mid) {
+			if (merge)
+				__list_merge_at(d, mid, d->sorted);
+			else
+				__list_sort(d, d->sorted, SORT_STABLE);
 		}
-		pthread_mutex_unlock(&l1->mut);
-		pthread_mutex_unlock(&l2->mut);
+		__list_unlock(d);
+		__list_unlock(s);
+	}
+	return ret;
+}
+
+int list_merge(Container dst, Container src, int order)
+{
+	int ret = -1;
+	list_p d, s;
+	if (IS_VALID_LIST(dst) && IS_VALID_LIST(src) && dst != src &&
+			(d = (list_p)dst->container)->etype == (s = (list_p)src->container)->etype) {
+		__list_lock_pair(d, 1, s, 1);
+		if (d->sorted)
+			order = d->sorted;
+		size_t mid = d->size;
+		ret = __list_transfer(d, mid, s);
+		if (ret == 0)
+			__list_merge_at(d, mid, order);
+		__list_unlock(d);
+		__list_unlock(s);
+	}
+	return ret;
+}
+
+void list_minus(Container list1, Container list2)
+{
+	list_p l1, l2;
+	if (list1 == list2) {
+		list_removeall(list1);		// 与自身的差为空列表
+	} else if (IS_VALID_LIST(list1) && IS_VALID_LIST(list2) &&
+			(l1 = (list_p)list1->container)->etype == (l2 = (list_p)list2->container)->etype &&
+			l2->size > 0) {
+		__list_lock_pair(l1, 1, l2, 0);
+		list_idx_t idx;
+		__list_idx_build(l2, &idx);
+		__list_filter(l1, &idx, 1);
+		__list_idx_destroy(&idx);
+		__list_unlock(l1);
+		__list_unlock(l2);
 	}
 }
 
 void list_retain(Container list1, Container list2)
 {
 	list_p l1, l2;
-	if (IS_VALID_LIST(list1) && IS_VALID_LIST(list2) &&
+	if (list1 == list2) {
+		return;				// 与自身的交集不变
+	} else if (IS_VALID_LIST(list1) && IS_VALID_LIST(list2) &&
 			(l1 = (list_p)list1->container)->etype == (l2 = (list_p)list2->container)->etype &&
 			l2->size > 0) {
-		pthread_mutex_lock(&l1->mut);
-		pthread_mutex_lock(&l2->mut);
-		list_pos_t pos;
-		if (l1->ltype == LinkedList)
-			pos.node = ((linkedlist_p)l1->list)->head;
-		else
-			pos.index = 0;
-		element_p ele;
-		int ex;
-		while ((ele = __list_get_at(l1, pos))) {
-			if (l2->ltype == LinkedList)
-				ex = __linkedlist_search((linkedlist_p)l2->list, 0, Forward, l2->size, ele, l2->cmpfunc);
-			else
-				ex = __arraylist_search((arraylist_p)l2->list, 0, Forward, l2->size, ele, l2->cmpfunc);
-			if (ex == -1)
-				__list_del_at(l1, &pos);
-			else {
-				if (l1->ltype == LinkedList)
-					pos.node = pos.node->next;
-				else
-					pos.index++;
-			}
-		}
-		pthread_mutex_unlock(&l1->mut);
-		pthread_mutex_unlock(&l2->mut);
+		__list_lock_pair(l1, 1, l2, 0);
+		list_idx_t idx;
+		__list_idx_build(l2, &idx);
+		__list_filter(l1, &idx, 0);
+		__list_idx_destroy(&idx);
+		__list_unlock(l1);
+		__list_unlock(l2);
 	} else {
 		list_removeall(list1);
 	}
@@ -583,15 +1299,23 @@ void list_retain(Container list1, Container list2)
 /**
  * @brief 销毁一个链表节点，包括其中的元素
  *
+ * @param list
+ * 	节点所属的列表
  * @param node
  * 	待销毁的节点
  */
-static void __linkedlist_node_destroy(ll_node_p node)
+static void __linkedlist_node_destroy(list_p list, ll_node_p node)
 {
 	if (!node)
 		return;
-	__element_destroy(node->element);
-	free(node);
+	__element_destroy(list->eslab, node->element);
+	if (list->cached < list->cachemax) {
+		node->next = list->cache;
+		list->cache = node;
+		list->cached++;
+	} else {
+		__slab_free(list->nslab, node);
+	}
 }
 
 /**
@@ -618,54 +1342,108 @@ static void __linkedlist_node_plugout(linkedlist_p ll, ll_node_p node)
  * @brief 清空链表，销毁其中所有节点，回到初始状态
  *
  * @param list
- * 	待清空的链表
+ * 	待清空的列表，须为链表
  */
-static void __linkedlist_removeall(linkedlist_p list)
+static void __linkedlist_removeall(list_p list)
 {
-	ll_node_p node = list->head;
+	linkedlist_p ll = (linkedlist_p)list->list;
+	ll_node_p node = ll->head;
 	while (node) {
 		ll_node_p current = node;
 		node = node->next;
-		__linkedlist_node_destroy(current);
+		__linkedlist_node_destroy(list, current);
 	}
-	list->head = NULL;
-	list->tail = NULL;
+	ll->head = NULL;
+	ll->tail = NULL;
 }
 
 /**
  * @brief 清空线性表，销毁其中所有元素，回到初始状态
  *
  * @param list
- * 	待清空的线性表
- * @param size
- * 	表中元素的数量
+ * 	待清空的列表，须为线性表
+ */
+static void __arraylist_removeall(list_p list)
+{
+	element_p *a = ((arraylist_p)list->list)->elements;
+	for (size_t i = 0; i < list->size; i++)
+		__element_destroy(list->eslab, a[i]);
+}
+
+/**
+ * @brief 清空环形线性表，销毁其中所有元素，回到初始状态
+ *
+ * @param list
+ * 	待清空的列表，须为环形线性表
+ */
+static void __ringlist_removeall(list_p list)
+{
+	ringlist_p rl = (ringlist_p)list->list;
+	for (size_t i = 0; i < list->size; i++)
+		__element_destroy(list->eslab, RL_AT(rl, i));
+	rl->head = 0;
+}
+
+/**
+ * @brief 清空展开链表，销毁其中所有元素和节点，回到初始状态
+ *
+ * @param list
+ * 	待清空的列表，须为展开链表
+ */
+static void __unrolledlist_removeall(list_p list)
+{
+	unrolledlist_p ul = (unrolledlist_p)list->list;
+	ul_node_p node = ul->head;
+	while (node) {
+		ul_node_p current = node;
+		node = node->next;
+		for (size_t i = 0; i < current->count; i++)
+			__element_destroy(list->eslab, current->elements[i]);
+		__slab_free(list->nslab, current);
+	}
+	ul->head = NULL;
+	ul->tail = NULL;
+	ul->finger = NULL;
+	ul->fbase = 0;
+}
+
+/**
+ * @brief 销毁一棵索引树子树，包括其中所有元素
+ *
+ * @param list
+ * 	列表，须为索引树
+ * @param node
+ * 	子树的根节点
  */
-static void __arraylist_removeall(arraylist_p list, size_t size)
+static void __indexedlist_node_destroy(list_p list, il_node_p node)
 {
-	for (size_t i = 0; i < size; i++)
-		__element_destroy(list->elements[i]);
+	if (!node)
+		return;
+	__indexedlist_node_destroy(list, node->left);
+	__indexedlist_node_destroy(list, node->right);
+	__element_destroy(list->eslab, node->element);
+	__slab_free(list->nslab, node);
 }
 
 /**
  * @brief 删除链表中的一个节点
  *
  * @param list
- * 	链表
- * @param size
- * 	链表中元素的数量
+ * 	列表，须为链表
  * @param index
  * 	删除节点的位置
  *
  * @return 
  * 	删除成功的节点数量
  */
-static size_t __linkedlist_remove_at(linkedlist_p ll, size_t size, size_t index)
+static size_t __linkedlist_remove_at(list_p list, size_t index)
 {
-	ll_node_p node = __linkedlist_goto(ll, size, index);
+	linkedlist_p ll = (linkedlist_p)list->list;
+	ll_node_p node = __linkedlist_goto(ll, list->size, index);
 	size_t ret = 0;
 	if (node) {
 		__linkedlist_node_plugout(ll, node);
-		__linkedlist_node_destroy(node);
+		__linkedlist_node_destroy(list, node);
 		ret = 1;
 	}
 	return ret;
@@ -675,47 +1453,164 @@ static size_t __linkedlist_remove_at(linkedlist_p ll, size_t size, size_t index)
  * @brief 删除线性表中的一个元素
  *
  * @param list
- * 	线性表
- * @param size
- * 	线性表中元素的数量
+ * 	列表，须为线性表
  * @param index
  * 	删除元素的位置
  *
  * @return 
  * 	删除成功的元素数量
  */
-static size_t __arraylist_remove_at(arraylist_p al, size_t size, size_t index)
+static size_t __arraylist_remove_at(list_p list, size_t index)
 {
+	arraylist_p al = (arraylist_p)list->list;
 	element_p ele = al->elements[index];
-	for (size_t i = index; i < size - 1; i++)
+	for (size_t i = index; i < list->size - 1; i++)
 		al->elements[i] = al->elements[i + 1];
-	__element_destroy(ele);
+	__element_destroy(list->eslab, ele);
 	return 1;
 }
 
 /**
- * @brief 在链表中删除所有元素等于ele的节点
+ * @brief 删除环形线性表中的一个元素，只移动被删除元素前后两侧中较短一侧的元素
  *
- * @param ll
- * 	链表
+ * @param list
+ * 	列表，须为环形线性表
+ * @param index
+ * 	删除元素的位置
+ *
+ * @return 
+ * 	删除成功的元素数量
+ */
+static size_t __ringlist_remove_at(list_p list, size_t index)
+{
+	ringlist_p rl = (ringlist_p)list->list;
+	element_p ele = RL_AT(rl, index);
+	if (index < list->size / 2) {
+		for (size_t i = index; i > 0; i--)
+			RL_AT(rl, i) = RL_AT(rl, i - 1);
+		rl->head = (rl->head + 1) & (rl->capacity - 1);
+	} else {
+		for (size_t i = index; i < list->size - 1; i++)
+			RL_AT(rl, i) = RL_AT(rl, i + 1);
+	}
+	__element_destroy(list->eslab, ele);
+	return 1;
+}
+
+/**
+ * @brief 从展开链表中取出一个元素，不销毁元素，不修改元素数量
+ * 节点取空后销毁节点，节点中元素少于容量的四分之一时尝试与相邻节点合并，避免节点过于稀疏
+ *
+ * @param list
+ * 	列表，须为展开链表
+ * @param index
+ * 	元素的位置，调用前须确保有效
+ *
+ * @return 
+ * 	取出的元素
+ */
+static element_p __unrolledlist_detach(list_p list, size_t index)
+{
+	unrolledlist_p ul = (unrolledlist_p)list->list;
+	size_t base;
+	ul_node_p node = __unrolledlist_locate(ul, list->size, index, &base);
+	size_t off = index - base;
+	element_p ele = node->elements[off];
+	node->count--;
+	memmove(node->elements + off, node->elements + off + 1, (node->count - off) * sizeof(element_p));
+	if (node->count == 0) {
+		if (node->next) {
+			ul->finger = node->next;
+			ul->fbase = base;
+		} else if (node->prev) {
+			ul->finger = node->prev;
+			ul->fbase = base - node->prev->count;
+		} else {
+			ul->finger = NULL;
+			ul->fbase = 0;
+		}
+		__unrolledlist_node_plugout(list, node);
+		return ele;
+	}
+	if (node->count < UL_NODE_CAPA / 4) {
+		if (node->next && node->count + node->next->count <= UL_NODE_CAPA) {
+			ul_node_p next = node->next;		// 后继节点并入当前节点
+			memcpy(node->elements + node->count, next->elements, next->count * sizeof(element_p));
+			node->count += next->count;
+			__unrolledlist_node_plugout(list, next);
+		} else if (node->prev && node->count + node->prev->count <= UL_NODE_CAPA) {
+			ul_node_p prev = node->prev;		// 当前节点并入前驱节点
+			memcpy(prev->elements + prev->count, node->elements, node->count * sizeof(element_p));
+			base -= prev->count;
+			prev->count += node->count;
+			__unrolledlist_node_plugout(list, node);
+			node = prev;
+		}
+	}
+	ul->finger = node;
+	ul->fbase = base;
+	return ele;
+}
+
+/**
+ * @brief 从索引树子树中取出第index个元素，不销毁元素，不修改元素数量
+ * 待删除节点有两个子节点时，用其中序后继的元素替换它的元素，然后删除后继节点
+ *
+ * @param list
+ * 	列表，须为索引树
+ * @param node
+ * 	子树的根节点
+ * @param index
+ * 	元素在子树中的位置，调用前须确保有效
+ * @param ele
+ * 	返回取出的元素
+ *
+ * @return 
+ * 	删除后子树新的根节点
+ */
+static il_node_p __indexedlist_node_del(list_p list, il_node_p node, size_t index, element_p *ele)
+{
+	size_t ls = IL_SIZE(node->left);
+	if (index < ls) {
+		node->left = __indexedlist_node_del(list, node->left, index, ele);
+	} else if (index > ls) {
+		node->right = __indexedlist_node_del(list, node->right, index - ls - 1, ele);
+	} else {
+		*ele = node->element;
+		if (node->left && node->right) {
+			node->right = __indexedlist_node_del(list, node->right, 0, &node->element);
+		} else {
+			il_node_p child = node->left ? node->left : node->right;
+			__slab_free(list->nslab, node);
+			return child;
+		}
+	}
+	return __indexedlist_balance(node);
+}
+
+/**
+ * @brief 在链表中删除所有元素等于ele的节点，用列表的比较函数判断是否相等
+ *
+ * @param list
+ * 	列表，须为链表
  * @param ele
  * 	元素
- * @param cmpfunc
- * 	比较函数
  *
  * @return 
  * 	删除的节点数量
  */
-static size_t __linkedlist_remove(linkedlist_p ll, element_p ele, CmpFunc cmpfunc)
+static size_t __linkedlist_remove(list_p list, element_p ele)
 {
 	size_t count = 0;
+	linkedlist_p ll = (linkedlist_p)list->list;
+	CmpFunc cmpfunc = list->cmpfunc;
 	ll_node_p node = ll->head;
 	while (node) {
 		if (cmpfunc(node->element->value, ele->value, node->element->len, ele->len) == 0) {
 			__linkedlist_node_plugout(ll, node);
 			ll_node_p n = node;
 			node = node->next;
-			__linkedlist_node_destroy(n);
+			__linkedlist_node_destroy(list, n);
 			count++;
 		} else {
 			node = node->next;
@@ -725,27 +1620,25 @@ static size_t __linkedlist_remove(linkedlist_p ll, element_p ele, CmpFunc cmpfun
 }
 
 /**
- * @brief 在线性表中删除所有等于ele的元素
+ * @brief 在线性表中删除所有等于ele的元素，用列表的比较函数判断是否相等
  *
- * @param al
- * 	线性表
- * @param size
- * 	表中元素数量
+ * @param list
+ * 	列表，须为线性表
  * @param ele
  * 	元素
- * @param cmpfunc
- * 	比较函数
  *
  * @return 
  * 	删除的元素数量
  */
-static size_t __arraylist_remove(arraylist_p al, size_t size, element_p ele, CmpFunc cmpfunc)
+static size_t __arraylist_remove(list_p list, element_p ele)
 {
 	size_t count = 0;
 	size_t pos = 0;
-	while (pos < size) {
+	arraylist_p al = (arraylist_p)list->list;
+	CmpFunc cmpfunc = list->cmpfunc;
+	while (pos < list->size) {
 		if (cmpfunc(al->elements[pos]->value, ele->value, al->elements[pos]->len, ele->len) == 0) {
-			__element_destroy(al->elements[pos]);
+			__element_destroy(list->eslab, al->elements[pos]);
 			count++;
 		} else if (count) {
 			al->elements[pos - count] = al->elements[pos];
@@ -756,57 +1649,192 @@ static size_t __arraylist_remove(arraylist_p al, size_t size, element_p ele, Cmp
 }
 
 /**
- * @brief 线性表底层数组扩容，宏函数AL_NEXT_CAPA用于计算扩容后的容量
+ * @brief 在环形线性表中删除所有等于ele的元素，用列表的比较函数判断是否相等
  *
  * @param list
- * 	现行表
+ * 	列表，须为环形线性表
+ * @param ele
+ * 	元素
  *
  * @return 
- * 	扩容成功返回0，失败返回-1
+ * 	删除的元素数量
  */
-static int __arraylist_expand(arraylist_p list)
+static size_t __ringlist_remove(list_p list, element_p ele)
 {
-	int ret = -1;
-	size_t oc = list->capacity;
-	size_t nc = AL_NEXT_CAPA(oc);
-	element_p *nl = (element_p *)realloc(list->elements, nc * sizeof(element_p));
-	if (nl) {
-		list->elements = nl;
-		list->capacity = nc;
-		ret = 0;
+	size_t count = 0;
+	size_t pos = 0;
+	ringlist_p rl = (ringlist_p)list->list;
+	CmpFunc cmpfunc = list->cmpfunc;
+	while (pos < list->size) {
+		element_p e = RL_AT(rl, pos);
+		if (cmpfunc(e->value, ele->value, e->len, ele->len) == 0) {
+			__element_destroy(list->eslab, e);
+			count++;
+		} else if (count) {
+			RL_AT(rl, pos - count) = e;
+		}
+		pos++;
 	}
-	return ret;
+	return count;
 }
 
 /**
- * @brief 创建一个链表节点
+ * @brief 在展开链表中删除所有等于ele的元素，用列表的比较函数判断是否相等，删空的节点随之销毁
  *
+ * @param list
+ * 	列表，须为展开链表
  * @param ele
- * 	节点中的元素
+ * 	元素
  *
  * @return 
- * 	创建的新节点，创建失败返回NULL
+ * 	删除的元素数量
  */
-static ll_node_p __linkedlist_node_create(element_p ele)
+static size_t __unrolledlist_remove(list_p list, element_p ele)
 {
-	ll_node_p node = (ll_node_p)malloc(sizeof(ll_node_t));
-	if (node) {
-		node->element = ele;
-		node->next = NULL;
-		node->prev = NULL;
+	size_t count = 0;
+	unrolledlist_p ul = (unrolledlist_p)list->list;
+	CmpFunc cmpfunc = list->cmpfunc;
+	ul_node_p node = ul->head;
+	while (node) {
+		size_t keep = 0;
+		for (size_t i = 0; i < node->count; i++) {
+			element_p e = node->elements[i];
+			if (cmpfunc(e->value, ele->value, e->len, ele->len) == 0) {
+				__element_destroy(list->eslab, e);
+				count++;
+			} else {
+				node->elements[keep++] = e;
+			}
+		}
+		node->count = keep;
+		ul_node_p n = node;
+		node = node->next;
+		if (keep == 0)
+			__unrolledlist_node_plugout(list, n);
 	}
-	return node;
+	ul->finger = NULL;
+	ul->fbase = 0;
+	return count;
 }
 
 /**
- * @brief 找到链表中的第pos个节点
+ * @brief 在索引树中删除所有等于ele的元素，用列表的比较函数判断是否相等
  *
- * @param ll
- * 	链表
- * @param size
- * 	链表中元素数量
- * @param pos
- * 	寻找的位置
+ * @param list
+ * 	列表，须为索引树
+ * @param ele
+ * 	元素
+ *
+ * @return 
+ * 	删除的元素数量
+ */
+static size_t __indexedlist_remove(list_p list, element_p ele)
+{
+	size_t count = 0;
+	size_t pos = 0;
+	indexedlist_p il = (indexedlist_p)list->list;
+	CmpFunc cmpfunc = list->cmpfunc;
+	while (pos < list->size - count) {
+		element_p e = __indexedlist_goto(il->root, pos)->element;
+		if (cmpfunc(e->value, ele->value, e->len, ele->len) == 0) {
+			il->root = __indexedlist_node_del(list, il->root, pos, &e);
+			__element_destroy(list->eslab, e);
+			count++;
+		} else {
+			pos++;
+		}
+	}
+	return count;
+}
+
+/**
+ * @brief 线性表底层数组扩容，宏函数AL_NEXT_CAPA用于计算扩容后的容量
+ *
+ * @param list
+ * 	现行表
+ * @param alloc
+ * 	分配器
+ *
+ * @return 
+ * 	扩容成功返回0，失败返回-1
+ */
+static int __arraylist_expand(arraylist_p list, Allocator alloc)
+{
+	int ret = -1;
+	size_t oc = list->capacity;
+	size_t nc = AL_NEXT_CAPA(oc);
+	element_p *nl = (element_p *)__mr_realloc(alloc, list->elements, nc * sizeof(element_p));
+	if (nl) {
+		list->elements = nl;
+		list->capacity = nc;
+		ret = 0;
+	}
+	return ret;
+}
+
+/**
+ * @brief 环形线性表扩容，容量扩大一倍，只在表满时调用
+ * 扩容后把绕回到数组头部的那一段元素复制到原数组尾部之后，使所有元素重新连续
+ *
+ * @param rl
+ * 	环形线性表
+ * @param alloc
+ * 	分配器
+ *
+ * @return 
+ * 	扩容成功返回0，失败返回-1
+ */
+static int __ringlist_expand(ringlist_p rl, Allocator alloc)
+{
+	int ret = -1;
+	size_t oc = rl->capacity;
+	element_p *nl = (element_p *)__mr_realloc(alloc, rl->elements, 2 * oc * sizeof(element_p));
+	if (nl) {
+		memcpy(nl + oc, nl, rl->head * sizeof(element_p));
+		rl->elements = nl;
+		rl->capacity = 2 * oc;
+		ret = 0;
+	}
+	return ret;
+}
+
+/**
+ * @brief 创建一个链表节点
+ *
+ * @param list
+ * 	节点所属的列表
+ * @param ele
+ * 	节点中的元素
+ *
+ * @return 
+ * 	创建的新节点，创建失败返回NULL
+ */
+static ll_node_p __linkedlist_node_create(list_p list, element_p ele)
+{
+	ll_node_p node = list->cache;
+	if (node) {
+		list->cache = node->next;
+		list->cached--;
+	} else {
+		node = (ll_node_p)__slab_alloc(list->nslab, sizeof(ll_node_t));
+	}
+	if (node) {
+		node->element = ele;
+		node->next = NULL;
+		node->prev = NULL;
+	}
+	return node;
+}
+
+/**
+ * @brief 找到链表中的第pos个节点
+ *
+ * @param ll
+ * 	链表
+ * @param size
+ * 	链表中元素数量
+ * @param pos
+ * 	寻找的位置
  *
  * @return 
  * 	第pos个节点，pos超出范围返回NULL
@@ -838,10 +1866,8 @@ static ll_node_p __linkedlist_goto(linkedlist_p ll, size_t size, size_t pos)
 /**
  * @brief 在链表的第pos个位置插入新元素ele
  *
- * @param ll
- * 	链表
- * @para size
- * 	插入前链表中元素数量
+ * @param list
+ * 	列表，须为链表
  * @param index
  * 	插入位置，超过表尾的添加在尾部
  * @param ele
@@ -850,11 +1876,12 @@ static ll_node_p __linkedlist_goto(linkedlist_p ll, size_t size, size_t pos)
  * @return 
  * 	插入成功返回0，失败返回-1
  */
-static int __linkedlist_ins(linkedlist_p ll, size_t size, size_t index, element_p ele)
+static int __linkedlist_ins(list_p list, size_t index, element_p ele)
 {
-	ll_node_p node = __linkedlist_node_create(ele);
+	linkedlist_p ll = (linkedlist_p)list->list;
+	ll_node_p node = __linkedlist_node_create(list, ele);
 	if (node) {
-		ll_node_p pos = __linkedlist_goto(ll, size, index);
+		ll_node_p pos = __linkedlist_goto(ll, list->size, index);
 		if (pos) {
 			// 在位置pos处插入node
 			node->next = pos;
@@ -892,15 +1919,19 @@ static int __linkedlist_ins(linkedlist_p ll, size_t size, size_t index, element_
  * 	插入位置，超过表尾的添加在尾部
  * @param ele
  * 	新的元素
+ * @param alloc
+ * 	扩容时所用的分配器
  *
  * @return 
  * 	插入成功返回0，失败返回-1
  */
-static int __arraylist_ins(arraylist_p al, size_t size, size_t index, element_p ele)
+static int __arraylist_ins(arraylist_p al, size_t size, size_t index, element_p ele, Allocator alloc)
 {
 	int ret = -1;
-	if (size <  al->capacity || __arraylist_expand(al) == 0) {
+	if (size <  al->capacity || __arraylist_expand(al, alloc) == 0) {
 		size_t i;
+		if (index > size)
+			index = size;
 		for (i = size; i > index; i--)
 			al->elements[i] = al->elements[i - 1];
 		al->elements[index] = ele;
@@ -909,6 +1940,343 @@ static int __arraylist_ins(arraylist_p al, size_t size, size_t index, element_p
 	return ret;
 }
 
+/**
+ * @brief 在环形线性表的第index个位置插入新元素ele，只移动插入位置前后两侧中较短一侧的元素，在两端插入时不移动任何元素
+ *
+ * @param list
+ * 	列表，须为环形线性表
+ * @param index
+ * 	插入位置，超过表尾的添加在尾部
+ * @param ele
+ * 	新的元素
+ *
+ * @return 
+ * 	插入成功返回0，失败返回-1
+ */
+static int __ringlist_ins(list_p list, size_t index, element_p ele)
+{
+	ringlist_p rl = (ringlist_p)list->list;
+	if (list->size == rl->capacity && __ringlist_expand(rl, &list->alloc) != 0)
+		return -1;
+	if (index > list->size)
+		index = list->size;
+	if (index < list->size / 2) {
+		rl->head = (rl->head - 1) & (rl->capacity - 1);
+		for (size_t i = 0; i < index; i++)
+			RL_AT(rl, i) = RL_AT(rl, i + 1);
+	} else {
+		for (size_t i = list->size; i > index; i--)
+			RL_AT(rl, i) = RL_AT(rl, i - 1);
+	}
+	RL_AT(rl, index) = ele;
+	return 0;
+}
+
+/**
+ * @brief 创建一个空的展开链表节点
+ *
+ * @param list
+ * 	节点所属的列表
+ *
+ * @return 
+ * 	创建的新节点，创建失败返回NULL
+ */
+static ul_node_p __unrolledlist_node_create(list_p list)
+{
+	ul_node_p node = (ul_node_p)__slab_alloc(list->nslab, sizeof(ul_node_t));
+	if (node) {
+		node->next = NULL;
+		node->prev = NULL;
+		node->count = 0;
+	}
+	return node;
+}
+
+/**
+ * @brief 把一个节点从展开链表中抽离出来并销毁，不销毁节点中的元素，调用者须处理finger
+ *
+ * @param list
+ * 	列表，须为展开链表
+ * @param node
+ * 	待抽离的节点
+ */
+static void __unrolledlist_node_plugout(list_p list, ul_node_p node)
+{
+	unrolledlist_p ul = (unrolledlist_p)list->list;
+	if (node->next)
+		node->next->prev = node->prev;
+	else
+		ul->tail = node->prev;
+	if (node->prev)
+		node->prev->next = node->next;
+	else
+		ul->head = node->next;
+	__slab_free(list->nslab, node);
+}
+
+/**
+ * @brief 找到展开链表中第index个元素所在的节点，从头、尾和finger三者中离目标最近的一处开始查找，并把finger移到找到的节点
+ * index等于size时返回尾节点，用于在表尾添加元素
+ *
+ * @param ul
+ * 	展开链表，不能为空表
+ * @param size
+ * 	元素数量
+ * @param index
+ * 	元素位置
+ * @param base
+ * 	返回找到的节点中第一个元素的位置
+ *
+ * @return 
+ * 	找到的节点
+ */
+static ul_node_p __unrolledlist_locate(unrolledlist_p ul, size_t size, size_t index, size_t *base)
+{
+	ul_node_p node;
+	size_t b;
+	size_t dist = index < size - index ? index : size - index;
+	if (ul->finger && (index >= ul->fbase ? index - ul->fbase : ul->fbase - index) < dist) {
+		node = ul->finger;
+		b = ul->fbase;
+	} else if (index < size - index) {
+		node = ul->head;
+		b = 0;
+	} else {
+		node = ul->tail;
+		b = size - ul->tail->count;
+	}
+	while (index >= b + node->count && node->next) {
+		b += node->count;
+		node = node->next;
+	}
+	while (index < b) {
+		node = node->prev;
+		b -= node->count;
+	}
+	ul->finger = node;
+	ul->fbase = b;
+	*base = b;
+	return node;
+}
+
+/**
+ * @brief 在展开链表的index位置插入一个新元素，目标节点已满时分裂为两个半满的节点，在表尾或节点末尾插入时直接新建后继节点
+ *
+ * @param list
+ * 	列表，须为展开链表
+ * @param index
+ * 	插入位置，超过表尾的添加在尾部
+ * @param ele
+ * 	新的元素
+ *
+ * @return 
+ * 	插入成功返回0，失败返回-1
+ */
+static int __unrolledlist_ins(list_p list, size_t index, element_p ele)
+{
+	unrolledlist_p ul = (unrolledlist_p)list->list;
+	ul_node_p node;
+	size_t base;
+	if (index > list->size)
+		index = list->size;
+	if (ul->head) {
+		node = __unrolledlist_locate(ul, list->size, index, &base);
+	} else {
+		node = __unrolledlist_node_create(list);
+		if (!node)
+			return -1;
+		ul->head = node;
+		ul->tail = node;
+		base = 0;
+	}
+	size_t off = index - base;
+	if (node->count == UL_NODE_CAPA) {
+		ul_node_p n = __unrolledlist_node_create(list);
+		if (!n)
+			return -1;
+		n->prev = node;
+		n->next = node->next;
+		if (node->next)
+			node->next->prev = n;
+		else
+			ul->tail = n;
+		node->next = n;
+		if (off < UL_NODE_CAPA) {
+			memcpy(n->elements, node->elements + UL_NODE_CAPA / 2, (UL_NODE_CAPA - UL_NODE_CAPA / 2) * sizeof(element_p));
+			n->count = UL_NODE_CAPA - UL_NODE_CAPA / 2;
+			node->count = UL_NODE_CAPA / 2;
+		}
+		if (off >= node->count) {
+			base += node->count;
+			off -= node->count;
+			node = n;
+		}
+	}
+	memmove(node->elements + off + 1, node->elements + off, (node->count - off) * sizeof(element_p));
+	node->elements[off] = ele;
+	node->count++;
+	ul->finger = node;
+	ul->fbase = base;
+	return 0;
+}
+
+/**
+ * @brief 根据两个子节点重新计算节点的子树大小和高度
+ *
+ * @param node
+ * 	节点
+ */
+static void __indexedlist_node_update(il_node_p node)
+{
+	int lh = IL_HEIGHT(node->left);
+	int rh = IL_HEIGHT(node->right);
+	node->size = IL_SIZE(node->left) + IL_SIZE(node->right) + 1;
+	node->height = (lh > rh ? lh : rh) + 1;
+}
+
+/**
+ * @brief 索引树左旋
+ *
+ * @param node
+ * 	旋转的节点
+ *
+ * @return 
+ * 	旋转后子树新的根节点
+ */
+static il_node_p __indexedlist_rotate_left(il_node_p node)
+{
+	il_node_p r = node->right;
+	node->right = r->left;
+	r->left = node;
+	__indexedlist_node_update(node);
+	__indexedlist_node_update(r);
+	return r;
+}
+
+/**
+ * @brief 索引树右旋
+ *
+ * @param node
+ * 	旋转的节点
+ *
+ * @return 
+ * 	旋转后子树新的根节点
+ */
+static il_node_p __indexedlist_rotate_right(il_node_p node)
+{
+	il_node_p l = node->left;
+	node->left = l->right;
+	l->right = node;
+	__indexedlist_node_update(node);
+	__indexedlist_node_update(l);
+	return l;
+}
+
+/**
+ * @brief 更新节点并在左右子树高度差超过1时旋转恢复平衡
+ *
+ * @param node
+ * 	节点
+ *
+ * @return 
+ * 	平衡后子树新的根节点
+ */
+static il_node_p __indexedlist_balance(il_node_p node)
+{
+	__indexedlist_node_update(node);
+	int bf = IL_HEIGHT(node->left) - IL_HEIGHT(node->right);
+	if (bf > 1) {
+		if (IL_HEIGHT(node->left->left) < IL_HEIGHT(node->left->right))
+			node->left = __indexedlist_rotate_left(node->left);		// LR型先把左子树左旋
+		return __indexedlist_rotate_right(node);
+	} else if (bf < -1) {
+		if (IL_HEIGHT(node->right->right) < IL_HEIGHT(node->right->left))
+			node->right = __indexedlist_rotate_right(node->right);		// RL型先把右子树右旋
+		return __indexedlist_rotate_left(node);
+	}
+	return node;
+}
+
+/**
+ * @brief 找到索引树中第index个节点
+ *
+ * @param root
+ * 	根节点
+ * @param index
+ * 	位置，调用前须确保有效
+ *
+ * @return 
+ * 	第index个节点
+ */
+static il_node_p __indexedlist_goto(il_node_p root, size_t index)
+{
+	il_node_p node = root;
+	size_t ls;
+	while ((ls = IL_SIZE(node->left)) != index) {
+		if (index < ls) {
+			node = node->left;
+		} else {
+			index -= ls + 1;
+			node = node->right;
+		}
+	}
+	return node;
+}
+
+/**
+ * @brief 把节点插入到索引树子树的第index个位置
+ *
+ * @param node
+ * 	子树的根节点
+ * @param index
+ * 	插入位置，不超过子树的元素数量
+ * @param n
+ * 	新节点
+ *
+ * @return 
+ * 	插入后子树新的根节点
+ */
+static il_node_p __indexedlist_node_ins(il_node_p node, size_t index, il_node_p n)
+{
+	if (!node)
+		return n;
+	size_t ls = IL_SIZE(node->left);
+	if (index <= ls)
+		node->left = __indexedlist_node_ins(node->left, index, n);
+	else
+		node->right = __indexedlist_node_ins(node->right, index - ls - 1, n);
+	return __indexedlist_balance(node);
+}
+
+/**
+ * @brief 在索引树的index位置插入一个新元素
+ *
+ * @param list
+ * 	列表，须为索引树
+ * @param index
+ * 	插入位置，超过表尾的添加在尾部
+ * @param ele
+ * 	新的元素
+ *
+ * @return 
+ * 	插入成功返回0，失败返回-1
+ */
+static int __indexedlist_ins(list_p list, size_t index, element_p ele)
+{
+	il_node_p n = (il_node_p)__slab_alloc(list->nslab, sizeof(il_node_t));
+	if (!n)
+		return -1;
+	n->left = NULL;
+	n->right = NULL;
+	n->size = 1;
+	n->height = 1;
+	n->element = ele;
+	if (index > list->size)
+		index = list->size;
+	((indexedlist_p)list->list)->root = __indexedlist_node_ins(((indexedlist_p)list->list)->root, index, n);
+	return 0;
+}
+
 /**
  * @brief 链表搜索
  *
@@ -974,47 +2342,188 @@ static int __arraylist_search(arraylist_p al, size_t from, int dir, size_t size,
 }
 
 /**
- * @brief 对链表进行快速排序
+ * @brief 环形线性表搜索
  *
- * @param left
- * 	左节点
- * @param right
- * 	右节点
- * @param order
- * 	排序顺序
- * @param cmpfunc
- * 	比较函数
- */
-static void __linkedlist_quicksort(ll_node_p left, ll_node_p right, int order, CmpFunc cmpfunc)
-{
-	if (left == right)
-		return;
-	ll_node_p i = left;
-	ll_node_p j = right;
-	element_p key = left->element;
-	while (i != j) {
-		while (i != j && (order * cmpfunc(key->value, j->element->value, key->len, j->element->len)) <= 0)
-			j = j->prev;
-		if (i != j) {
-			i->element = j->element;
-			i = i->next;
-		}
-		while (i != j && (order * cmpfunc(key->value, i->element->value, key->len, i->element->len)) >= 0)
-			i = i->next;
-		if (i != j) {
-			j->element = i->element;
-			j = j->prev;
+ * @param rl
+ * 	环形线性表
+ * @param from
+ * 	搜索开始位置
+ * @param dir
+ * 	搜索的方向
+ * @param size
+ * 	环形线性表中元素数量
+ * @param ele
+ * 	搜索的元素
+ * @param cmpfunc
+ * 	元素比较函数
+ *
+ * @return 
+ * 	搜索到的位置，搜索不到返回-1
+ */
+static int __ringlist_search(ringlist_p rl, size_t from, int dir, size_t size, element_p ele, CmpFunc cmpfunc)
+{
+	int pos = from;
+	while (pos >= 0 && pos < size && cmpfunc(RL_AT(rl, pos)->value, ele->value, RL_AT(rl, pos)->len, ele->len))
+		if (dir == Reverse)
+			pos--;
+		else
+			pos++;
+	return IN(pos, 0, size - 1) ? pos : -1;
+}
+
+/**
+ * @brief 展开链表搜索，在节点内部按数组顺序比较
+ *
+ * @param ul
+ * 	展开链表
+ * @param from
+ * 	搜索开始位置
+ * @param dir
+ * 	搜索的方向
+ * @param size
+ * 	展开链表中元素数量
+ * @param ele
+ * 	搜索的元素
+ * @param cmpfunc
+ * 	元素比较函数
+ *
+ * @return 
+ * 	搜索到的位置，搜索不到返回-1
+ */
+static int __unrolledlist_search(unrolledlist_p ul, size_t from, int dir, size_t size, element_p ele, CmpFunc cmpfunc)
+{
+	if (size == 0)
+		return -1;
+	size_t base;
+	ul_node_p node = __unrolledlist_locate(ul, size, from, &base);
+	size_t off = from - base;
+	while (node) {
+		element_p *a = node->elements;
+		if (dir == Reverse) {
+			for (size_t i = off + 1; i-- > 0; )
+				if (cmpfunc(a[i]->value, ele->value, a[i]->len, ele->len) == 0)
+					return base + i;
+			node = node->prev;
+			if (node) {
+				base -= node->count;
+				off = node->count - 1;
+			}
+		} else {
+			for (size_t i = off; i < node->count; i++)
+				if (cmpfunc(a[i]->value, ele->value, a[i]->len, ele->len) == 0)
+					return base + i;
+			base += node->count;
+			off = 0;
+			node = node->next;
+		}
+	}
+	return -1;
+}
+
+/**
+ * @brief 索引树搜索，按中序遍历，整个位于搜索起点另一侧的子树直接跳过
+ *
+ * @param node
+ * 	子树的根节点
+ * @param base
+ * 	子树中第一个元素在列表中的位置
+ * @param from
+ * 	搜索开始位置
+ * @param dir
+ * 	搜索的方向
+ * @param ele
+ * 	搜索的元素
+ * @param cmpfunc
+ * 	元素比较函数
+ *
+ * @return 
+ * 	搜索到的位置，搜索不到返回-1
+ */
+static int __indexedlist_search(il_node_p node, size_t base, size_t from, int dir, element_p ele, CmpFunc cmpfunc)
+{
+	if (!node)
+		return -1;
+	int ret;
+	size_t pos = base + IL_SIZE(node->left);
+	element_p e = node->element;
+	if (dir == Reverse) {
+		if (pos < from && (ret = __indexedlist_search(node->right, pos + 1, from, dir, ele, cmpfunc)) != -1)
+			return ret;
+		if (pos <= from && cmpfunc(e->value, ele->value, e->len, ele->len) == 0)
+			return pos;
+		return __indexedlist_search(node->left, base, from, dir, ele, cmpfunc);
+	} else {
+		if (pos > from && (ret = __indexedlist_search(node->left, base, from, dir, ele, cmpfunc)) != -1)
+			return ret;
+		if (pos >= from && cmpfunc(e->value, ele->value, e->len, ele->len) == 0)
+			return pos;
+		return __indexedlist_search(node->right, pos + 1, from, dir, ele, cmpfunc);
+	}
+}
+
+/**
+ * @brief 对链表进行自底向上的归并排序，直接重新链接节点而不交换元素，不分配内存，是稳定的排序算法
+ * 每一轮把相邻的两段长度为insize的有序段合并，合并时只维护后继指针，全部完成后再恢复前驱指针和尾指针
+ *
+ * @param ll
+ * 	链表
+ * @param order
+ * 	排序顺序
+ * @param cmpfunc
+ * 	比较函数
+ */
+static void __linkedlist_mergesort(linkedlist_p ll, int order, CmpFunc cmpfunc)
+{
+	ll_node_p head = ll->head;
+	size_t insize = 1;
+	size_t nmerges;
+	do {
+		ll_node_p p = head;
+		ll_node_p tail = NULL;
+		head = NULL;
+		nmerges = 0;
+		while (p) {
+			nmerges++;
+			ll_node_p q = p;
+			size_t psize = 0;
+			while (psize < insize && q) {
+				psize++;
+				q = q->next;
+			}
+			size_t qsize = insize;
+			while (psize > 0 || (qsize > 0 && q)) {
+				ll_node_p e;
+				if (psize > 0 && (qsize == 0 || !q || ORDER_CMP(p->element, q->element) <= 0)) {
+					e = p;				// 相等时取左段的节点，保证稳定
+					p = p->next;
+					psize--;
+				} else {
+					e = q;
+					q = q->next;
+					qsize--;
+				}
+				if (tail)
+					tail->next = e;
+				else
+					head = e;
+				tail = e;
+			}
+			p = q;
 		}
+		tail->next = NULL;
+		insize *= 2;
+	} while (nmerges > 1);
+	ll_node_p prev = NULL;
+	for (ll_node_p node = head; node; node = node->next) {
+		node->prev = prev;
+		prev = node;
 	}
-	i->element = key;
-	if (left != i)
-		__linkedlist_quicksort(left, i->prev, order, cmpfunc);
-	if (right != i)
-		__linkedlist_quicksort(i->next, right, order, cmpfunc);
+	ll->head = head;
+	ll->tail = prev;
 }
 
 /**
- * @brief 对线性表进行快速排序
+ * @brief 对线性表进行快速排序，采用内省排序，递归深度超过2log(n)时改用堆排序，保证最坏情况下的时间为O(n log n)
  *
  * @param a
  * 	元素数组
@@ -1029,24 +2538,111 @@ static void __linkedlist_quicksort(ll_node_p left, ll_node_p right, int order, C
  */
 static void __arraylist_quicksort(element_p *a, int left, int right, int order, CmpFunc cmpfunc)
 {
-	if(left >= right)
+	if (left >= right)
 		return;
-	int i = left;
-	int j = right;
-	element_p key = a[left];
-	while (i < j) {
-		while (i < j && (order * cmpfunc(key->value, a[j]->value, key->len, a[j]->len)) <= 0)
-			j--;
-		if (i < j)
-			a[i++] = a[j];
-		while (i < j && (order * cmpfunc(key->value, a[i]->value, key->len, a[i]->len)) >= 0)
-			i++;
-		if (i < j)
-			a[j--] = a[i];
+	__arraylist_introsort(a, left, right, 2 * lg2(right - left + 1), order, cmpfunc);
+}
+
+/**
+ * @brief 内省排序，以三数取中为枢轴进行快速排序，只对较短的一侧递归，较长的一侧在循环中继续划分
+ * 元素不超过SORT_SMALL个的区间用插入排序，可用的划分次数depth耗尽后剩余区间用堆排序
+ *
+ * @param a
+ * 	元素数组
+ * @param left
+ * 	左位置
+ * @param right
+ * 	右位置
+ * @param depth
+ * 	剩余可用的划分次数
+ * @param order
+ * 	排序顺序
+ * @param cmpfunc
+ * 	比较函数
+ */
+static void __arraylist_introsort(element_p *a, int left, int right, int depth, int order, CmpFunc cmpfunc)
+{
+	element_p temp;
+	while (right - left >= SORT_SMALL) {
+		if (depth-- == 0) {
+			__arraylist_heapsort(a, left, right, order, cmpfunc);
+			return;
+		}
+		int mid = left + (right - left) / 2;
+		if (ORDER_CMP(a[mid], a[left]) < 0) {		// 三数取中，排序后a[left] <= a[mid] <= a[right]，两端即为划分的哨兵
+			temp = a[mid]; a[mid] = a[left]; a[left] = temp;
+		}
+		if (ORDER_CMP(a[right], a[mid]) < 0) {
+			temp = a[mid]; a[mid] = a[right]; a[right] = temp;
+			if (ORDER_CMP(a[mid], a[left]) < 0) {
+				temp = a[mid]; a[mid] = a[left]; a[left] = temp;
+			}
+		}
+		element_p pivot = a[mid];
+		int i = left;
+		int j = right;
+		for (;;) {
+			do
+				i++;
+			while (ORDER_CMP(a[i], pivot) < 0);
+			do
+				j--;
+			while (ORDER_CMP(pivot, a[j]) < 0);
+			if (i >= j)
+				break;
+			temp = a[i]; a[i] = a[j]; a[j] = temp;
+		}
+		if (j - left < right - j) {			// 划分结果为[left, j]和[j + 1, right]
+			__arraylist_introsort(a, left, j, depth, order, cmpfunc);
+			left = j + 1;
+		} else {
+			__arraylist_introsort(a, j + 1, right, depth, order, cmpfunc);
+			right = j;
+		}
+	}
+	__arraylist_insertsort(a, left, right, order, cmpfunc);
+}
+
+/**
+ * @brief 对线性表的一段进行堆排序
+ *
+ * @param a
+ * 	元素数组
+ * @param left
+ * 	左位置
+ * @param right
+ * 	右位置
+ * @param order
+ * 	排序顺序
+ * @param cmpfunc
+ * 	比较函数
+ */
+static void __arraylist_heapsort(element_p *a, int left, int right, int order, CmpFunc cmpfunc)
+{
+	element_p *h = a + left;
+	int n = right - left + 1;
+	for (int k = n / 2 - 1, end = n; end > 1; ) {
+		int root;
+		if (k >= 0) {					// 建堆阶段，从最后一个非叶节点开始逐个下沉
+			root = k--;
+		} else {					// 排序阶段，堆顶与堆尾交换后下沉新的堆顶
+			element_p temp = h[0];
+			h[0] = h[--end];
+			h[end] = temp;
+			root = 0;
+		}
+		element_p e = h[root];
+		int child;
+		while ((child = 2 * root + 1) < end) {
+			if (child + 1 < end && ORDER_CMP(h[child], h[child + 1]) < 0)
+				child++;
+			if (ORDER_CMP(e, h[child]) >= 0)
+				break;
+			h[root] = h[child];
+			root = child;
+		}
+		h[root] = e;
 	}
-	a[i] = key;
-	__arraylist_quicksort(a, left, i - 1, order, cmpfunc);
-	__arraylist_quicksort(a, i + 1, right, order, cmpfunc);
 }
 
 /**
@@ -1106,121 +2702,890 @@ static void __arraylist_insertsort(element_p *a, int left, int right, int order,
 }
 
 /**
- * @brief 对链表进行二分搜索
+ * @brief 合并数组中相邻的两段有序序列[lo, mid)和[mid, hi)，把较短的一段复制到缓冲区后从相应的一端开始合并，相等时左段的元素在前
  *
- * @param e
- * 	搜索的元素
- * @param size
- * 	链表中的节点数量
+ * @param a
+ * 	元素数组
+ * @param lo
+ * 	左段的起始位置
+ * @param mid
+ * 	右段的起始位置
+ * @param hi
+ * 	右段的结束位置（不含）
+ * @param buf
+ * 	缓冲区，容量不小于较短一段的长度
  * @param order
- * 	表中元素的排列顺序
- * @param left
- * 	左节点
- * @param right
- * 	右节点
+ * 	排序顺序
  * @param cmpfunc
  * 	比较函数
- *
- * @return 
- * 	找到的元素的位置，找不到返回-1
  */
-static int __linkedlist_bisearch(element_p e, size_t size, int order, ll_node_p left, ll_node_p right, CmpFunc cmpfunc)
+static void __arraylist_merge(element_p *a, size_t lo, size_t mid, size_t hi, element_p *buf, int order, CmpFunc cmpfunc)
 {
-	int s = size;					// 每一轮搜索范围的节点数量
-	ll_node_p m = left;				// 每一轮搜索范围的比较节点
-	ll_node_p l = left;				// 每一轮搜索范围的左节点
-	ll_node_p r = right;				// 每一轮搜索范围的右节点
-	int pos = 0;					// 比较节点的位置
-	int step, cmp, i;				// 跳数，比较结果，循环变量
-	do {						// 每一轮循环都在一定的范围内找到中间节点并进行比较，循环开始时比较节点置于左端，循环中进行跳转
-		step = (s - 1) / 2;			// 计算到中间节点的跳跃数
-		for (i = 0; i < step; i++)
-			m = m->next;			// 比较节点跳跃到中间节点
-		pos += step;				// 比较节点节点的位置调整为中间节点的位置
-		cmp = order * cmpfunc(e->value, m->element->value, e->len, m->element->len);
-		if (cmp == 0)				// 中间节点就是要搜索的节点，直接返回中间节点的位置
-			return pos;
-		else if (cmp > 0) {			// 要搜索的元素大于中间节点的元素，在右半表(m->next, r)中继续循环
-			l = m->next;			// 右半表的左节点是当前节点的后继
-			m = l;				// 当前节点修正为右半表的左节点
-			pos++;				// 修正当前节点的位置
-			s = s - step - 1;		// 右半表的元素数量
-		} else {				// 要搜索的元素小于中间节点的元素，在左半表(l, m->prev)中继续循环
-			r = m->prev;			// 左半表的右节点等于当前节点的前驱
-			m = l;				// 当前节点回归到左节点
-			pos -= step;			// 修正当前节点的位置
-			s = step;			// 左半表的元素数量
-		}
-	} while (s > 0);				// 下一轮循环已经没有元素的时候循环结束，元素没有找到
-	return -1;
+	if (ORDER_CMP(a[mid - 1], a[mid]) <= 0)
+		return;						// 两段已经有序
+	if (mid - lo <= hi - mid) {
+		size_t n = mid - lo;
+		size_t i = 0, j = mid, k = lo;
+		memcpy(buf, a + lo, n * sizeof(element_p));
+		while (i < n && j < hi)
+			a[k++] = ORDER_CMP(a[j], buf[i]) < 0 ? a[j++] : buf[i++];
+		memcpy(a + k, buf + i, (n - i) * sizeof(element_p));
+	} else {
+		size_t n = hi - mid;
+		size_t i = mid, j = n, k = hi;
+		memcpy(buf, a + mid, n * sizeof(element_p));
+		while (j > 0 && i > lo)
+			a[--k] = ORDER_CMP(buf[j - 1], a[i - 1]) < 0 ? a[--i] : buf[--j];
+		memcpy(a + lo, buf, j * sizeof(element_p));
+	}
 }
 
 /**
- * @brief 对线性表进行二分搜索
+ * @brief 对线性表进行稳定排序，采用简化的Timsort：先识别已有的升序段和严格降序段（反转为升序），不足minrun的段用插入排序补齐，
+ * 然后按Timsort的栈规则合并相邻的段，对已经有序或基本有序的数据接近O(n)，最坏情况为O(n log n)
+ * 没有提供缓冲区时临时分配，分配失败时退化为插入排序
  *
- * @param e
- * 	搜索的元素
  * @param a
  * 	元素数组
+ * @param size
+ * 	元素数量
+ * @param buf
+ * 	合并使用的缓冲区，容量不小于size / 2 + 1，为NULL时临时分配
  * @param order
- * 	表中元素的排列顺序
- * @param left
- * 	左位置
- * @param right
- * 	右位置
+ * 	排序顺序
  * @param cmpfunc
  * 	比较函数
+ * @param alloc
+ * 	临时分配缓冲区使用的分配器
+ */
+static void __arraylist_stablesort(element_p *a, size_t size, element_p *buf, int order, CmpFunc cmpfunc, Allocator alloc)
+{
+	size_t minrun = size;
+	size_t r = 0;
+	while (minrun >= 64) {
+		r |= minrun & 1;
+		minrun >>= 1;
+	}
+	minrun += r;
+	if (size <= minrun) {
+		__arraylist_insertsort(a, 0, size - 1, order, cmpfunc);
+		return;
+	}
+	element_p *tmp = buf ? NULL : (element_p *)__mr_malloc(alloc, (size / 2 + 1) * sizeof(element_p));
+	if (!buf && !(buf = tmp)) {
+		__arraylist_insertsort(a, 0, size - 1, order, cmpfunc);
+		return;
+	}
+	size_t base[SORT_MAX_RUNS];					// 待合并的段的起始位置和长度
+	size_t len[SORT_MAX_RUNS];
+	int n = 0;
+	size_t lo = 0;
+	while (lo < size) {
+		size_t hi = lo + 1;
+		if (hi < size) {
+			if (ORDER_CMP(a[hi], a[lo]) < 0) {
+				while (hi < size && ORDER_CMP(a[hi], a[hi - 1]) < 0)
+					hi++;
+				__arraylist_reverse(a + lo, hi - lo);
+			} else {
+				while (hi < size && ORDER_CMP(a[hi], a[hi - 1]) >= 0)
+					hi++;
+			}
+		}
+		if (hi - lo < minrun) {
+			hi = lo + minrun < size ? lo + minrun : size;
+			__arraylist_insertsort(a, lo, hi - 1, order, cmpfunc);
+		}
+		base[n] = lo;
+		len[n++] = hi - lo;
+		lo = hi;
+		while (n > 1) {						// 保持len[n - 3] > len[n - 2] + len[n - 1]且len[n - 2] > len[n - 1]
+			int m = n - 2;
+			if ((m > 0 && len[m - 1] <= len[m] + len[m + 1]) || (m > 1 && len[m - 2] <= len[m - 1] + len[m])) {
+				if (len[m - 1] < len[m + 1])
+					m--;
+			} else if (len[m] > len[m + 1]) {
+				break;
+			}
+			__arraylist_merge(a, base[m], base[m + 1], base[m + 1] + len[m + 1], buf, order, cmpfunc);
+			len[m] += len[m + 1];
+			for (int k = m + 1; k < n - 1; k++) {
+				base[k] = base[k + 1];
+				len[k] = len[k + 1];
+			}
+			n--;
+		}
+	}
+	while (n > 1) {
+		__arraylist_merge(a, base[n - 2], base[n - 1], base[n - 1] + len[n - 1], buf, order, cmpfunc);
+		len[n - 2] += len[n - 1];
+		n--;
+	}
+	if (tmp)
+		__mr_free(alloc, tmp);
+}
+
+/**
+ * @brief 按指定的排序方法对列表的元素数组排序
  *
- * @return 
- * 	找到的元素的位置，找不到返回-1
+ * @param list
+ * 	列表，提供比较函数和分配器
+ * @param a
+ * 	元素数组，长度为列表的元素数量
+ * @param order
+ * 	排序顺序
+ * @param method
+ * 	排序方法，SORT_QUICK、SORT_INSERT、SORT_STABLE或SORT_RADIX，除插入排序外元素较多且使用默认比较函数时都优先使用基数排序
  */
-static int __arraylist_bisearch(element_p e, element_p *a, int order, int left, int right, CmpFunc cmpfunc)
+static void __arraylist_sort(list_p list, element_p *a, int order, int method)
 {
-	if (left > right)
-		return -1;
-	int mid = (left + right) / 2;
-	int cmp = order * cmpfunc(e->value, a[mid]->value, e->len, a[mid]->len);
-	if (cmp == 0)
-		return mid;
-	else if (cmp > 0)
-		return __arraylist_bisearch(e, a, order, mid + 1, right, cmpfunc);
+	if (method != SORT_INSERT && (method == SORT_RADIX || list->size >= SORT_RADIX_MIN) && __arraylist_radixsort(list, a, list->size, order) == 0)
+		return;
+	if (method == SORT_STABLE || method == SORT_RADIX)
+		__arraylist_stablesort(a, list->size, NULL, order, list->cmpfunc, &list->alloc);
+	else if (method == SORT_INSERT)
+		__arraylist_insertsort(a, 0, list->size - 1, order, list->cmpfunc);
 	else
-		return __arraylist_bisearch(e, a, order, left, mid - 1, cmpfunc);
+		__arraylist_quicksort(a, 0, list->size - 1, order, list->cmpfunc);
 }
 
 /**
- * @brief 反向排列链表
+ * @brief 计算元素的基数排序键，整数翻转符号位，实数为正时翻转符号位、为负时翻转全部位，0和-0使用同一个键，降序时再把键整体取反
  *
- * @param head
- * 	头节点
- * @param tail
- * 	尾节点
+ * @param e
+ * 	元素，不能为NULL元素
+ * @param type
+ * 	元素类型，整数或实数
+ * @param order
+ * 	排序顺序
+ * @param item
+ * 	保存排序键的排序项
  */
-static void __linkedlist_reverse(ll_node_p head, ll_node_p tail)
+static void __radix_key(element_p e, ElementType type, int order, radix_item_p item)
 {
-	ll_node_p left = head;
-	ll_node_p right = tail;
-	element_p temp = NULL;
-	while (left != right && left->prev != right) {
-		temp = left->element;
-		left->element = right->element;
-		right->element = temp;
-		left = left->next;
-		right = right->prev;
+	item->element = e;
+	item->ext = 0;
+	if (type == integer) {
+		item->key = (unsigned long long)*(Integer *)e->value ^ (1ULL << 63);
+	} else {
+#if RADIX_REAL_EXT >= 0
+		Real v = *(Real *)e->value;
+		if (v == 0)
+			v = 0;
+#if RADIX_REAL_EXT > 0
+		unsigned char bytes[sizeof(Real)];
+		memcpy(bytes, &v, sizeof(Real));
+		memcpy(&item->key, bytes, sizeof(item->key));
+		item->ext = bytes[8] | bytes[9] << 8;
+		if (item->ext & 0x8000) {
+			item->key = ~item->key;
+			item->ext = ~item->ext & 0xffff;
+		} else {
+			item->ext |= 0x8000;
+		}
+#else
+		double d = (double)v;
+		memcpy(&item->key, &d, sizeof(item->key));
+		item->key = item->key >> 63 ? ~item->key : item->key | 1ULL << 63;
+#endif
+#endif
+	}
+	if (order == Desc) {
+		item->key = ~item->key;
+		item->ext = ~item->ext & 0xffff;
 	}
 }
 
 /**
- * @brief 反向排列线性表
+ * @brief 对排序项进行LSD基数排序，每趟按一个字节分配，先一次性统计所有字节的分布，所有项在某个字节上都相同时跳过这一趟
  *
- * @param a
- * 	线性表
- * @param size
- * 	表内元素数量
+ * @param items
+ * 	排序项数组，排序结果也存放在这里
+ * @param tmp
+ * 	与排序项数组同样大小的缓冲区
+ * @param n
+ * 	排序项数量
+ * @param digits
+ * 	排序键的字节数，8字节的key之后为ext的低位字节
  */
-static void __arraylist_reverse(element_p *a, size_t size)
+static void __radix_lsd(radix_item_p items, radix_item_p tmp, size_t n, int digits)
 {
-	int left = 0;
+	size_t count[10][256];
+	memset(count, 0, sizeof(count));
+	for (size_t i = 0; i < n; i++) {
+		for (int d = 0; d < 8; d++)
+			count[d][(items[i].key >> (d * 8)) & 0xff]++;
+		for (int d = 8; d < digits; d++)
+			count[d][(items[i].ext >> ((d - 8) * 8)) & 0xff]++;
+	}
+	radix_item_p src = items;
+	radix_item_p dst = tmp;
+	for (int d = 0; d < digits; d++) {
+		unsigned int shift = d < 8 ? d * 8 : (d - 8) * 8;
+		size_t pos = 0;
+		int skip = 0;
+		for (int c = 0; c < 256; c++) {
+			size_t cnt = count[d][c];
+			if (cnt == n) {
+				skip = 1;
+				break;
+			}
+			count[d][c] = pos;
+			pos += cnt;
+		}
+		if (skip)
+			continue;
+		for (size_t i = 0; i < n; i++) {
+			unsigned int c = ((d < 8 ? src[i].key : src[i].ext) >> shift) & 0xff;
+			dst[count[d][c]++] = src[i];
+		}
+		radix_item_p temp = src;
+		src = dst;
+		dst = temp;
+	}
+	if (src != items)
+		memcpy(items, src, n * sizeof(radix_item_t));
+}
+
+/**
+ * @brief 对字符串进行MSD基数排序，按第depth个字符稳定地分配到256个桶中，再对各个非结尾符的桶递归排序
+ * 所有字符串在当前字符上都相同时直接比较下一个字符而不递归，元素较少的桶用插入排序，递归层数超过SORT_RADIX_LEVELS时用稳定排序
+ *
+ * @param a
+ * 	元素数组，元素都不是NULL元素，且前depth个字符都相同
+ * @param tmp
+ * 	与元素数组同样大小的缓冲区
+ * @param n
+ * 	元素数量
+ * @param depth
+ * 	当前比较的字符位置
+ * @param level
+ * 	当前的递归层数
+ * @param order
+ * 	排序顺序
+ * @param cmpfunc
+ * 	比较函数
+ */
+static void __radix_msd(element_p *a, element_p *tmp, size_t n, size_t depth, int level, int order, CmpFunc cmpfunc)
+{
+	size_t count[256];
+	int c;
+	for (;;) {
+		if (n <= SORT_RADIX_SMALL) {
+			__arraylist_insertsort(a, 0, n - 1, order, cmpfunc);
+			return;
+		}
+		if (level >= SORT_RADIX_LEVELS) {
+			__arraylist_stablesort(a, n, tmp, order, cmpfunc, NULL);
+			return;
+		}
+		memset(count, 0, sizeof(count));
+		for (size_t i = 0; i < n; i++)
+			count[((unsigned char *)a[i]->value)[depth]]++;
+		c = ((unsigned char *)a[0]->value)[depth];
+		if (count[c] < n)
+			break;
+		if (c == 0)
+			return;					// 所有字符串都相同
+		depth++;
+	}
+	size_t pos = 0;
+	for (int k = 0; k < 256; k++) {				// 降序时桶的顺序反过来，结尾符的桶排在最后
+		c = order == Desc ? 255 - k : k;
+		size_t cnt = count[c];
+		count[c] = pos;
+		pos += cnt;
+	}
+	for (size_t i = 0; i < n; i++)
+		tmp[count[((unsigned char *)a[i]->value)[depth]]++] = a[i];
+	memcpy(a, tmp, n * sizeof(element_p));
+	pos = 0;						// 分配后count[c]为第c个桶的结束位置
+	for (int k = 0; k < 256; k++) {
+		c = order == Desc ? 255 - k : k;
+		if (c && count[c] - pos > 1)
+			__radix_msd(a + pos, tmp + pos, count[c] - pos, depth + 1, level + 1, order, cmpfunc);
+		pos = count[c];
+	}
+}
+
+/**
+ * @brief 对使用默认比较函数的整数、实数或字符串列表的元素数组进行基数排序，是稳定的排序算法，NULL元素按原有顺序排在最小的位置
+ * 整数和实数转换为排序键后做LSD基数排序，字符串做MSD基数排序，需要分配与元素数量相当的临时空间
+ *
+ * @param list
+ * 	列表，提供元素类型、比较函数和分配器
+ * @param a
+ * 	元素数组
+ * @param size
+ * 	元素数量
+ * @param order
+ * 	排序顺序
+ *
+ * @return 
+ * 	完成排序返回0，比较函数不是默认的比较函数、元素类型不适用或分配内存失败时返回-1，此时元素数组保持不变
+ */
+static int __arraylist_radixsort(list_p list, element_p *a, size_t size, int order)
+{
+	ElementType type = list->etype;
+	if (list->cmpfunc != __default_cmpfunc(type) || type == object || (type == real && RADIX_REAL_EXT < 0))
+		return -1;
+	void *tmp = __mr_malloc(&list->alloc, size * (type == string ? sizeof(element_p) : 2 * sizeof(radix_item_t)));
+	if (!tmp)
+		return -1;
+	size_t nulls = 0, n = 0;
+	if (type == string) {
+		element_p *strs = (element_p *)tmp;
+		for (size_t i = 0; i < size; i++) {		// 非NULL元素暂存到缓冲区，NULL元素依次移到数组前部
+			if (a[i]->value)
+				strs[n++] = a[i];
+			else
+				a[nulls++] = a[i];
+		}
+		memcpy(a + nulls, strs, n * sizeof(element_p));
+		if (n > 1)
+			__radix_msd(a + nulls, strs, n, 0, 0, order, list->cmpfunc);
+	} else {
+		radix_item_p items = (radix_item_p)tmp;
+		for (size_t i = 0; i < size; i++) {
+			if (a[i]->value)
+				__radix_key(a[i], type, order, items + n++);
+			else
+				a[nulls++] = a[i];
+		}
+		__radix_lsd(items, items + n, n, type == real ? 8 + RADIX_REAL_EXT : 8);
+		for (size_t i = 0; i < n; i++)
+			a[nulls + i] = items[i].element;
+	}
+	if (order == Desc && nulls) {				// 降序时NULL元素移到最后
+		element_p *nul = (element_p *)tmp;
+		memcpy(nul, a, nulls * sizeof(element_p));
+		memmove(a, a + nulls, n * sizeof(element_p));
+		memcpy(a + n, nul, nulls * sizeof(element_p));
+	}
+	__mr_free(&list->alloc, tmp);
+	return 0;
+}
+
+/**
+ * @brief 对链表进行基数排序，把元素收集到数组中排序后按顺序放回各个节点
+ *
+ * @param list
+ * 	列表，须为链表
+ * @param order
+ * 	排序顺序
+ *
+ * @return 
+ * 	完成排序返回0，不适用基数排序或分配内存失败时返回-1
+ */
+static int __linkedlist_radixsort(list_p list, int order)
+{
+	element_p *a = (element_p *)__mr_malloc(&list->alloc, list->size * sizeof(element_p));
+	if (!a)
+		return -1;
+	size_t n = 0;
+	for (ll_node_p node = ((linkedlist_p)list->list)->head; node; node = node->next)
+		a[n++] = node->element;
+	int ret = __arraylist_radixsort(list, a, n, order);
+	if (ret == 0) {
+		n = 0;
+		for (ll_node_p node = ((linkedlist_p)list->list)->head; node; node = node->next)
+			node->element = a[n++];
+	}
+	__mr_free(&list->alloc, a);
+	return ret;
+}
+
+/**
+ * @brief 并行排序中对一段元素进行稳定排序的线程
+ *
+ * @param task
+ * 	排序任务
+ *
+ * @return 
+ * 	总是返回NULL
+ */
+static void *__psort_sort_task(void *task)
+{
+	psort_task_p t = (psort_task_p)task;
+	__arraylist_stablesort(t->src + t->lo, t->hi - t->lo, t->dst + t->lo, t->order, t->cmpfunc, NULL);
+	return NULL;
+}
+
+/**
+ * @brief 并行排序中合并两段有序序列的一部分的线程，相等时前一段的元素在前，保证稳定
+ *
+ * @param task
+ * 	合并任务
+ *
+ * @return 
+ * 	总是返回NULL
+ */
+static void *__psort_merge_task(void *task)
+{
+	psort_task_p t = (psort_task_p)task;
+	element_p *src = t->src;
+	element_p *dst = t->dst + t->out;
+	int order = t->order;
+	CmpFunc cmpfunc = t->cmpfunc;
+	size_t i = t->lo, j = t->lo2;
+	while (i < t->hi && j < t->hi2)
+		*dst++ = ORDER_CMP(src[j], src[i]) < 0 ? src[j++] : src[i++];
+	memcpy(dst, src + i, (t->hi - i) * sizeof(element_p));
+	memcpy(dst + (t->hi - i), src + j, (t->hi2 - j) * sizeof(element_p));
+	return NULL;
+}
+
+/**
+ * @brief 并行执行一组互不相关的任务，第一个任务在当前线程中执行，创建线程失败的任务在最后由当前线程补做
+ *
+ * @param tasks
+ * 	任务数组
+ * @param ntasks
+ * 	任务数量
+ * @param func
+ * 	执行任务的线程函数
+ */
+static void __psort_run(psort_task_p tasks, int ntasks, void *(*func)(void *))
+{
+	for (int i = 1; i < ntasks; i++)
+		tasks[i].running = pthread_create(&tasks[i].tid, NULL, func, tasks + i) == 0;
+	func(tasks);
+	for (int i = 1; i < ntasks; i++) {
+		if (tasks[i].running)
+			pthread_join(tasks[i].tid, NULL);
+		else
+			func(tasks + i);
+	}
+}
+
+/**
+ * @brief 在有序序列a[lo, hi)中用二分法查找e的插入位置
+ *
+ * @param a
+ * 	元素数组
+ * @param lo
+ * 	起始位置
+ * @param hi
+ * 	结束位置（不含）
+ * @param e
+ * 	查找的元素
+ * @param upper
+ * 	非0时返回第一个排在e之后的位置，否则返回第一个不排在e之前的位置
+ * @param order
+ * 	排序顺序
+ * @param cmpfunc
+ * 	比较函数
+ *
+ * @return 
+ * 	插入位置
+ */
+static size_t __arraylist_bound(element_p *a, size_t lo, size_t hi, element_p e, int upper, int order, CmpFunc cmpfunc)
+{
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		int cmp = ORDER_CMP(a[mid], e);
+		if (cmp < 0 || (upper && cmp == 0))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/**
+ * @brief 对线性表进行多线程并行稳定排序，先把数组均分为nthreads段由各线程分别排序，再逐轮两两合并相邻的段
+ * 每轮合并时按线程数把每一对段再切分为若干互不重叠的部分并行合并，元素在数组和缓冲区之间交替存放，最后一轮结束后如在缓冲区中则复制回数组
+ * 元素太少、线程数不足2或缓冲区分配失败时退化为单线程的稳定排序
+ *
+ * @param list
+ * 	列表，提供比较函数和分配器
+ * @param a
+ * 	元素数组，长度为列表的元素数量
+ * @param order
+ * 	排序顺序
+ * @param nthreads
+ * 	线程数量，不大于0时使用在线的处理器数量
+ */
+static void __arraylist_psort(list_p list, element_p *a, int order, int nthreads)
+{
+	size_t size = list->size;
+	CmpFunc cmpfunc = list->cmpfunc;
+	if (nthreads <= 0)
+		nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if (nthreads > SORT_PAR_MAX)
+		nthreads = SORT_PAR_MAX;
+	if (nthreads > size / SORT_PAR_MIN)
+		nthreads = size / SORT_PAR_MIN;
+	element_p *buf = (element_p *)__mr_malloc(&list->alloc, size * sizeof(element_p));
+	if (nthreads < 2 || !buf) {
+		__arraylist_stablesort(a, size, buf, order, cmpfunc, &list->alloc);
+		if (buf)
+			__mr_free(&list->alloc, buf);
+		return;
+	}
+	psort_task_t tasks[SORT_PAR_MAX + 1];
+	size_t bounds[SORT_PAR_MAX + 1];				// 各段的边界，第r段为[bounds[r], bounds[r + 1])
+	int nruns = nthreads;
+	for (int r = 0; r < nruns; r++) {
+		bounds[r] = size * r / nruns;
+		tasks[r].src = a;
+		tasks[r].dst = buf;
+		tasks[r].lo = bounds[r];
+		tasks[r].hi = size * (r + 1) / nruns;
+		tasks[r].order = order;
+		tasks[r].cmpfunc = cmpfunc;
+	}
+	bounds[nruns] = size;
+	__psort_run(tasks, nruns, __psort_sort_task);
+	element_p *src = a;
+	element_p *dst = buf;
+	while (nruns > 1) {
+		int k = nthreads / (nruns / 2);				// 每一对段切分的部分数
+		int ntasks = 0;
+		int r;
+		for (r = 0; r + 1 < nruns; r += 2) {
+			size_t alo = bounds[r], blo = bounds[r + 1], bhi = bounds[r + 2];
+			size_t pa = alo, pb = blo;
+			for (int p = 1; p <= k; p++) {
+				size_t qa, qb;
+				if (p == k) {
+					qa = blo;
+					qb = bhi;
+				} else if (blo - alo >= bhi - blo) {	// 按较长的一段均分，在另一段中二分查找对应的切分位置
+					qa = alo + (blo - alo) * p / k;
+					qb = __arraylist_bound(src, blo, bhi, src[qa], 0, order, cmpfunc);
+				} else {
+					qb = blo + (bhi - blo) * p / k;
+					qa = __arraylist_bound(src, alo, blo, src[qb], 1, order, cmpfunc);
+				}
+				psort_task_p t = tasks + ntasks++;
+				t->src = src;
+				t->dst = dst;
+				t->lo = pa;
+				t->hi = qa;
+				t->lo2 = pb;
+				t->hi2 = qb;
+				t->out = pa + pb - blo;
+				t->order = order;
+				t->cmpfunc = cmpfunc;
+				pa = qa;
+				pb = qb;
+			}
+			bounds[r / 2] = alo;
+		}
+		if (r < nruns) {					// 落单的最后一段原样复制
+			psort_task_p t = tasks + ntasks++;
+			t->src = src;
+			t->dst = dst;
+			t->lo = t->out = bounds[r];
+			t->hi = t->lo2 = t->hi2 = bounds[r + 1];
+			t->order = order;
+			t->cmpfunc = cmpfunc;
+			bounds[r / 2] = bounds[r];
+		}
+		nruns = (nruns + 1) / 2;
+		bounds[nruns] = size;
+		__psort_run(tasks, ntasks, __psort_merge_task);
+		element_p *temp = src;
+		src = dst;
+		dst = temp;
+	}
+	if (src != a)
+		memcpy(a, src, size * sizeof(element_p));
+	__mr_free(&list->alloc, buf);
+}
+
+/**
+ * @brief 对链表进行二分搜索
+ *
+ * @param e
+ * 	搜索的元素
+ * @param size
+ * 	链表中的节点数量
+ * @param order
+ * 	表中元素的排列顺序
+ * @param left
+ * 	左节点
+ * @param right
+ * 	右节点
+ * @param cmpfunc
+ * 	比较函数
+ *
+ * @return 
+ * 	找到的元素的位置，找不到返回-1
+ */
+static int __linkedlist_bisearch(element_p e, size_t size, int order, ll_node_p left, ll_node_p right, CmpFunc cmpfunc)
+{
+	int s = size;					// 每一轮搜索范围的节点数量
+	ll_node_p m = left;				// 每一轮搜索范围的比较节点
+	ll_node_p l = left;				// 每一轮搜索范围的左节点
+	ll_node_p r = right;				// 每一轮搜索范围的右节点
+	int pos = 0;					// 比较节点的位置
+	int step, cmp, i;				// 跳数，比较结果，循环变量
+	do {						// 每一轮循环都在一定的范围内找到中间节点并进行比较，循环开始时比较节点置于左端，循环中进行跳转
+		step = (s - 1) / 2;			// 计算到中间节点的跳跃数
+		for (i = 0; i < step; i++)
+			m = m->next;			// 比较节点跳跃到中间节点
+		pos += step;				// 比较节点节点的位置调整为中间节点的位置
+		cmp = order * cmpfunc(e->value, m->element->value, e->len, m->element->len);
+		if (cmp == 0)				// 中间节点就是要搜索的节点，直接返回中间节点的位置
+			return pos;
+		else if (cmp > 0) {			// 要搜索的元素大于中间节点的元素，在右半表(m->next, r)中继续循环
+			l = m->next;			// 右半表的左节点是当前节点的后继
+			m = l;				// 当前节点修正为右半表的左节点
+			pos++;				// 修正当前节点的位置
+			s = s - step - 1;		// 右半表的元素数量
+		} else {				// 要搜索的元素小于中间节点的元素，在左半表(l, m->prev)中继续循环
+			r = m->prev;			// 左半表的右节点等于当前节点的前驱
+			m = l;				// 当前节点回归到左节点
+			pos -= step;			// 修正当前节点的位置
+			s = step;			// 左半表的元素数量
+		}
+	} while (s > 0);				// 下一轮循环已经没有元素的时候循环结束，元素没有找到
+	return -1;
+}
+
+/**
+ * @brief 对线性表进行二分搜索
+ *
+ * @param e
+ * 	搜索的元素
+ * @param a
+ * 	元素数组
+ * @param order
+ * 	表中元素的排列顺序
+ * @param left
+ * 	左位置
+ * @param right
+ * 	右位置
+ * @param cmpfunc
+ * 	比较函数
+ *
+ * @return 
+ * 	找到的元素的位置，找不到返回-1
+ */
+static int __arraylist_bisearch(element_p e, element_p *a, int order, int left, int right, CmpFunc cmpfunc)
+{
+	if (left > right)
+		return -1;
+	int mid = (left + right) / 2;
+	int cmp = order * cmpfunc(e->value, a[mid]->value, e->len, a[mid]->len);
+	if (cmp == 0)
+		return mid;
+	else if (cmp > 0)
+		return __arraylist_bisearch(e, a, order, mid + 1, right, cmpfunc);
+	else
+		return __arraylist_bisearch(e, a, order, left, mid - 1, cmpfunc);
+}
+
+/**
+ * @brief 对环形线性表进行二分搜索
+ *
+ * @param e
+ * 	搜索的元素
+ * @param rl
+ * 	环形线性表
+ * @param order
+ * 	表中元素的排列顺序
+ * @param left
+ * 	左位置
+ * @param right
+ * 	右位置
+ * @param cmpfunc
+ * 	比较函数
+ *
+ * @return 
+ * 	找到的元素的位置，找不到返回-1
+ */
+static int __ringlist_bisearch(element_p e, ringlist_p rl, int order, int left, int right, CmpFunc cmpfunc)
+{
+	while (left <= right) {
+		int mid = (left + right) / 2;
+		element_p m = RL_AT(rl, mid);
+		int cmp = order * cmpfunc(e->value, m->value, e->len, m->len);
+		if (cmp == 0)
+			return mid;
+		else if (cmp > 0)
+			left = mid + 1;
+		else
+			right = mid - 1;
+	}
+	return -1;
+}
+
+/**
+ * @brief 展开链表二分搜索，先用各节点的最后一个元素顺序确定目标所在的节点，再在节点内部二分搜索
+ *
+ * @param e
+ * 	搜索的元素
+ * @param ul
+ * 	展开链表
+ * @param order
+ * 	表中元素的排列顺序
+ * @param cmpfunc
+ * 	比较函数
+ *
+ * @return 
+ * 	找到的元素的位置，找不到返回-1
+ */
+static int __unrolledlist_bisearch(element_p e, unrolledlist_p ul, int order, CmpFunc cmpfunc)
+{
+	size_t base = 0;
+	for (ul_node_p node = ul->head; node; node = node->next) {
+		element_p last = node->elements[node->count - 1];
+		if (order * cmpfunc(e->value, last->value, e->len, last->len) <= 0) {
+			int ret = __arraylist_bisearch(e, node->elements, order, 0, node->count - 1, cmpfunc);
+			return ret == -1 ? -1 : (int)base + ret;
+		}
+		base += node->count;
+	}
+	return -1;
+}
+
+/**
+ * @brief 展开链表排序，把所有元素收集到临时数组中用线性表的排序算法排序后按原节点结构写回，临时数组分配失败时不排序
+ *
+ * @param list
+ * 	列表，须为展开链表
+ * @param order
+ * 	排序顺序
+ * @param method
+ * 	排序方法
+ */
+static void __unrolledlist_sort(list_p list, int order, int method)
+{
+	element_p *a = (element_p *)__mr_malloc(&list->alloc, list->size * sizeof(element_p));
+	if (!a)
+		return;
+	unrolledlist_p ul = (unrolledlist_p)list->list;
+	size_t n = 0;
+	for (ul_node_p node = ul->head; node; node = node->next) {
+		memcpy(a + n, node->elements, node->count * sizeof(element_p));
+		n += node->count;
+	}
+	__arraylist_sort(list, a, order, method);
+	n = 0;
+	for (ul_node_p node = ul->head; node; node = node->next) {
+		memcpy(node->elements, a + n, node->count * sizeof(element_p));
+		n += node->count;
+	}
+	__mr_free(&list->alloc, a);
+}
+
+/**
+ * @brief 索引树二分搜索，从根节点向下比较，时间为O(log n)
+ *
+ * @param e
+ * 	搜索的元素
+ * @param root
+ * 	根节点
+ * @param order
+ * 	表中元素的排列顺序
+ * @param cmpfunc
+ * 	比较函数
+ *
+ * @return 
+ * 	找到的元素的位置，找不到返回-1
+ */
+static int __indexedlist_bisearch(element_p e, il_node_p root, int order, CmpFunc cmpfunc)
+{
+	size_t base = 0;
+	il_node_p node = root;
+	while (node) {
+		size_t pos = base + IL_SIZE(node->left);
+		int cmp = order * cmpfunc(e->value, node->element->value, e->len, node->element->len);
+		if (cmp == 0) {
+			return pos;
+		} else if (cmp < 0) {
+			node = node->left;
+		} else {
+			base = pos + 1;
+			node = node->right;
+		}
+	}
+	return -1;
+}
+
+/**
+ * @brief 按中序把索引树中的元素依次收集到数组中，或把数组中的元素依次写回索引树，树的结构不变
+ *
+ * @param node
+ * 	子树的根节点
+ * @param a
+ * 	数组
+ * @param fill
+ * 	为0时收集，非0时写回
+ *
+ * @return 
+ * 	子树中的元素数量
+ */
+static size_t __indexedlist_collect(il_node_p node, element_p *a, int fill)
+{
+	if (!node)
+		return 0;
+	size_t n = __indexedlist_collect(node->left, a, fill);
+	if (fill)
+		node->element = a[n];
+	else
+		a[n] = node->element;
+	return n + 1 + __indexedlist_collect(node->right, a + n + 1, fill);
+}
+
+/**
+ * @brief 索引树排序，把所有元素收集到临时数组中用线性表的排序算法排序后写回，临时数组分配失败时不排序
+ *
+ * @param list
+ * 	列表，须为索引树
+ * @param order
+ * 	排序顺序
+ * @param method
+ * 	排序方法
+ */
+static void __indexedlist_sort(list_p list, int order, int method)
+{
+	element_p *a = (element_p *)__mr_malloc(&list->alloc, list->size * sizeof(element_p));
+	if (!a)
+		return;
+	il_node_p root = ((indexedlist_p)list->list)->root;
+	__indexedlist_collect(root, a, 0);
+	__arraylist_sort(list, a, order, method);
+	__indexedlist_collect(root, a, 1);
+	__mr_free(&list->alloc, a);
+}
+
+/**
+ * @brief 反向排列链表
+ *
+ * @param head
+ * 	头节点
+ * @param tail
+ * 	尾节点
+ */
+static void __linkedlist_reverse(ll_node_p head, ll_node_p tail)
+{
+	ll_node_p left = head;
+	ll_node_p right = tail;
+	element_p temp = NULL;
+	while (left != right && left->prev != right) {
+		temp = left->element;
+		left->element = right->element;
+		right->element = temp;
+		left = left->next;
+		right = right->prev;
+	}
+}
+
+/**
+ * @brief 反向排列线性表
+ *
+ * @param a
+ * 	线性表
+ * @param size
+ * 	表内元素数量
+ */
+static void __arraylist_reverse(element_p *a, size_t size)
+{
+	int left = 0;
 	int right = size - 1;
 	element_p temp = NULL;
 	while (left < right) {
@@ -1233,210 +3598,1582 @@ static void __arraylist_reverse(element_p *a, size_t size)
 }
 
 /**
- * @brief 创建一个列表的迭代器
+ * @brief 把环形线性表整体旋转为从数组头部开始连续存放，以便直接使用线性表的排序等算法
+ * 通过三次反转原地旋转整个数组，不分配内存
+ *
+ * @param rl
+ * 	环形线性表
+ *
+ * @return 
+ * 	旋转后的元素数组
+ */
+static element_p *__ringlist_linearize(ringlist_p rl)
+{
+	if (rl->head) {
+		__arraylist_reverse(rl->elements, rl->head);
+		__arraylist_reverse(rl->elements + rl->head, rl->capacity - rl->head);
+		__arraylist_reverse(rl->elements, rl->capacity);
+		rl->head = 0;
+	}
+	return rl->elements;
+}
+
+/**
+ * @brief 反向排列展开链表，节点结构不变，从两端同时向中间交换元素
+ *
+ * @param ul
+ * 	展开链表
+ * @param size
+ * 	表内元素数量
+ */
+static void __unrolledlist_reverse(unrolledlist_p ul, size_t size)
+{
+	ul_node_p ln = ul->head;
+	ul_node_p rn = ul->tail;
+	size_t li = 0;
+	size_t ri = rn->count - 1;
+	element_p temp = NULL;
+	for (size_t i = 0; i < size / 2; i++) {
+		temp = ln->elements[li];
+		ln->elements[li] = rn->elements[ri];
+		rn->elements[ri] = temp;
+		if (++li == ln->count) {
+			ln = ln->next;
+			li = 0;
+		}
+		if (ri-- == 0) {
+			rn = rn->prev;
+			ri = rn->count - 1;
+		}
+	}
+}
+
+/**
+ * @brief 把索引树左右镜像，中序顺序随之反转，子树大小和高度不变
+ *
+ * @param node
+ * 	子树的根节点
+ */
+static void __indexedlist_mirror(il_node_p node)
+{
+	if (!node)
+		return;
+	il_node_p temp = node->left;
+	node->left = node->right;
+	node->right = temp;
+	__indexedlist_mirror(node->left);
+	__indexedlist_mirror(node->right);
+}
+
+/**
+ * @brief 按中序顺序用访问函数访问索引树中的元素，访问函数返回非0时终止
+ *
+ * @param node
+ * 	子树的根节点
+ * @param dir
+ * 	访问方向，Reverse时按中序的逆序访问
+ * @param visit
+ * 	访问函数
+ * @param ctx
+ * 	传递给访问函数的上下文
+ * @param count
+ * 	累计已访问的元素数量
+ *
+ * @return 
+ * 	访问被终止时返回非0，否则返回0
+ */
+static int __indexedlist_foreach(il_node_p node, int dir, VisitFunc visit, void *ctx, size_t *count)
+{
+	if (!node)
+		return 0;
+	il_node_p first = dir == Reverse ? node->right : node->left;
+	il_node_p second = dir == Reverse ? node->left : node->right;
+	if (__indexedlist_foreach(first, dir, visit, ctx, count))
+		return 1;
+	(*count)++;
+	if (__element_visit(node->element, visit, ctx))
+		return 1;
+	return __indexedlist_foreach(second, dir, visit, ctx, count);
+}
+
+/**
+ * @brief 创建一个列表的迭代器
+ *
+ * @param list
+ * 	列表容器
+ * @param dir
+ * 	迭代方向
+ *
+ * @return 
+ * 	列表迭代器
+ */
+static list_it_p __list_iterator(list_p list, int dir, int from, int to)
+{
+	list_it_p it = (list_it_p)__mr_malloc(&list->alloc, sizeof(list_it_t));	// 迭代器由列表的分配器分配
+	if (it) {
+		it->alloc = list->alloc;
+		it->list = list;
+		it->dir = dir;
+		it->from = from;
+		it->to = to;
+		__list_it_start(it);
+	}
+	return it;
+}
+
+/**
+ * @brief 用列表的分配器把列表迭代器封装成Iterator，封装失败时销毁列表迭代器
+ *
+ * @param it
+ * 	列表迭代器，可以为NULL
+ *
+ * @return 
+ * 	迭代器，it为NULL或内存不足时返回NULL
+ */
+static Iterator __list_it_wrap(list_it_p it)
+{
+	Iterator ret = it ? __it_create(&it->alloc, it, __list_it_next, __list_it_next_with, __list_it_next_batch, __list_it_remove, __list_it_reset, __list_it_destroy) : NULL;
+	if (it && !ret)
+		__list_it_destroy(it);
+	return ret;
+}
+
+/**
+ * @brief 把迭代器置于起始位置，正向迭代时为范围内的第一个元素，反向迭代时为范围内的最后一个元素，调用前须对列表加锁
+ *
+ * @param it
+ * 	迭代器
+ */
+static void __list_it_start(list_it_p it)
+{
+	list_p list = it->list;
+	int hi = it->to < 0 || it->to > list->size ? list->size : it->to;
+	it->at = it->dir == Reverse ? hi - 1 : it->from;
+	if (list->ltype == LinkedList) {
+		linkedlist_p ll = (linkedlist_p)list->list;
+		if (it->at < it->from || it->at >= hi)
+			it->pos.node = NULL;
+		else if (it->from == 0 && it->to < 0)
+			it->pos.node = it->dir == Reverse ? ll->tail : ll->head;
+		else
+			it->pos.node = __linkedlist_goto(ll, list->size, it->at);
+	} else {
+		it->pos.index = it->at;
+	}
+	it->removable = 0;
+	it->changes = list->changes;
+}
+
+/**
+ * @brief 迭代到下一个元素，调用前须对列表加锁
+ *
+ * @param it
+ * 	迭代器
+ *
+ * @return 
+ * 	下一个元素，迭代结束后返回NULL直到迭代器被重置，迭代时发现Fast-Fail时将迭代器置为迭代结束状态并返回NULL
+ */
+static element_p __list_it_next_element(list_it_p it)
+{
+	element_p ret = NULL;
+	list_p l = it->list;
+	if (it->changes != l->changes) {
+		if (l->ltype == LinkedList)
+			it->pos.node = NULL;
+		else
+			it->pos.index = it->dir == Reverse ? -1 : l->size;
+	}
+	if (l->ltype == LinkedList && it->pos.node && it->at >= it->from && (it->to < 0 || it->at < it->to)) {
+		ret = it->pos.node->element;
+		it->pos.node = it->dir == Reverse ? it->pos.node->prev : it->pos.node->next;
+		it->at = it->dir == Reverse ? it->at - 1 : it->at + 1;
+		it->removable = 1;
+	} else if (l->ltype != LinkedList && it->pos.index >= it->from && it->pos.index < l->size && (it->to < 0 || it->pos.index < it->to)) {
+		ret = __list_element_at(l, it->pos.index);
+		it->pos.index = it->dir == Reverse ? it->pos.index - 1 : it->pos.index + 1;
+		it->removable = 1;
+	}
+	return ret;
+}
+
+/**
+ * @brief 迭代访问下一个元素
+ *
+ * @param it
+ * 	迭代器
+ *
+ * @return 
+ * 	下一个元素的副本，迭代结束后返回NULL直到迭代器被重置
+ */
+static Element __list_it_next(void *it)
+{
+	Element ret = NULL;
+	if (it && ((list_it_p)it)->list) {
+		list_it_p i = (list_it_p)it;
+		__list_rdlock(i->list);
+		ret = __element_clone_value(i->list->eslab, __list_it_next_element(i));
+		__list_unlock(i->list);
+	}
+	return ret;
+}
+
+/**
+ * @brief 用访问函数迭代访问下一个元素，不复制元素
+ *
+ * @param it
+ * 	迭代器
+ * @param visit
+ * 	访问函数
+ * @param ctx
+ * 	传递给访问函数的上下文
+ *
+ * @return 
+ * 	访问成功返回0，迭代结束返回-1
+ */
+static int __list_it_next_with(void *it, VisitFunc visit, void *ctx)
+{
+	int ret = -1;
+	if (it && ((list_it_p)it)->list) {
+		list_it_p i = (list_it_p)it;
+		element_p e;
+		__list_rdlock(i->list);
+		if ((e = __list_it_next_element(i))) {
+			__element_visit(e, visit, ctx);
+			ret = 0;
+		}
+		__list_unlock(i->list);
+	}
+	return ret;
+}
+
+/**
+ * @brief 一次迭代最多n个元素，把元素的副本依次写入out，整批只加锁一次
+ *
+ * @param it
+ * 	迭代器
+ * @param out
+ * 	保存元素副本的数组
+ * @param n
+ * 	最多迭代的元素数量
+ *
+ * @return 
+ * 	写入out的元素数量，小于n表示迭代结束或内存不足
+ */
+static size_t __list_it_next_batch(void *it, Element *out, size_t n)
+{
+	size_t count = 0;
+	if (it && ((list_it_p)it)->list && out) {
+		list_it_p i = (list_it_p)it;
+		element_p e;
+		__list_rdlock(i->list);
+		while (count < n && (e = __list_it_next_element(i)) && (out[count] = __element_clone_value(i->list->eslab, e)))
+			count++;
+		__list_unlock(i->list);
+	}
+	return count;
+}
+
+/**
+ * @brief 删除上一次迭代得到的元素，没有迭代过的初始迭代器或连续调用都不会删除任何元素
+ *
+ * @param it
+ * 	迭代器
+ *
+ * @return 
+ * 	删除的元素数量，0或1
+ */
+static size_t __list_it_remove(void *it)
+{
+	size_t count = 0;
+	if (it && ((list_it_p)it)->list && ((list_it_p)it)->removable) {
+		list_it_p i = (list_it_p)it;
+		list_p l = i->list;
+		__list_wrlock(l);
+		if (l->ltype == LinkedList) {
+			linkedlist_p ll = (linkedlist_p)l->list;
+			ll_node_p n = i->dir == Reverse ? (i->pos.node ? i->pos.node->next : ll->head) : (i->pos.node ? i->pos.node->prev : ll->tail);
+			__linkedlist_node_plugout(ll, n);
+			__linkedlist_node_destroy(l, n);
+			if (i->dir != Reverse)
+				i->at--;
+		} else {
+			__list_remove_at(l, i->dir == Reverse ? i->pos.index + 1 : i->pos.index - 1);
+			if (i->dir != Reverse)
+				i->pos.index--;
+		}
+		if (i->to > 0)
+			i->to--;				// 范围内删除一个元素后范围的终点前移
+		i->removable = 0;
+		l->size--;
+		l->changes++;
+		i->changes++;
+		count++;
+		__list_unlock(l);
+	}
+	return count;
+}
+
+/**
+ * @brief 重置迭代器
+ *
+ * @param it
+ * 	迭代器
+ */
+static void __list_it_reset(void *it)
+{
+	if (it && ((list_it_p)it)->list) {
+		list_it_p i = (list_it_p)it;
+		__list_rdlock(i->list);
+		__list_it_start(i);
+		__list_unlock(i->list);
+	}
+}
+
+/**
+ * @brief 销毁迭代器
+ *
+ * @param it
+ * 	迭代器
+ */
+static void __list_it_destroy(void *it)
+{
+	if (it) {
+		Allocator_t alloc = ((list_it_p)it)->alloc;
+		__mr_free(&alloc, it);
+	}
+}
+
+/**
+ * @brief 按顺序用访问函数访问列表中的全部元素，访问函数返回非0时终止，链表、展开链表和索引树沿节点遍历，不按位置逐个定位
+ *
+ * @param list
+ * 	列表
+ * @param dir
+ * 	访问方向，Forward或Reverse
+ * @param visit
+ * 	访问函数
+ * @param ctx
+ * 	传递给访问函数的上下文
+ *
+ * @return 
+ * 	已访问的元素数量，包括使访问终止的元素
+ */
+static size_t __list_foreach(list_p list, int dir, VisitFunc visit, void *ctx)
+{
+	size_t count = 0;
+	int rev = dir == Reverse;
+	if (list->ltype == LinkedList) {
+		linkedlist_p ll = (linkedlist_p)list->list;
+		for (ll_node_p node = rev ? ll->tail : ll->head; node; node = rev ? node->prev : node->next) {
+			count++;
+			if (__element_visit(node->element, visit, ctx))
+				break;
+		}
+	} else if (list->ltype == UnrolledList) {
+		unrolledlist_p ul = (unrolledlist_p)list->list;
+		for (ul_node_p node = rev ? ul->tail : ul->head; node; node = rev ? node->prev : node->next)
+			for (size_t i = 0; i < node->count; i++) {
+				count++;
+				if (__element_visit(node->elements[rev ? node->count - 1 - i : i], visit, ctx))
+					return count;
+			}
+	} else if (list->ltype == IndexedList) {
+		__indexedlist_foreach(((indexedlist_p)list->list)->root, dir, visit, ctx, &count);
+	} else {
+		for (size_t i = 0; i < list->size; i++) {
+			size_t index = rev ? list->size - 1 - i : i;
+			element_p e = list->ltype == RingList ? RL_AT((ringlist_p)list->list, index) : ((arraylist_p)list->list)->elements[index];
+			count++;
+			if (__element_visit(e, visit, ctx))
+				break;
+		}
+	}
+	return count;
+}
+
+/**
+ * @brief 清空列表，销毁其中所有元素
+ * slab模式下如果所有元素值都内联存储，则不逐个销毁元素和节点，而是整块释放全部内存
+ *
+ * @param list
+ * 	列表
+ */
+static void __list_clear(list_p list)
+{
+	if (SLAB_RELEASABLE(list->eslab)) {
+		if (list->ltype == LinkedList) {
+			((linkedlist_p)list->list)->head = NULL;
+			((linkedlist_p)list->list)->tail = NULL;
+		} else if (list->ltype == RingList) {
+			((ringlist_p)list->list)->head = 0;
+		} else if (list->ltype == UnrolledList) {
+			((unrolledlist_p)list->list)->head = NULL;
+			((unrolledlist_p)list->list)->tail = NULL;
+			((unrolledlist_p)list->list)->finger = NULL;
+			((unrolledlist_p)list->list)->fbase = 0;
+		} else if (list->ltype == IndexedList) {
+			((indexedlist_p)list->list)->root = NULL;
+		}
+	} else if (list->ltype == LinkedList) {
+		__linkedlist_removeall(list);
+	} else if (list->ltype == RingList) {
+		__ringlist_removeall(list);
+	} else if (list->ltype == UnrolledList) {
+		__unrolledlist_removeall(list);
+	} else if (list->ltype == IndexedList) {
+		__indexedlist_node_destroy(list, ((indexedlist_p)list->list)->root);
+		((indexedlist_p)list->list)->root = NULL;
+	} else {
+		__arraylist_removeall(list);
+	}
+	__slab_reset(list->nslab);
+	__slab_reset(list->eslab);
+	list->size = 0;
+}
+
+/**
+ * @brief 把缓存中超出keep个的空闲链表节点交还给分配器
+ *
+ * @param list
+ * 	列表
+ * @param keep
+ * 	保留的节点数量
+ *
+ * @return 
+ * 	释放的节点数量
+ */
+static size_t __list_trim(list_p list, size_t keep)
+{
+	size_t ret = 0;
+	while (list->cached > keep) {
+		ll_node_p node = list->cache;
+		list->cache = node->next;
+		list->cached--;
+		__slab_free(list->nslab, node);
+		ret++;
+	}
+	return ret;
+}
+
+/**
+ * @brief 获取位置pos上的元素
+ *
+ * @param list
+ * 	列表
+ * @param pos
+ * 	位置
+ *
+ * @return 
+ * 	位置pos上的元素或NULL
+ */
+static element_p __list_get_at(list_p list, list_pos_t pos)
+{
+	if (list->ltype == LinkedList)
+		return pos.node ? pos.node->element : NULL;
+	else
+		return (pos.index >= 0 && pos.index < list->size) ? __list_element_at(list, pos.index) : NULL;
+}
+
+/**
+ * @brief 获取列表中第index个元素，调用前须确保index有效
+ *
+ * @param list
+ * 	列表
+ * @param index
+ * 	位置
+ *
+ * @return 
+ * 	第index个元素
+ */
+static element_p __list_element_at(list_p list, size_t index)
+{
+	if (list->ltype == LinkedList)
+		return __linkedlist_goto((linkedlist_p)list->list, list->size, index)->element;
+	else if (list->ltype == RingList)
+		return RL_AT((ringlist_p)list->list, index);
+	else if (list->ltype == UnrolledList) {
+		size_t base;
+		ul_node_p node = __unrolledlist_locate((unrolledlist_p)list->list, list->size, index, &base);
+		return node->elements[index - base];
+	} else if (list->ltype == IndexedList)
+		return __indexedlist_goto(((indexedlist_p)list->list)->root, index)->element;
+	else
+		return ((arraylist_p)list->list)->elements[index];
+}
+
+/**
+ * @brief 删除列表中第index个元素，不修改元素数量和变更次数，调用前须确保index有效并对列表加锁
+ *
+ * @param list
+ * 	列表
+ * @param index
+ * 	位置
+ *
+ * @return 
+ * 	删除的元素数量
+ */
+static size_t __list_remove_at(list_p list, size_t index)
+{
+	if (list->ltype == LinkedList)
+		return __linkedlist_remove_at(list, index);
+	else if (list->ltype == RingList)
+		return __ringlist_remove_at(list, index);
+	else if (list->ltype == UnrolledList) {
+		__element_destroy(list->eslab, __unrolledlist_detach(list, index));
+		return 1;
+	} else if (list->ltype == IndexedList) {
+		element_p e;
+		((indexedlist_p)list->list)->root = __indexedlist_node_del(list, ((indexedlist_p)list->list)->root, index, &e);
+		__element_destroy(list->eslab, e);
+		return 1;
+	} else
+		return __arraylist_remove_at(list, index);
+}
+
+/**
+ * @brief 在列表最后添加一个元素，添加时复制元素而非引用元素
+ *
+ * @param list
+ * 	列表
+ * @param ele
+ * 	元素
+ */
+static void __list_append(list_p list, element_p ele)
+{
+	element_p e = __element_clone(list->eslab, ele);
+	if (!e)
+		return;
+	int ret;
+	if (list->ltype == LinkedList)
+		ret = __linkedlist_ins(list, list->size, e);
+	else if (list->ltype == RingList)
+		ret = __ringlist_ins(list, list->size, e);
+	else if (list->ltype == UnrolledList)
+		ret = __unrolledlist_ins(list, list->size, e);
+	else if (list->ltype == IndexedList)
+		ret = __indexedlist_ins(list, list->size, e);
+	else
+		ret = __arraylist_ins((arraylist_p)list->list, list->size, list->size, e, &list->alloc);
+	if (ret == 0) {
+		list->size++;
+		list->changes++;
+	} else {
+		__element_destroy(list->eslab, e);
+	}
+}
+
+/**
+ * @brief 在列表第index个位置插入一个元素，插入时直接引用元素，调用前须对列表加锁
+ *
+ * @param list
+ * 	列表
+ * @param index
+ * 	插入位置，超过表尾的添加在尾部
+ * @param ele
+ * 	元素
+ *
+ * @return 
+ * 	插入成功返回0，失败返回-1，失败时元素由调用者负责销毁
+ */
+static int __list_insert(list_p list, size_t index, element_p ele)
+{
+	int ret;
+	if (list->ltype == LinkedList)
+		ret = __linkedlist_ins(list, index, ele);
+	else if (list->ltype == RingList)
+		ret = __ringlist_ins(list, index, ele);
+	else if (list->ltype == UnrolledList)
+		ret = __unrolledlist_ins(list, index, ele);
+	else if (list->ltype == IndexedList)
+		ret = __indexedlist_ins(list, index, ele);
+	else
+		ret = __arraylist_ins((arraylist_p)list->list, list->size, index, ele, &list->alloc);
+	if (ret == 0) {
+		list->size++;
+		list->changes++;
+	}
+	return ret;
+}
+
+/**
+ * @brief 删除表尾元素并返回其值
+ *
+ * @param list
+ * 	列表
+ * @param take
+ * 	为0时返回元素值的副本，非0时直接交出元素值的所有权
+ *
+ * @return 
+ * 	表尾元素的值，空表或复制元素值时内存不足返回NULL，内存不足时元素仍留在列表中
+ */
+static Element __list_pop(list_p list, int take)
+{
+	Element ret = NULL;
+	element_p e;
+	__list_wrlock(list);
+	if (list->size > 0) {
+		e = __list_element_at(list, list->size - 1);
+		ret = take ? __element_prepare_take(list->eslab, e) : __element_clone_value(list->eslab, e);
+		if (ret || !e->value) {		// 先取值再删除，复制失败时元素仍留在列表中
+			if (list->ltype == LinkedList) {
+				linkedlist_p ll = (linkedlist_p)list->list;
+				ll_node_p top = ll->tail;
+				top->element = NULL;
+				__linkedlist_node_plugout(ll, top);
+				__linkedlist_node_destroy(list, top);
+			} else if (list->ltype == UnrolledList) {
+				__unrolledlist_detach(list, list->size - 1);
+			} else if (list->ltype == IndexedList) {
+				((indexedlist_p)list->list)->root = __indexedlist_node_del(list, ((indexedlist_p)list->list)->root, list->size - 1, &e);
+			}
+			if (take)
+				__element_detach(list->eslab, e);
+			else
+				__element_destroy(list->eslab, e);
+			list->size--;
+			list->changes++;
+		}
+	}
+	__list_unlock(list);
+	return ret;
+}
+
+/**
+ * @brief 删除表头元素并返回其值，调用前须对列表加锁
+ *
+ * @param list
+ * 	列表
+ * @param take
+ * 	为0时返回元素值的副本，非0时直接交出元素值的所有权
+ *
+ * @return 
+ * 	表头元素的值，空表或复制元素值时内存不足返回NULL，内存不足时元素仍留在列表中
+ */
+static Element __list_dequeue(list_p list, int take)
+{
+	Element ret = NULL;
+	element_p e;
+	if (list->size > 0) {
+		e = __list_element_at(list, 0);
+		ret = take ? __element_prepare_take(list->eslab, e) : __element_clone_value(list->eslab, e);
+		if (ret || !e->value) {		// 先取值再删除，复制失败时元素仍留在列表中
+			if (list->ltype == LinkedList) {
+				linkedlist_p ll = (linkedlist_p)list->list;
+				ll_node_p head = ll->head;
+				head->element = NULL;
+				__linkedlist_node_plugout(ll, head);
+				__linkedlist_node_destroy(list, head);
+			} else if (list->ltype == RingList) {
+				ringlist_p rl = (ringlist_p)list->list;
+				rl->head = (rl->head + 1) & (rl->capacity - 1);
+			} else if (list->ltype == UnrolledList) {
+				__unrolledlist_detach(list, 0);
+			} else if (list->ltype == IndexedList) {
+				((indexedlist_p)list->list)->root = __indexedlist_node_del(list, ((indexedlist_p)list->list)->root, 0, &e);
+			} else {
+				arraylist_p al = (arraylist_p)list->list;
+				for (size_t i = 1; i < list->size; i++)
+					al->elements[i - 1] = al->elements[i];
+			}
+			if (take)
+				__element_detach(list->eslab, e);
+			else
+				__element_destroy(list->eslab, e);
+			list->size--;
+			list->changes++;
+		}
+	}
+	return ret;
+}
+
+/**
+ * @brief 按顺序把列表中的全部元素收集到数组中
+ *
+ * @param list
+ * 	列表
+ * @param a
+ * 	元素数组，长度不小于列表的元素数量
+ */
+static void __list_collect(list_p list, element_p *a)
+{
+	size_t n = 0;
+	if (list->ltype == LinkedList) {
+		for (ll_node_p node = ((linkedlist_p)list->list)->head; node; node = node->next)
+			a[n++] = node->element;
+	} else if (list->ltype == RingList) {
+		for (n = 0; n < list->size; n++)
+			a[n] = RL_AT((ringlist_p)list->list, n);
+	} else if (list->ltype == UnrolledList) {
+		for (ul_node_p node = ((unrolledlist_p)list->list)->head; node; node = node->next) {
+			memcpy(a + n, node->elements, node->count * sizeof(element_p));
+			n += node->count;
+		}
+	} else if (list->ltype == IndexedList) {
+		__indexedlist_collect(((indexedlist_p)list->list)->root, a, 0);
+	} else {
+		memcpy(a, ((arraylist_p)list->list)->elements, list->size * sizeof(element_p));
+	}
+}
+
+/**
+ * @brief 计算元素在索引中使用的哈希值，对哈希函数的结果再做一次混合，使低位也能均匀分布
+ *
+ * @param idx
+ * 	索引
+ * @param ele
+ * 	元素
+ *
+ * @return 
+ * 	哈希值
+ */
+static size_t __list_hash(list_idx_p idx, element_p ele)
+{
+	unsigned long long h = idx->hashfunc(ele->value, ele->len);
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	return (size_t)h;
+}
+
+/**
+ * @brief 为列表建立索引，列表设置了哈希函数或使用默认比较函数时建立哈希表，否则建立按比较函数排序的元素数组
+ * 索引直接引用列表中的元素，使用期间列表须保持加锁且不能修改
+ *
+ * @param list
+ * 	被索引的列表
+ * @param idx
+ * 	索引
+ */
+static void __list_idx_build(list_p list, list_idx_p idx)
+{
+	idx->list = list;
+	idx->hashfunc = list->hashfunc ? list->hashfunc : list->cmpfunc == __default_cmpfunc(list->etype) ? __default_hashfunc(list->etype) : NULL;
+	idx->slots = NULL;
+	idx->mask = 0;
+	idx->sorted = NULL;
+	element_p *a = (element_p *)__mr_malloc(&list->alloc, list->size * sizeof(element_p));
+	if (!a)
+		return;
+	__list_collect(list, a);
+	if (idx->hashfunc) {
+		size_t capa = IDX_MIN_CAPA;
+		while (capa < list->size * 2)
+			capa <<= 1;
+		if ((idx->slots = (idx_slot_p)__mr_malloc(&list->alloc, capa * sizeof(idx_slot_t)))) {
+			memset(idx->slots, 0, capa * sizeof(idx_slot_t));
+			idx->mask = capa - 1;
+			CmpFunc cmpfunc = list->cmpfunc;
+			for (size_t n = 0; n < list->size; n++) {
+				element_p e = a[n];
+				size_t h = __list_hash(idx, e);
+				size_t i = h & idx->mask;
+				while (idx->slots[i].element && (idx->slots[i].hash != h || cmpfunc(idx->slots[i].element->value, e->value, idx->slots[i].element->len, e->len) != 0))
+					i = (i + 1) & idx->mask;
+				if (!idx->slots[i].element) {		// 重复的元素只保留第一个
+					idx->slots[i].hash = h;
+					idx->slots[i].element = e;
+				}
+			}
+			__mr_free(&list->alloc, a);
+			return;
+		}
+	}
+	__arraylist_stablesort(a, list->size, NULL, Asc, list->cmpfunc, &list->alloc);
+	idx->sorted = a;
+}
+
+/**
+ * @brief 判断元素是否在索引的列表中存在，用被索引列表的比较函数判断是否相等
+ *
+ * @param idx
+ * 	索引
+ * @param ele
+ * 	元素
+ *
+ * @return 
+ * 	存在返回1，不存在返回0
+ */
+static int __list_idx_contains(list_idx_p idx, element_p ele)
+{
+	list_p list = idx->list;
+	CmpFunc cmpfunc = list->cmpfunc;
+	int ex;
+	if (idx->slots) {
+		size_t h = __list_hash(idx, ele);
+		for (size_t i = h & idx->mask; idx->slots[i].element; i = (i + 1) & idx->mask) {
+			element_p e = idx->slots[i].element;
+			if (idx->slots[i].hash == h && cmpfunc(e->value, ele->value, e->len, ele->len) == 0)
+				return 1;
+		}
+		return 0;
+	} else if (idx->sorted) {
+		size_t pos = __arraylist_bound(idx->sorted, 0, list->size, ele, 0, Asc, cmpfunc);
+		return pos < list->size && cmpfunc(idx->sorted[pos]->value, ele->value, idx->sorted[pos]->len, ele->len) == 0;
+	} else if (list->ltype == LinkedList) {
+		ex = __linkedlist_search((linkedlist_p)list->list, 0, Forward, list->size, ele, cmpfunc);
+	} else if (list->ltype == RingList) {
+		ex = __ringlist_search((ringlist_p)list->list, 0, Forward, list->size, ele, cmpfunc);
+	} else if (list->ltype == UnrolledList) {
+		ex = __unrolledlist_search((unrolledlist_p)list->list, 0, Forward, list->size, ele, cmpfunc);
+	} else if (list->ltype == IndexedList) {
+		ex = __indexedlist_search(((indexedlist_p)list->list)->root, 0, 0, Forward, ele, cmpfunc);
+	} else {
+		ex = __arraylist_search((arraylist_p)list->list, 0, Forward, list->size, ele, cmpfunc);
+	}
+	return ex != -1;
+}
+
+/**
+ * @brief 销毁索引，不销毁其中引用的元素
+ *
+ * @param idx
+ * 	索引
+ */
+static void __list_idx_destroy(list_idx_p idx)
+{
+	if (idx->slots)
+		__mr_free(&idx->list->alloc, idx->slots);
+	if (idx->sorted)
+		__mr_free(&idx->list->alloc, idx->sorted);
+}
+
+/**
+ * @brief 删除列表中所有在索引中存在（或不存在）的元素，只对列表做一遍扫描，保留的元素保持原有顺序，修改元素数量和变更次数
+ *
+ * @param list
+ * 	列表
+ * @param idx
+ * 	另一个列表的索引
+ * @param found
+ * 	为1时删除在索引中存在的元素，为0时删除不存在的元素
+ */
+static void __list_filter(list_p list, list_idx_p idx, int found)
+{
+	size_t count = 0;
+	size_t pos = 0;
+	if (list->ltype == LinkedList) {
+		linkedlist_p ll = (linkedlist_p)list->list;
+		ll_node_p node = ll->head;
+		while (node) {
+			ll_node_p n = node;
+			node = node->next;
+			if (__list_idx_contains(idx, n->element) == found) {
+				__linkedlist_node_plugout(ll, n);
+				__linkedlist_node_destroy(list, n);
+				count++;
+			}
+		}
+	} else if (list->ltype == RingList) {
+		ringlist_p rl = (ringlist_p)list->list;
+		for (pos = 0; pos < list->size; pos++) {
+			element_p e = RL_AT(rl, pos);
+			if (__list_idx_contains(idx, e) == found) {
+				__element_destroy(list->eslab, e);
+				count++;
+			} else if (count) {
+				RL_AT(rl, pos - count) = e;
+			}
+		}
+	} else if (list->ltype == UnrolledList) {
+		unrolledlist_p ul = (unrolledlist_p)list->list;
+		ul_node_p node = ul->head;
+		while (node) {
+			size_t keep = 0;
+			for (size_t i = 0; i < node->count; i++) {
+				element_p e = node->elements[i];
+				if (__list_idx_contains(idx, e) == found) {
+					__element_destroy(list->eslab, e);
+					count++;
+				} else {
+					node->elements[keep++] = e;
+				}
+			}
+			node->count = keep;
+			ul_node_p n = node;
+			node = node->next;
+			if (keep == 0)
+				__unrolledlist_node_plugout(list, n);
+		}
+		ul->finger = NULL;
+		ul->fbase = 0;
+	} else if (list->ltype == IndexedList) {
+		indexedlist_p il = (indexedlist_p)list->list;
+		while (pos < list->size - count) {
+			element_p e = __indexedlist_goto(il->root, pos)->element;
+			if (__list_idx_contains(idx, e) == found) {
+				il->root = __indexedlist_node_del(list, il->root, pos, &e);
+				__element_destroy(list->eslab, e);
+				count++;
+			} else {
+				pos++;
+			}
+		}
+	} else {
+		arraylist_p al = (arraylist_p)list->list;
+		for (pos = 0; pos < list->size; pos++) {
+			element_p e = al->elements[pos];
+			if (__list_idx_contains(idx, e) == found) {
+				__element_destroy(list->eslab, e);
+				count++;
+			} else if (count) {
+				al->elements[pos - count] = e;
+			}
+		}
+	}
+	if (count) {
+		list->size -= count;
+		list->changes++;
+	}
+}
+
+/**
+ * @brief 按指定的排序方法对列表排序，有序模式下同时更新列表的排列顺序，修改变更次数
  *
  * @param list
- * 	列表容器
- * @param dir
- * 	迭代方向
+ * 	列表
+ * @param order
+ * 	排序顺序
+ * @param method
+ * 	排序方法，SORT_QUICK、SORT_INSERT、SORT_STABLE或SORT_RADIX
+ */
+static void __list_sort(list_p list, int order, int method)
+{
+	if (list->sorted)
+		list->sorted = order;
+	if (list->size < 2)
+		return;
+	if (list->ltype == LinkedList) {
+		if (method == SORT_INSERT)
+			__linkedlist_insertsort(((linkedlist_p)list->list)->head, ((linkedlist_p)list->list)->tail, order, list->cmpfunc);
+		else if ((method != SORT_RADIX && list->size < SORT_RADIX_MIN) || __linkedlist_radixsort(list, order) != 0)
+			__linkedlist_mergesort((linkedlist_p)list->list, order, list->cmpfunc);
+	} else if (list->ltype == RingList) {
+		__arraylist_sort(list, __ringlist_linearize((ringlist_p)list->list), order, method);
+	} else if (list->ltype == UnrolledList) {
+		__unrolledlist_sort(list, order, method);
+	} else if (list->ltype == IndexedList) {
+		__indexedlist_sort(list, order, method);
+	} else {
+		__arraylist_sort(list, ((arraylist_p)list->list)->elements, order, method);
+	}
+	list->changes++;
+}
+
+/**
+ * @brief 获取有序列表的排列顺序，有序模式下即为设定的顺序，否则比较首尾两个元素来判断
+ *
+ * @param list
+ * 	列表
  *
  * @return 
- * 	列表迭代器
+ * 	Asc或Desc
  */
-static list_it_p __list_iterator(list_p list, int dir)
+static int __list_order(list_p list)
 {
-	list_it_p it = (list_it_p)malloc(sizeof(list_it_t));
-	if (it) {
-		it->list = list;
-		if (list->ltype == LinkedList)
-			it->pos.node = dir == Reverse ? ((linkedlist_p)list->list)->tail : ((linkedlist_p)list->list)->head;
-		else
-			it->pos.index = dir == Reverse ? list->size - 1 : 0;
-		it->dir = dir;
-		it->removable = 0;
-		it->changes = list->changes;
-	}
-	return it;
+	if (list->sorted)
+		return list->sorted;
+	if (list->size < 2)
+		return Asc;
+	element_p first = __list_element_at(list, 0);
+	element_p last = __list_element_at(list, list->size - 1);
+	return list->cmpfunc(first->value, last->value, first->len, last->len) > 0 ? Desc : Asc;
 }
 
 /**
- * @brief 迭代访问下一个元素
+ * @brief 在有序列表中查找元素的插入位置，链表顺序查找，其他列表二分查找
  *
- * @param it
- * 	迭代器
+ * @param list
+ * 	列表，须已按order排序
+ * @param ele
+ * 	元素
+ * @param upper
+ * 	非0时返回第一个排在ele之后的位置，否则返回第一个不排在ele之前的位置
+ * @param order
+ * 	排序顺序
  *
  * @return 
- * 	下一个元素，迭代结束后返回NULL直到迭代器被重置，迭代时发现Fast-Fail时将迭代器置为迭代结束状态并返回NULL
+ * 	插入位置，0到列表元素数量之间
  */
-static Element __list_it_next(void *it)
+static size_t __list_bound(list_p list, element_p ele, int upper, int order)
 {
-	Element ret = NULL;
-	if (it && ((list_it_p)it)->list) {
-		list_it_p i = (list_it_p)it;
-		list_p l = i->list;
-		pthread_mutex_lock(&l->mut);
-		if (i->changes != l->changes) {
-			if (l->ltype == LinkedList)
-				i->pos.node = NULL;
+	CmpFunc cmpfunc = list->cmpfunc;
+	size_t lo = 0;
+	if (list->ltype == LinkedList) {
+		for (ll_node_p node = ((linkedlist_p)list->list)->head; node; node = node->next, lo++) {
+			int cmp = ORDER_CMP(node->element, ele);
+			if (cmp > 0 || (!upper && cmp == 0))
+				break;
+		}
+	} else if (list->ltype == ArrayList) {
+		lo = __arraylist_bound(((arraylist_p)list->list)->elements, 0, list->size, ele, upper, order, cmpfunc);
+	} else {
+		size_t hi = list->size;
+		while (lo < hi) {
+			size_t mid = lo + (hi - lo) / 2;
+			int cmp = ORDER_CMP(__list_element_at(list, mid), ele);
+			if (cmp < 0 || (upper && cmp == 0))
+				lo = mid + 1;
 			else
-				i->pos.index = i->dir == Reverse ? -1 : l->size;
+				hi = mid;
+		}
+	}
+	return lo;
+}
+
+/**
+ * @brief 预留容纳capacity个元素的空间，只对线性表和环形线性表有效，其他列表按需分配节点，不需要预留
+ * 环形线性表的容量总是2的幂，扩容前先把元素旋转为从数组头部开始连续存放
+ *
+ * @param list
+ * 	列表
+ * @param capacity
+ * 	预留的元素数量，不大于现有容量时不做任何操作
+ *
+ * @return 
+ * 	预留成功返回0，分配失败返回-1
+ */
+static int __list_reserve(list_p list, size_t capacity)
+{
+	if (list->ltype == ArrayList) {
+		arraylist_p al = (arraylist_p)list->list;
+		if (capacity > al->capacity) {
+			element_p *nl = (element_p *)__mr_realloc(&list->alloc, al->elements, capacity * sizeof(element_p));
+			if (!nl)
+				return -1;
+			al->elements = nl;
+			al->capacity = capacity;
 		}
-		if (l->ltype == LinkedList && i->pos.node) {
-			ret = __element_clone_value(i->pos.node->element);
-			i->pos.node = i->dir == Reverse ? i->pos.node->prev : i->pos.node->next;
-			i->removable = 1;
-		} else if (l->ltype == ArrayList && i->pos.index >= 0 && i->pos.index < l->size) {
-			ret = __element_clone_value(((arraylist_p)l->list)->elements[i->pos.index]);
-			i->pos.index = i->dir == Reverse ? i->pos.index - 1 : i->pos.index + 1;
-			i->removable = 1;
+	} else if (list->ltype == RingList) {
+		ringlist_p rl = (ringlist_p)list->list;
+		if (capacity > rl->capacity) {
+			size_t nc = rl->capacity;
+			while (nc < capacity)
+				nc *= 2;
+			element_p *nl = (element_p *)__mr_realloc(&list->alloc, __ringlist_linearize(rl), nc * sizeof(element_p));
+			if (!nl)
+				return -1;
+			rl->elements = nl;
+			rl->capacity = nc;
 		}
-		pthread_mutex_unlock(&l->mut);
 	}
-	return ret;
+	return 0;
 }
 
 /**
- * @brief 删除上一次迭代得到的元素，没有迭代过的初始迭代器或连续调用都不会删除任何元素
+ * @brief 按元素值数组批量创建元素，元素值数组的约定见__element_array_at()
  *
- * @param it
- * 	迭代器
+ * @param list
+ * 	列表，元素从列表的slab中分配
+ * @param values
+ * 	元素值数组
+ * @param count
+ * 	元素数量，须大于0
+ * @param type
+ * 	元素类型
+ * @param len
+ * 	元素长度
  *
  * @return 
- * 	删除的元素数量，0或1
+ * 	创建的元素数组，由列表的分配器分配；任何一个元素创建失败时销毁已创建的元素并返回NULL
  */
-static size_t __list_it_remove(void *it)
+static element_p *__list_elements_create(list_p list, const void *values, size_t count, ElementType type, size_t len)
 {
-	size_t count = 0;
-	if (it && ((list_it_p)it)->list && ((list_it_p)it)->removable) {
-		list_it_p i = (list_it_p)it;
-		list_p l = i->list;
-		pthread_mutex_lock(&l->mut);
-		if (l->ltype == LinkedList) {
-			linkedlist_p ll = (linkedlist_p)l->list;
-			ll_node_p n = i->dir == Reverse ? (i->pos.node ? i->pos.node->next : ll->head) : (i->pos.node ? i->pos.node->prev : ll->tail);
-			__linkedlist_node_plugout(ll, n);
-			__linkedlist_node_destroy(n);
-		} else {
-			element_p *a = ((arraylist_p)l->list)->elements;
-			int dpos = i->dir == Reverse ? i->pos.index + 1 : i->pos.index - 1;
-			__element_destroy(a[dpos]);
-			for (int p = dpos + 1; p < l->size; p++)
-				a[p - 1] = a[p];
-			if (i->dir != Reverse)
-				i->pos.index--;
+	element_p *a = (element_p *)__mr_malloc(&list->alloc, count * sizeof(element_p));
+	if (!a)
+		return NULL;
+	for (size_t i = 0; i < count; i++) {
+		size_t elen;
+		Element v = __element_array_at(values, i, type, len, &elen);
+		if (!v || !(a[i] = __element_create(list->eslab, v, type, elen))) {
+			while (i > 0)
+				__element_destroy(list->eslab, a[--i]);
+			__mr_free(&list->alloc, a);
+			return NULL;
 		}
-		i->removable = 0;
-		l->size--;
-		l->changes++;
-		i->changes++;
-		count++;
-		pthread_mutex_unlock(&l->mut);
 	}
-	return count;
+	return a;
 }
 
 /**
- * @brief 重置迭代器
+ * @brief 在列表第index个位置批量插入n个元素，插入时直接引用元素，修改元素数量和变更次数，调用前须对列表加锁
+ * 线性表和环形线性表一次预留空间、一次移动后续元素；链表先创建好全部节点，找到插入位置后整串接入；其他列表逐个插入
  *
- * @param it
- * 	迭代器
+ * @param list
+ * 	列表
+ * @param index
+ * 	插入位置，超过表尾的添加在尾部
+ * @param a
+ * 	元素数组
+ * @param n
+ * 	元素数量
+ *
+ * @return 
+ * 	插入成功返回0，失败返回-1，失败时列表不变，元素由调用者负责销毁
  */
-static void __list_it_reset(void *it)
+static int __list_insert_array(list_p list, size_t index, element_p *a, size_t n)
 {
-	if (it && ((list_it_p)it)->list) {
-		list_it_p i = (list_it_p)it;
-		pthread_mutex_lock(&i->list->mut);
-		if (i->list->ltype == LinkedList)
-			i->pos.node = i->dir == Reverse ? ((linkedlist_p)i->list->list)->tail : ((linkedlist_p)i->list->list)->head;
+	if (index > list->size)
+		index = list->size;
+	if (list->ltype == ArrayList || list->ltype == RingList) {
+		if (__list_reserve(list, list->size + n) != 0)
+			return -1;
+		ringlist_p rl = (ringlist_p)list->list;
+		if (list->ltype == RingList && index == list->size) {
+			for (size_t i = 0; i < n; i++)
+				RL_AT(rl, list->size + i) = a[i];	// 在尾部添加时不需要移动元素
+		} else {
+			element_p *base = list->ltype == RingList ? __ringlist_linearize(rl) : ((arraylist_p)list->list)->elements;
+			memmove(base + index + n, base + index, (list->size - index) * sizeof(element_p));
+			memcpy(base + index, a, n * sizeof(element_p));
+		}
+		list->size += n;
+	} else if (list->ltype == LinkedList) {
+		linkedlist_p ll = (linkedlist_p)list->list;
+		ll_node_p first = NULL, last = NULL;
+		for (size_t i = 0; i < n; i++) {
+			ll_node_p node = __linkedlist_node_create(list, a[i]);
+			if (!node) {
+				while (first) {
+					node = first;
+					first = first->next;
+					node->element = NULL;		// 元素仍归调用者所有，只销毁节点
+					__linkedlist_node_destroy(list, node);
+				}
+				return -1;
+			}
+			node->prev = last;
+			if (last)
+				last->next = node;
+			else
+				first = node;
+			last = node;
+		}
+		ll_node_p pos = __linkedlist_goto(ll, list->size, index);
+		last->next = pos;
+		first->prev = pos ? pos->prev : ll->tail;
+		if (first->prev)
+			first->prev->next = first;
 		else
-			i->pos.index = i->dir == Reverse ? i->list->size - 1 : 0;
-		i->changes = i->list->changes;
-		i->removable = 0;
-		pthread_mutex_unlock(&i->list->mut);
+			ll->head = first;
+		if (pos)
+			pos->prev = last;
+		else
+			ll->tail = last;
+		list->size += n;
+	} else {
+		for (size_t i = 0; i < n; i++) {
+			int ret = list->ltype == UnrolledList ? __unrolledlist_ins(list, index + i, a[i]) : __indexedlist_ins(list, index + i, a[i]);
+			if (ret != 0) {
+				while (i-- > 0) {			// 取出已经插入的元素，恢复插入前的状态
+					element_p e;
+					if (list->ltype == UnrolledList)
+						__unrolledlist_detach(list, index);
+					else
+						((indexedlist_p)list->list)->root = __indexedlist_node_del(list, ((indexedlist_p)list->list)->root, index, &e);
+					list->size--;
+				}
+				return -1;
+			}
+			list->size++;
+		}
 	}
+	list->changes++;
+	return 0;
 }
 
 /**
- * @brief 销毁迭代器
+ * @brief 判断src的元素和节点能否不经复制直接转移给dst，两个列表都没有启用slab模式且使用相同的分配器时才可以
  *
- * @param it
- * 	迭代器
+ * @param dst
+ * 	目标列表
+ * @param src
+ * 	源列表
+ *
+ * @return 
+ * 	可以直接转移返回1，否则返回0
  */
-static void __list_it_destroy(void *it)
+static int __list_movable(list_p dst, list_p src)
 {
-	free(it);
+	return !SLAB_ACTIVE(dst->eslab) && !SLAB_ACTIVE(dst->nslab) && !SLAB_ACTIVE(src->eslab) && !SLAB_ACTIVE(src->nslab) &&
+		dst->alloc.malloc_fn == src->alloc.malloc_fn && dst->alloc.realloc_fn == src->alloc.realloc_fn &&
+		dst->alloc.free_fn == src->alloc.free_fn && dst->alloc.ctx == src->alloc.ctx;
 }
 
 /**
- * @brief 获取位置pos上的元素
+ * @brief 把索引树子树中所有节点的元素置为NULL，节点随后销毁时不再销毁元素
+ *
+ * @param node
+ * 	子树的根节点
+ */
+static void __indexedlist_forget(il_node_p node)
+{
+	for (; node; node = node->right) {
+		__indexedlist_forget(node->left);
+		node->element = NULL;
+	}
+}
+
+/**
+ * @brief 清空列表但不销毁其中的元素，用于元素已经转移给其他列表之后，先断开节点对元素的引用再按通常的方式清空
  *
  * @param list
- * 	列表
- * @param pos
- * 	位置
+ * 	列表，不能处于slab模式
+ */
+static void __list_forget(list_p list)
+{
+	if (list->ltype == LinkedList) {
+		for (ll_node_p node = ((linkedlist_p)list->list)->head; node; node = node->next)
+			node->element = NULL;
+	} else if (list->ltype == UnrolledList) {
+		for (ul_node_p node = ((unrolledlist_p)list->list)->head; node; node = node->next)
+			node->count = 0;
+	} else if (list->ltype == IndexedList) {
+		__indexedlist_forget(((indexedlist_p)list->list)->root);
+	} else {
+		list->size = 0;			// 线性表和环形线性表按元素数量逐个销毁元素
+	}
+	__list_clear(list);
+}
+
+/**
+ * @brief 把src的全部元素按顺序移到dst的第index个位置，src被清空，修改两个列表的元素数量和变更次数，调用前须对两个列表加锁
+ * 可以直接转移时不复制元素：dst为空且类型相同时交换两者的存储结构；两者都是链表时把src的节点整串接入；
+ * 其他情况一次收集src的元素指针后批量插入，线性表和环形线性表只需一次预留空间和一次块移动
+ * 不能直接转移时（slab模式或分配器不同）在dst中复制元素后清空src
+ *
+ * @param dst
+ * 	目标列表
+ * @param index
+ * 	插入位置，超过表尾的添加在尾部
+ * @param src
+ * 	源列表，不能与dst相同
  *
  * @return 
- * 	位置pos上的元素或NULL
+ * 	成功返回0，分配失败返回-1，失败时两个列表都不变
  */
-static element_p __list_get_at(list_p list, list_pos_t pos)
+static int __list_transfer(list_p dst, size_t index, list_p src)
 {
-	if (list->ltype == LinkedList)
-		return pos.node ? pos.node->element : NULL;
-	else
-		return (pos.index >= 0 && pos.index < list->size) ? ((arraylist_p)list->list)->elements[pos.index] : NULL;
+	size_t n = src->size;
+	if (n == 0)
+		return 0;
+	int movable = __list_movable(dst, src);
+	if (movable && dst->size == 0 && dst->ltype == src->ltype) {
+		void *temp = dst->list;
+		dst->list = src->list;
+		src->list = temp;
+		dst->size = n;
+		dst->changes++;
+		src->size = 0;
+	} else if (movable && dst->ltype == LinkedList && src->ltype == LinkedList) {
+		linkedlist_p dl = (linkedlist_p)dst->list;
+		linkedlist_p sl = (linkedlist_p)src->list;
+		ll_node_p pos = __linkedlist_goto(dl, dst->size, index);
+		sl->tail->next = pos;
+		sl->head->prev = pos ? pos->prev : dl->tail;
+		if (sl->head->prev)
+			sl->head->prev->next = sl->head;
+		else
+			dl->head = sl->head;
+		if (pos)
+			pos->prev = sl->tail;
+		else
+			dl->tail = sl->tail;
+		sl->head = NULL;
+		sl->tail = NULL;
+		dst->size += n;
+		dst->changes++;
+		src->size = 0;
+	} else {
+		element_p *a = (element_p *)__mr_malloc(&dst->alloc, n * sizeof(element_p));
+		if (!a)
+			return -1;
+		__list_collect(src, a);
+		for (size_t i = 0; !movable && i < n; i++) {
+			element_p e = __element_clone(dst->eslab, a[i]);
+			if (!e) {
+				while (i > 0)
+					__element_destroy(dst->eslab, a[--i]);
+				__mr_free(&dst->alloc, a);
+				return -1;
+			}
+			a[i] = e;
+		}
+		if (__list_insert_array(dst, index, a, n) != 0) {
+			for (size_t i = 0; !movable && i < n; i++)
+				__element_destroy(dst->eslab, a[i]);
+			__mr_free(&dst->alloc, a);
+			return -1;
+		}
+		__mr_free(&dst->alloc, a);
+		if (movable)
+			__list_forget(src);
+		else
+			__list_clear(src);
+	}
+	src->changes++;
+	return 0;
+}
+
+/**
+ * @brief 重新链接节点，合并链表中相邻的两段有序序列[head, mid)和[mid, tail]，相等时前一段的元素在前，不分配内存
+ *
+ * @param ll
+ * 	链表
+ * @param mid
+ * 	后一段的第一个节点，不能是头节点
+ * @param order
+ * 	排序顺序
+ * @param cmpfunc
+ * 	比较函数
+ */
+static void __linkedlist_merge(linkedlist_p ll, ll_node_p mid, int order, CmpFunc cmpfunc)
+{
+	if (ORDER_CMP(mid->prev->element, mid->element) <= 0)
+		return;						// 两段已经有序
+	ll_node_p a = ll->head, b = mid, last = NULL;
+	ll_node_p atail = mid->prev, btail = ll->tail;
+	atail->next = NULL;
+	while (a && b) {
+		ll_node_p node;
+		if (ORDER_CMP(b->element, a->element) < 0) {
+			node = b;
+			b = b->next;
+		} else {
+			node = a;
+			a = a->next;
+		}
+		node->prev = last;
+		if (last)
+			last->next = node;
+		else
+			ll->head = node;
+		last = node;
+	}
+	last->next = a ? a : b;
+	last->next->prev = last;
+	ll->tail = a ? atail : btail;
 }
 
 /**
- * @brief 删除位置pos上的元素
+ * @brief 合并列表中各自按order有序的两段[0, mid)和[mid, size)，使全部元素有序，相等时前一段的元素在前，时间为O(n + m)
+ * 链表重新链接节点；线性表和环形线性表用较短一段长度的缓冲区原地合并；展开链表和索引树收集元素合并后按原顺序写回
+ * 临时空间分配失败时退化为稳定排序
  *
  * @param list
  * 	列表
- * @param pos
- * 	位置
+ * @param mid
+ * 	后一段的起始位置
+ * @param order
+ * 	排序顺序
  */
-static void __list_del_at(list_p list, list_pos_p pos)
+static void __list_merge_at(list_p list, size_t mid, int order)
 {
+	size_t size = list->size;
+	if (mid == 0 || mid >= size)
+		return;
 	if (list->ltype == LinkedList) {
-		ll_node_p n = pos->node;
-		pos->node = pos->node->next;
-		__linkedlist_node_plugout((linkedlist_p)list->list, n);
-		__linkedlist_node_destroy(n);
+		linkedlist_p ll = (linkedlist_p)list->list;
+		__linkedlist_merge(ll, __linkedlist_goto(ll, size, mid), order, list->cmpfunc);
+		list->changes++;
+		return;
+	}
+	size_t n = mid < size - mid ? mid : size - mid;
+	int gather = list->ltype == UnrolledList || list->ltype == IndexedList;
+	element_p *buf = (element_p *)__mr_malloc(&list->alloc, n * sizeof(element_p));
+	element_p *a = buf && gather ? (element_p *)__mr_malloc(&list->alloc, size * sizeof(element_p)) : NULL;
+	if (!buf || (gather && !a)) {
+		__mr_free(&list->alloc, buf);
+		__list_sort(list, order, SORT_STABLE);
+		return;
+	}
+	if (list->ltype == ArrayList) {
+		__arraylist_merge(((arraylist_p)list->list)->elements, 0, mid, size, buf, order, list->cmpfunc);
+	} else if (list->ltype == RingList) {
+		__arraylist_merge(__ringlist_linearize((ringlist_p)list->list), 0, mid, size, buf, order, list->cmpfunc);
 	} else {
-		element_p *a = ((arraylist_p)list->list)->elements;
-		__element_destroy(a[pos->index]);
-		for (int i = pos->index + 1; i < list->size; i++)
-			a[i - 1] = a[i];
+		__list_collect(list, a);
+		__arraylist_merge(a, 0, mid, size, buf, order, list->cmpfunc);
+		if (list->ltype == IndexedList) {
+			__indexedlist_collect(((indexedlist_p)list->list)->root, a, 1);
+		} else {
+			size_t i = 0;
+			for (ul_node_p node = ((unrolledlist_p)list->list)->head; node; node = node->next) {
+				memcpy(node->elements, a + i, node->count * sizeof(element_p));
+				i += node->count;
+			}
+		}
+		__mr_free(&list->alloc, a);
 	}
-	list->size--;
+	__mr_free(&list->alloc, buf);
 	list->changes++;
 }
 
 /**
- * @brief 在列表最后添加一个元素，添加时复制元素而非引用元素
+ * @brief 删除列表中位置在[from, to)之间的元素，不修改元素数量和变更次数，调用前须对列表加锁
+ * 线性表一次移动后续元素完成压缩；环形线性表移动删除范围前后两侧中较短的一侧；链表找到起点后逐个摘除节点
  *
  * @param list
  * 	列表
- * @param ele
- * 	元素
+ * @param from
+ * 	范围的起点
+ * @param to
+ * 	范围的终点（不含），调用前须确保from < to <= 元素数量
+ *
+ * @return 
+ * 	删除的元素数量
  */
-static void __list_append(list_p list, element_p ele)
+static size_t __list_remove_range(list_p list, size_t from, size_t to)
 {
-	element_p e = __element_create(ele->value, ele->type, ele->len);
-	if (!e)
-		return;
-	if (list->ltype == LinkedList) {
-		ll_node_p n = __linkedlist_node_create(e);
-		if (!n)
-			return;
-		((linkedlist_p)list->list)->tail->next = n;
-		n->prev = ((linkedlist_p)list->list)->tail;
-		((linkedlist_p)list->list)->tail = n;
+	size_t n = to - from;
+	if (list->ltype == ArrayList) {
+		element_p *a = ((arraylist_p)list->list)->elements;
+		for (size_t i = from; i < to; i++)
+			__element_destroy(list->eslab, a[i]);
+		memmove(a + from, a + to, (list->size - to) * sizeof(element_p));
+	} else if (list->ltype == RingList) {
+		ringlist_p rl = (ringlist_p)list->list;
+		for (size_t i = from; i < to; i++)
+			__element_destroy(list->eslab, RL_AT(rl, i));
+		if (from < list->size - to) {
+			for (size_t i = from; i > 0; i--)
+				RL_AT(rl, i - 1 + n) = RL_AT(rl, i - 1);
+			rl->head = (rl->head + n) & (rl->capacity - 1);
+		} else {
+			for (size_t i = to; i < list->size; i++)
+				RL_AT(rl, i - n) = RL_AT(rl, i);
+		}
+	} else if (list->ltype == LinkedList) {
+		linkedlist_p ll = (linkedlist_p)list->list;
+		ll_node_p node = __linkedlist_goto(ll, list->size, from);
+		for (size_t i = 0; i < n; i++) {
+			ll_node_p next = node->next;
+			__linkedlist_node_plugout(ll, node);
+			__linkedlist_node_destroy(list, node);
+			node = next;
+		}
+	} else if (list->ltype == UnrolledList) {
+		for (size_t i = 0; i < n; i++) {
+			__element_destroy(list->eslab, __unrolledlist_detach(list, from));
+			list->size--;				// 展开链表按元素数量定位节点，逐个删除时须同步修改
+		}
+		list->size += n;
 	} else {
-		arraylist_p al = (arraylist_p)list->list;
-		if (list->size <  al->capacity || __arraylist_expand(al) == 0)
-			al->elements[list->size] = e;
+		for (size_t i = 0; i < n; i++) {
+			element_p e;
+			((indexedlist_p)list->list)->root = __indexedlist_node_del(list, ((indexedlist_p)list->list)->root, from, &e);
+			__element_destroy(list->eslab, e);
+		}
 	}
-	list->size++;
-	list->changes++;
+	return n;
+}
+
+/**
+ * @brief 为只读操作对列表加锁，读写锁策略下加共享锁
+ * 展开链表按位置定位元素时会移动finger，只读操作也会修改列表结构，因此总是加独占锁
+ *
+ * @param list
+ * 	列表
+ */
+static void __list_rdlock(list_p list)
+{
+	if (list->ltype == UnrolledList)
+		__lock_wrlock(&list->lock);
+	else
+		__lock_rdlock(&list->lock);
+}
+
+/**
+ * @brief 为修改操作对列表加独占锁
+ *
+ * @param list
+ * 	列表
+ */
+static void __list_wrlock(list_p list)
+{
+	__lock_wrlock(&list->lock);
+}
+
+/**
+ * @brief 对两个不同的列表按地址顺序加锁，展开链表的只读操作也要移动finger，因此与__list_rdlock()一样总是加独占锁
+ *
+ * @param a
+ * 	列表
+ * @param wa
+ * 	非0时对a加独占锁，0时加共享锁
+ * @param b
+ * 	另一个列表
+ * @param wb
+ * 	非0时对b加独占锁，0时加共享锁
+ */
+static void __list_lock_pair(list_p a, int wa, list_p b, int wb)
+{
+	__lock_pair(&a->lock, wa || a->ltype == UnrolledList, &b->lock, wb || b->ltype == UnrolledList);
+}
+
+/**
+ * @brief 对列表解锁，解锁前检查是否有阻塞等待的线程可以继续执行，有则唤醒其中一个
+ * 被唤醒的线程完成操作后解锁时会再次检查，因此一次添加或删除多个元素时等待的线程也能依次被唤醒
+ *
+ * @param list
+ * 	列表
+ */
+static void __list_unlock(list_p list)
+{
+	if (list->rwait && (list->size > 0 || list->closed))
+		pthread_cond_signal(&list->notempty);
+	if (list->wwait && (!list->bound || list->size < list->bound || list->closed))
+		pthread_cond_signal(&list->notfull);
+	__lock_unlock(&list->lock);
+}
+
+/**
+ * @brief 在列表的条件变量上等待一次，调用前须对列表加锁，等待期间暂时解锁
+ *
+ * @param list
+ * 	列表
+ * @param cond
+ * 	条件变量
+ * @param waiters
+ * 	在该条件变量上等待的线程数量
+ * @param deadline
+ * 	等待的截止时间，NULL表示一直等待
+ *
+ * @return 
+ * 	被唤醒返回0，超时返回ETIMEDOUT；调用者须先用LIST_CAN_WAIT确认加锁策略为互斥锁
+ */
+static int __list_wait(list_p list, pthread_cond_t *cond, int *waiters, const struct timespec *deadline)
+{
+	int ret;
+	pthread_mutex_t *mut = __lock_mutex(&list->lock);
+	if (!mut)
+		return ETIMEDOUT;	// 公开的阻塞函数已拒绝其他加锁策略，这里只是防御
+	(*waiters)++;
+	ret = deadline ? pthread_cond_timedwait(cond, mut, deadline) : pthread_cond_wait(cond, mut);
+	(*waiters)--;
+	return ret;
 }
 
+/**
+ * @brief 计算限时等待的截止时间，以单调时钟计
+ *
+ * @param ts
+ * 	保存截止时间的结构
+ * @param msec
+ * 	等待的毫秒数，小于0表示一直等待
+ *
+ * @return 
+ * 	截止时间，一直等待时返回NULL
+ */
+static struct timespec *__list_deadline(struct timespec *ts, long msec)
+{
+	if (msec < 0)
+		return NULL;
+	clock_gettime(CLOCK_MONOTONIC, ts);
+	ts->tv_sec += msec / 1000;
+	ts->tv_nsec += (msec % 1000) * 1000000;
+	if (ts->tv_nsec >= 1000000000) {
+		ts->tv_sec++;
+		ts->tv_nsec -= 1000000000;
+	}
+	return ts;
+}
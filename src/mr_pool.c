@@ -3,6 +3,8 @@
 
 #include "mr_pool.h"
 #include "private_element.h"
+#include "private_alloc.h"
+#include "private_lock.h"
 
 #define IS_VALID_POOL(X) (X && X->container && X->type == Pool)
 
@@ -17,16 +19,23 @@ typedef struct {					// 池结构
 	size_t init_capa;				// 初始池容量
 	size_t size;					// 当前元素数量
 	idle_node_p next_idle;				// 空闲句柄链栈头指针
-	pthread_mutex_t mut;				// 共享锁
+	lock_t lock;					// 锁，按创建属性指定的加锁策略选用
+	Allocator_t alloc;				// 内存分配器
+	slab_p eslab;					// 元素slab，始终不启用，只转交分配器
 } pool_t, *pool_p;
 
-static Container __pool_create(size_t capacity);				// 创建一个池并封装成Container
+static Container __pool_create(size_t capacity, ContainerAttr attr);		// 创建一个池并封装成Container
 static PoolNodeHandler __pool_retrieve(pool_p pool, element_p element);		// 托管一个新的元素
-static size_t __pool_release(pool_p pool, PoolNodeHandler handler);		// 释放一个池节点
+static element_p __pool_release(pool_p pool, PoolNodeHandler handler);		// 释放一个池节点并返回其中的元素，调用前须加锁
 
 Container pool_create(size_t capacity)
 {
-	return __pool_create(capacity > 9 ? capacity : 10);
+	return __pool_create(capacity > 9 ? capacity : 10, NULL);
+}
+
+Container pool_create_ex(size_t capacity, ContainerAttr attr)
+{
+	return __pool_create(capacity > 9 ? capacity : 10, attr);
 }
 
 int pool_destroy(Container pool)
@@ -34,19 +43,21 @@ int pool_destroy(Container pool)
 	int ret = -1;
 	if (IS_VALID_POOL(pool)) {
 		pool_p p = (pool_p)pool->container;
-		pthread_mutex_lock(&p->mut);
+		Allocator_t alloc = p->alloc;
+		__lock_wrlock(&p->lock);
 		while (p->next_idle) {
 			idle_node_p next = p->next_idle->next;
-			free(p->next_idle);
+			__mr_free(&alloc, p->next_idle);
 			p->next_idle = next;
 		}
 		for (size_t i = 0; i < p->capacity; i++)
-			__element_destroy(p->elements[i]);
-		free(p->elements);
-		pthread_mutex_unlock(&p->mut);
-		pthread_mutex_destroy(&p->mut);
-		free(p);
-		free(pool);
+			__element_destroy(p->eslab, p->elements[i]);
+		__mr_free(&alloc, p->elements);
+		__slab_destroy(p->eslab);
+		__lock_unlock(&p->lock);
+		__lock_destroy(&p->lock);
+		__mr_free(&alloc, p);
+		__mr_free(&alloc, pool);
 		ret = 0;
 	}
 	return ret;
@@ -71,36 +82,108 @@ PoolNodeHandler pool_retrieve(Container pool, Element element, ElementType type,
 {
 	PoolNodeHandler handler = -1;
 	element_p ele = NULL;
-	if (IS_VALID_POOL(pool) && element && len && (ele = __element_create(element, type, len)))
-		if((handler = __pool_retrieve((pool_p)pool->container, __element_create(element, type, len))) == -1)
-			__element_destroy(ele);
+	if (IS_VALID_POOL(pool) && element && len && (ele = __element_create(((pool_p)pool->container)->eslab, element, type, len)))
+		if ((handler = __pool_retrieve((pool_p)pool->container, ele)) == -1)
+			__element_destroy(((pool_p)pool->container)->eslab, ele);
+	return handler;
+}
+
+PoolNodeHandler pool_retrieve_adopt(Container pool, Element element, ElementType type, size_t len)
+{
+	PoolNodeHandler handler = -1;
+	element_p ele = NULL;
+	if (IS_VALID_POOL(pool) && (ele = __element_adopt(((pool_p)pool->container)->eslab, element, type, len)))
+		if ((handler = __pool_retrieve((pool_p)pool->container, ele)) == -1)
+			__element_detach(((pool_p)pool->container)->eslab, ele);
 	return handler;
 }
 
 size_t pool_release(Container pool, PoolNodeHandler handler)
 {
 	size_t ret = 0;
-	if (IS_VALID_POOL(pool) && handler >= 0 && handler < ((pool_p)pool->container)->capacity)
-		ret = __pool_release((pool_p)pool->container, handler);
+	element_p e = NULL;
+	if (IS_VALID_POOL(pool) && handler >= 0 && handler < ((pool_p)pool->container)->capacity) {
+		pool_p p = (pool_p)pool->container;
+		__lock_wrlock(&p->lock);
+		e = __pool_release(p, handler);
+		__lock_unlock(&p->lock);
+		if (e) {
+			__element_destroy(p->eslab, e);
+			ret = 1;
+		}
+	}
+	return ret;
+}
+
+Element pool_release_take(Container pool, PoolNodeHandler handler)
+{
+	Element ret = NULL;
+	element_p e = NULL;
+	if (IS_VALID_POOL(pool) && handler >= 0 && handler < ((pool_p)pool->container)->capacity) {
+		pool_p p = (pool_p)pool->container;
+		__lock_wrlock(&p->lock);
+		if ((e = p->elements[handler]) && ((ret = __element_prepare_take(p->eslab, e)) || !e->value)) {	// 先取值再释放节点，任何一步失败时元素都留在池中
+			if (__pool_release(p, handler)) {
+				__element_detach(p->eslab, e);
+			} else {
+				__element_cancel_take(p->eslab, e, ret);
+				ret = NULL;
+			}
+		}
+		__lock_unlock(&p->lock);
+	}
 	return ret;
 }
 
 Element pool_get(Container pool, PoolNodeHandler handler)
 {
 	Element element = NULL;
-	if (IS_VALID_POOL(pool) && handler >= 0 && handler < ((pool_p)pool->container)->capacity)
-		element = __element_clone_value(((pool_p)pool->container)->elements[handler]);
+	if (IS_VALID_POOL(pool) && handler >= 0) {
+		pool_p p = (pool_p)pool->container;
+		__lock_rdlock(&p->lock);
+		if (handler < p->capacity)
+			element = __element_clone_value(p->eslab, p->elements[handler]);
+		__lock_unlock(&p->lock);
+	}
 	return element;
 }
 
+int pool_get_with(Container pool, PoolNodeHandler handler, VisitFunc visit, void *ctx)
+{
+	int ret = -1;
+	if (IS_VALID_POOL(pool) && visit && handler >= 0) {
+		pool_p p = (pool_p)pool->container;
+		__lock_rdlock(&p->lock);
+		if (handler < p->capacity && p->elements[handler]) {
+			__element_visit(p->elements[handler], visit, ctx);
+			ret = 0;
+		}
+		__lock_unlock(&p->lock);
+	}
+	return ret;
+}
+
+long pool_get_into(Container pool, PoolNodeHandler handler, void *buf, size_t cap)
+{
+	long ret = -1;
+	if (IS_VALID_POOL(pool) && handler >= 0) {
+		pool_p p = (pool_p)pool->container;
+		__lock_rdlock(&p->lock);
+		if (handler < p->capacity && p->elements[handler])
+			ret = __element_copy_into(p->elements[handler], buf, cap);
+		__lock_unlock(&p->lock);
+	}
+	return ret;
+}
+
 int pool_expand(Container pool)
 {
 	int ret = -1;
 	if (IS_VALID_POOL(pool)) {
 		pool_p p = (pool_p)pool->container;
-		pthread_mutex_lock(&p->mut);
+		__lock_wrlock(&p->lock);
 		size_t nc = p->capacity + p->init_capa;
-		element_p *tmp = (element_p *)realloc(p->elements, nc * sizeof(element_p));
+		element_p *tmp = (element_p *)__mr_realloc(&p->alloc, p->elements, nc * sizeof(element_p));
 		if (tmp) {
 			p->elements = tmp;
 			for (size_t i = p->capacity; i < nc; i++)
@@ -108,7 +191,7 @@ int pool_expand(Container pool)
 			p->capacity = nc;
 			ret = 0;
 		}
-		pthread_mutex_unlock(&p->mut);
+		__lock_unlock(&p->lock);
 	}
 	return ret;
 }
@@ -118,20 +201,20 @@ int pool_shrink(Container pool)
 	int ret = -1;
 	if (IS_VALID_POOL(pool)) {
 		pool_p p = (pool_p)pool->container;
-		pthread_mutex_lock(&p->mut);
+		__lock_wrlock(&p->lock);
 		idle_node_p tail = p->next_idle;
 		while (tail->next)
 			tail = tail->next;
 		size_t nc = tail->handler + 10;
 		if (p->capacity > nc && nc >= p->init_capa) {
-			element_p *tmp = (element_p *)realloc(p->elements, nc * sizeof(element_p));
+			element_p *tmp = (element_p *)__mr_realloc(&p->alloc, p->elements, nc * sizeof(element_p));
 			if (tmp) {
 				p->elements = tmp;
 				p->capacity = nc;
 				ret = 0;
 			}
 		}
-		pthread_mutex_unlock(&p->mut);
+		__lock_unlock(&p->lock);
 	}
 	return ret;
 }
@@ -141,21 +224,21 @@ int pool_removeall(Container pool)
 	int ret = -1;
 	if (IS_VALID_POOL(pool)) {
 		pool_p p = (pool_p)pool->container;
-		pthread_mutex_lock(&p->mut);
+		__lock_wrlock(&p->lock);
 		for (size_t i = 0; i < p->capacity; i++) {
-			__element_destroy(p->elements[i]);
+			__element_destroy(p->eslab, p->elements[i]);
 			p->elements[i] = NULL;
 		}
 		p->size = 0;
 		idle_node_p head;
 		while (p->next_idle->next) {
 			head = p->next_idle->next;
-			free(p->next_idle);
+			__mr_free(&p->alloc, p->next_idle);
 			p->next_idle = head;
 		}
 		p->next_idle->handler = 0;
 		ret = 0;
-		pthread_mutex_unlock(&p->mut);
+		__lock_unlock(&p->lock);
 	}
 	return ret;
 }
@@ -173,16 +256,22 @@ int pool_removeall(Container pool)
  * next_idle --> | 0 | --> nil
  *               +---+
  */
-static Container __pool_create(size_t capacity)
+static Container __pool_create(size_t capacity, ContainerAttr attr)
 {
 	Container cont = NULL;
 	pool_p pool = NULL;
 	element_p *elements = NULL;
 	idle_node_p next_idle = NULL;
-	if ((cont = (Container)malloc(sizeof(Container_t))) &&
-			(pool = (pool_p)malloc(sizeof(pool_t))) &&
-			(elements = (element_p *)malloc(capacity * sizeof(element_p))) &&
-			(next_idle = (idle_node_p)malloc(sizeof(idle_node_t)))) {
+	slab_p eslab = NULL;
+	Allocator_t alloc;
+	if (__mr_allocator(&alloc, attr) != 0)
+		return NULL;
+	if ((cont = (Container)__mr_malloc(&alloc, sizeof(Container_t))) &&
+			(pool = (pool_p)__mr_malloc(&alloc, sizeof(pool_t))) &&
+			(elements = (element_p *)__mr_malloc(&alloc, capacity * sizeof(element_p))) &&
+			(next_idle = (idle_node_p)__mr_malloc(&alloc, sizeof(idle_node_t))) &&
+			(eslab = __slab_create(__element_size(object), 0, &alloc)) &&
+			__lock_init(&pool->lock, LOCK_POLICY(attr)) == 0) {
 		for (size_t i = 0; i < capacity; i++)
 			elements[i] = NULL;
 		pool->elements = elements;
@@ -192,14 +281,20 @@ static Container __pool_create(size_t capacity)
 		next_idle->handler = 0;
 		next_idle->next = NULL;
 		pool->next_idle = next_idle;
-		pthread_mutex_init(&pool->mut, NULL);
+		pool->alloc = alloc;
+		pool->eslab = eslab;
 		cont->container = pool;
 		cont->type = Pool;
 	} else {
-		free(next_idle);
-		free(elements);
-		free(pool);
-		free(cont);
+		__slab_destroy(eslab);
+		if (next_idle)
+			__mr_free(&alloc, next_idle);
+		if (elements)
+			__mr_free(&alloc, elements);
+		if (pool)
+			__mr_free(&alloc, pool);
+		if (cont)
+			__mr_free(&alloc, cont);
 		cont = NULL;
 	}
 	return cont;
@@ -224,23 +319,23 @@ static Container __pool_create(size_t capacity)
 static PoolNodeHandler __pool_retrieve(pool_p pool, element_p element)
 {
 	PoolNodeHandler h = -1;
-	pthread_mutex_lock(&pool->mut);
+	__lock_wrlock(&pool->lock);
 	if (pool->size < pool->capacity) {
 		h = pool->next_idle->handler++;
 		if (pool->next_idle->next) {
 			idle_node_p head = pool->next_idle;
 			pool->next_idle = head->next;
-			free(head);
+			__mr_free(&pool->alloc, head);
 		}
 		pool->elements[h] = element;
 		pool->size++;
 	}
-	pthread_mutex_unlock(&pool->mut);
+	__lock_unlock(&pool->lock);
 	return h;
 }
 
 /**
- * 释放一个池节点，返回其中的元素，调用前须确保池和句柄有效
+ * 释放一个池节点，返回其中的元素，由调用者负责销毁，节点为空或释放失败返回NULL，调用前须确保池和句柄有效并对池加锁
  * 释放池节点的算法描述
  * POOL-RELEASE(P, h)
  * 1	e := elements[P][h]
@@ -251,10 +346,8 @@ static PoolNodeHandler __pool_retrieve(pool_p pool, element_p element)
  * 6		else push h into next_idle[P]
  * 7	return e
  */
-static size_t __pool_release(pool_p pool, PoolNodeHandler handler)
+static element_p __pool_release(pool_p pool, PoolNodeHandler handler)
 {
-	pthread_mutex_lock(&pool->mut);
-	size_t ret = 0;
 	element_p e = pool->elements[handler];
 	if (e) {
 		if (pool->size == 1) {
@@ -262,11 +355,11 @@ static size_t __pool_release(pool_p pool, PoolNodeHandler handler)
 			while (pool->next_idle->next) {
 				head = pool->next_idle;
 				pool->next_idle = head->next;
-				free(head);
+				__mr_free(&pool->alloc, head);
 			}
 			pool->next_idle->handler = 0;
 		} else {
-			idle_node_p idle = (idle_node_p)malloc(sizeof(idle_node_t));
+			idle_node_p idle = (idle_node_p)__mr_malloc(&pool->alloc, sizeof(idle_node_t));
 			if (idle) {
 				idle->handler = handler;
 				idle->next = pool->next_idle;
@@ -278,10 +371,7 @@ static size_t __pool_release(pool_p pool, PoolNodeHandler handler)
 		if (e) {
 			pool->elements[handler] = NULL;
 			pool->size--;
-			__element_destroy(e);
-			ret = 1;
 		}
 	}
-	pthread_mutex_unlock(&pool->mut);
-	return ret;
+	return e;
 }
@@ -4,6 +4,8 @@
 
 #include "mr_pqueue.h"
 #include "private_element.h"
+#include "private_alloc.h"
+#include "private_lock.h"
 
 #define IS_VALID_PQ(X) (X && X->container && X->type == PriorityQueue)
 
@@ -34,35 +36,61 @@ typedef struct {
 	size_t capacity;
 	size_t size;
 	size_t order;
-	pthread_mutex_t mut;
+	lock_t lock;
+	Allocator_t alloc;
+	slab_p nslab;
+	slab_p eslab;
 } pq_t, *pq_p;
 
-static pq_node_p __pq_node_create(Element ele, ElementType type, size_t len, int priority, size_t order);	// 创建一个节点
-static void __pq_node_destroy(pq_node_p node);									// 销毁一个节点
+static pq_node_p __pq_node_create(pq_p pq, element_p e, int priority);						// 创建一个节点
+static void __pq_node_destroy(pq_p pq, pq_node_p node);								// 销毁一个节点
 
 static void __pq_removeall(pq_p pq);										// 清空所有节点
 
 static int __pq_bubble_up(pq_p pq, int pos);									// pos位置的节点上浮
 static int __pq_bubble_dn(pq_p pq, int pos);									// pos位置的节点下沉
 
-static int __pq_expand(pq_p pq);										// 扩展队列的容量
+static int __pq_expand(pq_p pq, size_t size);									// 扩展队列的容量
 
 static int __pq_change_pri(pq_p pq, int pos, int priority);							// 修改节点的优先级
 
+static int __pq_enqueue(pq_p pq, element_p e, int priority);							// 元素入队，直接引用元素，调用前须加锁
+static int __pq_enqueue_many(pq_p pq, const void *values, size_t count, ElementType type, size_t len, const int *priorities);	// 批量入队，调用前须加锁
+static Element __pq_dequeue(pq_p pq, int *priority, int take);							// 队首元素出队
+
 Container pq_create(PriorityType ptype, ElementType etype, CmpFunc cmpfunc)
 {
-	Container pq = (Container)malloc(sizeof(Container_t));
+	return pq_create_ex(ptype, etype, cmpfunc, NULL);
+}
+
+Container pq_create_ex(PriorityType ptype, ElementType etype, CmpFunc cmpfunc, ContainerAttr attr)
+{
+	Allocator_t alloc;
+	if (__mr_allocator(&alloc, attr) != 0)
+		return NULL;
+	Container pq = (Container)__mr_malloc(&alloc, sizeof(Container_t));
 	if (!pq)
 		return NULL;
-	pq_p q = (pq_p)malloc(sizeof(pq_t));
+	pq_p q = (pq_p)__mr_malloc(&alloc, sizeof(pq_t));
 	if (!q) {
-		free(pq);
+		__mr_free(&alloc, pq);
 		return NULL;
 	}
-	pq_node_p *queue = (pq_node_p *)malloc(PQ_INIT_CAPA * sizeof(pq_node_t));
+	pq_node_p *queue = (pq_node_p *)__mr_malloc(&alloc, PQ_INIT_CAPA * sizeof(pq_node_t));
 	if (!queue) {
-		free(pq);
-		free(q);
+		__mr_free(&alloc, pq);
+		__mr_free(&alloc, q);
+		return NULL;
+	}
+	q->alloc = alloc;
+	q->nslab = __slab_create(sizeof(pq_node_t), attr && attr->slab, &alloc);
+	q->eslab = __slab_create(__element_size(etype), attr && attr->slab, &alloc);
+	if (!q->nslab || !q->eslab || __lock_init(&q->lock, LOCK_POLICY(attr)) != 0) {
+		__slab_destroy(q->nslab);
+		__slab_destroy(q->eslab);
+		__mr_free(&alloc, queue);
+		__mr_free(&alloc, pq);
+		__mr_free(&alloc, q);
 		return NULL;
 	}
 	q->queue = queue;
@@ -72,7 +100,6 @@ Container pq_create(PriorityType ptype, ElementType etype, CmpFunc cmpfunc)
 	q->capacity = PQ_INIT_CAPA;
 	q->size = 0;
 	q->order = 0;
-	pthread_mutex_init(&q->mut, NULL);
 	pq->container = q;
 	pq->type = PriorityQueue;
 	return pq;
@@ -83,15 +110,17 @@ int pq_destroy(Container pq)
 	int ret = -1;
 	if (IS_VALID_PQ(pq)) {
 		pq_p q = (pq_p)pq->container;
-		pthread_mutex_lock(&q->mut);
+		Allocator_t alloc = q->alloc;
+		__lock_wrlock(&q->lock);
 		__pq_removeall(q);
-		free(q->queue);
-		q->size = 0;
+		__mr_free(&alloc, q->queue);
+		__slab_destroy(q->nslab);
+		__slab_destroy(q->eslab);
 		q->order = 0;
-		pthread_mutex_unlock(&q->mut);
-		pthread_mutex_destroy(&q->mut);
-		free(q);
-		free(pq);
+		__lock_unlock(&q->lock);
+		__lock_destroy(&q->lock);
+		__mr_free(&alloc, q);
+		__mr_free(&alloc, pq);
 		ret = 0;
 	}
 	return ret;
@@ -110,60 +139,71 @@ size_t pq_size(Container pq)
 int pq_enqueue(Container pq, Element ele, ElementType type, size_t len, int priority)
 {
 	int pos = -1;
-	pq_node_p node = NULL;
-	if (IS_VALID_PQ(pq) && ((pq_p)pq->container)->etype == type && (node = __pq_node_create(ele, type, len, priority, ((pq_p)pq->container)->order))) {
+	element_p e = NULL;
+	if (IS_VALID_PQ(pq) && ((pq_p)pq->container)->etype == type) {
 		pq_p q = (pq_p)pq->container;
-		pthread_mutex_lock(&q->mut);
-		int pos;
-		if (q->size < q->capacity || __pq_expand(q) == 0) {
-			pos = q->size;
-			q->queue[pos] = node;
-			q->size++;
-			q->order++;
-			__pq_bubble_up(q, pos);
-		} else {
-			__pq_node_destroy(node);
-		}
-		pthread_mutex_unlock(&q->mut);
+		__lock_wrlock(&q->lock);
+		if ((e = __element_create(q->eslab, ele, type, len)) && (pos = __pq_enqueue(q, e, priority)) == -1)
+			__element_destroy(q->eslab, e);
+		__lock_unlock(&q->lock);
 	}
 	return pos;
 }
 
-Element pq_dequeue(Container pq, int *priority)
+int pq_enqueue_adopt(Container pq, Element ele, ElementType type, size_t len, int priority)
 {
-	Element e = NULL;
-	int p = -1;
-	if (IS_VALID_PQ(pq) && ((pq_p)pq->container)->size > 0) {
+	int pos = -1;
+	element_p e = NULL;
+	if (IS_VALID_PQ(pq) && ((pq_p)pq->container)->etype == type) {
 		pq_p q = (pq_p)pq->container;
-		pthread_mutex_lock(&q->mut);
-		if ((e = __element_clone_value(q->queue[0]->element))) {
-			p = q->queue[0]->priority;
-			__pq_node_destroy(q->queue[0]);
-			q->size--;
-			if (q->size > 0) {
-				q->queue[0] = q->queue[q->size];
-				__pq_bubble_dn(q, 0);
-			} else {
-				q->order = 0;
-			}
-		}
-		pthread_mutex_unlock(&q->mut);
+		__lock_wrlock(&q->lock);
+		if ((e = __element_adopt(q->eslab, ele, type, len)) && (pos = __pq_enqueue(q, e, priority)) == -1)
+			__element_detach(q->eslab, e);
+		__lock_unlock(&q->lock);
 	}
+	return pos;
+}
+
+int pq_enqueue_many(Container pq, const void *values, size_t count, ElementType type, size_t len, const int *priorities)
+{
+	int ret = -1;
+	if (IS_VALID_PQ(pq) && ((pq_p)pq->container)->etype == type && ((values && priorities) || count == 0)) {
+		pq_p q = (pq_p)pq->container;
+		__lock_wrlock(&q->lock);
+		ret = __pq_enqueue_many(q, values, count, type, len, priorities);
+		__lock_unlock(&q->lock);
+	}
+	return ret;
+}
+
+Element pq_dequeue(Container pq, int *priority)
+{
+	if (IS_VALID_PQ(pq))
+		return __pq_dequeue((pq_p)pq->container, priority, 0);
 	if (priority)
-		*priority = p; 
-	return e;
+		*priority = -1;
+	return NULL;
+}
+
+Element pq_dequeue_take(Container pq, int *priority)
+{
+	if (IS_VALID_PQ(pq))
+		return __pq_dequeue((pq_p)pq->container, priority, 1);
+	if (priority)
+		*priority = -1;
+	return NULL;
 }
 
 Element pq_queuehead(Container pq, int *priority)
 {
 	Element e = NULL;
 	int p = -1;
-	if (IS_VALID_PQ(pq) && ((pq_p)pq->container)->size > 0) {
+	if (IS_VALID_PQ(pq)) {
 		pq_p q = (pq_p)pq->container;
-		pthread_mutex_lock(&q->mut);
-		if ((e = __element_clone_value(q->queue[0]->element)))
+		__lock_rdlock(&q->lock);
+		if (q->size > 0 && (e = __element_clone_value(q->eslab, q->queue[0]->element)))
 			p = q->queue[0]->priority;
-		pthread_mutex_unlock(&q->mut);
+		__lock_unlock(&q->lock);
 	}
 	if (priority)
 		*priority = p;
@@ -174,18 +214,78 @@ Element pq_get(Container pq, int index, int *priority)
 {
 	Element e = NULL;
 	int p = -1;
-	if (IS_VALID_PQ(pq) && index >= 0 && index < ((pq_p)pq->container)->size) {
+	if (IS_VALID_PQ(pq) && index >= 0) {
 		pq_p q = (pq_p)pq->container;
-		pthread_mutex_lock(&q->mut);
-		if ((e = __element_clone_value(q->queue[index]->element)))
+		__lock_rdlock(&q->lock);
+		if (index < q->size && (e = __element_clone_value(q->eslab, q->queue[index]->element)))
 			p = q->queue[index]->priority;
-		pthread_mutex_unlock(&q->mut);
+		__lock_unlock(&q->lock);
 	}
 	if (priority)
 		*priority = p;
 	return e;
 }
 
+int pq_queuehead_with(Container pq, VisitFunc visit, void *ctx, int *priority)
+{
+	return pq_get_with(pq, 0, visit, ctx, priority);
+}
+
+long pq_queuehead_into(Container pq, void *buf, size_t cap, int *priority)
+{
+	return pq_get_into(pq, 0, buf, cap, priority);
+}
+
+int pq_get_with(Container pq, int index, VisitFunc visit, void *ctx, int *priority)
+{
+	int ret = -1;
+	int p = -1;
+	if (IS_VALID_PQ(pq) && visit && index >= 0) {
+		pq_p q = (pq_p)pq->container;
+		__lock_rdlock(&q->lock);
+		if (index < q->size) {
+			__element_visit(q->queue[index]->element, visit, ctx);
+			p = q->queue[index]->priority;
+			ret = 0;
+		}
+		__lock_unlock(&q->lock);
+	}
+	if (priority)
+		*priority = p;
+	return ret;
+}
+
+long pq_get_into(Container pq, int index, void *buf, size_t cap, int *priority)
+{
+	long ret = -1;
+	int p = -1;
+	if (IS_VALID_PQ(pq) && index >= 0) {
+		pq_p q = (pq_p)pq->container;
+		__lock_rdlock(&q->lock);
+		if (index < q->size) {
+			ret = __element_copy_into(q->queue[index]->element, buf, cap);
+			p = q->queue[index]->priority;
+		}
+		__lock_unlock(&q->lock);
+	}
+	if (priority)
+		*priority = p;
+	return ret;
+}
+
+size_t pq_foreach(Container pq, VisitFunc visit, void *ctx)
+{
+	size_t count = 0;
+	if (IS_VALID_PQ(pq) && visit) {
+		pq_p q = (pq_p)pq->container;
+		__lock_rdlock(&q->lock);
+		while (count < q->size && __element_visit(q->queue[count++]->element, visit, ctx) == 0)
+			;
+		__lock_unlock(&q->lock);
+	}
+	return count;
+}
+
 int pq_contains(Container pq, Element ele, ElementType type, size_t len)
 {
 	return pq_search(pq, ele, type, len) != -1;
@@ -194,10 +294,11 @@ int pq_contains(Container pq, Element ele, ElementType type, size_t len)
 int pq_search(Container pq, Element ele, ElementType type, size_t len)
 {
 	int ret = -1;
+	element_tmp_t tmp;
 	element_p e;
-	if (IS_VALID_PQ(pq) && ((pq_p)pq->container)->size > 0 && ((pq_p)pq->container)->etype == type && (e = __element_create(ele, type, len))) {
+	if (IS_VALID_PQ(pq) && ((pq_p)pq->container)->size > 0 && ((pq_p)pq->container)->etype == type && (e = __element_temp(&tmp, &((pq_p)pq->container)->alloc, ele, type, len))) {
 		pq_p q = (pq_p)pq->container;
-		pthread_mutex_lock(&q->mut);
+		__lock_rdlock(&q->lock);
 		int i;
 		element_p n;
 		for (i = 0; i < q->size; i++) {
@@ -207,7 +308,8 @@ int pq_search(Container pq, Element ele, ElementType type, size_t len)
 				break;
 			}
 		}
-		pthread_mutex_unlock(&q->mut);
+		__element_temp_release(&q->alloc, e);
+		__lock_unlock(&q->lock);
 	}
 	return ret;
 }
@@ -217,9 +319,9 @@ int pq_change_pri_at(Container pq, int index, int priority)
 	int ret = -1;
 	if (IS_VALID_PQ(pq)) {
 		pq_p q = (pq_p)pq->container;
-		pthread_mutex_lock(&q->mut);
+		__lock_wrlock(&q->lock);
 		ret = __pq_change_pri(q, index, priority);
-		pthread_mutex_unlock(&q->mut);
+		__lock_unlock(&q->lock);
 	}
 	return ret;
 }
@@ -227,10 +329,11 @@ int pq_change_pri_at(Container pq, int index, int priority)
 int pq_change_pri(Container pq, Element ele, ElementType type, size_t len, int priority)
 {
 	int ret = -1;
+	element_tmp_t tmp;
 	element_p e;
-	if (IS_VALID_PQ(pq) && (e = __element_create(ele, type, len))) {
+	if (IS_VALID_PQ(pq) && (e = __element_temp(&tmp, &((pq_p)pq->container)->alloc, ele, type, len))) {
 		pq_p q = (pq_p)pq->container;
-		pthread_mutex_lock(&q->mut);
+		__lock_wrlock(&q->lock);
 		ret = 0;
 		element_p n;
 		int i = 0, j;
@@ -244,7 +347,8 @@ int pq_change_pri(Container pq, Element ele, ElementType type, size_t len, int p
 			if (j <= i)
 				i++;
 		}
-		pthread_mutex_unlock(&q->mut);
+		__element_temp_release(&q->alloc, e);
+		__lock_unlock(&q->lock);
 	}
 	return ret;
 }
@@ -254,63 +358,55 @@ int pq_removeall(Container pq)
 	int ret = 0;
 	if (IS_VALID_PQ(pq)) {
 		pq_p q = (pq_p)pq->container;
-		pthread_mutex_lock(&q->mut);
+		__lock_wrlock(&q->lock);
 		ret = q->size;
 		__pq_removeall(q);
-		q->size = 0;
 		q->order = 0;
-		pthread_mutex_unlock(&q->mut);
+		__lock_unlock(&q->lock);
 	}
 	return ret;
 }
 
 /**
- * @brief 创建一个节点
+ * @brief 创建一个节点，入队顺序编号由入队时设置
  *
- * @param ele
- * 	元素值
- * @param type
- * 	元素类型
- * @param len
- * 	元素长度
+ * @param pq
+ * 	节点所属的优先级队列
+ * @param e
+ * 	元素
  * @param priority
  * 	优先级
- * @param order
- * 	入队顺序编号
  *
  * @return 
  * 	创建成功返回节点，失败返回NULL
  */
-static pq_node_p __pq_node_create(Element ele, ElementType type, size_t len, int priority, size_t order)
+static pq_node_p __pq_node_create(pq_p pq, element_p e, int priority)
 {
-	element_p e = __element_create(ele, type, len);
-	if (!e)
-		return NULL;
-	pq_node_p node = (pq_node_p)malloc(sizeof(pq_node_t));
-	if (!node) {
-		__element_destroy(e);
-		return NULL;
+	pq_node_p node = (pq_node_p)__slab_alloc(pq->nslab, sizeof(pq_node_t));
+	if (node) {
+		node->element = e;
+		node->priority = priority;
+		node->order = 0;
 	}
-	node->element = e;
-	node->priority = priority;
-	node->order = order;
 	return node;
 }
 
 /**
  * @brief 销毁一个节点，同时销毁其中的元素
  *
+ * @param pq
+ * 	节点所属的优先级队列
  * @param node
  * 	节点
  */
-static void __pq_node_destroy(pq_node_p node)
+static void __pq_node_destroy(pq_p pq, pq_node_p node)
 {
-	__element_destroy(node->element);
-	free(node);
+	__element_destroy(pq->eslab, node->element);
+	__slab_free(pq->nslab, node);
 }
 
 /**
- * @brief 删除并销毁所有节点
+ * @brief 删除并销毁所有节点，slab模式下如果所有元素值都内联存储，则不逐个销毁节点，直接整块释放
  *
  * @param pq
  * 	优先级队列容器
@@ -318,8 +414,12 @@ static void __pq_node_destroy(pq_node_p node)
 static void __pq_removeall(pq_p pq)
 {
 	int i;
-	for (i = 0; i < pq->size; i++)
-		__pq_node_destroy(pq->queue[i]);
+	if (!SLAB_RELEASABLE(pq->eslab))
+		for (i = 0; i < pq->size; i++)
+			__pq_node_destroy(pq, pq->queue[i]);
+	__slab_reset(pq->nslab);
+	__slab_reset(pq->eslab);
+	pq->size = 0;
 }
 
 /**
@@ -390,20 +490,24 @@ static int __pq_bubble_dn(pq_p pq, int pos)
 }
 
 /**
- * @brief 扩展队列的容量
+ * @brief 扩展队列的容量，按增长规则扩展后仍不足size时直接扩展到size
  *
  * @param pq
  * 	优先级队列
+ * @param size
+ * 	需要容纳的节点数量
  *
  * @return 
  * 	扩容成功返回0，失败返回-1
  */
-static int __pq_expand(pq_p pq)
+static int __pq_expand(pq_p pq, size_t size)
 {
 	int ret = -1;
 	size_t oc = pq->capacity;
 	size_t nc = PQ_NEXT_CAPA(oc);
-	pq_node_p *nl = (pq_node_p *)realloc(pq->queue, nc * sizeof(pq_node_p));
+	if (nc < size)
+		nc = size;
+	pq_node_p *nl = (pq_node_p *)__mr_realloc(&pq->alloc, pq->queue, nc * sizeof(pq_node_p));
 	if (nl) {
 		pq->queue = nl;
 		pq->capacity = nc;
@@ -433,3 +537,127 @@ static int __pq_change_pri(pq_p pq, int pos, int priority)
 	return __pq_bubble_dn(pq, __pq_bubble_up(pq, pos));
 }
 
+/**
+ * @brief 元素入队，直接引用元素而不复制，调用前须对队列加锁
+ *
+ * @param pq
+ * 	优先级队列
+ * @param e
+ * 	元素
+ * @param priority
+ * 	优先级
+ *
+ * @return 
+ * 	入队成功返回节点的索引值，失败返回-1，失败时元素由调用者负责处理
+ */
+static int __pq_enqueue(pq_p pq, element_p e, int priority)
+{
+	int pos = -1;
+	pq_node_p node = __pq_node_create(pq, e, priority);
+	if (!node)
+		return -1;
+	if (pq->size < pq->capacity || __pq_expand(pq, pq->size + 1) == 0) {
+		node->order = pq->order++;
+		pq->queue[pq->size] = node;
+		pq->size++;
+		pos = __pq_bubble_up(pq, pq->size - 1);
+	} else {
+		__slab_free(pq->nslab, node);
+	}
+	return pos;
+}
+
+/**
+ * @brief 队首元素出队
+ *
+ * @param pq
+ * 	优先级队列
+ * @param priority
+ * 	出队成功时写入元素的优先级，失败时置为-1，可以为NULL
+ * @param take
+ * 	为0时返回元素值的副本，非0时直接交出元素值的所有权
+ *
+ * @return 
+ * 	队首元素的值，空队列或执行失败时返回NULL
+ */
+static Element __pq_dequeue(pq_p pq, int *priority, int take)
+{
+	Element e = NULL;
+	int p = -1;
+	__lock_wrlock(&pq->lock);
+	if (pq->size > 0) {
+		pq_node_p head = pq->queue[0];
+		element_p ele = head->element;
+		e = take ? __element_prepare_take(pq->eslab, ele) : __element_clone_value(pq->eslab, ele);
+		if (e || (take && !ele->value)) {	// 先取值再出队，复制失败时元素仍留在队列中
+			if (take) {
+				__element_detach(pq->eslab, ele);
+				head->element = NULL;
+			}
+			p = head->priority;
+			__pq_node_destroy(pq, head);
+			pq->size--;
+			if (pq->size > 0) {
+				pq->queue[0] = pq->queue[pq->size];
+				__pq_bubble_dn(pq, 0);
+			} else {
+				pq->order = 0;
+			}
+		}
+	}
+	__lock_unlock(&pq->lock);
+	if (priority)
+		*priority = p;
+	return e;
+}
+
+/**
+ * @brief 批量入队，先一次扩展到足够的容量并创建好所有节点，再整体调整堆
+ * 新节点数量不少于原有节点时自底向上重新建堆，时间为O(n)，否则逐个上浮
+ *
+ * @param pq
+ * 	优先级队列
+ * @param values
+ * 	元素值数组
+ * @param count
+ * 	元素数量
+ * @param type
+ * 	元素数据类型
+ * @param len
+ * 	元素长度
+ * @param priorities
+ * 	各元素的优先级
+ *
+ * @return 
+ * 	入队成功返回0，失败返回-1，失败时队列不变
+ */
+static int __pq_enqueue_many(pq_p pq, const void *values, size_t count, ElementType type, size_t len, const int *priorities)
+{
+	if (pq->size + count > pq->capacity && __pq_expand(pq, pq->size + count) != 0)
+		return -1;
+	size_t i;
+	for (i = 0; i < count; i++) {
+		size_t elen;
+		Element v = __element_array_at(values, i, type, len, &elen);
+		element_p e = v ? __element_create(pq->eslab, v, type, elen) : NULL;
+		if (!e || !(pq->queue[pq->size + i] = __pq_node_create(pq, e, priorities[i]))) {
+			if (e)
+				__element_destroy(pq->eslab, e);
+			while (i > 0)
+				__pq_node_destroy(pq, pq->queue[pq->size + --i]);
+			return -1;
+		}
+		pq->queue[pq->size + i]->order = pq->order + i;
+	}
+	pq->order += count;
+	size_t old = pq->size;
+	pq->size += count;
+	if (count >= old) {
+		for (i = pq->size / 2; i > 0; i--)
+			__pq_bubble_dn(pq, i - 1);
+	} else {
+		for (i = old; i < pq->size; i++)
+			__pq_bubble_up(pq, i);
+	}
+	return 0;
+}
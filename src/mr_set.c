@@ -1,11 +1,22 @@
 #include <stdlib.h>
+#include <string.h>
 #include <pthread.h>
 
 #include "mr_set.h"
 #include "private_element.h"
+#include "private_alloc.h"
+#include "private_lock.h"
 
 #define IS_VALID_SET(X) (X && X->container && X->type == Set)
 
+#define SET_ONLY1 1			// 集合运算保留只在第一个集合中的元素
+#define SET_ONLY2 2			// 集合运算保留只在第二个集合中的元素
+#define SET_BOTH 4			// 集合运算保留两个集合共有的元素
+
+#define BT_MAX 32			// B+树节点中键的最大数量
+#define BT_MIN (BT_MAX / 2)		// 非根节点中键的最小数量，低于这个数量时向兄弟节点借键或与兄弟节点合并
+#define BT_DEPTH 64			// B+树高度的上限，内部节点至少有两个子节点，树高不会超过元素数量的位数
+
 /**
  * 红黑树节点颜色
  */
@@ -23,18 +34,50 @@ typedef struct RBT_Node {
 	struct RBT_Node *right;		// 右子树根节点
 	struct RBT_Node *parent;	// 父节点
 	RBT_Color color;		// 节点颜色
+	size_t size;			// 以该节点为根的子树中的节点数量，用于按序号查找和计算排名
 } rbt_node_t, *rbt_node_p;
 
+#define RBT_SIZE(N) ((N) ? (N)->size : 0)	// 子树中的节点数量，空子树为0
+
+/**
+ * B+树的键，整数集合使用默认比较函数时ik中保存元素的整数值，查找时直接比较而不访问元素
+ */
+typedef struct {
+	Integer ik;			// 元素的整数值，仅在整数键模式下有效
+	element_p element;		// 元素
+} bt_key_t, *bt_key_p;
+
+/**
+ * B+树节点结构，叶节点按顺序保存元素并双向链接，内部节点的keys[i]为children[i + 1]子树中的最小元素
+ */
+typedef struct BT_Node {
+	int leaf;				// 是否为叶节点
+	int count;				// 键的数量，内部节点的子节点数量为count + 1
+	size_t total;				// 内部节点子树中的元素数量，叶节点不使用，元素数量即为count
+	struct BT_Node *prev;			// 叶节点的前一个叶节点
+	struct BT_Node *next;			// 叶节点的后一个叶节点
+	bt_key_t keys[BT_MAX];			// 有序的键
+	struct BT_Node *children[BT_MAX + 1];	// 内部节点的子节点
+} bt_node_t, *bt_node_p;
+
+#define BT_SIZE(N) ((N)->leaf ? (size_t)(N)->count : (N)->total)	// 子树中的元素数量
+
 /**
  * 集合结构
  */
 typedef struct {
 	ElementType type;		// 元素的数据类型
-	rbt_node_p root;		// 根节点
-	size_t size;			// 节点数量
+	SetType stype;			// 集合的构造类型
+	rbt_node_p root;		// 红黑树的根节点
+	bt_node_p btree;		// B+树的根节点
+	int ikey;			// B+树是否使用整数键，元素类型为integer且使用默认比较函数时为1
+	size_t size;			// 元素数量
 	CmpFunc cmpfunc;		// 元素比较函数
 	unsigned int changes;		// 集合内容发生变更的次数
-	pthread_mutex_t mut;		// 共享锁
+	lock_t lock;			// 锁，按创建属性指定的加锁策略选用
+	Allocator_t alloc;		// 内存分配器
+	slab_p nslab;			// 节点slab，非slab模式时未启用，只转交分配器
+	slab_p eslab;			// 元素slab，非slab模式时未启用，只转交分配器
 } set_t, *set_p;
 
 /**
@@ -45,12 +88,20 @@ typedef struct {
 	int asc;			// 迭代方向，1=正向，0=反向
 	rbt_node_p *stack;		// 迭代用的堆栈
 	rbt_node_p *top;		// 栈顶指针
+	bt_node_p leaf;			// B+树集合迭代的当前叶节点
+	int pos;			// B+树集合迭代的下一个元素在当前叶节点中的位置
+	element_p lo;			// 范围迭代的起点，NULL表示从最小的元素开始，指向lot
+	element_p hi;			// 范围迭代的终点（不含），NULL表示到最大的元素为止，指向hit
+	element_tmp_t lot;		// 范围起点的临时元素存储区
+	element_tmp_t hit;		// 范围终点的临时元素存储区
 	unsigned int changes;		// 迭代器创建时的集合变更次数，用于fast-fail
+	Allocator_t alloc;		// 集合的分配器，迭代器及其堆栈都由它分配
 } set_it_t, *set_it_p;
 
-static rbt_node_p __rbt_new_node(element_p element);				// 创建一个新节点
-static void __rbt_destroy_node(rbt_node_p node);				// 销毁一个节点及其中的元素
-static void __rbt_removeall(rbt_node_p root);					// 后序遍历删除所有节点
+static rbt_node_p __rbt_new_node(set_p set, element_p element);		// 创建一个新节点
+static void __rbt_destroy_node(set_p set, rbt_node_p node);			// 销毁一个节点及其中的元素
+static void __rbt_removeall(set_p set, rbt_node_p root, int elements);	// 后序遍历删除所有节点，elements非0时同时销毁元素
+static int __rbt_foreach(rbt_node_p root, int asc, VisitFunc visit, void *ctx, size_t *count);	// 中序遍历用访问函数访问所有节点中的元素
 
 static rbt_node_p __rbt_search_aux(element_p ele, rbt_node_p root, CmpFunc cmpfunc, rbt_node_p *save);	// 从root开始搜索指定元素所在节点的辅助函数，如果指定元素没有找到，可以通过save保存插入点
 static rbt_node_p __rbt_search(element_p ele, rbt_node_p root, CmpFunc cmpfunc);			// 从root开始查找元素与ele相等的节点并返回，找不到返回NULL
@@ -58,41 +109,97 @@ static rbt_node_p __rbt_search(element_p ele, rbt_node_p root, CmpFunc cmpfunc);
 static rbt_node_p __rbt_rotate_left(rbt_node_p node, rbt_node_p root);		// 以node节点为轴左旋，返回旋转后的根节点
 static rbt_node_p __rbt_rotate_right(rbt_node_p node, rbt_node_p root);		// 以node节点为轴右旋，返回旋转后的根节点
 
-static rbt_node_p __rbt_insert(element_p ele, rbt_node_p root, CmpFunc cmpfunc);		// 向根为root的红黑树中插入一个元素，如果元素存在则不做任何操作，返回插入完成后的根节点
+static rbt_node_p __rbt_insert(set_p set, element_p ele, rbt_node_p root, CmpFunc cmpfunc);	// 向根为root的红黑树中插入一个元素，如果元素存在则不做任何操作，返回插入完成后的根节点
 static rbt_node_p __rbt_insert_rebalance(rbt_node_p node, rbt_node_p root);			// 红黑树插入节点后重新平衡
-static rbt_node_p __rbt_delete(rbt_node_p node, rbt_node_p root);				// 从根为root的红黑树中删除一个节点，返回删除后的根节点
+static rbt_node_p __rbt_delete(set_p set, rbt_node_p node, rbt_node_p root);			// 从根为root的红黑树中删除一个节点，返回删除后的根节点
 static rbt_node_p __rbt_delete_rebalance(rbt_node_p node, rbt_node_p parent, rbt_node_p root);	// 红黑树删除节点后重新平衡
 
+static bt_node_p __bt_new_node(set_p set, int leaf);						// 创建一个新的B+树节点
+static void __bt_removeall(set_p set, bt_node_p node, int elements);				// 销毁子树中的所有节点，elements非0时同时销毁元素
+static int __bt_foreach(bt_node_p root, int asc, VisitFunc visit, void *ctx, size_t *count);	// 沿叶节点链用访问函数访问所有元素
+static bt_node_p __bt_edge(bt_node_p node, int asc);						// 找到子树中最左或最右的叶节点
+static int __bt_find(set_p set, bt_node_p node, bt_key_p key, int *found);			// 在节点中查找第一个不小于key的键的位置
+static bt_node_p __bt_locate(set_p set, element_p ele, int *pos, int *found);			// 查找ele在叶节点中的插入位置
+static bt_node_p __bt_search(set_p set, element_p ele, int *pos);				// 查找与ele相等的元素所在的叶节点
+static int __bt_split(set_p set, bt_node_p parent, int i, bt_key_p key);			// 分裂parent的第i个子节点，子节点须已满
+static int __bt_insert(set_p set, element_p ele);						// 向B+树中插入一个元素，元素重复或内存不足时返回-1
+static void __bt_merge(set_p set, bt_node_p parent, int i);					// 合并parent的第i个和第i + 1个子节点
+static void __bt_rebalance(set_p set, bt_node_p parent, int i);				// 第i个子节点的键数量不足时向兄弟节点借键或合并
+static element_p __bt_delete_aux(set_p set, bt_node_p node, bt_key_p key);			// 从子树中删除与key相等的元素
+static element_p __bt_delete(set_p set, element_p ele);					// 从B+树中删除与ele相等的元素并返回，不销毁元素
+
 static void __it_push(set_it_p it, rbt_node_p node);	// 迭代用的压栈函数
 static rbt_node_p __it_pop(set_it_p it);		// 迭代用的弹栈函数
 static int __it_stack_empty(set_it_p it);		// 迭代用的空栈判断函数
 
-static set_it_p __set_iterator(set_p s, int dir);	// 生成一个迭代器
-static rbt_node_p __set_it_next_node(set_it_p it);	// 中序迭代一个迭代器
+static set_it_p __set_iterator(set_p s, int dir, Element lo, Element hi, size_t lolen, size_t hilen);	// 生成一个迭代器，lo和hi不为NULL时只迭代[lo, hi)之间的元素
+static void __set_it_start(set_it_p it);		// 把迭代器置于起始位置
+static element_p __set_it_next_element(set_it_p it);	// 按顺序迭代到下一个元素
 
+static Iterator __set_it_wrap(set_it_p it);		// 把集合迭代器封装成Iterator
 static Element __set_it_next(void *it);			// Iterator的next函数
+static int __set_it_next_with(void *it, VisitFunc visit, void *ctx);	// Iterator的next_with函数
+static size_t __set_it_next_batch(void *it, Element *out, size_t n);	// Iterator的next_batch函数
 static size_t __set_it_remove(void *it);		// Iterator的remove函数，直接返回NULL
 static void __set_it_reset(void *it);			// Iterator的reset函数
 static void __set_it_destroy(void *it);			// Iterator的destroy函数
 
-static void __set_clone(set_p dest, set_p src);		// 将集合src复制一份到dest中
-static void __rbt_clone(set_p dest, rbt_node_p src);	// 二叉树复制，采用先序遍历的顺序复制，插入新节点的开销最小
+static Container __set_create_like(set_p proto);	// 创建一个与proto类型、比较函数和创建属性相同的空集合
+static void __set_clear(set_p set);			// 删除集合中的所有元素
+static int __set_add(set_p set, element_p e);		// 向集合中添加一个元素，添加时直接引用元素，调用前须加锁
+static int __set_remove(set_p set, element_p e);	// 从集合中删除与e相等的元素，调用前须加锁
+static Container __set_algebra(Container s1, Container s2, int keep);	// 集合运算的实现，keep指定结果中保留哪些元素
+static int __set_merge(set_p dest, set_p s1, set_p s2, int keep);	// 按顺序合并两个集合中keep指定的元素到空集合dest中
+static int __set_algebra_into(Container s1, Container s2, int keep);	// 原地集合运算的实现，结果保存在s1中
+static int __set_merge_into(set_p s1, set_p s2, int keep);	// 按顺序合并两个集合，用keep指定的元素重建s1
+static int __set_rebuild(set_p set, element_p *a, size_t n);	// 用有序元素重建集合的树，原有的节点被释放，元素不销毁
+static int __set_build(set_p set, element_p *a, size_t n);	// 用递增排列的元素一次性构造空集合的树
+static rbt_node_p __rbt_build(rbt_node_p *pool, element_p *a, size_t n, int depth, int red, rbt_node_p parent);	// 用有序元素构造完全平衡的红黑树
+static int __bt_build(set_p set, element_p *a, size_t n);	// 用有序元素自底向上逐层构造B+树
+static element_p __set_find(set_p set, element_p e);	// 查找集合中与e相等的元素
+static size_t __set_rank(set_p set, element_p e);	// 计算集合中小于e的元素数量
+static element_p __set_select(set_p set, size_t k);	// 查找集合中从小到大第k个元素
+static element_p __set_bound(set_p set, element_p e, int dir, int inclusive);	// 查找集合中与e最接近的元素
+static Element __set_nav(Container set, Element element, ElementType type, size_t len, int dir, int inclusive);	// 有序导航函数的实现
 
 Container set_create(ElementType type, CmpFunc cmpfunc) {
+	return set_create_typed(type, RBTreeSet, cmpfunc, NULL);
+}
+
+Container set_create_ex(ElementType type, CmpFunc cmpfunc, ContainerAttr attr) {
+	return set_create_typed(type, RBTreeSet, cmpfunc, attr);
+}
+
+Container set_create_typed(ElementType type, SetType stype, CmpFunc cmpfunc, ContainerAttr attr) {
 	Container cont = NULL;
 	set_p set = NULL;
-	if ((set = (set_p)malloc(sizeof(set_t))) && (cont = (Container)malloc(sizeof(Container_t)))) {
+	Allocator_t alloc;
+	if ((stype != RBTreeSet && stype != BPlusTreeSet) || __mr_allocator(&alloc, attr) != 0)
+		return NULL;
+	if ((set = (set_p)__mr_malloc(&alloc, sizeof(set_t))) && (cont = (Container)__mr_malloc(&alloc, sizeof(Container_t)))) {
 		set->type = type;
+		set->stype = stype;
 		set->root = NULL;
+		set->btree = NULL;
 		set->size = 0;
 		set->cmpfunc = cmpfunc ? cmpfunc : __default_cmpfunc(type);
+		set->ikey = type == integer && set->cmpfunc == __default_cmpfunc(integer);
 		set->changes = 0;
-		pthread_mutex_init(&set->mut, NULL);
+		set->alloc = alloc;
+		set->nslab = __slab_create(stype == RBTreeSet ? sizeof(rbt_node_t) : sizeof(bt_node_t), attr && attr->slab, &alloc);
+		set->eslab = __slab_create(__element_size(type), attr && attr->slab, &alloc);
+		if (!set->nslab || !set->eslab || __lock_init(&set->lock, LOCK_POLICY(attr)) != 0) {
+			__slab_destroy(set->nslab);
+			__slab_destroy(set->eslab);
+			__mr_free(&alloc, set);
+			__mr_free(&alloc, cont);
+			return NULL;
+		}
 		cont->container = set;
 		cont->type = Set;
 	} else {
-		free(set);
-		free(cont);
+		if (set)
+			__mr_free(&alloc, set);
 		cont = NULL;
 	}
 	return cont;
@@ -103,12 +210,15 @@ int set_destroy(Container set)
 	int ret = -1;
 	if (IS_VALID_SET(set)) {
 		set_p s = (set_p)set->container;
-		pthread_mutex_lock(&s->mut);
-		__rbt_removeall(s->root);
-		pthread_mutex_unlock(&s->mut);
-		pthread_mutex_destroy(&s->mut);
-		free(s);
-		free(set);
+		Allocator_t alloc = s->alloc;
+		__lock_wrlock(&s->lock);
+		__set_clear(s);
+		__slab_destroy(s->nslab);
+		__slab_destroy(s->eslab);
+		__lock_unlock(&s->lock);
+		__lock_destroy(&s->lock);
+		__mr_free(&alloc, s);
+		__mr_free(&alloc, set);
 		ret = 0;
 	}
 	return ret;
@@ -116,7 +226,7 @@ int set_destroy(Container set)
 
 int set_isempty(Container set)
 {
-	return IS_VALID_SET(set) ? ((set_p)set->container)->root == NULL : 1;
+	return IS_VALID_SET(set) ? ((set_p)set->container)->size == 0 : 1;
 }
 
 size_t set_size(Container set)
@@ -127,14 +237,14 @@ size_t set_size(Container set)
 int set_contains(Container set, Element element, ElementType type, size_t len)
 {
 	int ret = 0;
+	element_tmp_t tmp;
 	element_p e = NULL;
-	if (IS_VALID_SET(set) && element && len && ((set_p)set->container)->type == type && (e = __element_create(element, type, len))) {
+	if (IS_VALID_SET(set) && element && len && ((set_p)set->container)->type == type && (e = __element_temp(&tmp, &((set_p)set->container)->alloc, element, type, len))) {
 		set_p s = (set_p)set->container;
-		pthread_mutex_lock(&s->mut);
-		rbt_node_p result = __rbt_search(e, s->root, s->cmpfunc);
-		ret = result ? 1 : 0;
-		__element_destroy(e);
-		pthread_mutex_unlock(&s->mut);
+		__lock_rdlock(&s->lock);
+		ret = __set_find(s, e) ? 1 : 0;
+		__lock_unlock(&s->lock);
+		__element_temp_release(&s->alloc, e);
 	}
 	return ret;
 }
@@ -143,21 +253,48 @@ int set_add(Container set, Element element, ElementType type, size_t len)
 {
 	int ret = -1;
 	element_p e = NULL;
-	if (IS_VALID_SET(set) && element && len && ((set_p)set->container)->type == type && (e = __element_create(element, type, len))) {
+	if (IS_VALID_SET(set) && element && len && ((set_p)set->container)->type == type) {
 		set_p s = (set_p)set->container;
-		pthread_mutex_lock(&s->mut);
-		rbt_node_p r = __rbt_insert(e, s->root, s->cmpfunc);
-		if (r) {
-			// 插入时如果元素重复或者发生错误插入失败则返回NULL，否则返回插入后的红黑树的新根节点
-			s->root = r;
-			s->size++;
-			s->changes++;
-			ret = 0;
-		} else {
-			// 插入失败时把生成的元素副本销毁
-			__element_destroy(e);
+		__lock_wrlock(&s->lock);
+		if ((e = __element_create(s->eslab, element, type, len)) && (ret = __set_add(s, e)) != 0)
+			__element_destroy(s->eslab, e);	// 插入失败时把生成的元素副本销毁
+		__lock_unlock(&s->lock);
+	}
+	return ret;
+}
+
+int set_add_adopt(Container set, Element element, ElementType type, size_t len)
+{
+	int ret = -1;
+	element_p e = NULL;
+	if (IS_VALID_SET(set) && ((set_p)set->container)->type == type) {
+		set_p s = (set_p)set->container;
+		__lock_wrlock(&s->lock);
+		if ((e = __element_adopt(s->eslab, element, type, len)) && (ret = __set_add(s, e)) != 0)
+			__element_detach(s->eslab, e);	// 插入失败时把元素值交还给调用者
+		__lock_unlock(&s->lock);
+	}
+	return ret;
+}
+
+size_t set_add_many(Container set, const void *values, size_t count, ElementType type, size_t len)
+{
+	size_t ret = 0;
+	element_p e = NULL;
+	if (IS_VALID_SET(set) && values && ((set_p)set->container)->type == type) {
+		set_p s = (set_p)set->container;
+		__lock_wrlock(&s->lock);
+		for (size_t i = 0; i < count; i++) {
+			size_t elen;
+			Element v = __element_array_at(values, i, type, len, &elen);
+			if (!v || !elen || !(e = __element_create(s->eslab, v, type, elen)))
+				continue;
+			if (__set_add(s, e) == 0)
+				ret++;
+			else
+				__element_destroy(s->eslab, e);	// 元素重复时把生成的元素副本销毁
 		}
-		pthread_mutex_unlock(&s->mut);
+		__lock_unlock(&s->lock);
 	}
 	return ret;
 }
@@ -165,19 +302,14 @@ int set_add(Container set, Element element, ElementType type, size_t len)
 size_t set_remove(Container set, Element element, ElementType type, size_t len)
 {
 	size_t ret = 0;
+	element_tmp_t tmp;
 	element_p e = NULL;
-	if (IS_VALID_SET(set) && element && len && ((set_p)set->container)->type == type && (e = __element_create(element, type, len))) {
+	if (IS_VALID_SET(set) && element && len && ((set_p)set->container)->type == type && (e = __element_temp(&tmp, &((set_p)set->container)->alloc, element, type, len))) {
 		set_p s = (set_p)set->container;
-		pthread_mutex_lock(&s->mut);
-		rbt_node_p node = __rbt_search(e, s->root, s->cmpfunc);
-		if (node != NULL) {		// 找到要删除的元素
-			ret = 1;
-			s->root = __rbt_delete(node, s->root);
-			s->size--;
-			s->changes++;
-		}
-		__element_destroy(e);
-		pthread_mutex_unlock(&s->mut);
+		__lock_wrlock(&s->lock);
+		ret = __set_remove(s, e);
+		__lock_unlock(&s->lock);
+		__element_temp_release(&s->alloc, e);
 	}
 	return ret;
 }
@@ -186,12 +318,10 @@ void set_removeall(Container set)
 {
 	if (IS_VALID_SET(set)) {
 		set_p s = (set_p)set->container;
-		pthread_mutex_lock(&s->mut);
-		__rbt_removeall(s->root);
-		s->size = 0;
-		s->root = NULL;
+		__lock_wrlock(&s->lock);
+		__set_clear(s);
 		s->changes++;
-		pthread_mutex_unlock(&s->mut);
+		__lock_unlock(&s->lock);
 	}
 }
 
@@ -200,273 +330,189 @@ Iterator set_iterator(Container set, int dir)
 	set_it_p it = NULL;
 	if (IS_VALID_SET(set)) {
 		set_p s = (set_p)set->container;
-		pthread_mutex_lock(&s->mut);
-		it = __set_iterator(s, dir);
-		pthread_mutex_unlock(&s->mut);
+		__lock_rdlock(&s->lock);
+		it = __set_iterator(s, dir, NULL, NULL, 0, 0);
+		__lock_unlock(&s->lock);
 	}
-	return it ? it_create(it, __set_it_next, __set_it_remove, __set_it_reset, __set_it_destroy) : NULL;
+	return __set_it_wrap(it);
 }
 
-Container set_intersection(Container s1, Container s2)
+Iterator set_range_iterator(Container set, Element lo, Element hi, ElementType type, size_t lolen, size_t hilen, int dir)
 {
-	Container ret = NULL;
-	if (s1 != s2) {
-		if (IS_VALID_SET(s1) && IS_VALID_SET(s2)) {	// 没有无效容器，进行交集运算，否则直接返回空容器
-			set_p set1 = (set_p)s1->container;
-			set_p set2 = (set_p)s2->container;
-			set_p set = (set_p)malloc(sizeof(set_t));
-			ret = (Container)malloc(sizeof(Container_t));
-			if (!set || !ret) {	// 内存不足，返回空容器
-				free(set);
-				free(ret);
-				return NULL;
-			}
-			set->type = set1->type;
-			set->root = NULL;
-			set->size = 0;
-			set->changes = 0;
-			set->cmpfunc = set1->cmpfunc;
-			pthread_mutex_init(&set->mut, NULL);
-			ret->container = set;
-			ret->type = Set;
-			pthread_mutex_lock(&set1->mut);
-			pthread_mutex_lock(&set2->mut);
-			if (set1->type == set2->type && (set1->size * set2->size) > 0) {
-				// 两个集合数据类型一致，且两个集合都有数据时进行交集运算，否则返回空集合
-				set_it_p it1 = __set_iterator(set1, Forward);
-				set_it_p it2 = __set_iterator(set2, Forward);
-				rbt_node_p n1 = __set_it_next_node(it1);
-				rbt_node_p n2 = __set_it_next_node(it2);
-				while (n1 && n2) {			// 只要有一个集合已经取完所有数据，那么交集就结束了
-					int cmp = set->cmpfunc(n1->element->value, n2->element->value, n1->element->len, n2->element->len);
-					if (cmp < 0) {			// 集合1中的当前元素比较小，取下一个，继续循环
-						n1 = __set_it_next_node(it1);
-					} else if (cmp > 0) {		// 集合2中的当前元素比较小，取下一个，继续循环
-						n2 = __set_it_next_node(it2);
-					} else {			// 两个集合的当前元素相等，添加到结果集中，两个集合都取下一个，继续循环
-						element_p e = __element_create(n1->element->value, n1->element->type, n1->element->len);
-						if (!e) {		// 复制元素出错，内存不足，返回空容器
-							__rbt_removeall(set->root);
-							free(set);
-							free(ret);
-							return NULL;
-						}
-						rbt_node_p root = __rbt_insert(e, set->root, set->cmpfunc);
-						if (root) {
-							set->root = root;
-							set->size++;
-						}
-						n1 = __set_it_next_node(it1);
-						n2 = __set_it_next_node(it2);
-					}
-				}
-				__set_it_destroy(it1);
-				__set_it_destroy(it2);
-			}
-			pthread_mutex_unlock(&set1->mut);
-			pthread_mutex_unlock(&set2->mut);
-		}
-	} else {		// 自己交集自己，返回自己的clone
-		if (IS_VALID_SET(s1)) {		// 无效容器时直接返回NULL
-			set_p set1 = (set_p)s1->container;
-			set_p set = (set_p)malloc(sizeof(set_t));
-			ret = (Container)malloc(sizeof(Container_t));
-			if (!set || !ret) {	// 内存不足，返回空容器
-				free(set);
-				free(ret);
-				return NULL;
-			}
-			set->type = set1->type;
-			set->root = NULL;
-			set->size = 0;
-			set->changes = 0;
-			set->cmpfunc = set1->cmpfunc;
-			pthread_mutex_init(&set->mut, NULL);
-			ret->container = set;
-			ret->type = Set;
-			pthread_mutex_lock(&set1->mut);
-			__set_clone(set, set1);
-			pthread_mutex_unlock(&(set1->mut));
-		}
+	set_it_p it = NULL;
+	if (IS_VALID_SET(set) && ((set_p)set->container)->type == type && (!lo || lolen) && (!hi || hilen)) {
+		set_p s = (set_p)set->container;
+		__lock_rdlock(&s->lock);
+		it = __set_iterator(s, dir, lo, hi, lolen, hilen);
+		__lock_unlock(&s->lock);
+	}
+	return __set_it_wrap(it);
+}
+
+size_t set_foreach(Container set, int dir, VisitFunc visit, void *ctx)
+{
+	size_t count = 0;
+	if (IS_VALID_SET(set) && visit) {
+		set_p s = (set_p)set->container;
+		__lock_rdlock(&s->lock);
+		if (s->stype == BPlusTreeSet)
+			__bt_foreach(s->btree, dir, visit, ctx, &count);
+		else
+			__rbt_foreach(s->root, dir, visit, ctx, &count);
+		__lock_unlock(&s->lock);
+	}
+	return count;
+}
+
+size_t set_rank(Container set, Element element, ElementType type, size_t len)
+{
+	size_t ret = 0;
+	element_tmp_t tmp;
+	element_p e = NULL;
+	if (IS_VALID_SET(set) && element && len && ((set_p)set->container)->type == type && (e = __element_temp(&tmp, &((set_p)set->container)->alloc, element, type, len))) {
+		set_p s = (set_p)set->container;
+		__lock_rdlock(&s->lock);
+		ret = __set_rank(s, e);
+		__lock_unlock(&s->lock);
+		__element_temp_release(&s->alloc, e);
 	}
 	return ret;
 }
 
-Container set_union(Container s1, Container s2)
+Element set_select(Container set, size_t k)
 {
-	Container ret = NULL;
-	if (s1 != s2) {
-		if (IS_VALID_SET(s1) && IS_VALID_SET(s2)) {	// 如果有一个容器非法，那么直接返回NULL容器
-			set_p set1 = (set_p)s1->container;
-			set_p set2 = (set_p)s2->container;
-			set_p set = (set_p)malloc(sizeof(set_t));
-			ret = (Container)malloc(sizeof(Container_t));
-			if (!set || !ret) {
-				free(set);
-				free(ret);
-				return NULL;
-			}
-			set->type = set1->type;
-			set->root = NULL;
-			set->size = 0;
-			set->changes = 0;
-			set->cmpfunc = set1->cmpfunc;
-			pthread_mutex_init(&set->mut, NULL);
-			ret->container = set;
-			ret->type = Set;
-			pthread_mutex_lock(&set1->mut);
-			pthread_mutex_lock(&set2->mut);
-			if (set1->type == set2->type && (set1->size + set2->size) > 0) {
-				// 两个集合数据类型一致，且至少有一个集合有数据时进行合并，否则直接返回空集合
-				set_it_p it = NULL;
-				if (set1->size > set2->size) {		// set1比较大，复制set1再逐个添加set2中的元素
-					__set_clone(set, set1);
-					it = (set2->root ? __set_iterator(set2, Forward) : NULL);
-				} else {				// 反之
-					__set_clone(set, set2);
-					it = (set1->root ? __set_iterator(set1, Forward) : NULL);
-				}
-				if (it) {				// 另一个集合中有元素，则添加另一个集合的所有元素
-					rbt_node_p node = NULL;
-					while ((node = __set_it_next_node(it))) {
-						element_p e = __element_create(node->element->value, node->element->type, node->element->len);
-						if (!e) {		// 复制元素出错，内存不足，返回空容器
-							__rbt_removeall(set->root);
-							free(set);
-							free(ret);
-							return NULL;
-						}
-						rbt_node_p root = __rbt_insert(e, set->root, set->cmpfunc);
-						if (root) {
-							set->root = root;
-							set->size++;
-						}
-					}
-					__set_it_destroy(it);
-				}
-			}
-			pthread_mutex_unlock(&set1->mut);
-			pthread_mutex_unlock(&set2->mut);
-		}
-	} else {		// 自己并集自己，返回自己的clone
-		if (IS_VALID_SET(s1)) {		// 非法集合的话直接返回NULL容器
-			set_p set1 = (set_p)s1->container;
-			set_p set = (set_p)malloc(sizeof(set_t));
-			ret = (Container)malloc(sizeof(Container_t));
-			if (!set || !ret) {	// 内存不足，返回空容器
-				free(set);
-				free(ret);
-				return NULL;
-			}
-			set->type = set1->type;
-			set->root = NULL;
-			set->size = 0;
-			set->changes = 0;
-			set->cmpfunc = set1->cmpfunc;
-			pthread_mutex_init(&set->mut, NULL);
-			ret->container = set;
-			ret->type = Set;
-			pthread_mutex_lock(&set1->mut);
-			__set_clone(set, set1);
-			pthread_mutex_unlock(&(set1->mut));
+	Element ret = NULL;
+	if (IS_VALID_SET(set)) {
+		set_p s = (set_p)set->container;
+		__lock_rdlock(&s->lock);
+		if (k < s->size)			// 须在加锁后检查序号，其他线程可能同时删除了元素
+			ret = __element_clone_value(s->eslab, __set_select(s, k));
+		__lock_unlock(&s->lock);
+	}
+	return ret;
+}
+
+size_t set_count_range(Container set, Element lo, Element hi, ElementType type, size_t lolen, size_t hilen)
+{
+	size_t ret = 0;
+	element_tmp_t lot, hit;
+	element_p elo = NULL, ehi = NULL;
+	if (IS_VALID_SET(set) && lo && hi && lolen && hilen && ((set_p)set->container)->type == type) {
+		set_p s = (set_p)set->container;
+		if ((elo = __element_temp(&lot, &s->alloc, lo, type, lolen)) && (ehi = __element_temp(&hit, &s->alloc, hi, type, hilen))) {
+			__lock_rdlock(&s->lock);
+			size_t from = __set_rank(s, elo), to = __set_rank(s, ehi);
+			ret = to > from ? to - from : 0;	// hi不大于lo时范围为空
+			__lock_unlock(&s->lock);
 		}
+		__element_temp_release(&s->alloc, elo);
+		__element_temp_release(&s->alloc, ehi);
+	}
+	return ret;
+}
+
+Element set_first(Container set)
+{
+	Element ret = NULL;
+	if (IS_VALID_SET(set)) {
+		set_p s = (set_p)set->container;
+		__lock_rdlock(&s->lock);
+		if (s->size > 0)
+			ret = __element_clone_value(s->eslab, __set_select(s, 0));
+		__lock_unlock(&s->lock);
 	}
 	return ret;
 }
 
+Element set_last(Container set)
+{
+	Element ret = NULL;
+	if (IS_VALID_SET(set)) {
+		set_p s = (set_p)set->container;
+		__lock_rdlock(&s->lock);
+		if (s->size > 0)
+			ret = __element_clone_value(s->eslab, __set_select(s, s->size - 1));
+		__lock_unlock(&s->lock);
+	}
+	return ret;
+}
+
+Element set_floor(Container set, Element element, ElementType type, size_t len)
+{
+	return __set_nav(set, element, type, len, Reverse, 1);
+}
+
+Element set_ceiling(Container set, Element element, ElementType type, size_t len)
+{
+	return __set_nav(set, element, type, len, Forward, 1);
+}
+
+Element set_lower(Container set, Element element, ElementType type, size_t len)
+{
+	return __set_nav(set, element, type, len, Reverse, 0);
+}
+
+Element set_higher(Container set, Element element, ElementType type, size_t len)
+{
+	return __set_nav(set, element, type, len, Forward, 0);
+}
+
+Container set_intersection(Container s1, Container s2)
+{
+	return __set_algebra(s1, s2, SET_BOTH);
+}
+
+Container set_union(Container s1, Container s2)
+{
+	return __set_algebra(s1, s2, SET_ONLY1 | SET_ONLY2 | SET_BOTH);
+}
+
 Container set_minus(Container s1, Container s2)
 {
-	Container ret = NULL;
-	if (s1 != s2) {
-		if (IS_VALID_SET(s1) && IS_VALID_SET(s2)) {	// 如果有非法容器，那么直接返回空容器
-			set_p set1 = (set_p)s1->container;
-			set_p set2 = (set_p)s2->container;
-			set_p set = (set_p)malloc(sizeof(set_t));
-			ret = (Container)malloc(sizeof(Container_t));
-			if (!set || !ret) {	// 内存不足，返回空容器
-				free(set);
-				free(ret);
-				return NULL;
-			}
-			set->type = set1->type;
-			set->root = NULL;
-			set->size = 0;
-			set->changes = 0;
-			set->cmpfunc = set1->cmpfunc;
-			pthread_mutex_init(&set->mut, NULL);
-			ret->container = set;
-			ret->type = Set;
-			pthread_mutex_lock(&set1->mut);
-			pthread_mutex_lock(&set2->mut);
-			if (set1->type == set2->type && set1->size > 0) {	// 两个集合数据类型一致，且被减集合有数据
-				set_it_p it1 = __set_iterator(set1, Forward);
-				set_it_p it2 = __set_iterator(set2, Forward);
-				rbt_node_p n1 = __set_it_next_node(it1);
-				rbt_node_p n2 = __set_it_next_node(it2);
-				rbt_node_p root = NULL;
-				while (n1 && n2) {			// set1结束则循环结束，set2结束则循环结束后把set1剩余的数据全部添加到结果集中
-					int cmp = set->cmpfunc(n1->element->value, n2->element->value, n1->element->len, n2->element->len);
-					if (cmp < 0) {			// 集合1中的当前元素比较小，复制并跳到下一个元素，继续循环
-						element_p e = __element_create(n1->element->value, n1->element->type, n1->element->len);
-						if (!e) {		// 复制元素出错，内存不足，返回空容器
-							__rbt_removeall(set->root);
-							free(set);
-							free(ret);
-							return NULL;
-						}
-						root = __rbt_insert(e, set->root, set->cmpfunc);
-						if (root) {
-							set->root = root;
-							set->size++;
-						}
-						n1 = __set_it_next_node(it1);
-					} else if (cmp > 0) {		// 集合2中的当前元素比较小，取下一个，继续循环
-						n2 = __set_it_next_node(it2);
-					} else {			// 两个集合的当前元素相等，两个集合都取下一个，继续循环
-						n1 = __set_it_next_node(it1);
-						n2 = __set_it_next_node(it2);
-					}
-				}
-				while (n1) {				// 集合1中还有元素，全部复制到结果集中去
-					element_p e = __element_create(n1->element->value, n1->element->type, n1->element->len);
-					if (!e) {		// 复制元素出错，内存不足，返回空容器
-						__rbt_removeall(set->root);
-						free(set);
-						free(ret);
-						return NULL;
-					}
-					root = __rbt_insert(e, set->root, set->cmpfunc);
-					if (root) {
-						set->root = root;
-						set->size++;
-					}
-					n1 = __set_it_next_node(it1);
-				}
-				__set_it_destroy(it1);
-				__set_it_destroy(it2);
+	return __set_algebra(s1, s2, SET_ONLY1);
+}
+
+int set_union_into(Container s1, Container s2)
+{
+	return __set_algebra_into(s1, s2, SET_ONLY1 | SET_ONLY2 | SET_BOTH);
+}
+
+int set_intersect_into(Container s1, Container s2)
+{
+	return __set_algebra_into(s1, s2, SET_BOTH);
+}
+
+int set_subtract_into(Container s1, Container s2)
+{
+	return __set_algebra_into(s1, s2, SET_ONLY1);
+}
+
+Container set_build_sorted(ElementType type, SetType stype, CmpFunc cmpfunc, const void *values, size_t count, size_t len, ContainerAttr attr)
+{
+	Container ret = set_create_typed(type, stype, cmpfunc, attr);
+	if (ret && values && count > 0) {	// 新建的集合还未被其他线程访问，不需要加锁
+		set_p set = (set_p)ret->container;
+		element_p *a = (element_p *)__mr_malloc(&set->alloc, count * sizeof(element_p));
+		size_t i = 0, n = 0;
+		if (a) {
+			for (; i < count; i++) {
+				size_t elen;
+				Element v = __element_array_at(values, i, type, len, &elen);
+				if (!v || !elen)
+					continue;
+				if (!(a[n] = __element_create(set->eslab, v, type, elen)))
+					break;
+				n++;
 			}
-			pthread_mutex_unlock(&set1->mut);
-			pthread_mutex_unlock(&set2->mut);
 		}
-	} else {			// 自己减自己，返回一个空集
-		if (IS_VALID_SET(s1)) {
-			set_p set1 = (set_p)s1->container;
-			set_p set = (set_p)malloc(sizeof(set_t));
-			ret = (Container)malloc(sizeof(Container_t));
-			if (!set || !ret) {	// 内存不足，返回空容器
-				free(set);
-				free(ret);
-				return NULL;
-			}
-			set->type = set1->type;
-			set->root = NULL;
-			set->size = 0;
-			set->changes = 0;
-			set->cmpfunc = set1->cmpfunc;
-			pthread_mutex_init(&set->mut, NULL);
-			ret->container = set;
-			ret->type = Set;
+		if (!a || i < count || __set_build(set, a, n) != 0) {	// 内存不足，销毁已复制的元素
+			for (size_t j = 0; a && j < n; j++)
+				__element_destroy(set->eslab, a[j]);
+			__mr_free(&set->alloc, a);
+			set_destroy(ret);
+			return NULL;
 		}
+		__mr_free(&set->alloc, a);
 	}
 	return ret;
 }
@@ -474,15 +520,16 @@ Container set_minus(Container s1, Container s2)
 /**
  * 创建一个新的节点
  */
-static rbt_node_p __rbt_new_node(element_p element)
+static rbt_node_p __rbt_new_node(set_p set, element_p element)
 {
-	rbt_node_p nnode = (rbt_node_p)malloc(sizeof(rbt_node_t));
+	rbt_node_p nnode = (rbt_node_p)__slab_alloc(set->nslab, sizeof(rbt_node_t));
 	if (nnode) {
 		nnode->element = element;
 		nnode->left = NULL;
 		nnode->right = NULL;
 		nnode->parent = NULL;
 		nnode->color = Red;
+		nnode->size = 1;
 	}
 	return nnode;
 }
@@ -490,24 +537,43 @@ static rbt_node_p __rbt_new_node(element_p element)
 /**
  * 销毁一个节点及其中的元素
  */
-static void __rbt_destroy_node(rbt_node_p node)
+static void __rbt_destroy_node(set_p set, rbt_node_p node)
 {
-	__element_destroy(node->element);
-	free(node);
+	__element_destroy(set->eslab, node->element);
+	__slab_free(set->nslab, node);
 }
 
 /**
- * 销毁从root开始的所有节点及其中的元素
+ * 销毁从root开始的所有节点，elements非0时节点中的元素一并销毁，否则元素由调用者负责处理
  */
-static void __rbt_removeall(rbt_node_p root)
+static void __rbt_removeall(set_p set, rbt_node_p root, int elements)
 {
 	if (root) {
-		__rbt_removeall(root->left);
-		__rbt_removeall(root->right);
-		__rbt_destroy_node(root);
+		__rbt_removeall(set, root->left, elements);
+		__rbt_removeall(set, root->right, elements);
+		if (elements)
+			__rbt_destroy_node(set, root);
+		else
+			__slab_free(set->nslab, root);
 	}
 }
 
+/**
+ * 中序遍历从root开始的所有节点，用访问函数访问其中的元素，asc为0时按逆序遍历，count累计已访问的元素数量
+ * 访问函数返回非0时终止遍历并返回1，否则返回0
+ */
+static int __rbt_foreach(rbt_node_p root, int asc, VisitFunc visit, void *ctx, size_t *count)
+{
+	if (!root)
+		return 0;
+	if (__rbt_foreach(asc ? root->left : root->right, asc, visit, ctx, count))
+		return 1;
+	(*count)++;
+	if (__element_visit(root->element, visit, ctx))
+		return 1;
+	return __rbt_foreach(asc ? root->right : root->left, asc, visit, ctx, count);
+}
+
 /**
  * 从root开始搜索指定元素所在节点的辅助函数，如果指定元素没有找到，可以通过save保存插入点
  * 算法描述：
@@ -580,6 +646,8 @@ static rbt_node_p __rbt_rotate_left(rbt_node_p node, rbt_node_p root)
 		root = rnode;				// 7
 	rnode->left = node;				// 11
 	node->parent = rnode;				// 12
+	rnode->size = node->size;			// 旋转后rnode取代node成为子树的根，子树的节点数量不变
+	node->size = RBT_SIZE(node->left) + RBT_SIZE(node->right) + 1;
 	return root;
 }
 
@@ -609,6 +677,8 @@ static rbt_node_p __rbt_rotate_right(rbt_node_p node, rbt_node_p root)
 		root = lnode;
 	lnode->right = node;
 	node->parent = lnode;
+	lnode->size = node->size;
+	node->size = RBT_SIZE(node->left) + RBT_SIZE(node->right) + 1;
 	return root;
 }
 
@@ -635,12 +705,12 @@ static rbt_node_p __rbt_rotate_right(rbt_node_p node, rbt_node_p root)
  *-------------------------------------------------------
  * 如果插入完成返回根节点，因为插入元素可能导致根节点发生变化；如果已经有相等的元素存在则返回NULL，表示未进行插入操作
  */
-static rbt_node_p __rbt_insert(element_p ele, rbt_node_p root, CmpFunc cmpfunc)
+static rbt_node_p __rbt_insert(set_p set, element_p ele, rbt_node_p root, CmpFunc cmpfunc)
 {
 	rbt_node_p parent = NULL, node;
 	if ((node = __rbt_search_aux(ele, root, cmpfunc, &parent)))	// 寻找插入点，如果相等的元素已经存在则返回原节点，否则返回NULL并在parent中存放插入点
 		return NULL;
-	node = __rbt_new_node(ele);
+	node = __rbt_new_node(set, ele);
 	if (!node)	// 创建节点失败，直接返回NULL
 		return NULL;
 	node->parent = parent;     
@@ -651,6 +721,8 @@ static rbt_node_p __rbt_insert(element_p ele, rbt_node_p root, CmpFunc cmpfunc)
 			parent->right = node;
 	else		// 原树为空树，新节点即为根节点
 		root = node;
+	for (; parent; parent = parent->parent)	// 插入点到根节点路径上的子树都增加了一个节点
+		parent->size++;
 	// 至此二叉查找树的节点插入结束，接下来进行再平衡，修复红黑树的性质并返回根节点
 	return __rbt_insert_rebalance(node, root);
 }
@@ -768,7 +840,7 @@ static rbt_node_p __rbt_insert_rebalance(rbt_node_p node, rbt_node_p root)
  *--------------------------------------------------------------
  * 说明：由于删除节点时仅在符合条件left[z] != nil[T] and right[z] != nil[T]时才去z的中序后继作为替身，所以可以明确这里的TREE-SUCCESSOR算法可以简化为TREE-MINIMUN(right[z])
  */
-static rbt_node_p __rbt_delete(rbt_node_p node, rbt_node_p root)
+static rbt_node_p __rbt_delete(set_p set, rbt_node_p node, rbt_node_p root)
 {
 	rbt_node_p remove = node, dnode, parent;
 	RBT_Color color;
@@ -793,10 +865,12 @@ static rbt_node_p __rbt_delete(rbt_node_p node, rbt_node_p root)
 			remove->parent->right = dnode;
 	else
 		root = dnode;						// 经过4-12步，如果remove既没有parent又没有子树，那么说明remove是树里最后一个节点，此时root==dnode==NULL
-	__element_destroy(node->element);
+	for (rbt_node_p p = parent; p; p = p->parent)			// remove的父节点到根节点路径上的子树都减少了一个节点，node在这条路径上
+		p->size--;
+	__element_destroy(set->eslab, node->element);
 	if (remove != node)						// 13, 14, 15, 如果是用了中序后继作为替身，那么把替身中的元素复制到要被删除的节点node中去
 		node->element = remove->element;
-	free(remove);
+	__slab_free(set->nslab, remove);
 	if (color == Black)
 		root = __rbt_delete_rebalance(dnode, parent, root);
 	return root;
@@ -900,157 +974,1314 @@ static rbt_node_p __rbt_delete_rebalance(rbt_node_p node, rbt_node_p parent, rbt
 	return root;
 }
 
-static void __it_push(set_it_p it, rbt_node_p node)
+/**
+ * 创建一个新的B+树节点
+ */
+static bt_node_p __bt_new_node(set_p set, int leaf)
 {
-	*(it->top++) = node;
+	bt_node_p node = (bt_node_p)__slab_alloc(set->nslab, sizeof(bt_node_t));
+	if (node) {
+		node->leaf = leaf;
+		node->count = 0;
+		node->total = 0;
+		node->prev = NULL;
+		node->next = NULL;
+	}
+	return node;
 }
 
-static rbt_node_p __it_pop(set_it_p it)
+/**
+ * 销毁子树中的所有节点，elements非0时叶节点中的元素一并销毁，否则元素由调用者负责处理
+ */
+static void __bt_removeall(set_p set, bt_node_p node, int elements)
 {
-	return *(--it->top);
+	if (!node)
+		return;
+	if (node->leaf) {
+		for (int i = 0; elements && i < node->count; i++)
+			__element_destroy(set->eslab, node->keys[i].element);
+	} else {
+		for (int i = 0; i <= node->count; i++)
+			__bt_removeall(set, node->children[i], elements);
+	}
+	__slab_free(set->nslab, node);
 }
 
-static int __it_stack_empty(set_it_p it)
+/**
+ * 沿叶节点链表按顺序用访问函数访问所有元素，asc为0时按逆序访问，count累计已访问的元素数量
+ * 访问函数返回非0时终止遍历并返回1，否则返回0
+ */
+static int __bt_foreach(bt_node_p root, int asc, VisitFunc visit, void *ctx, size_t *count)
 {
-	return it->stack == it->top;
+	for (bt_node_p leaf = __bt_edge(root, asc); leaf; leaf = asc ? leaf->next : leaf->prev) {
+		for (int i = 0; i < leaf->count; i++) {
+			(*count)++;
+			if (__element_visit(leaf->keys[asc ? i : leaf->count - 1 - i].element, visit, ctx))
+				return 1;
+		}
+	}
+	return 0;
 }
 
-static set_it_p __set_iterator(set_p set, int dir)
+/**
+ * 找到子树中最左（asc非0）或最右（asc为0）的叶节点，子树为空时返回NULL
+ */
+static bt_node_p __bt_edge(bt_node_p node, int asc)
 {
-	set_it_p ret = (set_it_p)malloc(sizeof(set_it_t));
-	unsigned int len = lg2(set->size + 1);
-	len = len << 1;			// 红黑树最大树高度小于2*lg2(size+1)
-	rbt_node_p *stack = (rbt_node_p *)malloc(len * sizeof(rbt_node_p));
-	if (ret && stack) {
-		ret->asc = dir;
-		ret->set = set;
-		ret->stack = stack;
-		ret->top = ret->stack;
-		ret->changes = set->changes;
-		rbt_node_p current = set->root;
-		while (current != NULL) {
-			__it_push(ret, current);
-			current = ret->asc ? current->left : current->right;
-		}
-	} else {
-		free(ret);
-		free(stack);
-		ret = NULL;
-	}
-	return ret;
+	while (node && !node->leaf)
+		node = node->children[asc ? 0 : node->count];
+	return node;
 }
 
-static rbt_node_p __set_it_next_node(set_it_p it)
+/**
+ * 在节点的键中二分查找第一个不小于key的键，整数键模式下直接比较整数，否则用比较函数比较元素
+ *
+ * set
+ *	集合
+ * node
+ *	节点
+ * key
+ *	查找的键
+ * found
+ *	保存是否找到相等的键
+ *
+ * return
+ *	第一个不小于key的键的位置，所有键都小于key时为键的数量
+ */
+static int __bt_find(set_p set, bt_node_p node, bt_key_p key, int *found)
 {
-	rbt_node_p ret = NULL;
-	if (it && it->set) {
-		if (it->changes != it->set->changes)	// 迭代时集合变更，迭代结束，返回NULL
-			it->top = it->stack;
-		if (!__it_stack_empty(it)) {
-			ret = __it_pop(it);
-			if (it->asc ? ret->right != NULL : ret->left != NULL) {
-				rbt_node_p current = it->asc ? ret->right : ret->left;
-				while (current != NULL) {
-					__it_push(it, current);
-					current = it->asc ? current->left : current->right;
-				}
+	int lo = 0, hi = node->count;
+	*found = 0;
+	if (set->ikey) {
+		Integer ik = key->ik;
+		while (lo < hi) {
+			int mid = (lo + hi) >> 1;
+			if (node->keys[mid].ik < ik) {
+				lo = mid + 1;
+			} else if (node->keys[mid].ik > ik) {
+				hi = mid;
+			} else {
+				*found = 1;
+				return mid;
+			}
+		}
+	} else {
+		element_p e = key->element;
+		while (lo < hi) {
+			int mid = (lo + hi) >> 1;
+			element_p k = node->keys[mid].element;
+			int cmp = set->cmpfunc(e->value, k->value, e->len, k->len);
+			if (cmp > 0) {
+				lo = mid + 1;
+			} else if (cmp < 0) {
+				hi = mid;
+			} else {
+				*found = 1;
+				return mid;
 			}
 		}
 	}
-	return ret;
+	return lo;
 }
 
 /**
- * 重置迭代器
+ * 从根节点向下找到ele应处的叶节点，内部节点中找到相等的键时进入其右侧的子树
+ * 叶节点中所有元素都小于ele时pos等于叶节点的键数量，此时第一个不小于ele的元素在下一个叶节点的开头
+ *
+ * return
+ *	叶节点，pos保存第一个不小于ele的元素在叶节点中的位置，found保存是否找到相等的元素，树为空时返回NULL
  */
-static void __set_it_reset(void *it)
+static bt_node_p __bt_locate(set_p set, element_p ele, int *pos, int *found)
 {
-	if (it && ((set_it_p)it)->set) {
-		set_it_p iterator = (set_it_p)it;
-		set_p set = iterator->set;
-		unsigned int len = lg2(set->size + 1);
-		len = len << 1;			// 红黑树最大树高度小于2*lg2(size+1)
-		rbt_node_p *stack = (rbt_node_p *)malloc(len * sizeof(rbt_node_p));
-		if (stack) {
-			free(iterator->stack);
-			iterator->stack = stack;
-			iterator->top = iterator->stack;
-			pthread_mutex_lock(&set->mut);
-			iterator->changes = set->changes;
-			rbt_node_p current = set->root;
-			while (current != NULL) {
-				__it_push(iterator, current);
-				current = iterator->asc ? current->left : current->right;
-			}
-			pthread_mutex_unlock(&set->mut);
-		}
+	bt_key_t key = { set->ikey ? *(Integer *)ele->value : 0, ele };
+	bt_node_p node = set->btree;
+	while (node && !node->leaf) {
+		int i = __bt_find(set, node, &key, found);
+		node = node->children[*found ? i + 1 : i];
 	}
+	if (node)
+		*pos = __bt_find(set, node, &key, found);
+	return node;
 }
 
 /**
- * 迭代访问一个迭代器中的下一个元素
+ * 查找与ele相等的元素
  *
- * it
- *	集合迭代器的指针
+ * return
+ *	元素所在的叶节点，pos保存元素在叶节点中的位置，找不到返回NULL
+ */
+static bt_node_p __bt_search(set_p set, element_p ele, int *pos)
+{
+	int found;
+	bt_node_p node = __bt_locate(set, ele, pos, &found);
+	return found ? node : NULL;
+}
+
+/**
+ * 分裂parent的第i个子节点，新节点作为第i + 1个子节点，parent须未满，子节点须已满，分裂前分配新节点，分配失败时树不变
+ * 叶节点分裂时右半部分复制到新节点，新节点的第一个元素作为分隔键；内部节点分裂时中间的键上移到parent中
+ * 向最右的叶节点尾部添加元素时只把最后一个元素分到新节点，按递增顺序添加元素时叶节点接近全满
+ *
+ * set
+ *	集合
+ * parent
+ *	父节点
+ * i
+ *	须分裂的子节点的位置
+ * key
+ *	正在插入的键，用于判断是否在尾部添加
  *
  * return
- * 	迭代中的下一个元素，迭代器无效或已经迭代完成时返回NULL
+ *	分裂成功返回0，内存不足返回-1
  */
-static Element __set_it_next(void *it)
+static int __bt_split(set_p set, bt_node_p parent, int i, bt_key_p key)
 {
-	rbt_node_p node = NULL;
-	if (it && ((set_it_p)it)->set) {
-		set_p set = ((set_it_p)it)->set;
-		pthread_mutex_lock(&set->mut);
-		node = __set_it_next_node(it);
-		pthread_mutex_unlock(&set->mut);
+	bt_node_p child = parent->children[i];
+	bt_node_p right = __bt_new_node(set, child->leaf);
+	if (!right)
+		return -1;
+	int found, mid = BT_MAX / 2;
+	bt_key_t sep;
+	if (child->leaf) {
+		if (!child->next && __bt_find(set, child, key, &found) == BT_MAX)
+			mid = BT_MAX - 1;
+		right->count = BT_MAX - mid;
+		memcpy(right->keys, child->keys + mid, right->count * sizeof(bt_key_t));
+		right->prev = child;
+		right->next = child->next;
+		if (child->next)
+			child->next->prev = right;
+		child->next = right;
+		sep = right->keys[0];
+	} else {
+		right->count = BT_MAX - mid - 1;
+		memcpy(right->keys, child->keys + mid + 1, right->count * sizeof(bt_key_t));
+		memcpy(right->children, child->children + mid + 1, (right->count + 1) * sizeof(bt_node_p));
+		for (int j = 0; j <= right->count; j++)
+			right->total += BT_SIZE(right->children[j]);
+		child->total -= right->total;
+		sep = child->keys[mid];
 	}
-	return node ? __element_clone_value(node->element) : NULL;
+	child->count = mid;
+	memmove(parent->keys + i + 1, parent->keys + i, (parent->count - i) * sizeof(bt_key_t));
+	memmove(parent->children + i + 2, parent->children + i + 1, (parent->count - i) * sizeof(bt_node_p));
+	parent->keys[i] = sep;
+	parent->children[i + 1] = right;
+	parent->count++;
+	return 0;
 }
 
 /**
- * 迭代器删除元素，集合迭代器不支持删除元素，直接返回0
+ * 向B+树中插入一个元素，自顶向下查找插入位置，途中预先分裂已满的节点，因此插入到叶节点时不会再向上分裂
+ * 所有分配都在修改之前进行，内存不足时树保持有效，只是可能已经分裂了部分节点
+ *
+ * return
+ *	插入成功返回0，元素重复或内存不足返回-1，元素由调用者负责处理
  */
-static size_t __set_it_remove(void *it)
+static int __bt_insert(set_p set, element_p ele)
 {
+	bt_key_t key = { set->ikey ? *(Integer *)ele->value : 0, ele };
+	int found;
+	if (!set->btree && !(set->btree = __bt_new_node(set, 1)))
+		return -1;
+	if (set->btree->count == BT_MAX) {		// 根节点已满，先增加一层
+		bt_node_p root = __bt_new_node(set, 0);
+		if (!root)
+			return -1;
+		root->children[0] = set->btree;
+		root->total = BT_SIZE(set->btree);
+		if (__bt_split(set, root, 0, &key) != 0) {
+			__slab_free(set->nslab, root);
+			return -1;
+		}
+		set->btree = root;
+	}
+	bt_node_p node = set->btree, path[BT_DEPTH];
+	int depth = 0;
+	while (!node->leaf) {
+		int i = __bt_find(set, node, &key, &found);
+		if (found)
+			return -1;
+		if (node->children[i]->count == BT_MAX) {
+			if (__bt_split(set, node, i, &key) != 0)
+				return -1;
+			bt_key_p sep = &node->keys[i];		// 分裂后上移的分隔键，可能与key相等
+			int cmp = set->ikey ? (key.ik > sep->ik) - (key.ik < sep->ik) : set->cmpfunc(ele->value, sep->element->value, ele->len, sep->element->len);
+			if (cmp == 0)
+				return -1;
+			if (cmp > 0)
+				i++;
+		}
+		path[depth++] = node;
+		node = node->children[i];
+	}
+	int pos = __bt_find(set, node, &key, &found);
+	if (found)
+		return -1;
+	memmove(node->keys + pos + 1, node->keys + pos, (node->count - pos) * sizeof(bt_key_t));
+	node->keys[pos] = key;
+	node->count++;
+	while (depth > 0)		// 插入成功后路径上的内部节点都增加了一个元素
+		path[--depth]->total++;
 	return 0;
 }
 
 /**
- * 迭代器销毁
+ * 把parent的第i + 1个子节点合并到第i个子节点中并销毁，内部节点合并时parent中的分隔键下移到合并后的节点中
  */
-static void __set_it_destroy(void *it)
+static void __bt_merge(set_p set, bt_node_p parent, int i)
 {
-	if (it) {
-		free(((set_it_p)it)->stack);
-		free(it);
+	bt_node_p left = parent->children[i];
+	bt_node_p right = parent->children[i + 1];
+	if (left->leaf) {
+		memcpy(left->keys + left->count, right->keys, right->count * sizeof(bt_key_t));
+		left->count += right->count;
+		left->next = right->next;
+		if (right->next)
+			right->next->prev = left;
+	} else {
+		left->keys[left->count] = parent->keys[i];
+		memcpy(left->keys + left->count + 1, right->keys, right->count * sizeof(bt_key_t));
+		memcpy(left->children + left->count + 1, right->children, (right->count + 1) * sizeof(bt_node_p));
+		left->count += right->count + 1;
+		left->total += right->total;
+	}
+	memmove(parent->keys + i, parent->keys + i + 1, (parent->count - i - 1) * sizeof(bt_key_t));
+	memmove(parent->children + i + 1, parent->children + i + 2, (parent->count - i - 1) * sizeof(bt_node_p));
+	parent->count--;
+	__slab_free(set->nslab, right);
+}
+
+/**
+ * parent的第i个子节点的键数量低于BT_MIN时重新平衡，兄弟节点的键多于BT_MIN时借一个键，否则与兄弟节点合并
+ */
+static void __bt_rebalance(set_p set, bt_node_p parent, int i)
+{
+	bt_node_p child = parent->children[i];
+	bt_node_p left = i > 0 ? parent->children[i - 1] : NULL;
+	bt_node_p right = i < parent->count ? parent->children[i + 1] : NULL;
+	if (left && left->count > BT_MIN) {		// 从左兄弟借最后一个键
+		memmove(child->keys + 1, child->keys, child->count * sizeof(bt_key_t));
+		if (child->leaf) {
+			child->keys[0] = left->keys[left->count - 1];
+			parent->keys[i - 1] = child->keys[0];
+		} else {
+			memmove(child->children + 1, child->children, (child->count + 1) * sizeof(bt_node_p));
+			child->keys[0] = parent->keys[i - 1];
+			child->children[0] = left->children[left->count];
+			parent->keys[i - 1] = left->keys[left->count - 1];
+			child->total += BT_SIZE(child->children[0]);
+			left->total -= BT_SIZE(child->children[0]);
+		}
+		left->count--;
+		child->count++;
+	} else if (right && right->count > BT_MIN) {	// 从右兄弟借第一个键
+		if (child->leaf) {
+			child->keys[child->count] = right->keys[0];
+			memmove(right->keys, right->keys + 1, (right->count - 1) * sizeof(bt_key_t));
+			parent->keys[i] = right->keys[0];
+		} else {
+			child->keys[child->count] = parent->keys[i];
+			child->children[child->count + 1] = right->children[0];
+			parent->keys[i] = right->keys[0];
+			child->total += BT_SIZE(right->children[0]);
+			right->total -= BT_SIZE(right->children[0]);
+			memmove(right->keys, right->keys + 1, (right->count - 1) * sizeof(bt_key_t));
+			memmove(right->children, right->children + 1, right->count * sizeof(bt_node_p));
+		}
+		right->count--;
+		child->count++;
+	} else if (left) {
+		__bt_merge(set, parent, i - 1);
+	} else if (right) {
+		__bt_merge(set, parent, i);
 	}
 }
 
 /**
- * 复制集合，复制时元素只是复制了指针而没有复制内容
+ * 从子树中删除与key相等的元素，返回被删除的元素，找不到返回NULL
+ * 元素同时是某个内部节点中的分隔键时，向下删除之前先把分隔键换成它的后继元素，删除后子节点的键数量不足时重新平衡
  */
-static void __set_clone(set_p dest, set_p src)
+static element_p __bt_delete_aux(set_p set, bt_node_p node, bt_key_p key)
 {
-	__rbt_clone(dest, src->root);
+	int found;
+	int i = __bt_find(set, node, key, &found);
+	if (node->leaf) {
+		if (!found)
+			return NULL;
+		element_p ret = node->keys[i].element;
+		memmove(node->keys + i, node->keys + i + 1, (node->count - i - 1) * sizeof(bt_key_t));
+		node->count--;
+		return ret;
+	}
+	if (found) {			// 元素是children[i + 1]中的最小元素，它所在的叶节点是children[i + 1]最左的叶节点
+		bt_node_p leaf = __bt_edge(node->children[i + 1], 1);
+		if (leaf->count > 1)
+			node->keys[i] = leaf->keys[1];
+		else if (leaf->next)
+			node->keys[i] = leaf->next->keys[0];
+		i++;
+	}
+	element_p ret = __bt_delete_aux(set, node->children[i], key);
+	if (ret) {
+		node->total--;
+		if (node->children[i]->count < BT_MIN)
+			__bt_rebalance(set, node, i);
+	}
+	return ret;
 }
 
 /**
- * 复制二叉树，采用先序遍历顺序复制，插入新节点开销最小
+ * 从B+树中删除与ele相等的元素，根节点只剩一个子节点时降低一层，树为空时释放根节点
+ *
+ * return
+ *	被删除的元素，由调用者负责销毁，找不到返回NULL
  */
-static void __rbt_clone(set_p dest, rbt_node_p src)
+static element_p __bt_delete(set_p set, element_p ele)
 {
-	if (!src)
-		return;
-	element_p e = __element_create(src->element->value, src->element->type, src->element->len);
-	if (!e)
-		return;
-	rbt_node_p root = __rbt_insert(e, dest->root, dest->cmpfunc);
-	if (root) {
-		dest->root = root;
-		dest->size++;
+	if (!set->btree)
+		return NULL;
+	bt_key_t key = { set->ikey ? *(Integer *)ele->value : 0, ele };
+	element_p ret = __bt_delete_aux(set, set->btree, &key);
+	bt_node_p root = set->btree;
+	if (!root->leaf && root->count == 0) {
+		set->btree = root->children[0];
+		__slab_free(set->nslab, root);
+	} else if (root->leaf && root->count == 0) {
+		set->btree = NULL;
+		__slab_free(set->nslab, root);
 	}
-	__rbt_clone(dest, src->left);
-	__rbt_clone(dest, src->right);
-	return;
+	return ret;
+}
+
+static void __it_push(set_it_p it, rbt_node_p node)
+{
+	*(it->top++) = node;
+}
+
+static rbt_node_p __it_pop(set_it_p it)
+{
+	return *(--it->top);
+}
+
+static int __it_stack_empty(set_it_p it)
+{
+	return it->stack == it->top;
+}
+
+/**
+ * 生成一个迭代器，迭代器、红黑树迭代用的堆栈和范围端点较长的元素值都由集合的分配器分配，调用前须加锁
+ */
+static set_it_p __set_iterator(set_p set, int dir, Element lo, Element hi, size_t lolen, size_t hilen)
+{
+	set_it_p ret = (set_it_p)__mr_malloc(&set->alloc, sizeof(set_it_t));
+	if (!ret)
+		return NULL;
+	ret->alloc = set->alloc;
+	ret->stack = NULL;
+	ret->lo = lo ? __element_temp(&ret->lot, &ret->alloc, lo, set->type, lolen) : NULL;
+	ret->hi = hi ? __element_temp(&ret->hit, &ret->alloc, hi, set->type, hilen) : NULL;
+	if (set->stype == RBTreeSet) {
+		unsigned int len = lg2(set->size + 1);
+		len = len << 1;			// 红黑树最大树高度小于2*lg2(size+1)
+		ret->stack = (rbt_node_p *)__mr_malloc(&ret->alloc, len * sizeof(rbt_node_p));
+	}
+	if ((ret->stack || set->stype == BPlusTreeSet) && (!lo || ret->lo) && (!hi || ret->hi)) {
+		ret->asc = dir;
+		ret->set = set;
+		__set_it_start(ret);
+	} else {
+		__set_it_destroy(ret);
+		ret = NULL;
+	}
+	return ret;
+}
+
+/**
+ * 用集合的分配器把集合迭代器封装成Iterator，it为NULL或内存不足时返回NULL
+ */
+static Iterator __set_it_wrap(set_it_p it)
+{
+	Iterator ret = it ? __it_create(&it->alloc, it, __set_it_next, __set_it_next_with, __set_it_next_batch, __set_it_remove, __set_it_reset, __set_it_destroy) : NULL;
+	if (it && !ret)
+		__set_it_destroy(it);
+	return ret;
+}
+
+/**
+ * 把迭代器置于起始位置，调用前须加锁
+ * 红黑树集合从根节点向下把起始元素的所有祖先中排在起始元素之后（反向迭代时为之前）的节点压栈，栈顶即为起始元素
+ * B+树集合定位到起始元素所在的叶节点，正向迭代的起始元素为第一个不小于lo的元素，反向迭代的起始元素为最后一个小于hi的元素
+ */
+static void __set_it_start(set_it_p it)
+{
+	set_p set = it->set;
+	element_p from = it->asc ? it->lo : it->hi;
+	it->changes = set->changes;
+	if (set->stype == BPlusTreeSet) {
+		int found;
+		if (!from) {
+			it->leaf = __bt_edge(set->btree, it->asc);
+			it->pos = it->leaf && !it->asc ? it->leaf->count - 1 : 0;
+		} else if ((it->leaf = __bt_locate(set, from, &it->pos, &found))) {
+			if (it->asc && it->pos == it->leaf->count) {
+				it->leaf = it->leaf->next;
+				it->pos = 0;
+			} else if (!it->asc && it->pos-- == 0) {
+				it->leaf = it->leaf->prev;
+				it->pos = it->leaf ? it->leaf->count - 1 : 0;
+			}
+		}
+	} else {
+		it->top = it->stack;
+		rbt_node_p current = set->root;
+		while (current != NULL) {
+			int cmp = from ? set->cmpfunc(current->element->value, from->value, current->element->len, from->len) : 0;
+			if (!from || (it->asc ? cmp >= 0 : cmp < 0)) {
+				__it_push(it, current);
+				current = it->asc ? current->left : current->right;
+			} else {
+				current = it->asc ? current->right : current->left;
+			}
+		}
+	}
+}
+
+/**
+ * 按迭代方向迭代到下一个元素，调用前须加锁，迭代时集合发生变更则迭代结束
+ *
+ * it
+ *	集合迭代器
+ *
+ * return
+ *	下一个元素，迭代结束返回NULL
+ */
+static element_p __set_it_next_element(set_it_p it)
+{
+	element_p ret = NULL;
+	if (it && it->set) {
+		set_p set = it->set;
+		if (set->stype == BPlusTreeSet) {
+			if (it->changes != set->changes)	// 迭代时集合变更，迭代结束，返回NULL
+				it->leaf = NULL;
+			if (it->leaf) {
+				ret = it->leaf->keys[it->pos].element;
+				if (it->asc ? ++it->pos == it->leaf->count : it->pos-- == 0) {
+					it->leaf = it->asc ? it->leaf->next : it->leaf->prev;
+					it->pos = it->leaf && !it->asc ? it->leaf->count - 1 : 0;
+				}
+			}
+		} else {
+			if (it->changes != set->changes)	// 迭代时集合变更，迭代结束，返回NULL
+				it->top = it->stack;
+			if (!__it_stack_empty(it)) {
+				rbt_node_p node = __it_pop(it);
+				ret = node->element;
+				if (it->asc ? node->right != NULL : node->left != NULL) {
+					rbt_node_p current = it->asc ? node->right : node->left;
+					while (current != NULL) {
+						__it_push(it, current);
+						current = it->asc ? current->left : current->right;
+					}
+				}
+			}
+		}
+		element_p to = it->asc ? it->hi : it->lo;
+		if (ret && to) {			// 范围迭代越过终点，迭代结束
+			int cmp = set->cmpfunc(ret->value, to->value, ret->len, to->len);
+			if (it->asc ? cmp >= 0 : cmp < 0) {
+				ret = NULL;
+				it->leaf = NULL;
+				it->top = it->stack;
+			}
+		}
+	}
+	return ret;
+}
+
+/**
+ * 重置迭代器
+ */
+static void __set_it_reset(void *it)
+{
+	if (it && ((set_it_p)it)->set) {
+		set_it_p iterator = (set_it_p)it;
+		set_p set = iterator->set;
+		__lock_rdlock(&set->lock);
+		if (set->stype == RBTreeSet) {
+			unsigned int len = lg2(set->size + 1);
+			len = len << 1;			// 红黑树最大树高度小于2*lg2(size+1)
+			rbt_node_p *stack = (rbt_node_p *)__mr_malloc(&iterator->alloc, len * sizeof(rbt_node_p));
+			if (!stack) {
+				__lock_unlock(&set->lock);
+				return;
+			}
+			__mr_free(&iterator->alloc, iterator->stack);
+			iterator->stack = stack;
+		}
+		__set_it_start(iterator);
+		__lock_unlock(&set->lock);
+	}
+}
+
+/**
+ * 迭代访问一个迭代器中的下一个元素
+ *
+ * it
+ *	集合迭代器的指针
+ *
+ * return
+ * 	迭代中的下一个元素，迭代器无效或已经迭代完成时返回NULL
+ */
+static Element __set_it_next(void *it)
+{
+	Element ret = NULL;
+	if (it && ((set_it_p)it)->set) {
+		set_p set = ((set_it_p)it)->set;
+		__lock_rdlock(&set->lock);
+		element_p e = __set_it_next_element(it);
+		if (e)
+			ret = __element_clone_value(set->eslab, e);	// 须在解锁前复制，解锁后节点可能被其他线程删除
+		__lock_unlock(&set->lock);
+	}
+	return ret;
+}
+
+/**
+ * 用访问函数迭代访问一个迭代器中的下一个元素，不复制元素
+ *
+ * it
+ *	集合迭代器的指针
+ * visit
+ *	访问函数
+ * ctx
+ *	传递给访问函数的上下文
+ *
+ * return
+ * 	访问成功返回0，迭代器无效或已经迭代完成时返回-1
+ */
+static int __set_it_next_with(void *it, VisitFunc visit, void *ctx)
+{
+	int ret = -1;
+	if (it && ((set_it_p)it)->set) {
+		set_p set = ((set_it_p)it)->set;
+		__lock_rdlock(&set->lock);
+		element_p e = __set_it_next_element(it);
+		if (e) {
+			__element_visit(e, visit, ctx);
+			ret = 0;
+		}
+		__lock_unlock(&set->lock);
+	}
+	return ret;
+}
+
+/**
+ * 一次迭代最多n个元素，把元素的副本依次写入out，整批只加锁一次
+ *
+ * it
+ *	集合迭代器的指针
+ * out
+ *	保存元素副本的数组
+ * n
+ *	最多迭代的元素数量
+ *
+ * return
+ * 	写入out的元素数量，小于n表示迭代结束或内存不足
+ */
+static size_t __set_it_next_batch(void *it, Element *out, size_t n)
+{
+	size_t count = 0;
+	if (it && ((set_it_p)it)->set && out) {
+		set_p set = ((set_it_p)it)->set;
+		element_p e;
+		__lock_rdlock(&set->lock);
+		while (count < n && (e = __set_it_next_element(it)) && (out[count] = __element_clone_value(set->eslab, e)))
+			count++;
+		__lock_unlock(&set->lock);
+	}
+	return count;
+}
+
+/**
+ * 迭代器删除元素，集合迭代器不支持删除元素，直接返回0
+ */
+static size_t __set_it_remove(void *it)
+{
+	return 0;
+}
+
+/**
+ * 迭代器销毁
+ */
+static void __set_it_destroy(void *it)
+{
+	if (it) {
+		Allocator_t alloc = ((set_it_p)it)->alloc;
+		__mr_free(&alloc, ((set_it_p)it)->stack);
+		__element_temp_release(&alloc, ((set_it_p)it)->lo);
+		__element_temp_release(&alloc, ((set_it_p)it)->hi);
+		__mr_free(&alloc, it);
+	}
+}
+
+/**
+ * 创建一个与proto的元素类型、比较函数和创建属性都相同的空集合，用于存放集合运算的结果
+ */
+static Container __set_create_like(set_p proto)
+{
+	ContainerAttr_t attr = { .slab = proto->eslab->active, .allocator = &proto->alloc, .lock = proto->lock.policy };
+	return set_create_typed(proto->type, proto->stype, proto->cmpfunc, &attr);
+}
+
+/**
+ * 删除集合中的所有元素，slab模式下如果所有元素值都内联存储，则不遍历树，直接整块释放全部节点和元素
+ */
+static void __set_clear(set_p set)
+{
+	if (!SLAB_RELEASABLE(set->eslab)) {
+		if (set->stype == BPlusTreeSet)
+			__bt_removeall(set, set->btree, 1);
+		else
+			__rbt_removeall(set, set->root, 1);
+	}
+	__slab_reset(set->nslab);
+	__slab_reset(set->eslab);
+	set->root = NULL;
+	set->btree = NULL;
+	set->size = 0;
+}
+
+/**
+ * 向集合中添加一个元素，直接引用元素而不复制，添加失败或元素重复时返回-1，元素由调用者负责处理，调用前须对集合加锁
+ */
+static int __set_add(set_p set, element_p e)
+{
+	int ret = -1;
+	if (set->stype == BPlusTreeSet) {
+		ret = __bt_insert(set, e);
+	} else {
+		rbt_node_p r = __rbt_insert(set, e, set->root, set->cmpfunc);
+		if (r) {
+			// 插入时如果元素重复或者发生错误插入失败则返回NULL，否则返回插入后的红黑树的新根节点
+			set->root = r;
+			ret = 0;
+		}
+	}
+	if (ret == 0) {
+		set->size++;
+		set->changes++;
+	}
+	return ret;
+}
+
+/**
+ * 从集合中删除与e相等的元素并销毁，调用前须对集合加锁
+ *
+ * return
+ *	删除了元素返回1，找不到返回0
+ */
+static int __set_remove(set_p set, element_p e)
+{
+	int ret = 0;
+	if (set->stype == BPlusTreeSet) {
+		element_p found = __bt_delete(set, e);
+		if (found) {
+			__element_destroy(set->eslab, found);
+			ret = 1;
+		}
+	} else {
+		rbt_node_p node = __rbt_search(e, set->root, set->cmpfunc);
+		if (node != NULL) {		// 找到要删除的元素
+			ret = 1;
+			set->root = __rbt_delete(set, node, set->root);
+		}
+	}
+	if (ret) {
+		set->size--;
+		set->changes++;
+	}
+	return ret;
+}
+
+/**
+ * 查找集合中与e相等的元素，调用前须加锁
+ *
+ * return
+ *	集合中的元素，找不到返回NULL
+ */
+static element_p __set_find(set_p set, element_p e)
+{
+	if (set->stype == BPlusTreeSet) {
+		int pos;
+		bt_node_p leaf = __bt_search(set, e, &pos);
+		return leaf ? leaf->keys[pos].element : NULL;
+	}
+	rbt_node_p node = __rbt_search(e, set->root, set->cmpfunc);
+	return node ? node->element : NULL;
+}
+
+/**
+ * 计算集合中小于e的元素数量，即e在集合中的排名，e不必在集合中，调用前须加锁
+ * 红黑树从根节点向下查找，每次进入右子树时累加左子树和当前节点的数量；B+树每次进入子节点时累加其左侧各子树的元素数量
+ */
+static size_t __set_rank(set_p set, element_p e)
+{
+	size_t ret = 0;
+	if (set->stype == BPlusTreeSet) {
+		bt_key_t key = { set->ikey ? *(Integer *)e->value : 0, e };
+		bt_node_p node = set->btree;
+		int found;
+		while (node && !node->leaf) {
+			int i = __bt_find(set, node, &key, &found);
+			if (found)		// 与分隔键相等的元素是右侧子树中的最小元素
+				i++;
+			for (int j = 0; j < i; j++)
+				ret += BT_SIZE(node->children[j]);
+			node = node->children[i];
+		}
+		if (node)
+			ret += __bt_find(set, node, &key, &found);
+		return ret;
+	}
+	rbt_node_p node = set->root;
+	while (node) {
+		int cmp = set->cmpfunc(e->value, node->element->value, e->len, node->element->len);
+		if (cmp < 0) {
+			node = node->left;
+		} else {
+			ret += RBT_SIZE(node->left);
+			if (cmp == 0)
+				break;
+			ret++;
+			node = node->right;
+		}
+	}
+	return ret;
+}
+
+/**
+ * 查找集合中从小到大第k个元素，k从0开始计数，须小于元素数量，调用前须加锁
+ */
+static element_p __set_select(set_p set, size_t k)
+{
+	if (set->stype == BPlusTreeSet) {
+		bt_node_p node = set->btree;
+		while (!node->leaf) {
+			int i = 0;
+			while (k >= BT_SIZE(node->children[i])) {
+				k -= BT_SIZE(node->children[i]);
+				i++;
+			}
+			node = node->children[i];
+		}
+		return node->keys[k].element;
+	}
+	rbt_node_p node = set->root;
+	while (k != RBT_SIZE(node->left)) {
+		if (k < RBT_SIZE(node->left)) {
+			node = node->left;
+		} else {
+			k -= RBT_SIZE(node->left) + 1;
+			node = node->right;
+		}
+	}
+	return node->element;
+}
+
+/**
+ * 查找集合中与e最接近的元素，e不必在集合中，调用前须加锁
+ *
+ * set
+ *	集合
+ * e
+ *	查找的元素
+ * dir
+ *	Forward查找大于e的最小元素，Reverse查找小于e的最大元素
+ * inclusive
+ *	非0时与e相等的元素也符合条件
+ *
+ * return
+ *	找到的元素，不存在符合条件的元素时返回NULL
+ */
+static element_p __set_bound(set_p set, element_p e, int dir, int inclusive)
+{
+	if (set->stype == BPlusTreeSet) {
+		int pos, found;
+		bt_node_p leaf = __bt_locate(set, e, &pos, &found);
+		if (!leaf)
+			return NULL;
+		if (found && inclusive)
+			return leaf->keys[pos].element;
+		if (dir == Forward) {
+			pos += found;
+			if (pos == leaf->count) {	// 叶节点中的元素都不大于e，取下一个叶节点的第一个元素
+				leaf = leaf->next;
+				pos = 0;
+			}
+		} else if (pos-- == 0) {		// 叶节点中的元素都不小于e，取上一个叶节点的最后一个元素
+			leaf = leaf->prev;
+			pos = leaf ? leaf->count - 1 : 0;
+		}
+		return leaf ? leaf->keys[pos].element : NULL;
+	}
+	rbt_node_p node = set->root, ret = NULL;
+	while (node) {			// 记录途经的节点中符合条件的最后一个，即最接近e的一个
+		int cmp = set->cmpfunc(e->value, node->element->value, e->len, node->element->len);
+		if (cmp == 0 && inclusive)
+			return node->element;
+		if (dir == Forward ? cmp < 0 : cmp > 0) {
+			ret = node;
+			node = dir == Forward ? node->left : node->right;
+		} else {
+			node = dir == Forward ? node->right : node->left;
+		}
+	}
+	return ret ? ret->element : NULL;
+}
+
+/**
+ * set_floor(), set_ceiling(), set_lower(), set_higher()的实现，参数dir和inclusive的含义与__set_bound()相同
+ */
+static Element __set_nav(Container set, Element element, ElementType type, size_t len, int dir, int inclusive)
+{
+	Element ret = NULL;
+	element_tmp_t tmp;
+	element_p e = NULL;
+	if (IS_VALID_SET(set) && element && len && ((set_p)set->container)->type == type && (e = __element_temp(&tmp, &((set_p)set->container)->alloc, element, type, len))) {
+		set_p s = (set_p)set->container;
+		__lock_rdlock(&s->lock);
+		element_p found = __set_bound(s, e, dir, inclusive);
+		if (found)
+			ret = __element_clone_value(s->eslab, found);	// 须在解锁前复制
+		__lock_unlock(&s->lock);
+		__element_temp_release(&s->alloc, e);
+	}
+	return ret;
+}
+
+/**
+ * 集合运算的实现，两个集合都有效时创建结果集合并按keep合并两个集合的元素，两个集合元素类型不一致时结果为空集合
+ * 两个集合按地址顺序加锁，s1和s2为同一个集合时只加一次锁，交集和并集为s1的副本，差集为空集合
+ *
+ * return
+ *	结果集合，有无效集合或内存不足时返回NULL
+ */
+static Container __set_algebra(Container s1, Container s2, int keep)
+{
+	Container ret = NULL;
+	if (IS_VALID_SET(s1) && IS_VALID_SET(s2) && (ret = __set_create_like((set_p)s1->container))) {
+		set_p set1 = (set_p)s1->container;
+		set_p set2 = (set_p)s2->container;
+		set_p set = (set_p)ret->container;
+		int r = 0;
+		if (s1 == s2) {
+			__lock_rdlock(&set1->lock);
+			if (keep != SET_ONLY1)
+				r = __set_merge(set, set1, NULL, SET_ONLY1);
+			__lock_unlock(&set1->lock);
+		} else {
+			__lock_pair(&set1->lock, 0, &set2->lock, 0);	// 互斥锁策略下共享锁也是独占的，同样要按地址顺序加锁
+			if (set1->type == set2->type)
+				r = __set_merge(set, set1, set2, keep);
+			__lock_unlock(&set2->lock);
+			__lock_unlock(&set1->lock);
+		}
+		if (r != 0) {		// 复制元素出错，内存不足，返回NULL
+			set_destroy(ret);
+			ret = NULL;
+		}
+	}
+	return ret;
+}
+
+/**
+ * 按递增顺序同时迭代两个集合，把keep指定的元素复制到数组中，复制完成后用__set_build()一次性构造dest的树
+ * 输出的元素本身就是有序的，因此整个运算的时间复杂度为O(n + m)，不需要逐个插入和重新平衡，调用前须对s1和s2加锁
+ *
+ * dest
+ *	空的结果集合，比较函数与s1相同
+ * s1, s2
+ *	参与运算的集合，s2为NULL时复制s1的全部元素
+ * keep
+ *	SET_ONLY1, SET_ONLY2, SET_BOTH的组合
+ *
+ * return
+ *	成功返回0，内存不足返回-1，此时dest仍为空
+ */
+static int __set_merge(set_p dest, set_p s1, set_p s2, int keep)
+{
+	size_t cap = (keep & (SET_ONLY1 | SET_BOTH) ? s1->size : 0) + (s2 && (keep & SET_ONLY2) ? s2->size : 0);
+	if (cap == 0)
+		return 0;
+	element_p *a = (element_p *)__mr_malloc(&dest->alloc, cap * sizeof(element_p));
+	set_it_p it1 = __set_iterator(s1, Forward, NULL, NULL, 0, 0);
+	set_it_p it2 = s2 ? __set_iterator(s2, Forward, NULL, NULL, 0, 0) : NULL;
+	size_t n = 0;
+	int ret = -1;
+	if (a && it1 && (!s2 || it2)) {
+		element_p e1 = __set_it_next_element(it1);
+		element_p e2 = __set_it_next_element(it2);
+		ret = 0;
+		while (e1 || e2) {
+			if ((!e1 && !(keep & SET_ONLY2)) || (!e2 && !(keep & SET_ONLY1)))
+				break;			// 剩下的元素都不会进入结果
+			int cmp = !e2 ? -1 : !e1 ? 1 : dest->cmpfunc(e1->value, e2->value, e1->len, e2->len);
+			element_p e = NULL;
+			if (cmp < 0) {			// 只在s1中的元素
+				if (keep & SET_ONLY1)
+					e = e1;
+				e1 = __set_it_next_element(it1);
+			} else if (cmp > 0) {		// 只在s2中的元素
+				if (keep & SET_ONLY2)
+					e = e2;
+				e2 = __set_it_next_element(it2);
+			} else {			// 两个集合共有的元素
+				if (keep & SET_BOTH)
+					e = e1;
+				e1 = __set_it_next_element(it1);
+				e2 = __set_it_next_element(it2);
+			}
+			if (e) {
+				if (!(a[n] = __element_clone(dest->eslab, e))) {
+					ret = -1;
+					break;
+				}
+				n++;
+			}
+		}
+		if (ret != 0 || (ret = __set_build(dest, a, n)) != 0) {
+			for (size_t i = 0; i < n; i++)
+				__element_destroy(dest->eslab, a[i]);
+		}
+	}
+	__set_it_destroy(it1);
+	__set_it_destroy(it2);
+	__mr_free(&dest->alloc, a);
+	return ret;
+}
+
+/**
+ * 原地集合运算的实现，用s2修改s1，元素类型不一致时返回-1且不修改s1，两个集合按地址顺序加锁
+ * s1和s2为同一个集合时只加一次锁，交集和并集不变，差集为空集合
+ * s2的元素较少即m log n < n时，并集逐个查找并只复制添加s1中没有的元素，差集逐个删除，时间复杂度为O(m log n)
+ * 否则按顺序合并两个集合，保留的元素不复制，删除的元素整批销毁，再一次性重建s1的树，时间复杂度为O(n + m)
+ *
+ * return
+ *	成功返回0，有无效集合、元素类型不一致或内存不足返回-1，逐个添加时内存不足s1中可能已经添加了部分元素
+ */
+static int __set_algebra_into(Container s1, Container s2, int keep)
+{
+	int ret = -1;
+	if (IS_VALID_SET(s1) && IS_VALID_SET(s2)) {
+		set_p set1 = (set_p)s1->container;
+		set_p set2 = (set_p)s2->container;
+		if (s1 == s2) {			// 自身的并集和交集不变，差集为空集合
+			__lock_wrlock(&set1->lock);
+			if (keep == SET_ONLY1) {
+				__set_clear(set1);
+				set1->changes++;
+			}
+			ret = 0;
+			__lock_unlock(&set1->lock);
+		} else {
+			__lock_pair(&set1->lock, 1, &set2->lock, 0);
+			if (set1->type == set2->type) {
+				size_t n = set1->size, m = set2->size;
+				if (keep != SET_BOTH && m * lg2(n + 1) < n) {
+					set_it_p it = __set_iterator(set2, Forward, NULL, NULL, 0, 0);
+					element_p e;
+					ret = it ? 0 : -1;
+					while (ret == 0 && (e = __set_it_next_element(it))) {
+						if (keep == SET_ONLY1) {
+							__set_remove(set1, e);
+						} else if (!__set_find(set1, e)) {	// 只复制s1中没有的元素
+							element_p copy = __element_clone(set1->eslab, e);
+							if (!copy || __set_add(set1, copy) != 0) {
+								__element_destroy(set1->eslab, copy);
+								ret = -1;
+							}
+						}
+					}
+					__set_it_destroy(it);
+				} else {
+					ret = __set_merge_into(set1, set2, keep);
+				}
+			}
+			__lock_unlock(&set2->lock);
+			__lock_unlock(&set1->lock);
+		}
+	}
+	return ret;
+}
+
+/**
+ * 按递增顺序同时迭代两个集合，s1中保留的元素和s2中复制的元素按顺序放在数组前部，s1中删除的元素放在数组后部
+ * 用前部的元素重建s1的树之后再整批销毁后部的元素，调用前须对s1加写锁、对s2加锁
+ *
+ * return
+ *	成功返回0，内存不足返回-1，此时s1不变
+ */
+static int __set_merge_into(set_p s1, set_p s2, int keep)
+{
+	size_t cap = s1->size + ((keep & SET_ONLY2) ? s2->size : 0);
+	if (cap == 0)
+		return 0;
+	element_p *a = (element_p *)__mr_malloc(&s1->alloc, cap * sizeof(element_p));
+	set_it_p it1 = __set_iterator(s1, Forward, NULL, NULL, 0, 0);
+	set_it_p it2 = __set_iterator(s2, Forward, NULL, NULL, 0, 0);
+	size_t n = 0, r = cap;
+	int ret = -1;
+	if (a && it1 && it2) {
+		element_p e1 = __set_it_next_element(it1);
+		element_p e2 = __set_it_next_element(it2);
+		ret = 0;
+		while (e1 || (e2 && (keep & SET_ONLY2))) {	// s1取完后只有并集还需要s2剩余的元素
+			int cmp = !e2 ? -1 : !e1 ? 1 : s1->cmpfunc(e1->value, e2->value, e1->len, e2->len);
+			if (cmp < 0) {			// 只在s1中的元素
+				if (keep & SET_ONLY1)
+					a[n++] = e1;
+				else
+					a[--r] = e1;
+				e1 = __set_it_next_element(it1);
+			} else if (cmp > 0) {		// 只在s2中的元素
+				if (keep & SET_ONLY2) {
+					if (!(a[n] = __element_clone(s1->eslab, e2))) {
+						ret = -1;
+						break;
+					}
+					n++;
+				}
+				e2 = __set_it_next_element(it2);
+			} else {			// 两个集合共有的元素
+				if (keep & SET_BOTH)
+					a[n++] = e1;
+				else
+					a[--r] = e1;
+				e1 = __set_it_next_element(it1);
+				e2 = __set_it_next_element(it2);
+			}
+		}
+		if (ret == 0)
+			ret = __set_rebuild(s1, a, n);
+		if (ret == 0) {
+			for (size_t i = r; i < cap; i++)	// 整批销毁删除的元素
+				__element_destroy(s1->eslab, a[i]);
+		} else {
+			for (size_t i = 0; i < n; i++)		// 销毁从s2复制的元素，s1的元素仍在原来的树中
+				if (a[i] && __set_find(s1, a[i]) != a[i])
+					__element_destroy(s1->eslab, a[i]);
+		}
+	}
+	__set_it_destroy(it1);
+	__set_it_destroy(it2);
+	__mr_free(&s1->alloc, a);
+	return ret;
+}
+
+/**
+ * 用有序元素重建集合的树，先在临时集合中构造新树，成功后再释放原有的节点，元素不销毁，原有树中不在数组中的元素由调用者负责处理
+ *
+ * return
+ *	成功返回0，内存不足返回-1，此时集合不变
+ */
+static int __set_rebuild(set_p set, element_p *a, size_t n)
+{
+	set_t tmp = *set;
+	tmp.root = NULL;
+	tmp.btree = NULL;
+	tmp.size = 0;
+	if (__set_build(&tmp, a, n) != 0)
+		return -1;
+	if (set->stype == BPlusTreeSet)
+		__bt_removeall(set, set->btree, 0);
+	else
+		__rbt_removeall(set, set->root, 0);
+	set->root = tmp.root;
+	set->btree = tmp.btree;
+	set->size = tmp.size;
+	set->changes++;
+	return 0;
+}
+
+/**
+ * 用数组中的元素一次性构造空集合的树，元素归集合所有，时间复杂度为O(n)
+ * 元素须按集合的比较函数递增排列，相邻的重复元素只保留第一个；元素不是递增排列时（例如两个集合的比较函数不同）退化为逐个添加
+ *
+ * set
+ *	空集合
+ * a
+ *	元素数组，构造后数组中的内容被改变
+ * n
+ *	元素数量
+ *
+ * return
+ *	成功返回0，分配节点时内存不足返回-1，此时集合仍为空，数组中的元素仍归调用者所有，已销毁的重复元素在数组中置为NULL
+ *	元素不是递增排列时同样如此，逐个添加到一半内存不足时已添加的元素也从树中取出交还调用者
+ */
+static int __set_build(set_p set, element_p *a, size_t n)
+{
+	size_t m = 0;
+	int sorted = 1;
+	for (size_t i = 0; i < n; i++) {
+		int cmp = m > 0 ? set->cmpfunc(a[i]->value, a[m - 1]->value, a[i]->len, a[m - 1]->len) : 1;
+		if (cmp == 0) {
+			__element_destroy(set->eslab, a[i]);
+		} else {
+			sorted = sorted && cmp > 0;
+			a[m++] = a[i];
+		}
+	}
+	if (!sorted) {
+		size_t k = 0;
+		for (size_t i = 0; i < m; i++) {
+			if (__set_find(set, a[i])) {		// 先查找出重复的元素，__set_add()失败就只可能是内存不足
+				__element_destroy(set->eslab, a[i]);
+			} else if (__set_add(set, a[i]) == 0) {
+				a[k++] = a[i];
+			} else {				// 拆掉已构造的树但不销毁元素，全部元素交还调用者
+				if (set->stype == BPlusTreeSet)
+					__bt_removeall(set, set->btree, 0);
+				else
+					__rbt_removeall(set, set->root, 0);
+				set->root = NULL;
+				set->btree = NULL;
+				set->size = 0;
+				while (i < m)
+					a[k++] = a[i++];
+				while (k < n)
+					a[k++] = NULL;
+				return -1;
+			}
+		}
+		return 0;
+	}
+	int ret = 0;
+	if (set->stype == BPlusTreeSet) {
+		ret = __bt_build(set, a, m);
+	} else if (m > 0) {
+		rbt_node_p pool = NULL, node;
+		size_t i = 0;
+		for (; i < m && (node = __rbt_new_node(set, NULL)); i++) {	// 预先分配全部节点，用parent串成链表
+			node->parent = pool;
+			pool = node;
+		}
+		if (i == m) {
+			int red = 0;		// 最底层的深度，即floor(lg2(m))
+			while ((m >> red) > 1)
+				red++;
+			set->root = __rbt_build(&pool, a, m, 0, red, NULL);
+		} else {
+			ret = -1;
+			while ((node = pool)) {
+				pool = node->parent;
+				__slab_free(set->nslab, node);
+			}
+		}
+	}
+	if (ret == 0) {
+		set->size = m;
+		set->changes++;
+	} else {
+		for (size_t i = m; i < n; i++)
+			a[i] = NULL;
+	}
+	return ret;
+}
+
+/**
+ * 取有序元素的中间元素作为根节点，左右两半递归构造左右子树，兄弟子树的节点数量至多相差1，所有叶节点的深度至多相差1
+ * 除根节点外最底层的节点涂为红色，其余节点涂为黑色，每条路径上的黑色节点数量相同，满足红黑树的性质
+ *
+ * pool
+ *	预先分配的节点链表，用parent链接
+ * a
+ *	有序元素
+ * n
+ *	元素数量
+ * depth
+ *	子树根节点的深度
+ * red
+ *	最底层的深度
+ * parent
+ *	子树根节点的父节点
+ *
+ * return
+ *	子树的根节点
+ */
+static rbt_node_p __rbt_build(rbt_node_p *pool, element_p *a, size_t n, int depth, int red, rbt_node_p parent)
+{
+	if (n == 0)
+		return NULL;
+	size_t mid = n / 2;
+	rbt_node_p node = *pool;
+	*pool = node->parent;
+	node->element = a[mid];
+	node->parent = parent;
+	node->size = n;
+	node->color = depth == red && depth > 0 ? Red : Black;
+	node->left = __rbt_build(pool, a, mid, depth + 1, red, node);
+	node->right = __rbt_build(pool, a + mid + 1, n - mid - 1, depth + 1, red, node);
+	return node;
+}
+
+/**
+ * 用有序元素自底向上逐层构造B+树，先把元素平均分到尽量少的叶节点中，再把每一层的节点平均分到尽量少的上层节点中，直到只剩一个根节点
+ * 平均分配保证了非根节点的键数量不少于BT_MIN - 1，之后的插入和删除与逐个插入构造的树相同，所有节点在修改树之前预先分配
+ *
+ * return
+ *	成功返回0，内存不足返回-1，元素由调用者负责销毁
+ */
+static int __bt_build(set_p set, element_p *a, size_t n)
+{
+	if (n == 0)
+		return 0;
+	size_t total = 0, count = (n + BT_MAX - 1) / BT_MAX;
+	for (size_t c = count; ; c = (c + BT_MAX) / (BT_MAX + 1)) {	// 计算所有层的节点数量之和
+		total += c;
+		if (c == 1)
+			break;
+	}
+	bt_node_p *nodes = (bt_node_p *)__mr_malloc(&set->alloc, total * sizeof(bt_node_p));
+	size_t k = 0;
+	while (nodes && k < total && (nodes[k] = __bt_new_node(set, 1)))
+		k++;
+	if (!nodes || k < total) {
+		while (k > 0)
+			__slab_free(set->nslab, nodes[--k]);
+		__mr_free(&set->alloc, nodes);
+		return -1;
+	}
+	bt_node_p *level = nodes, *upper;
+	for (size_t i = 0, j = 0; i < count; i++) {	// 叶节点层，前n % count个叶节点多分一个元素
+		bt_node_p leaf = level[i];
+		leaf->count = (int)(n / count + (i < n % count));
+		for (int p = 0; p < leaf->count; p++, j++) {
+			leaf->keys[p].ik = set->ikey ? *(Integer *)a[j]->value : 0;
+			leaf->keys[p].element = a[j];
+		}
+		leaf->prev = i > 0 ? level[i - 1] : NULL;
+		leaf->next = i + 1 < count ? level[i + 1] : NULL;
+	}
+	while (count > 1) {			// 逐层向上构造内部节点，上层的分隔键为各子树最左叶节点的第一个元素
+		size_t parents = (count + BT_MAX) / (BT_MAX + 1);
+		upper = level + count;
+		for (size_t i = 0, j = 0; i < parents; i++) {
+			bt_node_p node = upper[i];
+			int children = (int)(count / parents + (i < count % parents));
+			node->leaf = 0;
+			node->count = children - 1;
+			for (int c = 0; c < children; c++, j++) {
+				node->children[c] = level[j];
+				node->total += BT_SIZE(level[j]);
+				if (c > 0)
+					node->keys[c - 1] = __bt_edge(level[j], 1)->keys[0];
+			}
+		}
+		level = upper;
+		count = parents;
+	}
+	set->btree = level[0];
+	__mr_free(&set->alloc, nodes);
+	return 0;
 }
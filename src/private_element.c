@@ -1,43 +1,43 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "mr_common.h"
-
-/**
- * 元素的内部结构
- */
-typedef struct {
-	void *value;
-	ElementType type;
-	size_t len;
-} element_t, *element_p;
+#include "private_element.h"
+#include "private_alloc.h"
 
 static int int_cmp(const Element e1, const Element e2, size_t len1, size_t len2);
 static int real_cmp(const Element e1, const Element e2, size_t len1, size_t len2);
 static int str_cmp(const Element e1, const Element e2, size_t len1, size_t len2);
 static int obj_cmp(const Element e1, const Element e2, size_t len1, size_t len2);
+static size_t int_hash(const Element e, size_t len);
+static size_t real_hash(const Element e, size_t len);
+static size_t str_hash(const Element e, size_t len);
+static size_t obj_hash(const Element e, size_t len);
+static size_t __element_ilen(ElementType type, size_t vlen);
+static void __element_fill(element_p e, void *buf, Element value, ElementType type, size_t len, size_t vlen, size_t ilen);
 
-element_p __element_create(Element value, ElementType type, size_t len)
+element_p __element_create(slab_p slab, Element value, ElementType type, size_t len)
 {
 	element_p e = NULL;
-	if ((e = (element_p)malloc(sizeof(element_t)))) {
-		if (value && len) {
-			e->type = type;
-			e->len = type == string ? len + 1 : len;
-			e->value = malloc(e->len);
-			switch (type) {
-				case integer:
-				case real:
-				case object:
-					memcpy(e->value, value, len);
-					break;
-				case string:
-					strncpy(e->value, value, len);
-					*(char *)(e->value + len) = '\0';
-					break;
+	size_t vlen = value && len ? (type == string ? len + 1 : len) : 0;
+	size_t ilen = __element_ilen(type, vlen);
+	int inl = sizeof(element_t) + ilen <= (SLAB_ACTIVE(slab) ? slab->size : sizeof(element_t) + ELE_INLINE_MAX);
+	if ((e = (element_p)__slab_alloc(slab, sizeof(element_t) + (inl ? ilen : 0)))) {
+		if (vlen) {
+			if (inl) {
+				__element_fill(e, e->data, value, type, len, vlen, ilen);
+				e->flags = ELE_INLINE;
+			} else if ((e->value = __mr_malloc(SLAB_ALLOCATOR(slab), vlen))) {
+				__element_fill(e, e->value, value, type, len, vlen, vlen);
+				e->flags = 0;
+				if (SLAB_ACTIVE(slab))
+					slab->outer++;
+			} else {
+				__slab_free(slab, e);
+				return NULL;
 			}
 		} else {
 			e->type = object;
+			e->flags = 0;
 			e->value = NULL;
 			e->len = 0;
 		}
@@ -45,27 +45,153 @@ element_p __element_create(Element value, ElementType type, size_t len)
 	return e;
 }
 
+element_p __element_clone(slab_p slab, element_p element)
+{
+	size_t len = element->type == string && element->len > 0 ? element->len - 1 : element->len;
+	return __element_create(slab, element->value, element->type, len);
+}
+
+element_p __element_temp(element_tmp_p tmp, Allocator alloc, Element value, ElementType type, size_t len)
+{
+	element_p e = (element_p)tmp->buf;
+	size_t vlen = value && len ? (type == string ? len + 1 : len) : 0;
+	size_t ilen = __element_ilen(type, vlen);
+	e->flags = ELE_INLINE;
+	if (!vlen) {
+		e->type = object;
+		e->value = NULL;
+		e->len = 0;
+	} else if (ilen <= ELE_INLINE_MAX) {
+		__element_fill(e, e->data, value, type, len, vlen, ilen);
+	} else {
+		void *buf = __mr_malloc(alloc, vlen);
+		if (!buf)
+			return NULL;
+		__element_fill(e, buf, value, type, len, vlen, vlen);
+		e->flags = 0;
+	}
+	return e;
+}
+
+void __element_temp_release(Allocator alloc, element_p element)
+{
+	if (element && !(element->flags & ELE_INLINE))
+		__mr_free(alloc, element->value);
+}
+
+element_p __element_adopt(slab_p slab, Element value, ElementType type, size_t len)
+{
+	element_p e = NULL;
+	if (value && len && (e = (element_p)__slab_alloc(slab, sizeof(element_t)))) {
+		e->value = value;
+		e->type = type;
+		e->flags = 0;
+		e->len = type == string ? len + 1 : len;
+		if (type == string)
+			*(char *)(value + len) = '\0';
+		if (SLAB_ACTIVE(slab))
+			slab->outer++;
+	}
+	return e;
+}
+
+void __element_detach(slab_p slab, element_p element)
+{
+	if (SLAB_ACTIVE(slab) && element && element->value && !(element->flags & ELE_INLINE))
+		slab->outer--;
+	__slab_free(slab, element);
+}
+
+size_t __element_size(ElementType type)
+{
+	size_t ret = sizeof(element_t);
+	switch (type) {
+		case integer:
+			ret += sizeof(Integer);
+			break;
+		case real:
+			ret += sizeof(Real);
+			break;
+		default:
+			ret += ELE_INLINE_MAX;
+	}
+	return ret;
+}
+
 int __element_isnull(element_p element)
 {
 	return element->value && element->len;
 }
 
-void __element_destroy(element_p element)
+void __element_destroy(slab_p slab, element_p element)
 {
 	if (!element)
 		return;
-	free(element->value);
-	free(element);
+	if (!(element->flags & ELE_INLINE) && element->value) {
+		__mr_free(SLAB_ALLOCATOR(slab), element->value);
+		if (SLAB_ACTIVE(slab))
+			slab->outer--;
+	}
+	__slab_free(slab, element);
 }
 
-Element __element_clone_value(element_p element)
+Element __element_clone_value(slab_p slab, element_p element)
 {
 	Element ret = NULL;
-	if (element && element->value && (ret = malloc(element->len)))
+	if (element && element->value && (ret = __mr_malloc(SLAB_ALLOCATOR(slab), element->len)))
 		memcpy(ret, element->value, element->len);
 	return ret;
 }
 
+Element __element_take_value(slab_p slab, element_p element)
+{
+	Element ret = NULL;
+	if (element && (element->flags & ELE_INLINE) && !SLAB_ACTIVE(slab))
+		ret = memmove(element, element->value, element->len);	// 元素结构是单独分配的，内联的值移到开头后整块交出，不需要复制
+	else if ((ret = __element_prepare_take(slab, element)) || (element && !element->value))
+		__element_detach(slab, element);
+	return ret;
+}
+
+Element __element_prepare_take(slab_p slab, element_p element)
+{
+	Element ret = NULL;
+	if (element)
+		ret = element->flags & ELE_INLINE ? __element_clone_value(slab, element) : element->value;
+	return ret;
+}
+
+void __element_cancel_take(slab_p slab, element_p element, Element value)
+{
+	if (element && (element->flags & ELE_INLINE))
+		__mr_free(SLAB_ALLOCATOR(slab), value);
+}
+
+int __element_visit(element_p element, VisitFunc visit, void *ctx)
+{
+	return visit(element->value, element->len, ctx);
+}
+
+long __element_copy_into(element_p element, void *buf, size_t cap)
+{
+	if (element->value && element->len <= cap)
+		memcpy(buf, element->value, element->len);
+	return element->len;
+}
+
+Element __element_array_at(const void *values, size_t index, ElementType type, size_t len, size_t *elen)
+{
+	Element ret;
+	if (type == string) {
+		ret = ((String *)values)[index];
+		*elen = ret ? strlen(ret) : 0;
+	} else {
+		ret = (char *)values + index * len;
+		*elen = len;
+	}
+	return ret;
+}
+
 CmpFunc __default_cmpfunc(ElementType type)
 {
 	CmpFunc ret = NULL;
@@ -85,6 +211,60 @@ CmpFunc __default_cmpfunc(ElementType type)
 	return ret;
 }
 
+HashFunc __default_hashfunc(ElementType type)
+{
+	HashFunc ret = NULL;
+	switch (type) {
+		case integer:
+			ret = int_hash;
+			break;
+		case real:
+			ret = real_hash;
+			break;
+		case string:
+			ret = str_hash;
+			break;
+		default:
+			ret = obj_hash;
+	}
+	return ret;
+}
+
+/**
+ * 计算元素值内联存储时占用的字节数，数值元素内联存储时至少保留一个完整数值的空间，默认比较函数按完整类型读取
+ */
+static size_t __element_ilen(ElementType type, size_t vlen)
+{
+	if (type == integer && vlen < sizeof(Integer))
+		return sizeof(Integer);
+	else if (type == real && vlen < sizeof(Real))
+		return sizeof(Real);
+	return vlen;
+}
+
+/**
+ * 把元素值复制到buf中并填写元素的类型、长度和值地址，buf中超出vlen的部分置0，字符串在len处加结尾符
+ */
+static void __element_fill(element_p e, void *buf, Element value, ElementType type, size_t len, size_t vlen, size_t ilen)
+{
+	e->value = buf;
+	e->type = type;
+	e->len = vlen;
+	if (ilen > vlen)
+		memset(buf + vlen, 0, ilen - vlen);
+	switch (type) {
+		case integer:
+		case real:
+		case object:
+			memcpy(buf, value, len);
+			break;
+		case string:
+			strncpy(buf, value, len);
+			*(char *)(buf + len) = '\0';
+			break;
+	}
+}
+
 /**
  * 默认的元素比较函数，NULL认为比任何非NULL元素小，两个NULL元素相等
  *
@@ -144,3 +324,49 @@ static int obj_cmp(const Element e1, const Element e2, size_t len1, size_t len2)
 	}
 	return ret;
 }
+
+/**
+ * 默认的元素哈希函数，与默认比较函数配套，NULL元素的哈希值为0
+ *
+ * e
+ *	元素的值
+ * len
+ *	元素的长度
+ *
+ * return
+ *	Integer: 直接以整数值作为哈希值
+ *	Real: 转换为double型后取其二进制表示，0和-0得到相同的哈希值
+ *	String: 对结尾符之前的字节计算FNV-1a哈希值
+ *	Object: 对全部len个字节计算FNV-1a哈希值
+ */
+static size_t int_hash(const Element e, size_t len)
+{
+	return e ? (size_t)*(Integer *)e : 0;
+}
+
+static size_t real_hash(const Element e, size_t len)
+{
+	unsigned long long bits = 0;
+	if (e && *(Real *)e != 0) {
+		double d = (double)*(Real *)e;
+		memcpy(&bits, &d, sizeof(bits));
+	}
+	return (size_t)bits;
+}
+
+static size_t str_hash(const Element e, size_t len)
+{
+	unsigned long long h = 14695981039346656037ULL;
+	for (const unsigned char *p = (const unsigned char *)e; p && *p; p++)
+		h = (h ^ *p) * 1099511628211ULL;
+	return e ? (size_t)h : 0;
+}
+
+static size_t obj_hash(const Element e, size_t len)
+{
+	unsigned long long h = 14695981039346656037ULL;
+	const unsigned char *p = (const unsigned char *)e;
+	for (size_t i = 0; p && i < len; i++)
+		h = (h ^ p[i]) * 1099511628211ULL;
+	return e ? (size_t)h : 0;
+}
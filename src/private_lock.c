@@ -0,0 +1,49 @@
+#include <pthread.h>
+
+#include "mr_common.h"
+#include "private_lock.h"
+
+int __lock_init(lock_p lock, LockPolicy policy)
+{
+	int ret = -1;
+	lock->policy = policy;
+	switch (policy) {
+	case Lock_Mutex:
+		ret = pthread_mutex_init(&lock->u.mutex, NULL) == 0 ? 0 : -1;
+		break;
+	case Lock_None:
+		ret = 0;
+		break;
+	case Lock_RWLock:
+		ret = pthread_rwlock_init(&lock->u.rwlock, NULL) == 0 ? 0 : -1;
+		break;
+	case Lock_Spin:
+		ret = pthread_spin_init(&lock->u.spin, PTHREAD_PROCESS_PRIVATE) == 0 ? 0 : -1;
+		break;
+	default:
+		break;
+	}
+	return ret;
+}
+
+void __lock_destroy(lock_p lock)
+{
+	switch (lock->policy) {
+	case Lock_Mutex:
+		pthread_mutex_destroy(&lock->u.mutex);
+		break;
+	case Lock_RWLock:
+		pthread_rwlock_destroy(&lock->u.rwlock);
+		break;
+	case Lock_Spin:
+		pthread_spin_destroy(&lock->u.spin);
+		break;
+	default:
+		break;
+	}
+}
+
+pthread_mutex_t *__lock_mutex(lock_p lock)
+{
+	return lock->policy == Lock_Mutex ? &lock->u.mutex : NULL;
+}
@@ -0,0 +1,122 @@
+#include <stdlib.h>
+
+#include "mr_common.h"
+#include "private_slab.h"
+
+#define SLAB_ALIGN sizeof(Real)
+#define SLAB_ROUND(S) (((S) + SLAB_ALIGN - 1) / SLAB_ALIGN * SLAB_ALIGN)
+
+#define SLAB_INIT_COUNT 64
+#define SLAB_MAX_COUNT 65536
+
+/**
+ * 块的头部结构，块中的对象紧随其后
+ */
+typedef struct SlabBlock {
+	struct SlabBlock *next;
+} slab_block_t, *slab_block_p;
+
+/**
+ * 空闲对象，空闲期间对象的头部用作链表指针
+ */
+typedef struct SlabIdle {
+	struct SlabIdle *next;
+} slab_idle_t, *slab_idle_p;
+
+static int __slab_grow(slab_p slab);		// 分配一个新块
+
+slab_p __slab_create(size_t size, int active, Allocator alloc)
+{
+	slab_p slab = (slab_p)alloc->malloc_fn(sizeof(slab_t), alloc->ctx);
+	if (slab) {
+		slab->size = SLAB_ROUND(size < sizeof(slab_idle_t) ? sizeof(slab_idle_t) : size);
+		slab->count = SLAB_INIT_COUNT;
+		slab->blocks = NULL;
+		slab->idle = NULL;
+		slab->cursor = NULL;
+		slab->end = NULL;
+		slab->outer = 0;
+		slab->active = active;
+		slab->alloc = *alloc;
+	}
+	return slab;
+}
+
+void __slab_destroy(slab_p slab)
+{
+	if (slab) {
+		Allocator_t alloc = slab->alloc;
+		__slab_reset(slab);
+		alloc.free_fn(slab, alloc.ctx);
+	}
+}
+
+void *__slab_alloc(slab_p slab, size_t size)
+{
+	void *ret = NULL;
+	if (!slab) {
+		ret = mr_malloc(size);
+	} else if (!slab->active) {
+		ret = slab->alloc.malloc_fn(size, slab->alloc.ctx);
+	} else if (slab->idle) {
+		ret = slab->idle;
+		slab->idle = ((slab_idle_p)ret)->next;
+	} else if (slab->cursor < slab->end || __slab_grow(slab) == 0) {
+		ret = slab->cursor;
+		slab->cursor += slab->size;
+	}
+	return ret;
+}
+
+void __slab_free(slab_p slab, void *ptr)
+{
+	if (!slab) {
+		mr_free(ptr);
+	} else if (!slab->active) {
+		slab->alloc.free_fn(ptr, slab->alloc.ctx);
+	} else if (ptr) {
+		((slab_idle_p)ptr)->next = slab->idle;
+		slab->idle = ptr;
+	}
+}
+
+void __slab_reset(slab_p slab)
+{
+	if (!SLAB_ACTIVE(slab))
+		return;
+	slab_block_p block = slab->blocks;
+	while (block) {
+		slab_block_p next = block->next;
+		slab->alloc.free_fn(block, slab->alloc.ctx);
+		block = next;
+	}
+	slab->blocks = NULL;
+	slab->idle = NULL;
+	slab->cursor = NULL;
+	slab->end = NULL;
+	slab->outer = 0;
+}
+
+/**
+ * 分配一个新块并作为当前块，新块的对象数量每次增长一倍直到SLAB_MAX_COUNT
+ *
+ * slab
+ *	slab
+ *
+ * return
+ *	成功返回0，失败返回-1
+ */
+static int __slab_grow(slab_p slab)
+{
+	size_t head = SLAB_ROUND(sizeof(slab_block_t));
+	slab_block_p block = (slab_block_p)slab->alloc.malloc_fn(head + slab->count * slab->size, slab->alloc.ctx);
+	if (!block)
+		return -1;
+	block->next = slab->blocks;
+	slab->blocks = block;
+	slab->cursor = (char *)block + head;
+	slab->end = slab->cursor + slab->count * slab->size;
+	if (slab->count < SLAB_MAX_COUNT)
+		slab->count <<= 1;
+	return 0;
+}